@@ -33,7 +33,39 @@ VIVANTE_SDK_DIR :=/media/jcq/study/GPU/source/GPU_userspace_binaries_and_VTK_too
 ARM_APP = gpu_hello
 
 ARM_APP_SRCS =                                                               \
-    tutorial.cpp                                                                 \
+    main.cpp                                                                 \
+    arena.cpp                                                                \
+    batch.cpp                                                                \
+    bench.cpp                                                                \
+    camerasource.cpp                                                         \
+    cull.cpp                                                                 \
+    damage.cpp                                                               \
+    eventthread.cpp                                                          \
+    extensions.cpp                                                           \
+    framepacer.cpp                                                           \
+    framestats.cpp                                                           \
+    framewriter.cpp                                                          \
+    glstate.cpp                                                              \
+    gltrace.cpp                                                              \
+    imagefilter.cpp                                                          \
+    imagepipe.cpp                                                            \
+    meshfile.cpp                                                             \
+    offscreen.cpp                                                            \
+    programcache.cpp                                                         \
+    renderqueue.cpp                                                          \
+    scenario.cpp                                                             \
+    scene.cpp                                                                \
+    shaderprogram.cpp                                                        \
+    shadersource.cpp                                                         \
+    shadervariant.cpp                                                        \
+    simulation.cpp                                                           \
+    spscqueue.cpp                                                            \
+    startup.cpp                                                              \
+    streambuffer.cpp                                                         \
+    swrast.cpp                                                               \
+    texstream.cpp                                                            \
+    triplebuffer.cpp                                                         \
+    vertexbuffer.cpp                                                         \
 
 ARM_INCS =                                                                   \
     -I.																		 \
@@ -45,6 +77,111 @@ ARM_LDOPTS +=                                                                \
 	-Wl,-rpath-link=$(VIVANTE_SDK_DIR)/lib                              	 \
 	-lEGL																	 \
 	-lGLESv2                                                                 \
-	-lVDK
+	-lVDK                                                                    \
+	-lpthread
 
 ARM_DEFS += -DLINUX -DEGL_API_FB -DGPU_TYPE_VIV -DGL_GLEXT_PROTOTYPES
+
+
+##############################################################################
+# X86_APP
+#
+# Host build of the same application, linked against the headless
+# EGL/GLES2/VDK stand-in in src/host instead of the Vivante libraries. It
+# counts GL calls, state changes and uploaded bytes per frame and prints
+# them when the application calls vdkFinishEGL(). Only the Khronos GLES2/EGL
+# headers are needed on the host (e.g. libgles-dev and libegl-dev).
+##############################################################################
+
+X86_APP = gpu_hello_host
+
+X86_APP_SRCS =                                                               \
+    main.cpp                                                                 \
+    arena.cpp                                                                \
+    batch.cpp                                                                \
+    bench.cpp                                                                \
+    camerasource.cpp                                                         \
+    cull.cpp                                                                 \
+    damage.cpp                                                               \
+    eventthread.cpp                                                          \
+    extensions.cpp                                                           \
+    framepacer.cpp                                                           \
+    framestats.cpp                                                           \
+    framewriter.cpp                                                          \
+    glstate.cpp                                                              \
+    gltrace.cpp                                                              \
+    imagefilter.cpp                                                          \
+    imagepipe.cpp                                                            \
+    meshfile.cpp                                                             \
+    offscreen.cpp                                                            \
+    programcache.cpp                                                         \
+    renderqueue.cpp                                                          \
+    scenario.cpp                                                             \
+    scene.cpp                                                                \
+    shaderprogram.cpp                                                        \
+    shadersource.cpp                                                         \
+    shadervariant.cpp                                                        \
+    simulation.cpp                                                           \
+    spscqueue.cpp                                                            \
+    startup.cpp                                                              \
+    streambuffer.cpp                                                         \
+    swrast.cpp                                                               \
+    texstream.cpp                                                            \
+    triplebuffer.cpp                                                         \
+    vertexbuffer.cpp                                                         \
+    host/host_counters.cpp                                                   \
+    host/vdk_host.cpp                                                        \
+    host/egl_host.cpp                                                        \
+    host/gl_host.cpp                                                         \
+
+X86_INCS =                                                                   \
+    -I.                                                                      \
+    -I../src/host                                                            \
+
+X86_LDOPTS +=                                                                \
+    -lpthread                                                                \
+    -lm
+
+X86_DEFS += -DLINUX -DGL_GLEXT_PROTOTYPES -DHEAP_STATS
+
+
+##############################################################################
+# Embedded shaders
+#
+# The GLSL sources are turned into string tables in the build directory
+# (shaders_embedded.h, found through -I.), so the application reads no
+# shader files at startup. Run with -d <dir> to use edited copies instead.
+##############################################################################
+
+SHADER_SRCS =                                                                \
+    vs_es20t1.vert                                                           \
+    ps_es20t1.frag                                                           \
+    camera.vert                                                              \
+    camera_yuv.frag                                                          \
+    camera_rgb.frag                                                          \
+    imagepipe.vert                                                           \
+    imagepipe.frag                                                           \
+
+SHADER_FILES = $(addprefix ../src/,$(SHADER_SRCS))
+
+# One string literal per source line; the table name is the file name with
+# '.' replaced by '_'.
+shaders_embedded.h: $(SHADER_FILES)
+	@echo "Embedding $(strip $(SHADER_SRCS))"
+	@( echo "/* Generated from $(strip $(SHADER_SRCS)) - do not edit. */" ;           \
+	   for f in $(SHADER_FILES) ; do                                             \
+	       n=`basename $$f | tr '.' '_'` ;                                       \
+	       echo "static const char $${n}[] =" ;                                  \
+	       sed -e 's/\r$$//' -e 's/\\/\\\\/g' -e 's/"/\\"/g'                     \
+	           -e 's/^/    "/' -e 's/$$/\\n"/' $$f ;                             \
+	       echo "    \"\";" ;                                                    \
+	   done ;                                                                    \
+	   echo "static const EmbeddedShader embeddedShaders[] =" ;                  \
+	   echo "{" ;                                                                \
+	   for f in $(SHADER_FILES) ; do                                             \
+	       b=`basename $$f` ; n=`echo $$b | tr '.' '_'` ;                        \
+	       echo "    { \"$$b\", $${n}, sizeof($${n}) - 1 }," ;                   \
+	   done ;                                                                    \
+	   echo "};" ) > $@.tmp && mv $@.tmp $@
+
+shadersource.o: shaders_embedded.h
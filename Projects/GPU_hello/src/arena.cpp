@@ -0,0 +1,252 @@
+/*
+ * Allocation without the heap in the frame loop.
+ *
+ * A free pool item holds the pointer to the next free one. With HEAP_STATS
+ * the heap counters replace malloc() and friends for the whole process and
+ * forward to glibc's own entry points; the counts are atomic, as any thread
+ * may allocate.
+ */
+
+#include "arena.h"
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+static Arena frameArena;
+
+/***************************************************************************************
+***************************************************************************************/
+
+int ArenaInit(Arena * Ar, size_t Size)
+{
+    memset(Ar, 0, sizeof(*Ar));
+    Size = (Size + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+    if (posix_memalign((void **)&Ar->base, ARENA_ALIGN, Size) != 0)
+    {
+        Ar->base = NULL;
+        return 0;
+    }
+    Ar->size = Size;
+    return 1;
+}
+
+void ArenaDestroy(Arena * Ar)
+{
+    free(Ar->base);
+    memset(Ar, 0, sizeof(*Ar));
+}
+
+void * ArenaAlloc(Arena * Ar, size_t Bytes)
+{
+    Bytes = (Bytes + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+    if ((Ar->base == NULL) || (Bytes > Ar->size - Ar->used))
+    {
+        ++Ar->failures;
+        return NULL;
+    }
+    void * memory = Ar->base + Ar->used;
+    Ar->used += Bytes;
+    Ar->peak = (Ar->used > Ar->peak) ? Ar->used : Ar->peak;
+    ++Ar->allocations;
+    return memory;
+}
+
+void ArenaReset(Arena * Ar)
+{
+    Ar->used = 0;
+    ++Ar->resets;
+}
+
+/***************************************************************************************
+***************************************************************************************/
+
+int FrameArenaInit(size_t Size)
+{
+    FrameArenaDestroy();
+    return ArenaInit(&frameArena, Size);
+}
+
+void FrameArenaDestroy(void)
+{
+    ArenaDestroy(&frameArena);
+}
+
+void * FrameAlloc(size_t Bytes)
+{
+    return ArenaAlloc(&frameArena, Bytes);
+}
+
+void FrameArenaReset(void)
+{
+    ArenaReset(&frameArena);
+}
+
+const Arena * FrameArenaGet(void)
+{
+    return &frameArena;
+}
+
+/***************************************************************************************
+***************************************************************************************/
+
+int PoolInit(Pool * Pl, int ItemSize, int Capacity)
+{
+    memset(Pl, 0, sizeof(*Pl));
+    Pl->itemSize = (ItemSize + ARENA_ALIGN - 1) & ~(ARENA_ALIGN - 1);
+    if (posix_memalign((void **)&Pl->items, ARENA_ALIGN, (size_t)Pl->itemSize * Capacity) != 0)
+    {
+        Pl->items = NULL;
+        return 0;
+    }
+    Pl->capacity = Capacity;
+
+    // Free list in address order.
+    for (int i = Capacity - 1; i >= 0; --i)
+    {
+        void * item = Pl->items + (size_t)i * Pl->itemSize;
+        *(void **)item = Pl->freeList;
+        Pl->freeList = item;
+    }
+    return 1;
+}
+
+void PoolDestroy(Pool * Pl)
+{
+    free(Pl->items);
+    memset(Pl, 0, sizeof(*Pl));
+}
+
+void * PoolAlloc(Pool * Pl)
+{
+    void * item = Pl->freeList;
+    if (item == NULL)
+    {
+        ++Pl->failures;
+        return NULL;
+    }
+    Pl->freeList = *(void **)item;
+    ++Pl->used;
+    Pl->peak = (Pl->used > Pl->peak) ? Pl->used : Pl->peak;
+    return item;
+}
+
+void PoolFree(Pool * Pl, void * Item)
+{
+    if (Item != NULL)
+    {
+        *(void **)Item = Pl->freeList;
+        Pl->freeList = Item;
+        --Pl->used;
+    }
+}
+
+/***************************************************************************************
+***************************************************************************************/
+
+#if defined(HEAP_STATS) && defined(__GLIBC__)
+
+static HeapStats heapStats;
+
+static void heapCount(size_t Size)
+{
+    __atomic_fetch_add(&heapStats.allocations, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&heapStats.bytes, Size, __ATOMIC_RELAXED);
+}
+
+extern "C"
+{
+void * __libc_malloc(size_t Size);
+void * __libc_calloc(size_t Count, size_t Size);
+void * __libc_realloc(void * Memory, size_t Size);
+void * __libc_memalign(size_t Alignment, size_t Size);
+void * __libc_valloc(size_t Size);
+void * __libc_pvalloc(size_t Size);
+void __libc_free(void * Memory);
+
+void * malloc(size_t Size)
+{
+    heapCount(Size);
+    return __libc_malloc(Size);
+}
+
+void * calloc(size_t Count, size_t Size)
+{
+    heapCount(Count * Size);
+    return __libc_calloc(Count, Size);
+}
+
+void * realloc(void * Memory, size_t Size)
+{
+    heapCount(Size);
+    return __libc_realloc(Memory, Size);
+}
+
+// Every way to get memory free() takes back is counted, so the counts
+// balance.
+int posix_memalign(void ** Memory, size_t Alignment, size_t Size)
+{
+    if ((Alignment % sizeof(void *) != 0) || ((Alignment & (Alignment - 1)) != 0) || (Alignment == 0))
+    {
+        return EINVAL;
+    }
+    heapCount(Size);
+    void * memory = __libc_memalign(Alignment, Size);
+    if (memory == NULL)
+    {
+        return ENOMEM;
+    }
+    *Memory = memory;
+    return 0;
+}
+
+void * memalign(size_t Alignment, size_t Size)
+{
+    heapCount(Size);
+    return __libc_memalign(Alignment, Size);
+}
+
+void * aligned_alloc(size_t Alignment, size_t Size)
+{
+    heapCount(Size);
+    return __libc_memalign(Alignment, Size);
+}
+
+void * valloc(size_t Size)
+{
+    heapCount(Size);
+    return __libc_valloc(Size);
+}
+
+void * pvalloc(size_t Size)
+{
+    heapCount(Size);
+    return __libc_pvalloc(Size);
+}
+
+void free(void * Memory)
+{
+    if (Memory != NULL)
+    {
+        __atomic_fetch_add(&heapStats.frees, 1, __ATOMIC_RELAXED);
+    }
+    __libc_free(Memory);
+}
+}
+
+int HeapGetStats(HeapStats * Stats)
+{
+    Stats->allocations = __atomic_load_n(&heapStats.allocations, __ATOMIC_RELAXED);
+    Stats->frees = __atomic_load_n(&heapStats.frees, __ATOMIC_RELAXED);
+    Stats->bytes = __atomic_load_n(&heapStats.bytes, __ATOMIC_RELAXED);
+    return 1;
+}
+
+#else
+
+int HeapGetStats(HeapStats * Stats)
+{
+    memset(Stats, 0, sizeof(*Stats));
+    return 0;
+}
+
+#endif
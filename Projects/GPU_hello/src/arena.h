@@ -0,0 +1,101 @@
+/*
+ * Allocation without the heap in the frame loop.
+ *
+ *  - Arena: a linear allocator over one block allocated up front. Memory
+ *    is handed out by moving a pointer and given back all at once by a
+ *    reset; there is no per-allocation free.
+ *  - Frame arena: the arena for data that lives for one frame (draw lists,
+ *    uniform staging, culling output, info logs at startup). It is reset
+ *    after each swap, when the GL has copied whatever was passed to it.
+ *  - Pool: fixed-size items from one block with a free list, for objects
+ *    created and destroyed at run time, such as GL object wrappers.
+ *
+ * None of them grows: a full arena or pool returns NULL and counts the
+ * failure, and the caller falls back or drops the work. The peaks show
+ * the size needed.
+ *
+ * The heap counters count every malloc(), calloc(), realloc() and aligned
+ * allocation of the process (driver and C++ runtime included) by wrapping
+ * glibc's functions, so a frame that allocates shows up however deep the
+ * call is. The wrappers add an atomic add to every allocation, so they are
+ * only built with HEAP_STATS defined (the host build does); the target
+ * build keeps the plain allocator and counts nothing.
+ */
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+// Every allocation is aligned to this, enough for NEON/SSE2 vectors.
+#define ARENA_ALIGN     16
+
+typedef struct _Arena
+{
+    unsigned char *     base;
+    size_t              size;
+    size_t              used;
+    size_t              peak;       // most used between resets
+    unsigned long long  allocations;
+    unsigned long long  failures;   // did not fit
+    unsigned long long  resets;
+}
+Arena;
+
+typedef struct _Pool
+{
+    unsigned char *     items;
+    void *              freeList;
+    int                 itemSize;
+    int                 capacity;
+    int                 used;
+    int                 peak;
+    unsigned long long  failures;   // pool empty
+}
+Pool;
+
+typedef struct _HeapStats
+{
+    unsigned long long  allocations;    // malloc, calloc, realloc and aligned calls
+    unsigned long long  frees;
+    unsigned long long  bytes;          // asked for
+}
+HeapStats;
+
+// returns 0: out of memory
+//         1: success
+int ArenaInit(Arena * Ar, size_t Size);
+void ArenaDestroy(Arena * Ar);
+
+// returns ARENA_ALIGN aligned memory, or NULL when it does not fit
+void * ArenaAlloc(Arena * Ar, size_t Bytes);
+void ArenaReset(Arena * Ar);
+
+// The frame arena.
+// returns 0: out of memory
+//         1: success
+int FrameArenaInit(size_t Size);
+void FrameArenaDestroy(void);
+
+// returns NULL when full or not initialized
+void * FrameAlloc(size_t Bytes);
+
+// Call once per frame, after the swap.
+void FrameArenaReset(void);
+const Arena * FrameArenaGet(void);
+
+// Capacity items of ItemSize bytes (rounded up to ARENA_ALIGN).
+// returns 0: out of memory
+//         1: success
+int PoolInit(Pool * Pl, int ItemSize, int Capacity);
+void PoolDestroy(Pool * Pl);
+
+// returns an item, or NULL when all are in use
+void * PoolAlloc(Pool * Pl);
+void PoolFree(Pool * Pl, void * Item);
+
+// returns 0: not counted (no HEAP_STATS or no glibc), Stats all zero
+//         1: success
+int HeapGetStats(HeapStats * Stats);
+
+#endif /* ARENA_H */
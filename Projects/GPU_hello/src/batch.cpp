@@ -0,0 +1,377 @@
+/*
+ * Geometry batching.
+ *
+ * batchPending objects are queued: their matrices in batchPalette, or
+ * their transformed vertices in batchStaging.
+ */
+
+#include "batch.h"
+#include "glstate.h"
+#include "shadervariant.h"
+#include "streambuffer.h"
+#include "vecmath.h"
+#include "gltrace.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+
+// Uniform vectors left to the rest of the vertex shader, my_TransformMatrix.
+#define BATCH_RESERVED_VECTORS  4
+
+// Mesh copies of the palette buffer.
+typedef struct _BatchVertex
+{
+    GLfloat position[2];
+    GLubyte color[4];
+    GLubyte index[4];       // first byte only
+}
+BatchVertex;
+
+// Transformed on the CPU.
+typedef struct _BatchClipVertex
+{
+    GLfloat position[4];
+    GLubyte color[4];
+}
+BatchClipVertex;
+
+static const char * modeNames[] = { "off", "palette", "transform" };
+
+// my_TransformMatrix: palette matrices and transformed vertices are final.
+static const GLfloat batchIdentity[16] = { 1, 0, 0, 0,  0, 1, 0, 0,  0, 0, 1, 0,  0, 0, 0, 1 };
+
+static int batchMode = BATCH_OFF;
+static int batchSize = 0;           // objects per draw
+static int batchPending = 0;
+static int batchMeshVertices = 0;
+static GLfloat * batchMesh = NULL;  // xy per vertex
+static GLubyte * batchColors = NULL; // rgba per vertex
+static float * batchPalette = NULL;
+static BatchClipVertex * batchStaging = NULL;
+static const ShaderVariant * batchVariant = NULL;
+static GLuint batchVbo = 0;
+static GLint batchLocVertex = -1;
+static GLint batchLocColor = -1;
+static GLint batchLocIndex = -1;
+static GLint batchLocPalette = -1;
+static GLint batchLocTransform = -1;
+static BatchStats batchStats;
+
+/***************************************************************************************
+***************************************************************************************/
+
+static GLubyte batchByte(float Value)
+{
+    Value = (Value < 0.0f) ? 0.0f : ((Value > 1.0f) ? 1.0f : Value);
+    return (GLubyte)(Value * 255.0f + 0.5f);
+}
+
+// Draws Count queued objects; palette mode takes their matrices from
+// Matrices.
+static void batchDraw(const float * Matrices, int Count)
+{
+    if (Count == 0)
+    {
+        return;
+    }
+
+    GLsizei vertices = Count * batchMeshVertices;
+    if (batchMode == BATCH_PALETTE)
+    {
+        GlStateUniformMatrix4fv(batchLocPalette, Count, Matrices);
+        batchStats.matrices += Count;
+    }
+    else
+    {
+        GLsizeiptr bytes = vertices * sizeof(BatchClipVertex);
+        GLintptr offset = StreamBufferWrite(batchStaging, bytes);
+        GlStateAttribPointer(batchLocVertex, 4, GL_FLOAT, GL_FALSE, sizeof(BatchClipVertex),
+                             (const GLvoid *)(offset + offsetof(BatchClipVertex, position)));
+        GlStateAttribPointer(batchLocColor, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(BatchClipVertex),
+                             (const GLvoid *)(offset + offsetof(BatchClipVertex, color)));
+        batchStats.bytes += bytes;
+    }
+    glDrawArrays(GL_TRIANGLES, 0, vertices);
+
+    batchStats.objects += Count;
+    batchStats.triangles += vertices / 3;
+    ++batchStats.draws;
+}
+
+// Clip-space vertices of one object at Out.
+static void batchTransform(const float * Matrix, BatchClipVertex * Out)
+{
+    // The mesh is flat: z = 0 and w = 1, so the third column drops out.
+    VmFloat4 c0 = vmLoad(Matrix + 0);
+    VmFloat4 c1 = vmLoad(Matrix + 4);
+    VmFloat4 c3 = vmLoad(Matrix + 12);
+    for (int i = 0; i < batchMeshVertices; ++i)
+    {
+        VmFloat4 p = vmMadd(c0, vmSplat(batchMesh[i * 2 + 0]), vmMadd(c1, vmSplat(batchMesh[i * 2 + 1]), c3));
+        vmStore(Out[i].position, p);
+        memcpy(Out[i].color, &batchColors[i * 4], 4);
+    }
+}
+
+// The shader variant of Mode.
+static unsigned int batchFeatures(int Mode)
+{
+    return SHADER_FEATURE_VERTEX_COLOR | ((Mode == BATCH_PALETTE) ? SHADER_FEATURE_SKINNING : 0);
+}
+
+// returns the objects per draw, 0 when no palette fits the uniforms
+static int batchObjects(int Mode, int Palette, int VertexCount)
+{
+    if (Mode != BATCH_PALETTE)
+    {
+        return BATCH_STREAM_VERTICES / VertexCount;
+    }
+
+    GLint vectors = 0;
+    glGetIntegerv(GL_MAX_VERTEX_UNIFORM_VECTORS, &vectors);
+    int largest = (vectors - BATCH_RESERVED_VECTORS) / 4;
+    largest = (largest > BATCH_MAX_PALETTE) ? BATCH_MAX_PALETTE : largest;
+    return ((Palette > 0) && (Palette < largest)) ? Palette : largest;
+}
+
+/***************************************************************************************
+***************************************************************************************/
+
+void BatchPrepare(int Mode, int Palette, int VertexCount)
+{
+    if (((Mode == BATCH_PALETTE) || (Mode == BATCH_TRANSFORM)) && (VertexCount > 0))
+    {
+        int objects = batchObjects(Mode, Palette, VertexCount);
+        if (objects >= 1)
+        {
+            if (Mode == BATCH_PALETTE)
+            {
+                ShaderVariantSetBones(objects);
+            }
+            ShaderVariantPrepare(batchFeatures(Mode));
+        }
+    }
+}
+
+int BatchInit(int Mode, int Palette, const GLfloat * Positions, const GLfloat * Colors, int VertexCount)
+{
+    BatchDestroy();
+    memset(&batchStats, 0, sizeof(batchStats));
+
+    if ((Mode != BATCH_PALETTE) && (Mode != BATCH_TRANSFORM))
+    {
+        fprintf(stderr, "Unknown batch mode %d.\n", Mode);
+        return 0;
+    }
+    if ((VertexCount <= 0) || (VertexCount % 3 != 0) || (VertexCount > BATCH_STREAM_VERTICES))
+    {
+        fprintf(stderr, "Batched meshes need 3 .. %d vertices, a triangle list.\n", BATCH_STREAM_VERTICES);
+        return 0;
+    }
+    if ((Mode == BATCH_TRANSFORM) && (StreamBufferSize() < BATCH_STREAM_BYTES))
+    {
+        fprintf(stderr, "Transformed batches need stream buffers of %d bytes.\n", BATCH_STREAM_BYTES);
+        return 0;
+    }
+    batchMode = Mode;
+    batchMeshVertices = VertexCount;
+
+    batchSize = batchObjects(Mode, Palette, VertexCount);
+    if (batchSize < 1)
+    {
+        fprintf(stderr, "No room for a matrix palette in the vertex uniforms.\n");
+        BatchDestroy();
+        return 0;
+    }
+    batchStats.palette = (Mode == BATCH_PALETTE) ? batchSize : 0;
+
+    // The palette is the size of the skinning variant's my_Palette.
+    if (Mode == BATCH_PALETTE)
+    {
+        ShaderVariantSetBones(batchSize);
+    }
+    batchVariant = ShaderVariantGet(batchFeatures(Mode));
+    if (batchVariant == NULL)
+    {
+        BatchDestroy();
+        return 0;
+    }
+    batchLocVertex = batchVariant->attribs[SHADER_ATTRIB_VERTEX];
+    batchLocColor = batchVariant->attribs[SHADER_ATTRIB_COLOR];
+    batchLocIndex = batchVariant->attribs[SHADER_ATTRIB_INDEX];
+    batchLocPalette = batchVariant->uniforms[SHADER_UNIFORM_PALETTE];
+    batchLocTransform = batchVariant->uniforms[SHADER_UNIFORM_TRANSFORM];
+
+    batchMesh = (GLfloat *)malloc(VertexCount * 2 * sizeof(GLfloat));
+    batchColors = (GLubyte *)malloc(VertexCount * 4);
+    if ((batchMesh == NULL) || (batchColors == NULL))
+    {
+        fprintf(stderr, "Out of memory.\n");
+        BatchDestroy();
+        return 0;
+    }
+    memcpy(batchMesh, Positions, VertexCount * 2 * sizeof(GLfloat));
+    for (int i = 0; i < VertexCount; ++i)
+    {
+        for (int c = 0; c < 3; ++c)
+        {
+            batchColors[i * 4 + c] = batchByte(Colors[i * 3 + c]);
+        }
+        batchColors[i * 4 + 3] = 255;
+    }
+
+    if (Mode == BATCH_PALETTE)
+    {
+        // batchSize copies of the mesh, each tagged with its palette index.
+        batchPalette = (float *)malloc(batchSize * 16 * sizeof(float));
+        BatchVertex * copies = (BatchVertex *)calloc(batchSize * VertexCount, sizeof(BatchVertex));
+        if ((batchPalette == NULL) || (copies == NULL))
+        {
+            fprintf(stderr, "Out of memory.\n");
+            free(copies);
+            BatchDestroy();
+            return 0;
+        }
+        glGenBuffers(1, &batchVbo);
+        GlStateBindBuffer(GL_ARRAY_BUFFER, batchVbo);
+        for (int copy = 0; copy < batchSize; ++copy)
+        {
+            for (int i = 0; i < VertexCount; ++i)
+            {
+                BatchVertex * vertex = &copies[copy * VertexCount + i];
+                vertex->position[0] = Positions[i * 2 + 0];
+                vertex->position[1] = Positions[i * 2 + 1];
+                memcpy(vertex->color, &batchColors[i * 4], 4);
+                vertex->index[0] = (GLubyte)copy;
+            }
+        }
+        glBufferData(GL_ARRAY_BUFFER, batchSize * VertexCount * sizeof(BatchVertex), copies, GL_STATIC_DRAW);
+        free(copies);
+    }
+    else
+    {
+        batchStaging = (BatchClipVertex *)malloc(BATCH_STREAM_BYTES);
+        if (batchStaging == NULL)
+        {
+            fprintf(stderr, "Out of memory.\n");
+            BatchDestroy();
+            return 0;
+        }
+    }
+    return 1;
+}
+
+void BatchDestroy(void)
+{
+    BatchDisableArrays();
+    if (batchVbo != 0)
+    {
+        GlStateDeleteBuffers(1, &batchVbo);
+        batchVbo = 0;
+    }
+    // The program belongs to the variant.
+    batchVariant = NULL;
+    free(batchStaging);
+    batchStaging = NULL;
+    free(batchPalette);
+    batchPalette = NULL;
+    free(batchColors);
+    batchColors = NULL;
+    free(batchMesh);
+    batchMesh = NULL;
+    batchMode = BATCH_OFF;
+    batchPending = 0;
+}
+
+// The arrays are left enabled by BatchEnd(), so from the second frame on
+// enabling them again is elided by the state filter.
+void BatchBegin(void)
+{
+    GlStateUseProgram(batchVariant->program);
+    GlStateUniformMatrix4fv(batchLocTransform, 1, batchIdentity);
+    GlStateEnableAttrib(batchLocVertex);
+    GlStateEnableAttrib(batchLocColor);
+
+    // Transformed vertices are pointed at where each draw streams them.
+    if (batchMode == BATCH_PALETTE)
+    {
+        GlStateBindBuffer(GL_ARRAY_BUFFER, batchVbo);
+        GlStateEnableAttrib(batchLocIndex);
+        GlStateAttribPointer(batchLocVertex, 2, GL_FLOAT, GL_FALSE, sizeof(BatchVertex),
+                             (const GLvoid *)offsetof(BatchVertex, position));
+        GlStateAttribPointer(batchLocColor, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(BatchVertex),
+                             (const GLvoid *)offsetof(BatchVertex, color));
+        GlStateAttribPointer(batchLocIndex, 1, GL_UNSIGNED_BYTE, GL_FALSE, sizeof(BatchVertex),
+                             (const GLvoid *)offsetof(BatchVertex, index));
+    }
+    batchPending = 0;
+}
+
+void BatchAdd(const float * Matrix)
+{
+    if (batchMode == BATCH_PALETTE)
+    {
+        memcpy(&batchPalette[batchPending * 16], Matrix, 16 * sizeof(float));
+    }
+    else
+    {
+        batchTransform(Matrix, &batchStaging[batchPending * batchMeshVertices]);
+    }
+    if (++batchPending == batchSize)
+    {
+        batchDraw(batchPalette, batchPending);
+        batchPending = 0;
+    }
+}
+
+void BatchAddArray(const float * Matrices, int Count)
+{
+    int i = 0;
+    if (batchMode == BATCH_PALETTE)
+    {
+        // Top up a partial batch first, then whole palettes need no copy.
+        for (; (i < Count) && (batchPending > 0); ++i)
+        {
+            BatchAdd(&Matrices[i * 16]);
+        }
+        for (; i + batchSize <= Count; i += batchSize)
+        {
+            batchDraw(&Matrices[i * 16], batchSize);
+        }
+    }
+    for (; i < Count; ++i)
+    {
+        BatchAdd(&Matrices[i * 16]);
+    }
+}
+
+void BatchEnd(void)
+{
+    batchDraw(batchPalette, batchPending);
+    batchPending = 0;
+}
+
+void BatchDisableArrays(void)
+{
+    if (batchVariant == NULL)
+    {
+        return;
+    }
+    GlStateDisableAttrib(batchLocVertex);
+    GlStateDisableAttrib(batchLocColor);
+    if (batchMode == BATCH_PALETTE)
+    {
+        GlStateDisableAttrib(batchLocIndex);
+    }
+}
+
+void BatchGetStats(BatchStats * Stats)
+{
+    *Stats = batchStats;
+}
+
+const char * BatchModeName(int Mode)
+{
+    return ((Mode >= BATCH_OFF) && (Mode <= BATCH_TRANSFORM)) ? modeNames[Mode] : "unknown";
+}
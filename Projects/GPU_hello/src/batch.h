@@ -0,0 +1,89 @@
+/*
+ * Geometry batching.
+ *
+ * Many copies of one small mesh, each with its own transform, drawn in a
+ * few large draw calls instead of one uniform upload and one draw per
+ * object (GLES2 has no instancing). Two ways:
+ *
+ *  - Matrix palette: a static vertex buffer holds Palette copies of the
+ *    mesh, every vertex tagged with its copy's index. A draw uploads up to
+ *    Palette matrices into a uniform array with one call and draws that
+ *    many copies; the SKINNING shader variant (shadervariant.h) picks the
+ *    matrix by index. The palette size follows
+ *    GL_MAX_VERTEX_UNIFORM_VECTORS.
+ *  - CPU transform: the vertices are transformed with NEON/SSE2 into a
+ *    staging array, which is drawn when full after streaming it through
+ *    the stream buffer ring (streambuffer.h). No uniforms at all, but
+ *    more vertex bytes.
+ *
+ * Matrices are column-major, 16 floats, as Scene keeps them.
+ */
+
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <GLES2/gl2.h>
+
+#define BATCH_MAX_PALETTE       64
+
+// Vertices the CPU transform path streams per draw, 4096 triangles, and
+// their size: the stream buffers must hold that much.
+#define BATCH_STREAM_VERTICES   12288
+#define BATCH_STREAM_BYTES      (BATCH_STREAM_VERTICES * 20)
+
+enum
+{
+    BATCH_OFF,          // not batched: the caller draws each object
+    BATCH_PALETTE,
+    BATCH_TRANSFORM,
+};
+
+typedef struct _BatchStats
+{
+    unsigned long long  objects;
+    unsigned long long  triangles;
+    unsigned long long  draws;
+    unsigned long long  matrices;   // uploaded as uniforms
+    unsigned long long  bytes;      // vertex bytes streamed
+    int                 palette;    // matrices per draw, palette mode
+}
+BatchStats;
+
+// Positions are 2 floats and Colors 3 floats per vertex, a triangle list.
+// Palette is the palette size, 0 for as large as the uniforms allow; it
+// is ignored by BATCH_TRANSFORM, which needs the stream buffers set up.
+// Needs a current context.
+// returns 0: fail
+//         1: success
+int BatchInit(int Mode, int Palette, const GLfloat * Positions, const GLfloat * Colors, int VertexCount);
+void BatchDestroy(void);
+
+// Has the program BatchInit() with the same arguments needs built ahead on
+// the shader worker (see shaderprogram.h).
+void BatchPrepare(int Mode, int Palette, int VertexCount);
+
+// Binds the batch program, buffer and vertex arrays. The arrays stay
+// enabled across frames, until BatchDisableArrays() or BatchDestroy(); the
+// caller's arrays must be disabled meanwhile, and its program and buffers
+// rebound after BatchEnd().
+void BatchBegin(void);
+
+// Queues one object; a full batch is drawn.
+void BatchAdd(const float * Matrix);
+
+// Queues Count objects whose matrices follow each other; whole palettes
+// are uploaded straight from Matrices.
+void BatchAddArray(const float * Matrices, int Count);
+
+// Draws what is queued.
+void BatchEnd(void);
+
+// Disables the batch's vertex arrays for a draw in between that needs them
+// off; the next BatchBegin() enables them again.
+void BatchDisableArrays(void);
+
+void BatchGetStats(BatchStats * Stats);
+
+const char * BatchModeName(int Mode);
+
+#endif /* BATCH_H */
@@ -0,0 +1,1266 @@
+/*
+ * Microbenchmarks.
+ */
+
+#include "bench.h"
+#include "arena.h"
+#include "batch.h"
+#include "camerasource.h"
+#include "cull.h"
+#include "framestats.h"
+#include "glstate.h"
+#include "imagefilter.h"
+#include "imagepipe.h"
+#include "programcache.h"
+#include "renderqueue.h"
+#include "scene.h"
+#include "shaderprogram.h"
+#include "shadervariant.h"
+#include "streambuffer.h"
+#include "texstream.h"
+#include "vecmath.h"
+#include "vertexbuffer.h"
+#include <GLES2/gl2.h>
+#include <gc_vdk.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <math.h>
+
+#define BENCH_ITEMS     4096
+#define BENCH_REPEATS   11
+
+// Camera frames of the upload benchmark, produced faster than they are shown.
+#define UPLOAD_WIDTH    1280
+#define UPLOAD_HEIGHT   720
+#define UPLOAD_RATE     240
+#define UPLOAD_BUFFERS  4
+#define UPLOAD_FRAMES   60
+
+// Source image of the filter benchmark, and GPU chain runs timed.
+#define FILTER_WIDTH    1280
+#define FILTER_HEIGHT   720
+#define FILTER_RUNS     20
+
+// Frames timed per object count of the batch benchmark.
+#define BATCH_FRAMES    10
+#define BATCH_STREAM    (1 << 20)   // bytes per stream buffer, three of them
+
+// Mixed scene of the render queue benchmark: programs, textures, one draw
+// in QUEUE_TRANSLUCENT blended, frames timed per draw count.
+#define QUEUE_PROGRAMS      4
+#define QUEUE_TEXTURES      16
+#define QUEUE_TRANSLUCENT   16
+#define QUEUE_FRAMES        20
+
+// Spheres of the culling benchmark, in a box of this half size around a
+// camera looking down -z.
+#define CULL_BOX            100.0f
+
+// Blocks of the allocator benchmark: BENCH_ITEMS of them, mixed sizes up
+// to ALLOC_MAX_BYTES, the pool's items that size.
+#define ALLOC_MAX_BYTES     256
+
+typedef void (*BenchKernel)(void * Context);
+
+typedef struct _BenchEntry
+{
+    const char *    name;
+    const char *    description;
+    int             (*run)(void);
+}
+BenchEntry;
+
+/***************************************************************************************
+***************************************************************************************/
+
+// Best of BENCH_REPEATS runs, in nanoseconds per item.
+static double benchTime(BenchKernel Kernel, void * Context, int Items)
+{
+    double best = 0.0;
+    for (int r = 0; r < BENCH_REPEATS; ++r)
+    {
+        unsigned long long start = FrameStatsNs();
+        Kernel(Context);
+        double ns = (double)(FrameStatsNs() - start) / Items;
+        if ((r == 0) || (ns < best))
+        {
+            best = ns;
+        }
+    }
+    return best;
+}
+
+static void benchPrint(const char * Kernel, double RefNs, double Ns, double Error)
+{
+    printf("%-12s %10.2f %10.2f %8.2fx %12.3g\n", Kernel, RefNs, Ns, (Ns > 0.0) ? RefNs / Ns : 0.0, Error);
+}
+
+static float benchRandom(unsigned int * Seed)
+{
+    *Seed = *Seed * 1664525u + 1013904223u;
+    return (float)(*Seed >> 8) / (float)(1 << 24) * 2.0f - 1.0f;
+}
+
+// GPU benchmarks need a context; a small window is enough. What names the
+// benchmark in the error message.
+// returns 0: fail
+//         1: success
+static int benchSetupEGL(vdkEGL * Egl, const char * What)
+{
+    EGLint configAttribs[] =
+    {
+        EGL_RED_SIZE,     8,
+        EGL_GREEN_SIZE,   8,
+        EGL_BLUE_SIZE,    8,
+        EGL_SURFACE_TYPE, EGL_WINDOW_BIT,
+        EGL_NONE,
+    };
+    EGLint contextAttribs[] =
+    {
+        EGL_CONTEXT_CLIENT_VERSION, 2,
+        EGL_NONE
+    };
+    memset(Egl, 0, sizeof(*Egl));
+    if (!vdkSetupEGL(-1, -1, 64, 64, configAttribs, NULL, contextAttribs, Egl))
+    {
+        fprintf(stderr, "EGL setup failed, no %s.\n", What);
+        return 0;
+    }
+    ProgramCacheInit(NULL);
+    GlStateReset();
+    return 1;
+}
+
+/***************************************************************************************
+***************************************************************************************/
+
+typedef struct _MathData
+{
+    Mat4 *  a;
+    Mat4 *  out;
+    float * angles;
+    float * sin;    // sin and cos share one buffer, compared as a whole
+    float * cos;
+    Scene   scene;
+}
+MathData;
+
+static void mathMultiplyScalar(void * Context)
+{
+    MathData * d = (MathData *)Context;
+    for (int i = 0; i < BENCH_ITEMS; ++i)
+    {
+        Mat4MultiplyScalar(&d->out[i], &d->a[0], &d->a[i]);
+    }
+}
+
+static void mathMultiply(void * Context)
+{
+    MathData * d = (MathData *)Context;
+    Mat4MultiplyBatch(d->out, &d->a[0], d->a, BENCH_ITEMS);
+}
+
+static void mathTransposeScalar(void * Context)
+{
+    MathData * d = (MathData *)Context;
+    for (int i = 0; i < BENCH_ITEMS; ++i)
+    {
+        Mat4TransposeScalar(&d->out[i], &d->a[i]);
+    }
+}
+
+static void mathTranspose(void * Context)
+{
+    MathData * d = (MathData *)Context;
+    for (int i = 0; i < BENCH_ITEMS; ++i)
+    {
+        Mat4Transpose(&d->out[i], &d->a[i]);
+    }
+}
+
+static void mathInverseScalar(void * Context)
+{
+    MathData * d = (MathData *)Context;
+    for (int i = 0; i < BENCH_ITEMS; ++i)
+    {
+        Mat4InverseScalar(&d->out[i], &d->a[i]);
+    }
+}
+
+static void mathInverse(void * Context)
+{
+    MathData * d = (MathData *)Context;
+    Mat4InverseBatch(d->out, d->a, BENCH_ITEMS);
+}
+
+static void mathSinCosScalar(void * Context)
+{
+    MathData * d = (MathData *)Context;
+    for (int i = 0; i < BENCH_ITEMS; ++i)
+    {
+        d->sin[i] = sinf(d->angles[i]);
+        d->cos[i] = cosf(d->angles[i]);
+    }
+}
+
+static void mathSinCos(void * Context)
+{
+    MathData * d = (MathData *)Context;
+    for (int i = 0; i < BENCH_ITEMS; i += 4)
+    {
+        FastSinCos4(&d->angles[i], &d->sin[i], &d->cos[i]);
+    }
+}
+
+// The per-object update as it was before the vector math.
+static void mathSceneScalar(void * Context)
+{
+    Scene * scn = &((MathData *)Context)->scene;
+    for (int i = 0; i < scn->count; ++i)
+    {
+        float angle = scn->angle + scn->phase[i];
+        float s = scn->scale[i];
+        float * m = &scn->matrices[i * 16];
+
+        m[0] = m[10] = s * (float)cos(angle);
+        m[2] = s * (float)sin(angle);
+        m[8] = -m[2];
+        m[5] = s;
+        m[12] = scn->offsetX[i];
+        m[13] = scn->offsetY[i];
+    }
+}
+
+static void mathScene(void * Context)
+{
+    Scene * scn = &((MathData *)Context)->scene;
+    float angle = scn->angle;
+    SceneUpdate(scn);
+    scn->angle = angle;
+}
+
+static double mathMaxError(const float * A, const float * B, int Count)
+{
+    double error = 0.0;
+    for (int i = 0; i < Count; ++i)
+    {
+        double e = fabs((double)A[i] - (double)B[i]);
+        error = (e > error) ? e : error;
+    }
+    return error;
+}
+
+// Runs the reference and the vector kernel and compares their output.
+static void mathCompare(const char * Name, BenchKernel Ref, BenchKernel Kernel, MathData * Data,
+                        const float * Out, float * Copy, int Floats)
+{
+    double refNs = benchTime(Ref, Data, BENCH_ITEMS);
+    memcpy(Copy, Out, sizeof (float) * Floats);
+    double ns = benchTime(Kernel, Data, BENCH_ITEMS);
+    benchPrint(Name, refNs, ns, mathMaxError(Copy, Out, Floats));
+}
+
+static int benchMath(void)
+{
+    MathData d;
+    memset(&d, 0, sizeof(d));
+
+    d.a      = (Mat4 *)malloc(sizeof (Mat4) * BENCH_ITEMS);
+    d.out    = (Mat4 *)malloc(sizeof (Mat4) * BENCH_ITEMS);
+    d.angles = (float *)malloc(sizeof (float) * BENCH_ITEMS);
+    d.sin    = (float *)malloc(sizeof (float) * BENCH_ITEMS * 2);
+    d.cos    = d.sin + BENCH_ITEMS;
+    float * copy = (float *)malloc(sizeof (Mat4) * BENCH_ITEMS);
+    int result = (d.a != NULL) && (d.out != NULL) && (d.angles != NULL) && (d.sin != NULL)
+              && (copy != NULL) && SceneInit(&d.scene, BENCH_ITEMS);
+
+    if (result)
+    {
+        // Random, well-conditioned matrices: diagonally dominant.
+        unsigned int seed = 1;
+        for (int i = 0; i < BENCH_ITEMS; ++i)
+        {
+            for (int k = 0; k < 16; ++k)
+            {
+                d.a[i].m[k] = benchRandom(&seed) + ((k % 5 == 0) ? 4.0f : 0.0f);
+            }
+            d.angles[i] = benchRandom(&seed) * 100.0f;
+        }
+
+#if VECMATH_NEON
+        const char * isa = "NEON";
+#elif VECMATH_SSE
+        const char * isa = "SSE2";
+#else
+        const char * isa = "scalar";
+#endif
+        printf("math: %d items, %s kernels, best of %d runs\n", BENCH_ITEMS, isa, BENCH_REPEATS);
+        printf("%-12s %10s %10s %9s %12s\n", "kernel", "ref ns", "vec ns", "speedup", "max error");
+
+        mathCompare("multiply",  mathMultiplyScalar,  mathMultiply,  &d, d.out[0].m, copy, BENCH_ITEMS * 16);
+        mathCompare("transpose", mathTransposeScalar, mathTranspose, &d, d.out[0].m, copy, BENCH_ITEMS * 16);
+        mathCompare("inverse",   mathInverseScalar,   mathInverse,   &d, d.out[0].m, copy, BENCH_ITEMS * 16);
+
+        mathCompare("sincos",    mathSinCosScalar,    mathSinCos,    &d, d.sin,      copy, BENCH_ITEMS * 2);
+        mathCompare("scene", mathSceneScalar, mathScene, &d, d.scene.matrices, copy, BENCH_ITEMS * 16);
+    }
+    else
+    {
+        fprintf(stderr, "Out of memory.\n");
+    }
+
+    SceneDestroy(&d.scene);
+    free(copy);
+    free(d.sin);
+    free(d.angles);
+    free(d.out);
+    free(d.a);
+    return result;
+}
+
+/***************************************************************************************
+***************************************************************************************/
+
+typedef struct _SplitData
+{
+    unsigned char * yuyv;
+    unsigned char * luma;
+    unsigned char * chroma;
+}
+SplitData;
+
+static void splitScalar(void * Context)
+{
+    SplitData * d = (SplitData *)Context;
+    for (int y = 0; y < UPLOAD_HEIGHT; ++y)
+    {
+        TexStreamSplitYUYVScalar(d->yuyv + y * UPLOAD_WIDTH * 2, d->luma + y * UPLOAD_WIDTH,
+                                 d->chroma + y * UPLOAD_WIDTH, UPLOAD_WIDTH);
+    }
+}
+
+static void splitVector(void * Context)
+{
+    SplitData * d = (SplitData *)Context;
+    for (int y = 0; y < UPLOAD_HEIGHT; ++y)
+    {
+        TexStreamSplitYUYV(d->yuyv + y * UPLOAD_WIDTH * 2, d->luma + y * UPLOAD_WIDTH,
+                           d->chroma + y * UPLOAD_WIDTH, UPLOAD_WIDTH);
+    }
+}
+
+// Streams UPLOAD_FRAMES camera frames into textures and draws each; Ms gets
+// the time per frame from the update to the end of the draw on the GPU.
+// returns 0: fail
+//         1: success
+static int uploadRun(vdkEGL * Egl, int Format, int Direct, double * Ms, TexStreamStats * Stats)
+{
+    if (!CameraSourceStart(Format, UPLOAD_WIDTH, UPLOAD_HEIGHT, UPLOAD_BUFFERS, UPLOAD_RATE))
+    {
+        return 0;
+    }
+    if (!TexStreamInit(Egl->eglDisplay, Format, UPLOAD_WIDTH, UPLOAD_HEIGHT, UPLOAD_BUFFERS, Direct))
+    {
+        CameraSourceStop();
+        return 0;
+    }
+
+    *Ms = 0.0;
+    for (int frames = 0; frames < UPLOAD_FRAMES;)
+    {
+        const CameraBuffer * frame = CameraSourceAcquire();
+        if (frame == NULL)
+        {
+            usleep(500);
+            continue;
+        }
+
+        unsigned long long start = FrameStatsNs();
+        TexStreamUpdate(frame);
+        TexStreamDraw();
+        glFinish();
+        *Ms += (FrameStatsNs() - start) / 1e6;
+        ++frames;
+    }
+    *Ms /= UPLOAD_FRAMES;
+
+    TexStreamGetStats(Stats);
+    TexStreamDestroy();
+    CameraSourceStop();
+    return 1;
+}
+
+static int benchUpload(void)
+{
+    SplitData d;
+    size_t pixels = (size_t)UPLOAD_WIDTH * UPLOAD_HEIGHT;
+    d.yuyv = (unsigned char *)malloc(pixels * 2);
+    d.luma = (unsigned char *)malloc(pixels * 2);
+    d.chroma = (unsigned char *)malloc(pixels);
+    unsigned char * copy = (unsigned char *)malloc(pixels * 2);
+    if ((d.yuyv == NULL) || (d.luma == NULL) || (d.chroma == NULL) || (copy == NULL))
+    {
+        fprintf(stderr, "Out of memory.\n");
+        free(copy);
+        free(d.chroma);
+        free(d.luma);
+        free(d.yuyv);
+        return 0;
+    }
+
+    unsigned int seed = 1;
+    for (size_t i = 0; i < pixels * 2; ++i)
+    {
+        d.yuyv[i] = (unsigned char)(benchRandom(&seed) * 127.0f + 128.0f);
+    }
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+    const char * isa = "NEON";
+#elif defined(__SSE2__)
+    const char * isa = "SSE2";
+#else
+    const char * isa = "scalar";
+#endif
+    printf("upload: %dx%d camera frames, %s YUYV split, best of %d runs\n",
+           UPLOAD_WIDTH, UPLOAD_HEIGHT, isa, BENCH_REPEATS);
+    printf("%-12s %10s %10s %9s %12s\n", "kernel", "ref ns", "vec ns", "speedup", "mismatches");
+
+    double refNs = benchTime(splitScalar, &d, (int)pixels);
+    memcpy(copy, d.luma, pixels);
+    memcpy(copy + pixels, d.chroma, pixels);
+    double ns = benchTime(splitVector, &d, (int)pixels);
+    int mismatches = 0;
+    for (size_t i = 0; i < pixels; ++i)
+    {
+        mismatches += (copy[i] != d.luma[i]) + (copy[pixels + i] != d.chroma[i]);
+    }
+    benchPrint("split", refNs, ns, mismatches);
+
+    free(copy);
+    free(d.chroma);
+    free(d.luma);
+    free(d.yuyv);
+
+    vdkEGL egl;
+    if (!benchSetupEGL(&egl, "texture streaming"))
+    {
+        return 0;
+    }
+
+    printf("\n%-12s %10s %10s %14s\n", "stream", "ms/frame", "ms/MPixel", "bytes/frame");
+    double megapixels = pixels / 1e6;
+    int result = 1;
+    for (int format = CAMERA_NV12; format <= CAMERA_YUYV; ++format)
+    {
+        for (int direct = 0; direct <= 1; ++direct)
+        {
+            char name[16];
+            snprintf(name, sizeof(name), "%s %s", CameraFormatName(format), direct ? "map" : "copy");
+
+            double ms = 0.0;
+            TexStreamStats stats;
+            if (!uploadRun(&egl, format, direct, &ms, &stats))
+            {
+                result = 0;
+                break;
+            }
+            if (direct && !stats.direct)
+            {
+                printf("%-12s %10s\n", name, "n/a");
+                continue;
+            }
+            printf("%-12s %10.3f %10.3f %14llu\n", name, ms, ms / megapixels, stats.bytes / UPLOAD_FRAMES);
+        }
+    }
+
+    vdkFinishEGL(&egl);
+    return result;
+}
+
+/***************************************************************************************
+***************************************************************************************/
+
+// Buffers of the CPU chain gray, blur, downsample, sobel; each step reads
+// the output of the one before.
+typedef struct _FilterData
+{
+    unsigned char * rgba;
+    unsigned char * gray;
+    unsigned char * blurH;
+    unsigned char * blurV;
+    unsigned char * down;
+    unsigned char * sobel;
+}
+FilterData;
+
+static void filterGray(void * Context)
+{
+    FilterData * d = (FilterData *)Context;
+    ImageGray(d->rgba, FILTER_WIDTH, FILTER_HEIGHT, d->gray);
+}
+
+static void filterBlurH(void * Context)
+{
+    FilterData * d = (FilterData *)Context;
+    ImageBlurH(d->gray, FILTER_WIDTH, FILTER_HEIGHT, d->blurH);
+}
+
+static void filterBlurV(void * Context)
+{
+    FilterData * d = (FilterData *)Context;
+    ImageBlurV(d->blurH, FILTER_WIDTH, FILTER_HEIGHT, d->blurV);
+}
+
+static void filterDown(void * Context)
+{
+    FilterData * d = (FilterData *)Context;
+    ImageDownsample(d->blurV, FILTER_WIDTH, FILTER_HEIGHT, d->down);
+}
+
+static void filterSobel(void * Context)
+{
+    FilterData * d = (FilterData *)Context;
+    ImageSobel(d->down, FILTER_WIDTH / 2, FILTER_HEIGHT / 2, d->sobel);
+}
+
+// Times Kernel scalar and vectorized and counts the bytes of Out that
+// differ; adds the milliseconds per image to the chain totals.
+static void filterCompare(const char * Name, BenchKernel Kernel, FilterData * Data,
+                          const unsigned char * Out, unsigned char * Copy, int Pixels,
+                          double * RefMs, double * Ms)
+{
+    ImageFilterSetSimd(0);
+    double refNs = benchTime(Kernel, Data, Pixels);
+    memcpy(Copy, Out, Pixels);
+    ImageFilterSetSimd(1);
+    double ns = benchTime(Kernel, Data, Pixels);
+    int mismatches = 0;
+    for (int i = 0; i < Pixels; ++i)
+    {
+        mismatches += (Copy[i] != Out[i]);
+    }
+    benchPrint(Name, refNs, ns, mismatches);
+    *RefMs += refNs * Pixels / 1e6;
+    *Ms += ns * Pixels / 1e6;
+}
+
+// Runs the GPU chain FILTER_RUNS times, waiting for every pass, and
+// prints each pass.
+// returns 0: fail
+//         1: success
+static int filterRunGpu(GLuint Source, int Fuse)
+{
+    static const int ops[] = { IMAGE_OP_GRAY, IMAGE_OP_BLUR, IMAGE_OP_DOWNSAMPLE, IMAGE_OP_SOBEL };
+    if (!ImagePipeInit(ops, sizeof(ops) / sizeof(ops[0]), FILTER_WIDTH, FILTER_HEIGHT, Fuse))
+    {
+        return 0;
+    }
+
+    // The first run allocates the pool textures; it is not counted.
+    int result = (ImagePipeRun(Source, 1) != 0);
+    ImagePassStats first[IMAGE_MAX_PASSES];
+    for (int i = 0; i < ImagePipeGetPassCount(); ++i)
+    {
+        ImagePipeGetPassStats(i, &first[i]);
+    }
+    for (int r = 0; result && (r < FILTER_RUNS); ++r)
+    {
+        result = (ImagePipeRun(Source, 1) != 0);
+    }
+
+    if (result)
+    {
+        printf("\n%s: %d passes, %d pool textures\n", Fuse ? "fused" : "unfused",
+               ImagePipeGetPassCount(), ImagePipeGetPoolSize());
+        printf("%-16s %10s %10s %10s\n", "pass", "size", "ms", "MPixel/s");
+        double total = 0.0;
+        for (int i = 0; i < ImagePipeGetPassCount(); ++i)
+        {
+            ImagePassStats stats;
+            ImagePipeGetPassStats(i, &stats);
+            double ms = (stats.ms - first[i].ms) / FILTER_RUNS;
+            char size[16];
+            snprintf(size, sizeof(size), "%dx%d", stats.width, stats.height);
+            printf("%-16s %10s %10.3f %10.1f\n", stats.name, size, ms,
+                   (ms > 0.0) ? stats.width * stats.height / (ms * 1e3) : 0.0);
+            total += ms;
+        }
+        printf("%-16s %10s %10.3f\n", "total", "", total);
+    }
+
+    ImagePipeDestroy();
+    return result;
+}
+
+static int benchFilters(void)
+{
+    size_t pixels = (size_t)FILTER_WIDTH * FILTER_HEIGHT;
+    FilterData d;
+    d.rgba = (unsigned char *)malloc(pixels * 4);
+    d.gray = (unsigned char *)malloc(pixels);
+    d.blurH = (unsigned char *)malloc(pixels);
+    d.blurV = (unsigned char *)malloc(pixels);
+    d.down = (unsigned char *)malloc(pixels / 4);
+    d.sobel = (unsigned char *)malloc(pixels / 4);
+    unsigned char * copy = (unsigned char *)malloc(pixels);
+    int result = (d.rgba != NULL) && (d.gray != NULL) && (d.blurH != NULL) && (d.blurV != NULL) &&
+                 (d.down != NULL) && (d.sobel != NULL) && (copy != NULL);
+    if (!result)
+    {
+        fprintf(stderr, "Out of memory.\n");
+    }
+    else
+    {
+        // Smooth gradients with noise, so both the blur and the edges matter.
+        unsigned int seed = 1;
+        for (int y = 0; y < FILTER_HEIGHT; ++y)
+        {
+            for (int x = 0; x < FILTER_WIDTH; ++x)
+            {
+                unsigned char * p = d.rgba + ((size_t)y * FILTER_WIDTH + x) * 4;
+                int noise = (int)(benchRandom(&seed) * 24.0f);
+                int r = x * 255 / FILTER_WIDTH + noise;
+                int g = y * 255 / FILTER_HEIGHT + noise;
+                int b = ((x / 64 + y / 64) & 1) ? 200 + noise : 40 + noise;
+                p[0] = (unsigned char)((r < 0) ? 0 : (r > 255) ? 255 : r);
+                p[1] = (unsigned char)((g < 0) ? 0 : (g > 255) ? 255 : g);
+                p[2] = (unsigned char)((b < 0) ? 0 : (b > 255) ? 255 : b);
+                p[3] = 255;
+            }
+        }
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+        const char * isa = "NEON";
+#elif defined(__SSE2__)
+        const char * isa = "SSE2";
+#else
+        const char * isa = "scalar";
+#endif
+        printf("filters: %dx%d RGBA, %s kernels, best of %d runs\n", FILTER_WIDTH, FILTER_HEIGHT, isa, BENCH_REPEATS);
+        printf("%-12s %10s %10s %9s %12s\n", "kernel", "ref ns", "vec ns", "speedup", "mismatches");
+
+        int quarter = (int)pixels / 4;
+        double refMs = 0.0;
+        double ms = 0.0;
+        filterCompare("gray",   filterGray,  &d, d.gray,  copy, (int)pixels, &refMs, &ms);
+        filterCompare("blur-h", filterBlurH, &d, d.blurH, copy, (int)pixels, &refMs, &ms);
+        filterCompare("blur-v", filterBlurV, &d, d.blurV, copy, (int)pixels, &refMs, &ms);
+        filterCompare("down",   filterDown,  &d, d.down,  copy, quarter,     &refMs, &ms);
+        filterCompare("sobel",  filterSobel, &d, d.sobel, copy, quarter,     &refMs, &ms);
+        printf("cpu chain: %.3f ms scalar, %.3f ms %s\n", refMs, ms, isa);
+    }
+
+    if (result)
+    {
+        vdkEGL egl;
+        result = benchSetupEGL(&egl, "GPU filters");
+        if (result)
+        {
+            GLuint source = 0;
+            glGenTextures(1, &source);
+            glBindTexture(GL_TEXTURE_2D, source);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, FILTER_WIDTH, FILTER_HEIGHT, 0, GL_RGBA, GL_UNSIGNED_BYTE, d.rgba);
+
+            result = filterRunGpu(source, 1) && filterRunGpu(source, 0);
+
+            glDeleteTextures(1, &source);
+            vdkFinishEGL(&egl);
+        }
+    }
+
+    free(copy);
+    free(d.sobel);
+    free(d.down);
+    free(d.blurV);
+    free(d.blurH);
+    free(d.gray);
+    free(d.rgba);
+    return result;
+}
+
+/***************************************************************************************
+***************************************************************************************/
+
+// Draws Scn with the batcher BATCH_FRAMES times, waiting for the GPU after
+// each frame.
+// returns the milliseconds per frame
+static double batchFrames(const Scene * Scn)
+{
+    // One frame first, so buffers and programs are resident.
+    double ms = 0.0;
+    for (int f = -1; f < BATCH_FRAMES; ++f)
+    {
+        unsigned long long start = FrameStatsNs();
+        BatchBegin();
+        BatchAddArray(Scn->matrices, Scn->count);
+        BatchEnd();
+        StreamBufferFrame();
+        glFinish();
+        if (f >= 0)
+        {
+            ms += (FrameStatsNs() - start) / 1e6;
+        }
+    }
+    return ms / BATCH_FRAMES;
+}
+
+static int benchBatch(void)
+{
+    static const GLfloat positions[3][2] = { { -0.5f, -0.5f }, { 0.0f, 0.5f }, { 0.5f, -0.5f } };
+    static const GLfloat colors[3][3] = { { 1.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f }, { 0.0f, 0.0f, 1.0f } };
+    static const int counts[] = { 1, 10, 100, 1000, 10000, 100000 };
+    const int countCount = sizeof(counts) / sizeof(counts[0]);
+
+    // A palette of one matrix is the unbatched baseline: one uniform upload
+    // and one draw per object. Transformed vertices go through both kinds
+    // of stream buffers.
+    static const struct
+    {
+        const char *    name;
+        int             mode;
+        int             palette;
+        int             stream;
+    }
+    modes[] =
+    {
+        { "per-object",   BATCH_PALETTE,   1, STREAM_ORPHAN },
+        { "palette",      BATCH_PALETTE,   0, STREAM_ORPHAN },
+        { "xform-orphan", BATCH_TRANSFORM, 0, STREAM_ORPHAN },
+        { "xform-fenced", BATCH_TRANSFORM, 0, STREAM_FENCED },
+    };
+
+    Scene scenes[sizeof(counts) / sizeof(counts[0])];
+    memset(scenes, 0, sizeof(scenes));
+    int result = 1;
+    for (int c = 0; result && (c < countCount); ++c)
+    {
+        result = SceneInit(&scenes[c], counts[c]);
+        if (result)
+        {
+            SceneUpdate(&scenes[c]);
+        }
+    }
+    if (!result)
+    {
+        fprintf(stderr, "Out of memory.\n");
+    }
+
+    vdkEGL egl;
+    if (result && benchSetupEGL(&egl, "batching"))
+    {
+        ShaderVariantInit("vs_es20t1.vert", "ps_es20t1.frag");
+        printf("batch: tutorial triangles, %d frames per count, GPU finished every frame\n", BATCH_FRAMES);
+        printf("%-12s %8s %8s %10s %12s\n", "mode", "objects", "draws", "ms/frame", "Mtri/s");
+        for (int m = 0; result && (m < (int)(sizeof(modes) / sizeof(modes[0]))); ++m)
+        {
+            result = StreamBufferInit(egl.eglDisplay, BATCH_STREAM, 3, modes[m].stream) &&
+                     BatchInit(modes[m].mode, modes[m].palette, &positions[0][0], &colors[0][0], 3);
+            for (int c = 0; result && (c < countCount); ++c)
+            {
+                BatchStats before;
+                BatchGetStats(&before);
+                double ms = batchFrames(&scenes[c]);
+                BatchStats after;
+                BatchGetStats(&after);
+                printf("%-12s %8d %8llu %10.3f %12.2f\n", modes[m].name, counts[c],
+                       (after.draws - before.draws) / (BATCH_FRAMES + 1), ms,
+                       (ms > 0.0) ? counts[c] / (ms * 1e3) : 0.0);
+            }
+            if (result)
+            {
+                BatchStats stats;
+                BatchGetStats(&stats);
+                StreamBufferStats streamStats;
+                StreamBufferGetStats(&streamStats);
+                if (stats.palette > 0)
+                {
+                    printf("%-12s palette of %d matrices\n", "", stats.palette);
+                }
+                else
+                {
+                    printf("%-12s %s, %llu orphans, %llu waits (%.3f ms), %.3f ms in buffer updates\n", "",
+                           StreamModeName(streamStats.mode), streamStats.orphans, streamStats.waits,
+                           streamStats.waitMs, streamStats.uploadMs);
+                }
+            }
+            BatchDestroy();
+            StreamBufferDestroy();
+        }
+        ShaderVariantDestroy();
+        vdkFinishEGL(&egl);
+    }
+    else
+    {
+        result = 0;
+    }
+
+    for (int c = 0; c < countCount; ++c)
+    {
+        SceneDestroy(&scenes[c]);
+    }
+    return result;
+}
+
+/***************************************************************************************
+***************************************************************************************/
+
+typedef struct _QueueDraw
+{
+    unsigned long long  key;
+    int                 program;    // of the benchmark's programs
+    Mat4                matrix;
+}
+QueueDraw;
+
+typedef struct _QueueScene
+{
+    QueueDraw *     draws;
+    VertexBuffer *  triangle;
+    GLint           locMatrix[QUEUE_PROGRAMS];
+}
+QueueScene;
+
+static void queueDraw(unsigned int Payload, void * User)
+{
+    QueueScene * scn = (QueueScene *)User;
+    const QueueDraw * draw = &scn->draws[Payload];
+    GlStateUniformMatrix4fv(scn->locMatrix[draw->program], 1, draw->matrix.m);
+    VertexBufferDraw(scn->triangle);
+}
+
+// Submits Count draws, sorted or not, and executes them QUEUE_FRAMES
+// times after one untimed frame.
+// returns the milliseconds per frame
+static double queueFrames(QueueScene * Scn, int Count, int Sort)
+{
+    double ms = 0.0;
+    for (int f = -1; f < QUEUE_FRAMES; ++f)
+    {
+        unsigned long long start = FrameStatsNs();
+        RenderQueueBegin();
+        for (int i = 0; i < Count; ++i)
+        {
+            RenderQueueSubmit(Scn->draws[i].key, i);
+        }
+        if (Sort)
+        {
+            RenderQueueSort();
+        }
+        RenderQueueExecute(queueDraw, Scn);
+        glFinish();
+        if (f >= 0)
+        {
+            ms += (FrameStatsNs() - start) / 1e6;
+        }
+    }
+    return ms / QUEUE_FRAMES;
+}
+
+static int benchQueue(void)
+{
+    static const GLfloat positions[3][2] = { { -0.5f, -0.5f }, { 0.0f, 0.5f }, { 0.5f, -0.5f } };
+    static const GLfloat colors[3][3] = { { 1.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f }, { 0.0f, 0.0f, 1.0f } };
+    static const GLushort indices[3] = { 0, 1, 2 };
+    static const int counts[] = { 100, 1000, 10000 };
+    const int countCount = sizeof(counts) / sizeof(counts[0]);
+    const int maxCount = counts[countCount - 1];
+
+    QueueScene scn;
+    memset(&scn, 0, sizeof(scn));
+    VertexBuffer triangle;
+    memset(&triangle, 0, sizeof(triangle));
+    GLuint programs[QUEUE_PROGRAMS];
+    int programIds[QUEUE_PROGRAMS];
+    GLuint textures[QUEUE_TEXTURES];
+    memset(programs, 0, sizeof(programs));
+    memset(textures, 0, sizeof(textures));
+
+    scn.draws = (QueueDraw *)malloc(maxCount * sizeof(QueueDraw));
+    if ((scn.draws == NULL) || !RenderQueueInit(maxCount))
+    {
+        fprintf(stderr, "Out of memory.\n");
+        free(scn.draws);
+        return 0;
+    }
+
+    vdkEGL egl;
+    if (!benchSetupEGL(&egl, "render queue"))
+    {
+        RenderQueueDestroy();
+        free(scn.draws);
+        return 0;
+    }
+
+    // Variants of the tutorial program, each a program of its own.
+    int result = VertexBufferCreate(&triangle, VERTEX_FORMAT_FLOAT, &positions[0][0], &colors[0][0], 3, indices, 3);
+    for (int p = 0; result && (p < QUEUE_PROGRAMS); ++p)
+    {
+        char defines[32];
+        snprintf(defines, sizeof(defines), "#define QUEUE_VARIANT %d\n", p);
+        programs[p] = ShaderProgramLoad("vs_es20t1.vert", "ps_es20t1.frag", defines, NULL);
+        result = (programs[p] != 0);
+        if (result)
+        {
+            scn.locMatrix[p] = glGetUniformLocation(programs[p], "my_TransformMatrix");
+            programIds[p] = RenderQueueProgram(programs[p]);
+        }
+    }
+    glGenTextures(QUEUE_TEXTURES, textures);
+    for (int t = 0; result && (t < QUEUE_TEXTURES); ++t)
+    {
+        unsigned char texel[4] = { (unsigned char)(t * 16), 128, 255, 255 };
+        glBindTexture(GL_TEXTURE_2D, textures[t]);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, texel);
+    }
+
+    if (result)
+    {
+        // All variants have the attributes of the tutorial program.
+        GLint locVertex = glGetAttribLocation(programs[0], "my_Vertex");
+        GLint locColor = glGetAttribLocation(programs[0], "my_Color");
+        GlStateEnableAttrib(locVertex);
+        GlStateEnableAttrib(locColor);
+        VertexBufferBind(&triangle, locVertex, locColor);
+        scn.triangle = &triangle;
+
+        // Random state and placement, submitted in scene order.
+        unsigned int seed = 7;
+        for (int i = 0; i < maxCount; ++i)
+        {
+            int p = (int)((benchRandom(&seed) * 0.5f + 0.5f) * (QUEUE_PROGRAMS - 1) + 0.5f);
+            int t = (int)((benchRandom(&seed) * 0.5f + 0.5f) * (QUEUE_TEXTURES - 1) + 0.5f);
+            float depth = benchRandom(&seed) * 0.5f + 0.5f;
+            Mat4 matrix = MAT4_IDENTITY;
+            matrix.m[0] = matrix.m[5] = 0.1f;
+            matrix.m[12] = benchRandom(&seed);
+            matrix.m[13] = benchRandom(&seed);
+            matrix.m[14] = depth * 2.0f - 1.0f;
+            scn.draws[i].program = p;
+            scn.draws[i].matrix = matrix;
+            scn.draws[i].key = RenderQueueKey(0, (i % QUEUE_TRANSLUCENT) == 0, programIds[p],
+                                              RenderQueueTexture(textures[t]), depth);
+        }
+
+        printf("queue: %d programs, %d textures, 1 in %d draws blended, %d frames per count, GPU finished every frame\n",
+               QUEUE_PROGRAMS, QUEUE_TEXTURES, QUEUE_TRANSLUCENT, QUEUE_FRAMES);
+        printf("%-10s %8s %10s %10s %10s %10s %10s\n", "order", "draws", "programs", "textures", "blends",
+               "sort ms", "ms/frame");
+        for (int c = 0; c < countCount; ++c)
+        {
+            for (int sort = 0; sort <= 1; ++sort)
+            {
+                RenderQueueStats before;
+                RenderQueueGetStats(&before);
+                double ms = queueFrames(&scn, counts[c], sort);
+                RenderQueueStats after;
+                RenderQueueGetStats(&after);
+                double frames = (double)(after.frames - before.frames);
+                printf("%-10s %8d %10.1f %10.1f %10.1f %10.3f %10.3f\n", sort ? "sorted" : "submitted", counts[c],
+                       (after.programs - before.programs) / frames, (after.textures - before.textures) / frames,
+                       (after.blends - before.blends) / frames, (after.sortMs - before.sortMs) / frames, ms);
+            }
+        }
+        GlStateDisableAttrib(locVertex);
+        GlStateDisableAttrib(locColor);
+    }
+
+    glDeleteTextures(QUEUE_TEXTURES, textures);
+    for (int p = 0; p < QUEUE_PROGRAMS; ++p)
+    {
+        if (programs[p] != 0)
+        {
+            GlStateDeleteProgram(programs[p]);
+        }
+    }
+    VertexBufferDestroy(&triangle);
+    vdkFinishEGL(&egl);
+    RenderQueueDestroy();
+    free(scn.draws);
+    return result;
+}
+
+/***************************************************************************************
+***************************************************************************************/
+
+typedef struct _CullData
+{
+    CullFrustum     frustum;
+    CullBounds      bounds;
+    int *           visible;
+    int             count;      // result
+}
+CullData;
+
+static void cullScalar(void * Context)
+{
+    CullData * data = (CullData *)Context;
+    data->count = CullSpheresScalar(&data->frustum, &data->bounds, 0, data->bounds.count, data->visible);
+}
+
+static void cullVector(void * Context)
+{
+    CullData * data = (CullData *)Context;
+    data->count = CullSpheres(&data->frustum, &data->bounds, 0, data->bounds.count, data->visible);
+}
+
+static void cullThreaded(void * Context)
+{
+    CullData * data = (CullData *)Context;
+    data->count = CullRun(&data->frustum, &data->bounds, data->visible);
+}
+
+static int benchCull(void)
+{
+    static const int counts[] = { 10000, 100000, 1000000 };
+    const int countCount = sizeof(counts) / sizeof(counts[0]);
+    int threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    threads = (threads < 2) ? 2 : ((threads > CULL_MAX_THREADS) ? CULL_MAX_THREADS : threads);
+    if (!CullStart(threads))
+    {
+        return 0;
+    }
+
+    // 60 degree perspective, near 1, far 2 * CULL_BOX: about a tenth of
+    // the box is in view.
+    float f = 1.0f / tanf(30.0f * 3.14159265f / 180.0f);
+    float n = 1.0f;
+    float fa = 2.0f * CULL_BOX;
+    Mat4 projection =
+    {
+        {
+            f, 0.0f, 0.0f, 0.0f,
+            0.0f, f, 0.0f, 0.0f,
+            0.0f, 0.0f, (fa + n) / (n - fa), -1.0f,
+            0.0f, 0.0f, 2.0f * fa * n / (n - fa), 0.0f,
+        }
+    };
+
+    printf("cull: spheres in a %.0f^3 box, 60 degree frustum, %d threads, ns per object\n", 2.0 * CULL_BOX,
+           CullThreads());
+    printf("%-10s %10s %10s %10s %10s %10s %10s\n", "objects", "visible", "scalar", "simd", "threads", "simd x",
+           "threads x");
+    int result = 1;
+    for (int c = 0; result && (c < countCount); ++c)
+    {
+        CullData data;
+        memset(&data, 0, sizeof(data));
+        CullFrustumFromMatrix(&data.frustum, &projection);
+        int * reference = (int *)malloc(((counts[c] + 3) & ~3) * sizeof(int));
+        data.visible = (int *)malloc(((counts[c] + 3) & ~3) * sizeof(int));
+        result = (reference != NULL) && (data.visible != NULL) && CullBoundsInit(&data.bounds, counts[c]);
+        if (!result)
+        {
+            fprintf(stderr, "Out of memory.\n");
+        }
+        else
+        {
+            unsigned int seed = 11;
+            for (int i = 0; i < counts[c]; ++i)
+            {
+                data.bounds.centerX[i] = benchRandom(&seed) * CULL_BOX;
+                data.bounds.centerY[i] = benchRandom(&seed) * CULL_BOX;
+                data.bounds.centerZ[i] = benchRandom(&seed) * CULL_BOX;
+                data.bounds.radius[i] = (benchRandom(&seed) * 0.5f + 0.5f) * 2.0f;
+            }
+
+            double scalarNs = benchTime(cullScalar, &data, counts[c]);
+            int referenceCount = data.count;
+            memcpy(reference, data.visible, referenceCount * sizeof(int));
+            double vectorNs = benchTime(cullVector, &data, counts[c]);
+            int match = (data.count == referenceCount) && (memcmp(reference, data.visible, referenceCount * sizeof(int)) == 0);
+            double threadNs = benchTime(cullThreaded, &data, counts[c]);
+            match = match && (data.count == referenceCount) &&
+                    (memcmp(reference, data.visible, referenceCount * sizeof(int)) == 0);
+
+            printf("%-10d %10d %10.2f %10.2f %10.2f %9.2fx %9.2fx%s\n", counts[c], referenceCount, scalarNs, vectorNs,
+                   threadNs, (vectorNs > 0.0) ? scalarNs / vectorNs : 0.0, (threadNs > 0.0) ? scalarNs / threadNs : 0.0,
+                   match ? "" : "  MISMATCH");
+            result = match;
+        }
+        CullBoundsDestroy(&data.bounds);
+        free(data.visible);
+        free(reference);
+    }
+    CullStop();
+    return result;
+}
+
+/***************************************************************************************
+***************************************************************************************/
+
+typedef struct _AllocData
+{
+    void *  blocks[BENCH_ITEMS];
+    int     sizes[BENCH_ITEMS];
+    Arena   arena;
+    Pool    pool;
+}
+AllocData;
+
+// A frame's worth of blocks, then all given back, as a frame would.
+static void allocHeap(void * Context)
+{
+    AllocData * data = (AllocData *)Context;
+    for (int i = 0; i < BENCH_ITEMS; ++i)
+    {
+        data->blocks[i] = malloc(data->sizes[i]);
+    }
+    for (int i = 0; i < BENCH_ITEMS; ++i)
+    {
+        free(data->blocks[i]);
+    }
+}
+
+static void allocArena(void * Context)
+{
+    AllocData * data = (AllocData *)Context;
+    for (int i = 0; i < BENCH_ITEMS; ++i)
+    {
+        data->blocks[i] = ArenaAlloc(&data->arena, data->sizes[i]);
+    }
+    ArenaReset(&data->arena);
+}
+
+static void allocPool(void * Context)
+{
+    AllocData * data = (AllocData *)Context;
+    for (int i = 0; i < BENCH_ITEMS; ++i)
+    {
+        data->blocks[i] = PoolAlloc(&data->pool);
+    }
+    for (int i = 0; i < BENCH_ITEMS; ++i)
+    {
+        PoolFree(&data->pool, data->blocks[i]);
+    }
+}
+
+static int benchArena(void)
+{
+    AllocData * data = (AllocData *)calloc(1, sizeof(AllocData));
+    if ((data == NULL) || !ArenaInit(&data->arena, (size_t)BENCH_ITEMS * ALLOC_MAX_BYTES) ||
+        !PoolInit(&data->pool, ALLOC_MAX_BYTES, BENCH_ITEMS))
+    {
+        fprintf(stderr, "Out of memory.\n");
+        if (data != NULL)
+        {
+            ArenaDestroy(&data->arena);
+            free(data);
+        }
+        return 0;
+    }
+
+    unsigned int seed = 5;
+    for (int i = 0; i < BENCH_ITEMS; ++i)
+    {
+        data->sizes[i] = 16 + (int)((benchRandom(&seed) * 0.5f + 0.5f) * (ALLOC_MAX_BYTES - 16));
+    }
+
+    // The heap calls of each kernel, counted once.
+    HeapStats before, after;
+    unsigned long long heapCalls[3];
+    BenchKernel kernels[3] = { allocHeap, allocArena, allocPool };
+    int heapCounted = 0;
+    for (int k = 0; k < 3; ++k)
+    {
+        heapCounted = HeapGetStats(&before);
+        kernels[k](data);
+        HeapGetStats(&after);
+        heapCalls[k] = after.allocations - before.allocations;
+    }
+
+    double heapNs = benchTime(allocHeap, data, BENCH_ITEMS);
+    double arenaNs = benchTime(allocArena, data, BENCH_ITEMS);
+    double poolNs = benchTime(allocPool, data, BENCH_ITEMS);
+
+    printf("arena: %d blocks of 16 .. %d bytes allocated and given back, ns per block\n", BENCH_ITEMS, ALLOC_MAX_BYTES);
+    printf("%-12s %10s %10s %9s %12s\n", "allocator", "malloc", "this", "speedup", "heap calls");
+    printf("%-12s %10.2f %10.2f %8.2fx %12llu\n", "malloc", heapNs, heapNs, 1.0, heapCalls[0]);
+    printf("%-12s %10.2f %10.2f %8.2fx %12llu\n", "arena", heapNs, arenaNs, (arenaNs > 0.0) ? heapNs / arenaNs : 0.0,
+           heapCalls[1]);
+    printf("%-12s %10.2f %10.2f %8.2fx %12llu\n", "pool", heapNs, poolNs, (poolNs > 0.0) ? heapNs / poolNs : 0.0,
+           heapCalls[2]);
+    if (!heapCounted)
+    {
+        printf("heap calls not counted, built without HEAP_STATS\n");
+    }
+    printf("arena peak %lu bytes, %llu failures; pool peak %d items, %llu failures\n", (unsigned long)data->arena.peak,
+           data->arena.failures, data->pool.peak, data->pool.failures);
+
+    int result = (data->arena.failures == 0) && (data->pool.failures == 0);
+    ArenaDestroy(&data->arena);
+    PoolDestroy(&data->pool);
+    free(data);
+    return result;
+}
+
+/***************************************************************************************
+***************************************************************************************/
+
+// Builds every variant of the triangle program, so a GLSL error in one the
+// demo never asks for still shows.
+static int benchShaders(void)
+{
+    vdkEGL egl;
+    if (!benchSetupEGL(&egl, "shader variants"))
+    {
+        return 0;
+    }
+    ShaderVariantInit("vs_es20t1.vert", "ps_es20t1.frag");
+
+    unsigned int variantCount = 1u << SHADER_FEATURE_COUNT;
+    printf("shaders: %u variants of vs_es20t1.vert + ps_es20t1.frag, no program cache\n", variantCount);
+    printf("%-48s %10s\n", "variant", "ms");
+    int failed = 0;
+    for (unsigned int features = 0; features < variantCount; ++features)
+    {
+        char name[128];
+        ShaderVariantName(features, name, sizeof(name));
+        unsigned long long start = FrameStatsNs();
+        const ShaderVariant * variant = ShaderVariantGet(features);
+        printf("%-48s %10.3f%s\n", name, (FrameStatsNs() - start) / 1e6, (variant != NULL) ? "" : "  failed");
+        failed += (variant == NULL);
+    }
+
+    ShaderVariantStats stats;
+    ShaderVariantGetStats(&stats);
+    printf("%d built, %d failed in %.2f ms\n", stats.variants, stats.failed, stats.buildMs);
+    ShaderVariantDestroy();
+    vdkFinishEGL(&egl);
+    return (failed == 0);
+}
+
+/***************************************************************************************
+***************************************************************************************/
+
+static const BenchEntry benchmarks[] =
+{
+    { "math", "mat4/vec4 kernels and the scene update, SIMD against scalar", benchMath },
+    { "upload", "camera frames to textures, copied or mapped, and the YUYV split", benchUpload },
+    { "filters", "image filter chain on the GPU, fused and not, and its SIMD CPU reference", benchFilters },
+    { "batch", "triangles per second from 1 to 100k objects, per-object draws against batches", benchBatch },
+    { "queue", "mixed programs, textures and blending, submission order against the sorted render queue", benchQueue },
+    { "cull", "frustum culling of 10k to 1M spheres, scalar, SIMD and on worker threads", benchCull },
+    { "arena", "per-frame blocks from malloc, the frame arena and a pool, and their heap calls", benchArena },
+    { "shaders", "every feature combination of the triangle program built, any that fails fails the run", benchShaders },
+};
+
+int BenchRun(const char * Name)
+{
+    int count = sizeof(benchmarks) / sizeof(benchmarks[0]);
+    for (int i = 0; i < count; ++i)
+    {
+        if (strcmp(benchmarks[i].name, Name) == 0)
+        {
+            return benchmarks[i].run();
+        }
+    }
+
+    fprintf(stderr, "Unknown benchmark '%s', available:\n", Name);
+    for (int i = 0; i < count; ++i)
+    {
+        fprintf(stderr, "\t%-8s %s\n", benchmarks[i].name, benchmarks[i].description);
+    }
+    return 0;
+}
@@ -0,0 +1,15 @@
+/*
+ * Microbenchmarks, run with -b <name> instead of the demo.
+ *
+ * Each benchmark times a kernel against its reference on the same data
+ * and prints the per-item times, the speedup and the largest deviation.
+ */
+
+#ifndef BENCH_H
+#define BENCH_H
+
+// returns 0: unknown benchmark or failure
+//         1: success
+int BenchRun(const char * Name);
+
+#endif /* BENCH_H */
@@ -0,0 +1,9 @@
+attribute vec4 my_Vertex;	// xy position, zw texture coordinate
+
+varying vec2 texCoord;
+
+void main()
+{
+	texCoord = my_Vertex.zw;
+	gl_Position = vec4(my_Vertex.xy, 0.0, 1.0);
+}
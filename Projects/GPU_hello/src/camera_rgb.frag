@@ -0,0 +1,10 @@
+precision mediump float;
+
+uniform sampler2D my_LumaTexture;	// a mapped YUV texture, the sampler converts
+
+varying vec2 texCoord;
+
+void main (void)
+{
+	gl_FragColor = texture2D(my_LumaTexture, texCoord);
+}
@@ -0,0 +1,14 @@
+precision mediump float;
+
+uniform sampler2D my_LumaTexture;
+uniform sampler2D my_ChromaTexture;	// U in luminance, V in alpha
+
+varying vec2 texCoord;
+
+void main (void)
+{
+	// Full range BT.601, as the camera delivers it.
+	float y = texture2D(my_LumaTexture, texCoord).r;
+	vec2 uv = texture2D(my_ChromaTexture, texCoord).ra - 0.5;
+	gl_FragColor = vec4(y + 1.402 * uv.y, y - 0.344 * uv.x - 0.714 * uv.y, y + 1.772 * uv.x, 1.0);
+}
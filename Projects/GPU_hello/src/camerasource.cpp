@@ -0,0 +1,286 @@
+/*
+ * Synthetic camera.
+ *
+ * The buffer states are guarded by one mutex; it is taken twice per frame
+ * on either side, never while a frame is being filled.
+ */
+
+#include "camerasource.h"
+#include "framestats.h"
+#include <pthread.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define CAMERA_MAX_BUFFERS  8
+
+enum
+{
+    BUFFER_FREE,
+    BUFFER_FILLING,
+    BUFFER_FILLED,
+    BUFFER_ACQUIRED,
+};
+
+static CameraBuffer cameraBuffers[CAMERA_MAX_BUFFERS];
+static int cameraStates[CAMERA_MAX_BUFFERS];
+static int cameraCount = 0;
+static unsigned long long cameraPeriod = 0;
+static unsigned long long cameraSequence = 0;
+static pthread_mutex_t cameraLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_t cameraThread;
+static volatile int cameraRunning = 0;
+static CameraSourceStats cameraStats;
+
+// Diagonal luma ramp and chroma bars, both scrolling with Phase.
+static void cameraFill(CameraBuffer * Buffer, unsigned int Phase)
+{
+    int w = Buffer->width;
+    int h = Buffer->height;
+
+    if (Buffer->format == CAMERA_NV12)
+    {
+        for (int y = 0; y < h; ++y)
+        {
+            unsigned char * row = Buffer->planes[0] + y * Buffer->strides[0];
+            for (int x = 0; x < w; ++x)
+            {
+                row[x] = (unsigned char)(x + y + Phase);
+            }
+        }
+        for (int y = 0; y < h / 2; ++y)
+        {
+            unsigned char * row = Buffer->planes[1] + y * Buffer->strides[1];
+            for (int x = 0; x < w / 2; ++x)
+            {
+                row[x * 2 + 0] = (unsigned char)(((x + Phase) >> 5) * 48);
+                row[x * 2 + 1] = (unsigned char)((y >> 5) * 48);
+            }
+        }
+        return;
+    }
+
+    for (int y = 0; y < h; ++y)
+    {
+        unsigned char * row = Buffer->planes[0] + y * Buffer->strides[0];
+        for (int x = 0; x < w / 2; ++x)
+        {
+            row[x * 4 + 0] = (unsigned char)(x * 2 + y + Phase);
+            row[x * 4 + 1] = (unsigned char)(((x + Phase) >> 5) * 48);
+            row[x * 4 + 2] = (unsigned char)(x * 2 + 1 + y + Phase);
+            row[x * 4 + 3] = (unsigned char)((y >> 6) * 48);
+        }
+    }
+}
+
+// A free buffer, else the oldest filled one; -1 if the consumer holds all.
+static int cameraTakeBuffer(void)
+{
+    int oldest = -1;
+    for (int i = 0; i < cameraCount; ++i)
+    {
+        if (cameraStates[i] == BUFFER_FREE)
+        {
+            return i;
+        }
+        if ((cameraStates[i] == BUFFER_FILLED)
+        && ((oldest < 0) || (cameraBuffers[i].sequence < cameraBuffers[oldest].sequence)))
+        {
+            oldest = i;
+        }
+    }
+    if (oldest >= 0)
+    {
+        ++cameraStats.dropped;
+    }
+    return oldest;
+}
+
+static void * cameraMain(void * Arg)
+{
+    (void)Arg;
+    unsigned long long next = FrameStatsNs();
+
+    while (__atomic_load_n(&cameraRunning, __ATOMIC_ACQUIRE))
+    {
+        pthread_mutex_lock(&cameraLock);
+        int index = cameraTakeBuffer();
+        if (index >= 0)
+        {
+            cameraStates[index] = BUFFER_FILLING;
+        }
+        else
+        {
+            ++cameraStats.stalls;
+        }
+        pthread_mutex_unlock(&cameraLock);
+
+        if (index >= 0)
+        {
+            CameraBuffer * buffer = &cameraBuffers[index];
+            cameraFill(buffer, (unsigned int)cameraSequence * 4);
+
+            pthread_mutex_lock(&cameraLock);
+            buffer->sequence = cameraSequence++;
+            cameraStates[index] = BUFFER_FILLED;
+            ++cameraStats.produced;
+            pthread_mutex_unlock(&cameraLock);
+        }
+
+        // Sensor timing: a fixed period, not fill time plus a delay. A fill
+        // that overran the period starts the grid over.
+        next += cameraPeriod;
+        unsigned long long now = FrameStatsNs();
+        next = (next < now) ? now : next;
+        struct timespec until;
+        until.tv_sec = next / 1000000000ULL;
+        until.tv_nsec = next % 1000000000ULL;
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &until, NULL) == EINTR)
+        {
+        }
+    }
+    return NULL;
+}
+
+static void cameraFreeBuffers(void)
+{
+    for (int i = 0; i < CAMERA_MAX_BUFFERS; ++i)
+    {
+        free(cameraBuffers[i].planes[0]);
+    }
+    memset(cameraBuffers, 0, sizeof(cameraBuffers));
+    cameraCount = 0;
+}
+
+/***************************************************************************************
+***************************************************************************************/
+
+int CameraSourceStart(int Format, int Width, int Height, int Buffers, int Rate)
+{
+    memset(cameraBuffers, 0, sizeof(cameraBuffers));
+    memset(&cameraStats, 0, sizeof(cameraStats));
+    cameraCount = (Buffers < 2) ? 2 : ((Buffers > CAMERA_MAX_BUFFERS) ? CAMERA_MAX_BUFFERS : Buffers);
+    cameraPeriod = 1000000000ULL / ((Rate > 0) ? Rate : 30);
+    cameraSequence = 0;
+
+    // Even sizes only: chroma is subsampled by two.
+    Width &= ~1;
+    Height &= ~1;
+
+    int bytesPerPixel = (Format == CAMERA_YUYV) ? 2 : 1;
+    int stride = (Width * bytesPerPixel + CAMERA_ALIGN - 1) & ~(CAMERA_ALIGN - 1);
+    size_t planeSize = (size_t)stride * Height;
+    size_t size = (Format == CAMERA_NV12) ? planeSize + planeSize / 2 : planeSize;
+
+    for (int i = 0; i < cameraCount; ++i)
+    {
+        CameraBuffer * buffer = &cameraBuffers[i];
+        void * memory = NULL;
+        if (posix_memalign(&memory, CAMERA_ALIGN, size) != 0)
+        {
+            fprintf(stderr, "Out of memory.\n");
+            cameraFreeBuffers();
+            return 0;
+        }
+
+        buffer->index      = i;
+        buffer->format     = Format;
+        buffer->width      = Width;
+        buffer->height     = Height;
+        buffer->planes[0]  = (unsigned char *)memory;
+        buffer->strides[0] = stride;
+        if (Format == CAMERA_NV12)
+        {
+            buffer->planes[1]  = buffer->planes[0] + planeSize;
+            buffer->strides[1] = stride;
+        }
+        cameraStates[i] = BUFFER_FREE;
+    }
+
+    cameraRunning = 1;
+    if (pthread_create(&cameraThread, NULL, cameraMain, NULL) != 0)
+    {
+        fprintf(stderr, "Cannot create the camera thread.\n");
+        cameraRunning = 0;
+        cameraFreeBuffers();
+        return 0;
+    }
+    return 1;
+}
+
+void CameraSourceStop(void)
+{
+    if (cameraCount == 0)
+    {
+        return;
+    }
+
+    __atomic_store_n(&cameraRunning, 0, __ATOMIC_RELEASE);
+    pthread_join(cameraThread, NULL);
+    cameraFreeBuffers();
+}
+
+const CameraBuffer * CameraSourceAcquire(void)
+{
+    pthread_mutex_lock(&cameraLock);
+    int newest = -1;
+    for (int i = 0; i < cameraCount; ++i)
+    {
+        if ((cameraStates[i] == BUFFER_FILLED)
+        && ((newest < 0) || (cameraBuffers[i].sequence > cameraBuffers[newest].sequence)))
+        {
+            newest = i;
+        }
+    }
+
+    // Frames older than the newest are never shown.
+    for (int i = 0; (newest >= 0) && (i < cameraCount); ++i)
+    {
+        if ((i != newest) && (cameraStates[i] == BUFFER_FILLED))
+        {
+            cameraStates[i] = BUFFER_FREE;
+            ++cameraStats.dropped;
+        }
+    }
+    if (newest >= 0)
+    {
+        cameraStates[newest] = BUFFER_ACQUIRED;
+    }
+    pthread_mutex_unlock(&cameraLock);
+
+    return (newest >= 0) ? &cameraBuffers[newest] : NULL;
+}
+
+void CameraSourceRelease(const CameraBuffer * Buffer)
+{
+    pthread_mutex_lock(&cameraLock);
+    cameraStates[Buffer->index] = BUFFER_FREE;
+    pthread_mutex_unlock(&cameraLock);
+}
+
+void CameraSourceGetStats(CameraSourceStats * Stats)
+{
+    pthread_mutex_lock(&cameraLock);
+    *Stats = cameraStats;
+    pthread_mutex_unlock(&cameraLock);
+}
+
+int CameraFormatParse(const char * Name)
+{
+    if (strcmp(Name, "nv12") == 0)
+    {
+        return CAMERA_NV12;
+    }
+    if (strcmp(Name, "yuyv") == 0)
+    {
+        return CAMERA_YUYV;
+    }
+    return -1;
+}
+
+const char * CameraFormatName(int Format)
+{
+    return (Format == CAMERA_YUYV) ? "YUYV" : "NV12";
+}
@@ -0,0 +1,63 @@
+/*
+ * Synthetic camera.
+ *
+ * Stands in for the Vision SDK capture path on builds without a sensor: a
+ * thread fills a ring of frame buffers with a moving test pattern at the
+ * camera rate, in the layouts the ISP hands out (NV12 or YUYV, rows padded
+ * to 64 bytes, planes 64-byte aligned so the GPU can map them directly).
+ *
+ * Buffers cycle free -> filled -> acquired -> free. The consumer always
+ * gets the newest filled frame; older filled frames it skipped go back to
+ * the producer, and when no buffer is free the producer reuses the oldest
+ * filled one. Both count as dropped frames.
+ */
+
+#ifndef CAMERASOURCE_H
+#define CAMERASOURCE_H
+
+// Row and plane alignment in bytes.
+#define CAMERA_ALIGN    64
+
+enum
+{
+    CAMERA_NV12,    // Y plane, then interleaved UV at half width and height
+    CAMERA_YUYV,    // Y0 U Y1 V, one plane
+};
+
+typedef struct _CameraBuffer
+{
+    int                 index;      // in the ring, 0 .. Buffers - 1
+    int                 format;
+    int                 width;
+    int                 height;
+    unsigned char *     planes[2];  // NV12: Y, UV; YUYV: planes[0]
+    int                 strides[2]; // bytes per row
+    unsigned long long  sequence;   // frames produced before this one
+}
+CameraBuffer;
+
+typedef struct _CameraSourceStats
+{
+    unsigned long long  produced;
+    unsigned long long  dropped;    // filled but never acquired
+    unsigned long long  stalls;     // every buffer was held by the consumer
+}
+CameraSourceStats;
+
+// returns 0: fail
+//         1: success
+int CameraSourceStart(int Format, int Width, int Height, int Buffers, int Rate);
+void CameraSourceStop(void);
+
+// returns the newest frame filled since the last call, or NULL if none;
+// it stays valid until CameraSourceRelease()
+const CameraBuffer * CameraSourceAcquire(void);
+void CameraSourceRelease(const CameraBuffer * Buffer);
+
+void CameraSourceGetStats(CameraSourceStats * Stats);
+
+// "nv12" or "yuyv"; returns -1 for anything else.
+int CameraFormatParse(const char * Name);
+const char * CameraFormatName(int Format);
+
+#endif /* CAMERASOURCE_H */
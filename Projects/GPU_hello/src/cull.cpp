@@ -0,0 +1,295 @@
+/*
+ * Frustum culling.
+ *
+ * Each worker has a start semaphore and posts cullDone when its slice is
+ * culled; slices are multiples of four objects, and each writes its
+ * indices at its own start in Visible, so nothing is shared while they
+ * run. The slices are then moved together.
+ */
+
+#include "cull.h"
+#include "framestats.h"
+#include <pthread.h>
+#include <semaphore.h>
+#include <errno.h>
+#include <float.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct _CullSlice
+{
+    int     first;
+    int     last;
+    int     visible;    // result
+}
+CullSlice;
+
+typedef struct _CullWorker
+{
+    pthread_t   thread;
+    sem_t       start;
+    int         slice;
+}
+CullWorker;
+
+static CullWorker cullWorkers[CULL_MAX_THREADS];
+static int cullWorkerCount = 0;
+static sem_t cullDone;
+static volatile int cullRunning = 0;
+static CullSlice cullSlices[CULL_MAX_THREADS];
+static const CullFrustum * cullFrustum = NULL;
+static const CullBounds * cullBounds = NULL;
+static int * cullVisible = NULL;
+static CullStats cullStats;
+
+/***************************************************************************************
+***************************************************************************************/
+
+static void cullWait(sem_t * Semaphore)
+{
+    while ((sem_wait(Semaphore) != 0) && (errno == EINTR))
+    {
+    }
+}
+
+static void cullSlice(CullSlice * Slice)
+{
+    Slice->visible = CullSpheres(cullFrustum, cullBounds, Slice->first, Slice->last, &cullVisible[Slice->first]);
+}
+
+static void * cullMain(void * Arg)
+{
+    CullWorker * worker = (CullWorker *)Arg;
+    for (;;)
+    {
+        cullWait(&worker->start);
+        if (!__atomic_load_n(&cullRunning, __ATOMIC_ACQUIRE))
+        {
+            break;
+        }
+        cullSlice(&cullSlices[worker->slice]);
+        sem_post(&cullDone);
+    }
+    return NULL;
+}
+
+/***************************************************************************************
+***************************************************************************************/
+
+int CullBoundsInit(CullBounds * Bounds, int Count)
+{
+    memset(Bounds, 0, sizeof(*Bounds));
+    int padded = (Count + 3) & ~3;
+    Bounds->centerX = (float *)calloc(padded, sizeof(float));
+    Bounds->centerY = (float *)calloc(padded, sizeof(float));
+    Bounds->centerZ = (float *)calloc(padded, sizeof(float));
+    Bounds->radius  = (float *)malloc(padded * sizeof(float));
+    if ((Bounds->centerX == NULL) || (Bounds->centerY == NULL) || (Bounds->centerZ == NULL) || (Bounds->radius == NULL))
+    {
+        CullBoundsDestroy(Bounds);
+        return 0;
+    }
+    for (int i = 0; i < padded; ++i)
+    {
+        Bounds->radius[i] = (i < Count) ? 0.0f : -FLT_MAX;
+    }
+    Bounds->count = Count;
+    return 1;
+}
+
+void CullBoundsDestroy(CullBounds * Bounds)
+{
+    free(Bounds->centerX);
+    free(Bounds->centerY);
+    free(Bounds->centerZ);
+    free(Bounds->radius);
+    memset(Bounds, 0, sizeof(*Bounds));
+}
+
+void CullFrustumFromMatrix(CullFrustum * Frustum, const Mat4 * ViewProjection)
+{
+    // Row r of the matrix is m[r], m[4 + r], m[8 + r], m[12 + r]; the planes
+    // are row 3 plus and minus rows 0 (x), 1 (y) and 2 (z).
+    const float * m = ViewProjection->m;
+    for (int p = 0; p < 6; ++p)
+    {
+        int row = p / 2;
+        float sign = (p & 1) ? -1.0f : 1.0f;
+        float * plane = Frustum->planes[p];
+        for (int c = 0; c < 4; ++c)
+        {
+            plane[c] = m[c * 4 + 3] + sign * m[c * 4 + row];
+        }
+        float length = sqrtf(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+        float scale = (length > 0.0f) ? 1.0f / length : 0.0f;
+        for (int c = 0; c < 4; ++c)
+        {
+            plane[c] *= scale;
+        }
+    }
+}
+
+int CullSpheres(const CullFrustum * Frustum, const CullBounds * Bounds, int First, int Last, int * Visible)
+{
+    VmFloat4 a[6], b[6], c[6], d[6];
+    for (int p = 0; p < 6; ++p)
+    {
+        a[p] = vmSplat(Frustum->planes[p][0]);
+        b[p] = vmSplat(Frustum->planes[p][1]);
+        c[p] = vmSplat(Frustum->planes[p][2]);
+        d[p] = vmSplat(Frustum->planes[p][3]);
+    }
+
+    int count = 0;
+    for (int i = First; i < Last; i += 4)
+    {
+        VmFloat4 x = vmLoad(&Bounds->centerX[i]);
+        VmFloat4 y = vmLoad(&Bounds->centerY[i]);
+        VmFloat4 z = vmLoad(&Bounds->centerZ[i]);
+        VmFloat4 r = vmLoad(&Bounds->radius[i]);
+
+        // The smallest distance plus radius over the planes; negative lanes
+        // are outside one of them.
+        VmFloat4 inside = vmAdd(vmMadd(a[0], x, vmMadd(b[0], y, vmMadd(c[0], z, d[0]))), r);
+        for (int p = 1; p < 6; ++p)
+        {
+            inside = vmMin(inside, vmAdd(vmMadd(a[p], x, vmMadd(b[p], y, vmMadd(c[p], z, d[p]))), r));
+        }
+
+        // Written whether visible or not, advancing only past visible ones.
+        int outside = vmSignMask(inside);
+        int lanes = (Last - i < 4) ? Last - i : 4;
+        for (int k = 0; k < lanes; ++k)
+        {
+            Visible[count] = i + k;
+            count += ((outside >> k) & 1) ^ 1;
+        }
+    }
+    return count;
+}
+
+int CullSpheresScalar(const CullFrustum * Frustum, const CullBounds * Bounds, int First, int Last, int * Visible)
+{
+    int count = 0;
+    for (int i = First; i < Last; ++i)
+    {
+        int visible = 1;
+        for (int p = 0; visible && (p < 6); ++p)
+        {
+            const float * plane = Frustum->planes[p];
+            float distance = plane[0] * Bounds->centerX[i] + plane[1] * Bounds->centerY[i] +
+                             plane[2] * Bounds->centerZ[i] + plane[3];
+            visible = (distance + Bounds->radius[i] >= 0.0f);
+        }
+        if (visible)
+        {
+            Visible[count++] = i;
+        }
+    }
+    return count;
+}
+
+int CullStart(int Threads)
+{
+    CullStop();
+    memset(&cullStats, 0, sizeof(cullStats));
+    Threads = (Threads < 1) ? 1 : ((Threads > CULL_MAX_THREADS) ? CULL_MAX_THREADS : Threads);
+    if (Threads == 1)
+    {
+        return 1;
+    }
+
+    sem_init(&cullDone, 0, 0);
+    cullRunning = 1;
+    for (int w = 0; w < Threads - 1; ++w)
+    {
+        CullWorker * worker = &cullWorkers[w];
+        worker->slice = w + 1;
+        sem_init(&worker->start, 0, 0);
+        if (pthread_create(&worker->thread, NULL, cullMain, worker) != 0)
+        {
+            fprintf(stderr, "Cannot create cull thread %d, culling on %d threads.\n", w + 1, w + 1);
+            sem_destroy(&worker->start);
+            break;
+        }
+        ++cullWorkerCount;
+    }
+    if (cullWorkerCount == 0)
+    {
+        cullRunning = 0;
+        sem_destroy(&cullDone);
+    }
+    return 1;
+}
+
+void CullStop(void)
+{
+    if (cullWorkerCount > 0)
+    {
+        __atomic_store_n(&cullRunning, 0, __ATOMIC_RELEASE);
+        for (int w = 0; w < cullWorkerCount; ++w)
+        {
+            sem_post(&cullWorkers[w].start);
+        }
+        for (int w = 0; w < cullWorkerCount; ++w)
+        {
+            pthread_join(cullWorkers[w].thread, NULL);
+            sem_destroy(&cullWorkers[w].start);
+        }
+        sem_destroy(&cullDone);
+        cullWorkerCount = 0;
+    }
+}
+
+int CullThreads(void)
+{
+    return cullWorkerCount + 1;
+}
+
+int CullRun(const CullFrustum * Frustum, const CullBounds * Bounds, int * Visible)
+{
+    unsigned long long start = FrameStatsNs();
+    cullFrustum = Frustum;
+    cullBounds = Bounds;
+    cullVisible = Visible;
+
+    // Slices of whole groups of four; small counts are not worth waking
+    // the workers for.
+    int groups = (Bounds->count + 3) / 4;
+    int slices = (groups >= 1024) ? cullWorkerCount + 1 : 1;
+    for (int s = 0; s < slices; ++s)
+    {
+        cullSlices[s].first = (int)((long long)groups * s / slices) * 4;
+        cullSlices[s].last = (int)((long long)groups * (s + 1) / slices) * 4;
+        cullSlices[s].last = (cullSlices[s].last > Bounds->count) ? Bounds->count : cullSlices[s].last;
+    }
+
+    for (int s = 1; s < slices; ++s)
+    {
+        sem_post(&cullWorkers[s - 1].start);
+    }
+    cullSlice(&cullSlices[0]);
+    for (int s = 1; s < slices; ++s)
+    {
+        cullWait(&cullDone);
+    }
+
+    int count = cullSlices[0].visible;
+    for (int s = 1; s < slices; ++s)
+    {
+        memmove(&Visible[count], &Visible[cullSlices[s].first], cullSlices[s].visible * sizeof(int));
+        count += cullSlices[s].visible;
+    }
+
+    ++cullStats.runs;
+    cullStats.tested += Bounds->count;
+    cullStats.visible += count;
+    cullStats.ms += (FrameStatsNs() - start) / 1e6;
+    return count;
+}
+
+void CullGetStats(CullStats * Stats)
+{
+    *Stats = cullStats;
+}
@@ -0,0 +1,81 @@
+/*
+ * Frustum culling.
+ *
+ * Object bounds are spheres kept as a structure of arrays (center x, y, z
+ * and radius, each padded to a multiple of four), tested against the six
+ * planes of a view-projection matrix four objects per NEON/SSE2
+ * instruction: a sphere is visible unless it lies wholly behind a plane.
+ * The result is the list of visible object indices, in object order, to
+ * draw instead of all objects.
+ *
+ * Large counts can be split over worker threads: CullStart() makes a pool
+ * that CullRun() hands equal slices of the objects to, the calling thread
+ * taking the first slice; the slices' results are joined in order.
+ * CullSpheres() is the single-threaded kernel over a range, for callers
+ * that have their own threads.
+ */
+
+#ifndef CULL_H
+#define CULL_H
+
+#include "vecmath.h"
+
+#define CULL_MAX_THREADS    8
+
+typedef struct _CullBounds
+{
+    int     count;      // objects
+    float * centerX;    // arrays padded to a multiple of four; the padding
+    float * centerY;    // has a negative radius, so it is never visible
+    float * centerZ;
+    float * radius;
+}
+CullBounds;
+
+// Planes as a x + b y + c z + d >= 0 inside, (a, b, c) of unit length.
+typedef struct _CullFrustum
+{
+    float   planes[6][4];
+}
+CullFrustum;
+
+typedef struct _CullStats
+{
+    unsigned long long  runs;
+    unsigned long long  tested;
+    unsigned long long  visible;
+    double              ms;
+}
+CullStats;
+
+// returns 0: out of memory
+//         1: success
+int CullBoundsInit(CullBounds * Bounds, int Count);
+void CullBoundsDestroy(CullBounds * Bounds);
+
+// Clip space planes (-w <= x, y, z <= w) of a column-major view-projection
+// matrix, in the space the bounds are in.
+void CullFrustumFromMatrix(CullFrustum * Frustum, const Mat4 * ViewProjection);
+
+// Tests objects [First, Last), First a multiple of four, and writes the
+// visible ones' indices to Visible.
+// returns the number of visible objects
+int CullSpheres(const CullFrustum * Frustum, const CullBounds * Bounds, int First, int Last, int * Visible);
+int CullSpheresScalar(const CullFrustum * Frustum, const CullBounds * Bounds, int First, int Last, int * Visible);
+
+// Threads (1 .. CULL_MAX_THREADS) includes the calling thread; with fewer
+// workers started than asked for, CullRun() uses those there are.
+// returns 0: fail
+//         1: success
+int CullStart(int Threads);
+void CullStop(void);
+int CullThreads(void);
+
+// Culls all objects of Bounds; Visible has room for Bounds->count indices,
+// padded to a multiple of four.
+// returns the number of visible objects
+int CullRun(const CullFrustum * Frustum, const CullBounds * Bounds, int * Visible);
+
+void CullGetStats(CullStats * Stats);
+
+#endif /* CULL_H */
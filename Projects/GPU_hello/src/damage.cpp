@@ -0,0 +1,284 @@
+/*
+ * Damage tracking and partial presentation.
+ *
+ * The surface side keeps the damage of the last few presented frames: a
+ * back buffer of age N already shows everything except the damage of the
+ * N - 1 frames since it was last drawn, plus the current one.
+ */
+
+#include "damage.h"
+#include "extensions.h"
+#include <EGL/egl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#ifndef EGL_BUFFER_AGE_KHR
+#define EGL_BUFFER_AGE_KHR  0x313D      // same value as EGL_BUFFER_AGE_EXT
+#endif
+
+#define DAMAGE_HISTORY      4
+
+// Older eglext.h headers lack these.
+typedef EGLBoolean (EGLAPIENTRY * DamageRectsProc)(EGLDisplay Display, EGLSurface Surface, EGLint * Rects, EGLint Count);
+
+static EGLDisplay surfaceDisplay = EGL_NO_DISPLAY;
+static EGLSurface surfaceSurface = EGL_NO_SURFACE;
+static EGLint surfaceWidth = 0;
+static EGLint surfaceHeight = 0;
+static DamageRectsProc swapWithDamage = NULL;
+static DamageRectsProc setDamageRegion = NULL;
+static int bufferAge = 0;
+
+static GLint frameDamage[4];                    // x, y, width, height
+static GLint history[DAMAGE_HISTORY][4];        // [0] is the last presented frame
+static int historyCount = 0;
+
+static const float fullArea[4] = {-1.0f, -1.0f, 1.0f, 1.0f};
+
+/***************************************************************************************
+***************************************************************************************/
+
+static void areaUnion(float Area[4], const float Other[4])
+{
+    Area[0] = (Other[0] < Area[0]) ? Other[0] : Area[0];
+    Area[1] = (Other[1] < Area[1]) ? Other[1] : Area[1];
+    Area[2] = (Other[2] > Area[2]) ? Other[2] : Area[2];
+    Area[3] = (Other[3] > Area[3]) ? Other[3] : Area[3];
+}
+
+static void objectBounds(const DamageTracker * Tracker, const float * M, float Bounds[4])
+{
+    Bounds[0] = Bounds[1] =  HUGE_VALF;
+    Bounds[2] = Bounds[3] = -HUGE_VALF;
+
+    for (int v = 0; v < Tracker->vertexCount; ++v)
+    {
+        float x = Tracker->vertices[v * 2 + 0];
+        float y = Tracker->vertices[v * 2 + 1];
+        float w = M[3] * x + M[7] * y + M[15];
+        if (w <= 1e-6f)
+        {
+            // Crosses the eye plane, assume it covers everything.
+            memcpy(Bounds, fullArea, sizeof(fullArea));
+            return;
+        }
+
+        float point[4];
+        point[0] = point[2] = (M[0] * x + M[4] * y + M[12]) / w;
+        point[1] = point[3] = (M[1] * x + M[5] * y + M[13]) / w;
+        areaUnion(Bounds, point);
+    }
+}
+
+static void rectUnion(GLint Rect[4], const GLint Other[4])
+{
+    GLint x0 = (Other[0] < Rect[0]) ? Other[0] : Rect[0];
+    GLint y0 = (Other[1] < Rect[1]) ? Other[1] : Rect[1];
+    GLint x1 = (Other[0] + Other[2] > Rect[0] + Rect[2]) ? Other[0] + Other[2] : Rect[0] + Rect[2];
+    GLint y1 = (Other[1] + Other[3] > Rect[1] + Rect[3]) ? Other[1] + Other[3] : Rect[1] + Rect[3];
+    Rect[0] = x0;
+    Rect[1] = y0;
+    Rect[2] = x1 - x0;
+    Rect[3] = y1 - y0;
+}
+
+// Window pixels covering Area, one pixel wider for rasterization rounding
+// and never empty.
+static void areaToRect(const float Area[4], GLint Rect[4])
+{
+    float x0 = floorf((Area[0] + 1.0f) * 0.5f * surfaceWidth)  - 1.0f;
+    float y0 = floorf((Area[1] + 1.0f) * 0.5f * surfaceHeight) - 1.0f;
+    float x1 = ceilf((Area[2] + 1.0f) * 0.5f * surfaceWidth)   + 1.0f;
+    float y1 = ceilf((Area[3] + 1.0f) * 0.5f * surfaceHeight)  + 1.0f;
+
+    x0 = (x0 < 0.0f) ? 0.0f : ((x0 > surfaceWidth  - 1) ? surfaceWidth  - 1 : x0);
+    y0 = (y0 < 0.0f) ? 0.0f : ((y0 > surfaceHeight - 1) ? surfaceHeight - 1 : y0);
+    x1 = (x1 > surfaceWidth)  ? surfaceWidth  : ((x1 < x0 + 1.0f) ? x0 + 1.0f : x1);
+    y1 = (y1 > surfaceHeight) ? surfaceHeight : ((y1 < y0 + 1.0f) ? y0 + 1.0f : y1);
+
+    Rect[0] = (GLint)x0;
+    Rect[1] = (GLint)y0;
+    Rect[2] = (GLint)(x1 - x0);
+    Rect[3] = (GLint)(y1 - y0);
+}
+
+static void rectToArea(const GLint Rect[4], float Area[4])
+{
+    Area[0] = 2.0f * Rect[0] / surfaceWidth - 1.0f;
+    Area[1] = 2.0f * Rect[1] / surfaceHeight - 1.0f;
+    Area[2] = 2.0f * (Rect[0] + Rect[2]) / surfaceWidth - 1.0f;
+    Area[3] = 2.0f * (Rect[1] + Rect[3]) / surfaceHeight - 1.0f;
+}
+
+/***************************************************************************************
+***************************************************************************************/
+
+int DamageTrackerInit(DamageTracker * Tracker, const GLfloat * Vertices, int VertexCount, int Count)
+{
+    memset(Tracker, 0, sizeof(*Tracker));
+    Tracker->matrices = (float *)malloc(sizeof (float) * 16 * Count);
+    Tracker->bounds   = (float *)malloc(sizeof (float) * 4 * Count);
+    if ((Tracker->matrices == NULL) || (Tracker->bounds == NULL))
+    {
+        DamageTrackerDestroy(Tracker);
+        return 0;
+    }
+
+    Tracker->count       = Count;
+    Tracker->vertices    = Vertices;
+    Tracker->vertexCount = VertexCount;
+    return 1;
+}
+
+void DamageTrackerDestroy(DamageTracker * Tracker)
+{
+    free(Tracker->matrices);
+    free(Tracker->bounds);
+    memset(Tracker, 0, sizeof(*Tracker));
+}
+
+void DamageTrackerInvalidate(DamageTracker * Tracker)
+{
+    Tracker->valid = 0;
+}
+
+int DamageTrackerUpdate(DamageTracker * Tracker, const float * Matrices, float Area[4])
+{
+    if (!Tracker->valid)
+    {
+        for (int i = 0; i < Tracker->count; ++i)
+        {
+            objectBounds(Tracker, &Matrices[i * 16], &Tracker->bounds[i * 4]);
+        }
+        memcpy(Tracker->matrices, Matrices, sizeof (float) * 16 * Tracker->count);
+        memcpy(Area, fullArea, sizeof(fullArea));
+        Tracker->valid = 1;
+        return 1;
+    }
+
+    int damaged = 0;
+    Area[0] = Area[1] =  HUGE_VALF;
+    Area[2] = Area[3] = -HUGE_VALF;
+
+    for (int i = 0; i < Tracker->count; ++i)
+    {
+        const float * matrix = &Matrices[i * 16];
+        float * presented = &Tracker->matrices[i * 16];
+        if (memcmp(matrix, presented, sizeof (float) * 16) == 0)
+        {
+            continue;
+        }
+
+        // Where it was and where it is now.
+        float * bounds = &Tracker->bounds[i * 4];
+        areaUnion(Area, bounds);
+        objectBounds(Tracker, matrix, bounds);
+        areaUnion(Area, bounds);
+        memcpy(presented, matrix, sizeof (float) * 16);
+        damaged = 1;
+    }
+    return damaged;
+}
+
+int DamageTrackerOverlaps(const DamageTracker * Tracker, int Index, const float Area[4])
+{
+    const float * bounds = &Tracker->bounds[Index * 4];
+    return (bounds[0] <= Area[2]) && (bounds[2] >= Area[0])
+        && (bounds[1] <= Area[3]) && (bounds[3] >= Area[1]);
+}
+
+/***************************************************************************************
+***************************************************************************************/
+
+void DamageSurfaceInit(vdkEGL * Egl)
+{
+    surfaceDisplay = Egl->eglDisplay;
+    surfaceSurface = Egl->eglSurface;
+    eglQuerySurface(surfaceDisplay, surfaceSurface, EGL_WIDTH, &surfaceWidth);
+    eglQuerySurface(surfaceDisplay, surfaceSurface, EGL_HEIGHT, &surfaceHeight);
+    historyCount = 0;
+
+    swapWithDamage = NULL;
+    if (HasEGLExtension(surfaceDisplay, "EGL_KHR_swap_buffers_with_damage"))
+    {
+        swapWithDamage = (DamageRectsProc)eglGetProcAddress("eglSwapBuffersWithDamageKHR");
+    }
+    else if (HasEGLExtension(surfaceDisplay, "EGL_EXT_swap_buffers_with_damage"))
+    {
+        swapWithDamage = (DamageRectsProc)eglGetProcAddress("eglSwapBuffersWithDamageEXT");
+    }
+
+    setDamageRegion = NULL;
+    if (HasEGLExtension(surfaceDisplay, "EGL_KHR_partial_update"))
+    {
+        setDamageRegion = (DamageRectsProc)eglGetProcAddress("eglSetDamageRegionKHR");
+    }
+    bufferAge = (setDamageRegion != NULL) || HasEGLExtension(surfaceDisplay, "EGL_EXT_buffer_age");
+}
+
+int DamageBeginFrame(const float Area[4], float Repaint[4], GLint Scissor[4])
+{
+    areaToRect(Area, frameDamage);
+
+    EGLint age = 0;
+    if (bufferAge)
+    {
+        eglQuerySurface(surfaceDisplay, surfaceSurface, EGL_BUFFER_AGE_KHR, &age);
+    }
+
+    // Age 0 is a buffer with undefined content; an age beyond the history
+    // misses damage we no longer know.
+    int partial = (age >= 1) && (age - 1 <= historyCount);
+    memcpy(Scissor, frameDamage, sizeof(frameDamage));
+    for (int i = 0; partial && (i < age - 1); ++i)
+    {
+        rectUnion(Scissor, history[i]);
+    }
+    if (!partial)
+    {
+        Scissor[0] = Scissor[1] = 0;
+        Scissor[2] = surfaceWidth;
+        Scissor[3] = surfaceHeight;
+    }
+
+    if (setDamageRegion != NULL)
+    {
+        setDamageRegion(surfaceDisplay, surfaceSurface, Scissor, 1);
+    }
+
+    rectToArea(Scissor, Repaint);
+    return partial && ((Scissor[2] < surfaceWidth) || (Scissor[3] < surfaceHeight));
+}
+
+int DamageSwap(vdkEGL * Egl)
+{
+    int result;
+    if (swapWithDamage != NULL)
+    {
+        result = swapWithDamage(surfaceDisplay, surfaceSurface, frameDamage, 1);
+    }
+    else
+    {
+        result = vdkSwapEGL(Egl);
+    }
+
+    memmove(&history[1], &history[0], sizeof (history[0]) * (DAMAGE_HISTORY - 1));
+    memcpy(history[0], frameDamage, sizeof(frameDamage));
+    historyCount = (historyCount < DAMAGE_HISTORY) ? historyCount + 1 : DAMAGE_HISTORY;
+    return result;
+}
+
+const char * DamageSurfaceMode(void)
+{
+    if (setDamageRegion != NULL)
+    {
+        return (swapWithDamage != NULL) ? "partial update + swap with damage" : "partial update";
+    }
+    if (bufferAge)
+    {
+        return (swapWithDamage != NULL) ? "buffer age + swap with damage" : "buffer age";
+    }
+    return (swapWithDamage != NULL) ? "swap with damage" : "full swaps";
+}
@@ -0,0 +1,71 @@
+/*
+ * Damage tracking and partial presentation.
+ *
+ * DamageTracker compares every object's matrix with the one last presented
+ * and returns the screen area the changed objects covered before and after,
+ * so a frame with no change is neither rendered nor swapped.
+ *
+ * The area is then handed to EGL: with EGL_KHR_partial_update or
+ * EGL_EXT_buffer_age only that area (plus what the reused back buffer
+ * missed) is repainted under a scissor, and with
+ * EGL_KHR_swap_buffers_with_damage the display only updates that area.
+ * Without the extensions every frame is repainted and swapped whole.
+ *
+ * Areas are in normalized device coordinates: minX, minY, maxX, maxY.
+ */
+
+#ifndef DAMAGE_H
+#define DAMAGE_H
+
+#include <GLES2/gl2.h>
+#include <gc_vdk.h>
+
+typedef struct _DamageTracker
+{
+    int             count;
+    const GLfloat * vertices;   // xy pairs, object space
+    int             vertexCount;
+    int             valid;      // presented state below is known
+    float *         matrices;   // as last presented, 16 floats per object
+    float *         bounds;     // screen area of each object, 4 floats
+}
+DamageTracker;
+
+// Vertices are referenced, not copied.
+// returns 0: out of memory
+//         1: success
+int DamageTrackerInit(DamageTracker * Tracker, const GLfloat * Vertices, int VertexCount, int Count);
+void DamageTrackerDestroy(DamageTracker * Tracker);
+
+// The next update damages the whole screen.
+void DamageTrackerInvalidate(DamageTracker * Tracker);
+
+// Compares Matrices with the last presented ones and takes them as
+// presented. Area gets what changed.
+// returns 0: nothing changed
+//         1: Area is damaged
+int DamageTrackerUpdate(DamageTracker * Tracker, const float * Matrices, float Area[4]);
+
+// Whether object Index, as of the last update, overlaps Area.
+int DamageTrackerOverlaps(const DamageTracker * Tracker, int Index, const float Area[4]);
+
+/***************************************************************************************
+***************************************************************************************/
+
+// Needs the current context of Egl.
+void DamageSurfaceInit(vdkEGL * Egl);
+
+// Before rendering a frame whose damage is Area: Repaint gets the area that
+// must be drawn, given what the back buffer still holds, and Scissor the
+// same in window pixels (x, y, width, height).
+// returns 0: repaint everything
+//         1: only Repaint, under the scissor
+int DamageBeginFrame(const float Area[4], float Repaint[4], GLint Scissor[4]);
+
+// Swaps, telling EGL the damage given to DamageBeginFrame() when it can.
+int DamageSwap(vdkEGL * Egl);
+
+// "partial update", "buffer age + swap with damage", ... for the report.
+const char * DamageSurfaceMode(void);
+
+#endif /* DAMAGE_H */
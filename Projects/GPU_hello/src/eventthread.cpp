@@ -0,0 +1,173 @@
+/*
+ * VDK event polling on its own thread.
+ */
+
+#include "eventthread.h"
+#include "spscqueue.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+// Idle poll period; vdkGetEvent() does not block. While the render loop
+// sleeps too the slower period is enough, a paused UI needs no 1 ms input.
+#define EVENT_POLL_NS       1000000
+#define EVENT_IDLE_POLL_NS  10000000
+
+static SpscQueue eventQueue;
+static pthread_t eventThread;
+static vdkWindow eventWindow = NULL;
+static volatile int eventRunning = 0;
+static unsigned long long eventStalls = 0;
+static EventThreadStats eventStats;
+
+// Set while the render thread sleeps in EventThreadWait().
+static pthread_mutex_t eventLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t eventWake;
+static int eventWaiting = 0;
+
+static void eventSleep(void)
+{
+    struct timespec delay = { 0, EVENT_POLL_NS };
+    if (__atomic_load_n(&eventWaiting, __ATOMIC_RELAXED))
+    {
+        delay.tv_nsec = EVENT_IDLE_POLL_NS;
+    }
+    nanosleep(&delay, NULL);
+}
+
+static void eventNotify(void)
+{
+    // Pairs with the fence in EventThreadWait(): either the waiter sees the
+    // event, or this sees the waiter and wakes it.
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&eventWaiting, __ATOMIC_RELAXED))
+    {
+        pthread_mutex_lock(&eventLock);
+        pthread_cond_signal(&eventWake);
+        pthread_mutex_unlock(&eventLock);
+    }
+}
+
+static void * eventMain(void * Arg)
+{
+    (void)Arg;
+
+    vdkEvent event;
+    while (__atomic_load_n(&eventRunning, __ATOMIC_ACQUIRE))
+    {
+        if (!vdkGetEvent(eventWindow, &event))
+        {
+            eventSleep();
+            continue;
+        }
+
+        while (!SpscQueuePush(&eventQueue, &event))
+        {
+            // Full: the render thread is behind, let it catch up.
+            __atomic_fetch_add(&eventStalls, 1, __ATOMIC_RELAXED);
+            if (!__atomic_load_n(&eventRunning, __ATOMIC_ACQUIRE))
+            {
+                return NULL;
+            }
+            eventSleep();
+        }
+        eventNotify();
+    }
+    return NULL;
+}
+
+/***************************************************************************************
+***************************************************************************************/
+
+int EventThreadStart(vdkWindow Window)
+{
+    memset(&eventStats, 0, sizeof(eventStats));
+    eventStalls = 0;
+
+    if (!SpscQueueInit(&eventQueue, sizeof (vdkEvent), EVENT_QUEUE_SIZE))
+    {
+        fprintf(stderr, "Out of memory.\n");
+        return 0;
+    }
+
+    // Timed waits on the monotonic clock, immune to wall clock changes.
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&eventWake, &attr);
+    pthread_condattr_destroy(&attr);
+
+    eventWindow = Window;
+    eventRunning = 1;
+    if (pthread_create(&eventThread, NULL, eventMain, NULL) != 0)
+    {
+        fprintf(stderr, "Cannot create the event thread.\n");
+        eventRunning = 0;
+        pthread_cond_destroy(&eventWake);
+        SpscQueueDestroy(&eventQueue);
+        return 0;
+    }
+    return 1;
+}
+
+void EventThreadStop(void)
+{
+    if (!eventRunning)
+    {
+        return;
+    }
+
+    __atomic_store_n(&eventRunning, 0, __ATOMIC_RELEASE);
+    pthread_join(eventThread, NULL);
+    pthread_cond_destroy(&eventWake);
+    SpscQueueDestroy(&eventQueue);
+}
+
+int EventThreadDrain(vdkEvent * Events, int Max)
+{
+    unsigned int depth = SpscQueueSize(&eventQueue);
+    int count = SpscQueuePopBatch(&eventQueue, Events, Max);
+
+    eventStats.events += count;
+    eventStats.maxDepth = (depth > eventStats.maxDepth) ? depth : eventStats.maxDepth;
+    eventStats.maxBatch = ((unsigned int)count > eventStats.maxBatch) ? count : eventStats.maxBatch;
+    return count;
+}
+
+int EventThreadWait(unsigned int TimeoutMs)
+{
+    struct timespec deadline;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    deadline.tv_sec  += TimeoutMs / 1000;
+    deadline.tv_nsec += (TimeoutMs % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L)
+    {
+        deadline.tv_sec  += 1;
+        deadline.tv_nsec -= 1000000000L;
+    }
+
+    pthread_mutex_lock(&eventLock);
+    __atomic_store_n(&eventWaiting, 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+    int result = 0;
+    while (!(result = (SpscQueueSize(&eventQueue) > 0)))
+    {
+        if (pthread_cond_timedwait(&eventWake, &eventLock, &deadline) != 0)
+        {
+            result = SpscQueueSize(&eventQueue) > 0;
+            break;
+        }
+    }
+
+    __atomic_store_n(&eventWaiting, 0, __ATOMIC_RELAXED);
+    pthread_mutex_unlock(&eventLock);
+    return result;
+}
+
+void EventThreadGetStats(EventThreadStats * Stats)
+{
+    *Stats = eventStats;
+    Stats->stalls = __atomic_load_n(&eventStalls, __ATOMIC_RELAXED);
+}
@@ -0,0 +1,50 @@
+/*
+ * VDK event polling on its own thread.
+ *
+ * The thread polls vdkGetEvent() and pushes every event into a bounded
+ * SPSC queue; the render loop drains the queue once per frame. A burst of
+ * input therefore costs the render thread one batch copy instead of whole
+ * frames, and the polling system calls leave the render thread. When the
+ * queue is full the thread waits rather than dropping events, so the
+ * backlog stays in the VDK queue.
+ *
+ * While the render loop waits in EventThreadWait() the thread polls less
+ * often and wakes it with the first event, so an idle application sleeps
+ * instead of spinning.
+ *
+ * The native window system must allow event retrieval from a second thread;
+ * the framebuffer and Wayland back ends do, X11 needs XInitThreads().
+ */
+
+#ifndef EVENTTHREAD_H
+#define EVENTTHREAD_H
+
+#include <gc_vdk.h>
+
+#define EVENT_QUEUE_SIZE    256
+
+typedef struct _EventThreadStats
+{
+    unsigned long long  events;     // events delivered through the queue
+    unsigned long long  stalls;     // pushes that had to wait for space
+    unsigned int        maxDepth;   // deepest queue seen by a drain
+    unsigned int        maxBatch;   // most events handed out by one drain
+}
+EventThreadStats;
+
+// returns 0: fail
+//         1: success
+int EventThreadStart(vdkWindow Window);
+void EventThreadStop(void);
+
+// Render thread: copies up to Max pending events into Events, returns the count.
+int EventThreadDrain(vdkEvent * Events, int Max);
+
+// Render thread: sleeps until an event is queued or TimeoutMs passed.
+// returns 0: timed out
+//         1: events are pending
+int EventThreadWait(unsigned int TimeoutMs);
+
+void EventThreadGetStats(EventThreadStats * Stats);
+
+#endif /* EVENTTHREAD_H */
@@ -0,0 +1,87 @@
+/*
+ * GL and EGL extension queries.
+ */
+
+#include "extensions.h"
+#include <GLES2/gl2.h>
+#include <string.h>
+
+// Older eglext.h headers lack these.
+typedef EGLSyncKHR (EGLAPIENTRY * CreateSyncProc)(EGLDisplay Display, EGLenum Type, const EGLint * Attribs);
+typedef EGLBoolean (EGLAPIENTRY * DestroySyncProc)(EGLDisplay Display, EGLSyncKHR Sync);
+typedef EGLint (EGLAPIENTRY * ClientWaitSyncProc)(EGLDisplay Display, EGLSyncKHR Sync, EGLint Flags, unsigned long long Timeout);
+
+static EGLDisplay fenceDisplay = EGL_NO_DISPLAY;
+static CreateSyncProc createSync = NULL;
+static DestroySyncProc destroySync = NULL;
+static ClientWaitSyncProc clientWaitSync = NULL;
+
+static int findWord(const char * List, const char * Name)
+{
+    if ((List == NULL) || (Name == NULL))
+    {
+        return 0;
+    }
+
+    size_t length = strlen(Name);
+    for (const char * p = strstr(List, Name); p != NULL; p = strstr(p + 1, Name))
+    {
+        if (((p == List) || (p[-1] == ' ')) && ((p[length] == ' ') || (p[length] == '\0')))
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int HasGLExtension(const char * Name)
+{
+    return findWord((const char *)glGetString(GL_EXTENSIONS), Name);
+}
+
+int HasEGLExtension(EGLDisplay Display, const char * Name)
+{
+    return findWord(eglQueryString(Display, EGL_EXTENSIONS), Name);
+}
+
+/***************************************************************************************
+***************************************************************************************/
+
+int EglFenceInit(EGLDisplay Display)
+{
+    fenceDisplay = Display;
+    createSync = NULL;
+    destroySync = NULL;
+    clientWaitSync = NULL;
+    if (HasEGLExtension(Display, "EGL_KHR_fence_sync"))
+    {
+        createSync = (CreateSyncProc)eglGetProcAddress("eglCreateSyncKHR");
+        destroySync = (DestroySyncProc)eglGetProcAddress("eglDestroySyncKHR");
+        clientWaitSync = (ClientWaitSyncProc)eglGetProcAddress("eglClientWaitSyncKHR");
+        if ((destroySync == NULL) || (clientWaitSync == NULL))
+        {
+            createSync = NULL;
+        }
+    }
+    return (createSync != NULL);
+}
+
+EGLSyncKHR EglFenceCreate(void)
+{
+    return (createSync != NULL) ? createSync(fenceDisplay, EGL_SYNC_FENCE_KHR, NULL) : EGL_NO_SYNC_KHR;
+}
+
+int EglFenceWait(EGLSyncKHR Sync, int Wait, int * Flushed)
+{
+    EGLint flags = *Flushed ? 0 : EGL_SYNC_FLUSH_COMMANDS_BIT_KHR;
+    *Flushed = 1;
+    return (clientWaitSync(fenceDisplay, Sync, flags, Wait ? EGL_FOREVER_KHR : 0) == EGL_CONDITION_SATISFIED_KHR);
+}
+
+void EglFenceDestroy(EGLSyncKHR Sync)
+{
+    if (Sync != EGL_NO_SYNC_KHR)
+    {
+        destroySync(fenceDisplay, Sync);
+    }
+}
@@ -0,0 +1,45 @@
+/*
+ * GL and EGL extension queries.
+ */
+
+#ifndef EXTENSIONS_H
+#define EXTENSIONS_H
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+#ifndef EGL_SYNC_FENCE_KHR
+#define EGL_SYNC_FENCE_KHR              0x30F9
+#define EGL_SYNC_FLUSH_COMMANDS_BIT_KHR 0x0001
+#define EGL_CONDITION_SATISFIED_KHR     0x30F6
+#define EGL_FOREVER_KHR                 0xFFFFFFFFFFFFFFFFull
+#define EGL_NO_SYNC_KHR                 ((EGLSyncKHR)0)
+typedef void * EGLSyncKHR;
+#endif
+
+// Whole-word match against GL_EXTENSIONS of the current context.
+int HasGLExtension(const char * Name);
+
+// Whole-word match against EGL_EXTENSIONS of Display.
+int HasEGLExtension(EGLDisplay Display, const char * Name);
+
+// Fences (EGL_KHR_fence_sync) on Display, for the modules that must know
+// when the GPU is done with a buffer.
+// returns 0: no fences, EglFenceCreate() returns EGL_NO_SYNC_KHR
+//         1: success
+int EglFenceInit(EGLDisplay Display);
+
+// Fences the commands issued so far; EGL_NO_SYNC_KHR without fences.
+EGLSyncKHR EglFenceCreate(void);
+
+// Polls Sync, or with Wait blocks until it signals. Flushed belongs to the
+// fence and starts 0: the first wait also flushes, or the fence might never
+// be submitted.
+// returns 0: not signaled
+//         1: signaled
+int EglFenceWait(EGLSyncKHR Sync, int Wait, int * Flushed);
+
+// Accepts EGL_NO_SYNC_KHR.
+void EglFenceDestroy(EGLSyncKHR Sync);
+
+#endif /* EXTENSIONS_H */
@@ -0,0 +1,247 @@
+/*
+ * Frame pacing.
+ *
+ * Timer pacing keeps a grid of slot times on the monotonic clock and sleeps
+ * until the next one; a frame that starts more than PACE_RESYNC_NS after its
+ * slot moves the grid instead of trying to win the time back. Vsync pacing
+ * follows the presents: the next frame starts a little before the vblank
+ * after the last present and the swap blocks for the rest, so timer and
+ * display clocks never drift apart.
+ */
+
+#include "framepacer.h"
+#include "framestats.h"
+#include <errno.h>
+#include <math.h>
+#include <string.h>
+#include <time.h>
+
+#define PACE_RESYNC_NS      1000000
+
+static int paceHz = 0;
+static int pacePolicy = FRAME_PACE_DROP;
+static int paceSwapInterval = 0;
+static int paceVsync = 0;                   // the swap blocks for the slot
+static unsigned long long pacePeriod = 0;   // ns, 0 uncapped
+static unsigned long long paceNext = 0;     // slot of the next frame
+static unsigned long long paceMissed = 0;   // slots missed by the last present (vsync)
+static unsigned long long paceLastPresent = 0;
+static unsigned long long paceStart = 0;
+static unsigned long long paceCpuStart = 0;
+
+// Present intervals, running mean and squared deviations (Welford).
+static FramePacerStats paceStats;
+static double paceM2 = 0.0;
+
+static unsigned long long paceCpuNs(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &now);
+    return now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+static void paceSleepUntil(unsigned long long Ns)
+{
+    struct timespec until;
+    until.tv_sec = Ns / 1000000000ULL;
+    until.tv_nsec = Ns % 1000000000ULL;
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &until, NULL) == EINTR)
+    {
+    }
+}
+
+/***************************************************************************************
+***************************************************************************************/
+
+void FramePacerInit(EGLDisplay Display, int TargetHz, int Policy)
+{
+    paceHz = (TargetHz > 0) ? TargetHz : 0;
+    pacePolicy = Policy;
+    pacePeriod = (paceHz > 0) ? 1000000000ULL / paceHz : 0;
+
+    // Vsync paces exact divisors of the refresh rate; anything else is
+    // paced by the timer with vsync on, anything faster than the display
+    // runs with it off.
+    if ((paceHz == 0) || (paceHz > FRAME_PACE_DISPLAY_HZ))
+    {
+        paceSwapInterval = 0;
+    }
+    else if (FRAME_PACE_DISPLAY_HZ % paceHz == 0)
+    {
+        paceSwapInterval = FRAME_PACE_DISPLAY_HZ / paceHz;
+    }
+    else
+    {
+        paceSwapInterval = 1;
+    }
+
+    if (Display != EGL_NO_DISPLAY)
+    {
+        if (!eglSwapInterval(Display, paceSwapInterval))
+        {
+            fprintf(stderr, "eglSwapInterval(%d) failed, pacing by timer.\n", paceSwapInterval);
+            paceSwapInterval = -1;
+        }
+    }
+    else
+    {
+        paceSwapInterval = -1;
+    }
+    paceVsync = (paceSwapInterval > 0) && (paceSwapInterval * paceHz == FRAME_PACE_DISPLAY_HZ);
+
+    memset(&paceStats, 0, sizeof(paceStats));
+    paceM2 = 0.0;
+    paceStart = FrameStatsNs();
+    paceCpuStart = paceCpuNs();
+    FramePacerRestart();
+}
+
+int FramePacerBegin(void)
+{
+    unsigned long long now = FrameStatsNs();
+    if (pacePeriod == 0)
+    {
+        return 1;
+    }
+
+    unsigned long long missed;
+    if (paceVsync)
+    {
+        // Wake a quarter period before the vblank, the swap waits for it.
+        unsigned long long wake = paceNext - pacePeriod / 4;
+        if (now < wake)
+        {
+            paceSleepUntil(wake);
+            paceStats.sleptMs += (FrameStatsNs() - now) / 1e6;
+        }
+        missed = paceMissed;
+        paceMissed = 0;
+    }
+    else
+    {
+        if (now < paceNext)
+        {
+            paceSleepUntil(paceNext);
+            unsigned long long woke = FrameStatsNs();
+            paceStats.sleptMs += (woke - now) / 1e6;
+            now = woke;
+        }
+
+        unsigned long long late = now - paceNext;
+        missed = late / pacePeriod;
+        paceNext = (late > PACE_RESYNC_NS) ? now + pacePeriod : paceNext + pacePeriod;
+    }
+
+    if (missed == 0)
+    {
+        return 1;
+    }
+
+    ++paceStats.late;
+    if (pacePolicy == FRAME_PACE_CATCH_UP)
+    {
+        int steps = (missed + 1 < FRAME_PACE_MAX_STEPS) ? (int)missed + 1 : FRAME_PACE_MAX_STEPS;
+        paceStats.caughtUp += steps - 1;
+        return steps;
+    }
+    paceStats.dropped += missed;
+    return 1;
+}
+
+void FramePacerRestart(void)
+{
+    paceLastPresent = 0;
+    paceMissed = 0;
+    paceNext = FrameStatsNs();
+}
+
+void FramePacerSkip(void)
+{
+    // No swap waits for this slot, the next frame is a period later.
+    paceLastPresent = 0;
+    if (paceVsync)
+    {
+        paceNext += pacePeriod;
+    }
+}
+
+void FramePacerPresented(void)
+{
+    unsigned long long now = FrameStatsNs();
+    if (paceLastPresent != 0)
+    {
+        double interval = (now - paceLastPresent) / 1e6;
+        double delta = interval - paceStats.intervalMean;
+        ++paceStats.frames;
+        paceStats.intervalMean += delta / paceStats.frames;
+        paceM2 += delta * (interval - paceStats.intervalMean);
+
+        if (paceStats.frames == 1 || interval < paceStats.intervalMin)
+        {
+            paceStats.intervalMin = interval;
+        }
+        if (interval > paceStats.intervalMax)
+        {
+            paceStats.intervalMax = interval;
+        }
+
+        // Vsync pacing: a present more than half a period late missed its vblank.
+        if (paceVsync)
+        {
+            unsigned long long elapsed = now - paceLastPresent;
+            paceMissed = (elapsed > pacePeriod + pacePeriod / 2) ? (elapsed + pacePeriod / 2) / pacePeriod - 1 : 0;
+        }
+    }
+    paceLastPresent = now;
+
+    if (paceVsync)
+    {
+        paceNext = now + pacePeriod;
+    }
+}
+
+int FramePacerSwapInterval(void)
+{
+    return paceSwapInterval;
+}
+
+void FramePacerGetStats(FramePacerStats * Stats)
+{
+    *Stats = paceStats;
+    Stats->intervalStdDev = (paceStats.frames > 1) ? sqrt(paceM2 / (paceStats.frames - 1)) : 0.0;
+    Stats->wallMs = (FrameStatsNs() - paceStart) / 1e6;
+    Stats->cpuMs = (paceCpuNs() - paceCpuStart) / 1e6;
+}
+
+void FramePacerPrint(FILE * Stream)
+{
+    FramePacerStats stats;
+    FramePacerGetStats(&stats);
+
+    if (paceHz > 0)
+    {
+        fprintf(Stream, "pacing: %d Hz target, %s late frames, ", paceHz,
+                (pacePolicy == FRAME_PACE_CATCH_UP) ? "catch up" : "drop");
+    }
+    else
+    {
+        fprintf(Stream, "pacing: uncapped, ");
+    }
+    if (paceSwapInterval >= 0)
+    {
+        fprintf(Stream, "swap interval %d\n", paceSwapInterval);
+    }
+    else
+    {
+        fprintf(Stream, "swap interval not set\n");
+    }
+
+    fprintf(Stream, "pacing: present interval %.3f ms mean, %.3f ms jitter (std dev), %.3f min, %.3f max\n",
+            stats.intervalMean, stats.intervalStdDev, stats.intervalMin, stats.intervalMax);
+    fprintf(Stream, "pacing: %llu late frames, %llu slots dropped, %llu steps caught up\n",
+            stats.late, stats.dropped, stats.caughtUp);
+
+    double wall = (stats.wallMs > 0.0) ? stats.wallMs : 1.0;
+    fprintf(Stream, "pacing: %.1f%% of the time asleep, CPU %.1f%% of one core\n",
+            100.0 * stats.sleptMs / wall, 100.0 * stats.cpuMs / wall);
+}
@@ -0,0 +1,76 @@
+/*
+ * Frame pacing.
+ *
+ * Frames start on a fixed grid of the target rate instead of whenever the
+ * previous swap returned: FramePacerBegin() sleeps until the next slot, so
+ * a capped demo delivers evenly spaced frames and leaves the CPU idle in
+ * between. The swap interval is set to the number of display refreshes per
+ * frame when the target divides the refresh rate, letting vsync do the
+ * pacing; otherwise the timer does.
+ *
+ * A frame that starts one or more slots late is handled by the late policy:
+ * FRAME_PACE_DROP shows the next simulation step and gives up the missed
+ * slots (the animation slows down), FRAME_PACE_CATCH_UP runs one fixed
+ * simulation step per slot elapsed, up to FRAME_PACE_MAX_STEPS, so the
+ * animation keeps wall-clock time.
+ *
+ * The interval between presents is measured for the jitter report.
+ */
+
+#ifndef FRAMEPACER_H
+#define FRAMEPACER_H
+
+#include <EGL/egl.h>
+#include <stdio.h>
+
+// Refresh rate assumed for the swap interval; EGL cannot query it.
+#define FRAME_PACE_DISPLAY_HZ   60
+#define FRAME_PACE_MAX_STEPS    4
+
+// Late policies.
+enum
+{
+    FRAME_PACE_DROP,
+    FRAME_PACE_CATCH_UP,
+};
+
+typedef struct _FramePacerStats
+{
+    unsigned long long frames;          // presents measured
+    unsigned long long late;            // frames that started a slot or more late
+    unsigned long long dropped;         // slots given up (drop policy)
+    unsigned long long caughtUp;        // extra simulation steps (catch-up policy)
+    double             intervalMean;    // ms between presents
+    double             intervalStdDev;  // ms, the jitter
+    double             intervalMin;
+    double             intervalMax;
+    double             sleptMs;         // waiting for slots
+    double             wallMs;          // since FramePacerInit()
+    double             cpuMs;           // process CPU time since FramePacerInit()
+}
+FramePacerStats;
+
+// TargetHz 0 runs uncapped with swap interval 0. Display may be
+// EGL_NO_DISPLAY, the swap interval is then left alone.
+void FramePacerInit(EGLDisplay Display, int TargetHz, int Policy);
+
+// Waits for the slot of the next frame.
+// returns the simulation steps to run for it, at least 1
+int FramePacerBegin(void);
+
+// Starts over after a pause: the next frame is not late and its interval
+// is not measured.
+void FramePacerRestart(void);
+
+// The frame of the last FramePacerBegin() was not presented; its slot
+// passes without a swap.
+void FramePacerSkip(void);
+
+// Call right after the swap.
+void FramePacerPresented(void);
+
+int FramePacerSwapInterval(void);
+void FramePacerGetStats(FramePacerStats * Stats);
+void FramePacerPrint(FILE * Stream);
+
+#endif /* FRAMEPACER_H */
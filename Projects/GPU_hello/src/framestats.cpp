@@ -0,0 +1,251 @@
+/*
+ * Per-frame CPU timing.
+ *
+ * Histogram index of a value v in nanoseconds: values below 128 have their
+ * own bucket; above, v lies in [2^k, 2^(k+1)) and is stored with its top
+ * seven bits, index = m * 64 + (v >> m) with m = k - 6.
+ */
+
+#include "framestats.h"
+#include <string.h>
+#include <time.h>
+
+#define STATS_SUB_BITS      7
+#define STATS_HALF_COUNT    (1 << (STATS_SUB_BITS - 1))
+#define STATS_MAX_SHIFT     33      // values up to 2^40 ns
+#define STATS_BUCKETS       (STATS_HALF_COUNT * (STATS_MAX_SHIFT + 2))
+
+typedef struct _StatsHistogram
+{
+    unsigned int        counts[STATS_BUCKETS];
+    unsigned long long  count;
+    unsigned long long  sum;
+    unsigned long long  min;
+    unsigned long long  max;
+}
+StatsHistogram;
+
+static StatsHistogram statsPhases[FRAME_PHASE_COUNT];
+static unsigned long long statsFrame[FRAME_PHASE_COUNT];
+static unsigned long long statsFrameStart = 0;
+static unsigned long long statsLastLap = 0;
+static int statsWarmup = 0;
+static int statsSkipped = 0;
+
+static const char * statsNames[FRAME_PHASE_COUNT] =
+{
+    "pace",
+    "events",
+    "scene",
+    "render",
+    "swap",
+    "frame",
+};
+
+/***************************************************************************************
+***************************************************************************************/
+
+static int statsIndex(unsigned long long Value)
+{
+    if (Value < (1ULL << STATS_SUB_BITS))
+    {
+        return (int)Value;
+    }
+
+    int k = 63 - __builtin_clzll(Value);
+    int m = k - (STATS_SUB_BITS - 1);
+    if (m > STATS_MAX_SHIFT)
+    {
+        return STATS_BUCKETS - 1;
+    }
+    return m * STATS_HALF_COUNT + (int)(Value >> m);
+}
+
+// Midpoint of the values that share the bucket.
+static unsigned long long statsValue(int Index)
+{
+    if (Index < (1 << STATS_SUB_BITS))
+    {
+        return Index;
+    }
+
+    int m = Index / STATS_HALF_COUNT - 1;
+    unsigned long long sub = Index - m * STATS_HALF_COUNT;
+    return (sub << m) + ((1ULL << m) >> 1);
+}
+
+static void statsRecord(StatsHistogram * Hist, unsigned long long Value)
+{
+    ++Hist->counts[statsIndex(Value)];
+    if ((Hist->count == 0) || (Value < Hist->min))
+    {
+        Hist->min = Value;
+    }
+    if (Value > Hist->max)
+    {
+        Hist->max = Value;
+    }
+    ++Hist->count;
+    Hist->sum += Value;
+}
+
+static unsigned long long statsPercentile(const StatsHistogram * Hist, double Percent)
+{
+    if (Hist->count == 0)
+    {
+        return 0;
+    }
+
+    unsigned long long rank = (unsigned long long)(Percent / 100.0 * Hist->count + 0.5);
+    if (rank < 1)
+    {
+        rank = 1;
+    }
+
+    unsigned long long seen = 0;
+    for (int i = 0; i < STATS_BUCKETS; ++i)
+    {
+        seen += Hist->counts[i];
+        if (seen >= rank)
+        {
+            // The exact extremes are known, keep estimates inside them.
+            unsigned long long value = statsValue(i);
+            return (value > Hist->max) ? Hist->max : ((value < Hist->min) ? Hist->min : value);
+        }
+    }
+    return Hist->max;
+}
+
+/***************************************************************************************
+***************************************************************************************/
+
+unsigned long long FrameStatsNs(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+void FrameStatsInit(int WarmupFrames)
+{
+    memset(statsPhases, 0, sizeof(statsPhases));
+    statsWarmup = WarmupFrames;
+    statsSkipped = 0;
+    FrameStatsRestart();
+}
+
+void FrameStatsRestart(void)
+{
+    memset(statsFrame, 0, sizeof(statsFrame));
+    statsFrameStart = statsLastLap = FrameStatsNs();
+}
+
+void FrameStatsLap(int Phase)
+{
+    unsigned long long now = FrameStatsNs();
+    statsFrame[Phase] += now - statsLastLap;
+    statsLastLap = now;
+}
+
+void FrameStatsEnd(void)
+{
+    unsigned long long now = FrameStatsNs();
+    statsFrame[FRAME_PHASE_TOTAL] = now - statsFrameStart;
+
+    if (statsSkipped < statsWarmup)
+    {
+        ++statsSkipped;
+    }
+    else
+    {
+        for (int i = 0; i < FRAME_PHASE_COUNT; ++i)
+        {
+            statsRecord(&statsPhases[i], statsFrame[i]);
+        }
+    }
+
+    memset(statsFrame, 0, sizeof(statsFrame));
+    statsFrameStart = statsLastLap = now;
+}
+
+void FrameStatsSummarize(int Phase, FrameStatsSummary * Summary)
+{
+    const StatsHistogram * hist = &statsPhases[Phase];
+
+    Summary->count = hist->count;
+    Summary->mean  = (hist->count > 0) ? hist->sum / 1e6 / hist->count : 0.0;
+    Summary->min   = hist->min / 1e6;
+    Summary->p50   = statsPercentile(hist, 50.0) / 1e6;
+    Summary->p90   = statsPercentile(hist, 90.0) / 1e6;
+    Summary->p99   = statsPercentile(hist, 99.0) / 1e6;
+    Summary->p999  = statsPercentile(hist, 99.9) / 1e6;
+    Summary->max   = hist->max / 1e6;
+}
+
+const char * FrameStatsPhaseName(int Phase)
+{
+    return statsNames[Phase];
+}
+
+void FrameStatsPrint(FILE * Stream)
+{
+    fprintf(Stream, "%-8s %8s %9s %9s %9s %9s %9s %9s %9s (ms, %d warm-up frames skipped)\n",
+            "phase", "frames", "mean", "min", "p50", "p90", "p99", "p99.9", "max", statsSkipped);
+
+    for (int i = 0; i < FRAME_PHASE_COUNT; ++i)
+    {
+        FrameStatsSummary s;
+        FrameStatsSummarize(i, &s);
+        fprintf(Stream, "%-8s %8llu %9.3f %9.3f %9.3f %9.3f %9.3f %9.3f %9.3f\n",
+                statsNames[i], s.count, s.mean, s.min, s.p50, s.p90, s.p99, s.p999, s.max);
+    }
+}
+
+int FrameStatsWrite(const char * FName)
+{
+    FILE * fptr = fopen(FName, "w");
+    if (fptr == NULL)
+    {
+        fprintf(stderr, "Cannot open file '%s'\n", FName);
+        return 0;
+    }
+
+    size_t length = strlen(FName);
+    int csv = (length >= 4) && (strcmp(&FName[length - 4], ".csv") == 0);
+
+    if (csv)
+    {
+        fprintf(fptr, "phase,frames,mean_ms,min_ms,p50_ms,p90_ms,p99_ms,p999_ms,max_ms\n");
+    }
+    else
+    {
+        fprintf(fptr, "{\n  \"warmup\": %d,\n  \"unit\": \"ms\",\n  \"phases\": {\n", statsSkipped);
+    }
+
+    for (int i = 0; i < FRAME_PHASE_COUNT; ++i)
+    {
+        FrameStatsSummary s;
+        FrameStatsSummarize(i, &s);
+
+        if (csv)
+        {
+            fprintf(fptr, "%s,%llu,%.6f,%.6f,%.6f,%.6f,%.6f,%.6f,%.6f\n",
+                    statsNames[i], s.count, s.mean, s.min, s.p50, s.p90, s.p99, s.p999, s.max);
+        }
+        else
+        {
+            fprintf(fptr, "    \"%s\": { \"frames\": %llu, \"mean\": %.6f, \"min\": %.6f, \"p50\": %.6f, "
+                          "\"p90\": %.6f, \"p99\": %.6f, \"p99.9\": %.6f, \"max\": %.6f }%s\n",
+                    statsNames[i], s.count, s.mean, s.min, s.p50, s.p90, s.p99, s.p999, s.max,
+                    (i + 1 < FRAME_PHASE_COUNT) ? "," : "");
+        }
+    }
+
+    if (!csv)
+    {
+        fprintf(fptr, "  }\n}\n");
+    }
+
+    fclose(fptr);
+    return 1;
+}
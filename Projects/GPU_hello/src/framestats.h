@@ -0,0 +1,63 @@
+/*
+ * Per-frame CPU timing.
+ *
+ * Each frame is split into phases measured on the monotonic nanosecond
+ * clock. Every phase and the whole frame go into a log-linear histogram
+ * (HdrHistogram layout, 128 sub-buckets per power of two, < 1% error) so
+ * the tail percentiles are reported instead of a single average.
+ */
+
+#ifndef FRAMESTATS_H
+#define FRAMESTATS_H
+
+#include <stdio.h>
+
+enum
+{
+    FRAME_PHASE_PACE,       // waiting for the frame's slot
+    FRAME_PHASE_EVENTS,     // event polling and handling
+    FRAME_PHASE_SCENE,      // scene update, or waiting for the simulation thread
+    FRAME_PHASE_RENDER,     // Render() command submission
+    FRAME_PHASE_SWAP,       // vdkSwapEGL
+    FRAME_PHASE_TOTAL,      // whole frame
+    FRAME_PHASE_COUNT
+};
+
+typedef struct _FrameStatsSummary
+{
+    unsigned long long count;
+    double mean;            // milliseconds
+    double min;
+    double p50;
+    double p90;
+    double p99;
+    double p999;
+    double max;
+}
+FrameStatsSummary;
+
+unsigned long long FrameStatsNs(void);
+
+// The first WarmupFrames frames are timed but not recorded.
+void FrameStatsInit(int WarmupFrames);
+
+// Starts a new frame now, discarding the partial one (e.g. after a pause).
+void FrameStatsRestart(void);
+
+// Charges the time since the previous lap (or frame start) to Phase.
+void FrameStatsLap(int Phase);
+
+// Records the frame; the next one starts now.
+void FrameStatsEnd(void);
+
+void FrameStatsSummarize(int Phase, FrameStatsSummary * Summary);
+const char * FrameStatsPhaseName(int Phase);
+
+void FrameStatsPrint(FILE * Stream);
+
+// Writes the summary as CSV if FName ends in ".csv", JSON otherwise.
+// returns 0: fail
+//         1: success
+int FrameStatsWrite(const char * FName);
+
+#endif /* FRAMESTATS_H */
@@ -0,0 +1,298 @@
+/*
+ * Background writer of rendered frames.
+ *
+ * Buffers are used round-robin by both threads, so no queue is needed: two
+ * semaphores count the free and the queued buffers. FrameWriterClose()
+ * posts one extra wakeup, which the writer sees as a wakeup with nothing
+ * queued behind it.
+ */
+
+#include "framewriter.h"
+#include <pthread.h>
+#include <semaphore.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define FNV_OFFSET  2166136261u
+#define FNV_PRIME   16777619u
+
+#define WRITER_RAW  0
+#define WRITER_Y4M  1
+#define WRITER_MEM  2
+
+static int writerKind = WRITER_RAW;
+static FILE * writerFile = NULL;
+static int writerWidth = 0;
+static int writerHeight = 0;
+static int writerCount = 0;
+static unsigned char ** writerBuffers = NULL;
+static unsigned char * writerScratch = NULL;    // converted frame
+static size_t writerFrameSize = 0;              // bytes of the converted frame
+static unsigned int writerHead = 0;             // buffers submitted, render thread
+static unsigned int writerTail = 0;             // buffers written, writer thread
+static sem_t writerFree;
+static sem_t writerQueued;
+static pthread_t writerThread;
+static int writerError = 0;
+static FrameWriterStats writerStats;
+
+static void writerWait(sem_t * Semaphore)
+{
+    while ((sem_wait(Semaphore) != 0) && (errno == EINTR))
+    {
+    }
+}
+
+static unsigned int fnv(unsigned int Hash, const unsigned char * Data, size_t Size)
+{
+    for (size_t i = 0; i < Size; ++i)
+    {
+        Hash = (Hash ^ Data[i]) * FNV_PRIME;
+    }
+    return Hash;
+}
+
+static unsigned char clampByte(int Value)
+{
+    return (Value > 255) ? 255 : (unsigned char)Value;
+}
+
+// Bottom-up RGBA to top-down planar 4:2:0, full range BT.601 in 8.8 fixed
+// point. The offsets keep every sum positive before the shift.
+static void convertY4M(const unsigned char * Rgba, unsigned char * Planes)
+{
+    int w = writerWidth;
+    int h = writerHeight;
+    int cw = (w + 1) / 2;
+    int ch = (h + 1) / 2;
+    unsigned char * yPlane = Planes;
+    unsigned char * uPlane = yPlane + w * h;
+    unsigned char * vPlane = uPlane + cw * ch;
+
+    for (int y = 0; y < h; ++y)
+    {
+        const unsigned char * src = Rgba + (size_t)(h - 1 - y) * w * 4;
+        unsigned char * dst = yPlane + (size_t)y * w;
+        for (int x = 0; x < w; ++x, src += 4)
+        {
+            dst[x] = (unsigned char)((77 * src[0] + 150 * src[1] + 29 * src[2] + 128) >> 8);
+        }
+    }
+
+    for (int cy = 0; cy < ch; ++cy)
+    {
+        int y0 = h - 1 - cy * 2;
+        int y1 = (y0 > 0) ? y0 - 1 : y0;
+        const unsigned char * row0 = Rgba + (size_t)y0 * w * 4;
+        const unsigned char * row1 = Rgba + (size_t)y1 * w * 4;
+        for (int cx = 0; cx < cw; ++cx)
+        {
+            int x0 = cx * 2 * 4;
+            int x1 = (cx * 2 + 1 < w) ? x0 + 4 : x0;
+            int r = row0[x0 + 0] + row0[x1 + 0] + row1[x0 + 0] + row1[x1 + 0];
+            int g = row0[x0 + 1] + row0[x1 + 1] + row1[x0 + 1] + row1[x1 + 1];
+            int b = row0[x0 + 2] + row0[x1 + 2] + row1[x0 + 2] + row1[x1 + 2];
+
+            // Sums of four, hence >> 10.
+            uPlane[cy * cw + cx] = clampByte((-43 * r - 85 * g + 128 * b + (128 << 10) + 512) >> 10);
+            vPlane[cy * cw + cx] = clampByte((128 * r - 107 * g - 21 * b + (128 << 10) + 512) >> 10);
+        }
+    }
+}
+
+static void convertRaw(const unsigned char * Rgba, unsigned char * Out)
+{
+    size_t row = (size_t)writerWidth * 4;
+    for (int y = 0; y < writerHeight; ++y)
+    {
+        memcpy(Out + y * row, Rgba + (writerHeight - 1 - y) * row, row);
+    }
+}
+
+static void writeFrame(const unsigned char * Rgba)
+{
+    size_t size = (size_t)writerWidth * writerHeight * 4;
+    writerStats.lastChecksum = fnv(FNV_OFFSET, Rgba, size);
+    writerStats.checksum = fnv(writerStats.checksum, Rgba, size);
+    ++writerStats.frames;
+
+    if ((writerKind == WRITER_MEM) || writerError)
+    {
+        return;
+    }
+
+    if (writerKind == WRITER_Y4M)
+    {
+        convertY4M(Rgba, writerScratch);
+        if (fputs("FRAME\n", writerFile) < 0)
+        {
+            writerError = 1;
+        }
+        writerStats.bytes += 6;
+    }
+    else
+    {
+        convertRaw(Rgba, writerScratch);
+    }
+
+    if (fwrite(writerScratch, 1, writerFrameSize, writerFile) != writerFrameSize)
+    {
+        writerError = 1;
+    }
+    writerStats.bytes += writerFrameSize;
+}
+
+static void * writerMain(void * Arg)
+{
+    (void)Arg;
+    for (;;)
+    {
+        writerWait(&writerQueued);
+        if (writerTail == __atomic_load_n(&writerHead, __ATOMIC_ACQUIRE))
+        {
+            break;
+        }
+
+        writeFrame(writerBuffers[writerTail % writerCount]);
+        ++writerTail;
+        sem_post(&writerFree);
+    }
+    return NULL;
+}
+
+static void writerFreeBuffers(void)
+{
+    for (int i = 0; (writerBuffers != NULL) && (i < writerCount); ++i)
+    {
+        free(writerBuffers[i]);
+    }
+    free(writerBuffers);
+    free(writerScratch);
+    writerBuffers = NULL;
+    writerScratch = NULL;
+}
+
+/***************************************************************************************
+***************************************************************************************/
+
+int FrameWriterOpen(const char * Target, int Width, int Height, int Rate, int Buffers)
+{
+    size_t length = strlen(Target);
+    if (strcmp(Target, "mem") == 0)
+    {
+        writerKind = WRITER_MEM;
+    }
+    else if ((length > 4) && (strcmp(Target + length - 4, ".y4m") == 0))
+    {
+        writerKind = WRITER_Y4M;
+    }
+    else
+    {
+        writerKind = WRITER_RAW;
+    }
+
+    writerWidth = Width;
+    writerHeight = Height;
+    writerCount = (Buffers > 0) ? Buffers : 1;
+    writerHead = writerTail = 0;
+    writerError = 0;
+    memset(&writerStats, 0, sizeof(writerStats));
+    writerStats.checksum = FNV_OFFSET;
+
+    writerFrameSize = (writerKind == WRITER_Y4M)
+                    ? (size_t)Width * Height + 2 * (size_t)((Width + 1) / 2) * ((Height + 1) / 2)
+                    : (size_t)Width * Height * 4;
+
+    writerBuffers = (unsigned char **)calloc(writerCount, sizeof (unsigned char *));
+    writerScratch = (writerKind != WRITER_MEM) ? (unsigned char *)malloc(writerFrameSize) : NULL;
+    int ok = (writerBuffers != NULL) && ((writerKind == WRITER_MEM) || (writerScratch != NULL));
+    for (int i = 0; ok && (i < writerCount); ++i)
+    {
+        writerBuffers[i] = (unsigned char *)malloc((size_t)Width * Height * 4);
+        ok = (writerBuffers[i] != NULL);
+    }
+    if (!ok)
+    {
+        fprintf(stderr, "Out of memory.\n");
+        writerFreeBuffers();
+        return 0;
+    }
+
+    writerFile = NULL;
+    if (writerKind != WRITER_MEM)
+    {
+        writerFile = fopen(Target, "wb");
+        if (writerFile == NULL)
+        {
+            fprintf(stderr, "Cannot create %s.\n", Target);
+            writerFreeBuffers();
+            return 0;
+        }
+    }
+    if (writerKind == WRITER_Y4M)
+    {
+        int bytes = fprintf(writerFile, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C420jpeg\n", Width, Height, Rate);
+        writerStats.bytes += (bytes > 0) ? bytes : 0;
+    }
+
+    sem_init(&writerFree, 0, writerCount);
+    sem_init(&writerQueued, 0, 0);
+    if (pthread_create(&writerThread, NULL, writerMain, NULL) != 0)
+    {
+        fprintf(stderr, "Cannot create the frame writer thread.\n");
+        sem_destroy(&writerFree);
+        sem_destroy(&writerQueued);
+        if (writerFile != NULL)
+        {
+            fclose(writerFile);
+            writerFile = NULL;
+        }
+        writerFreeBuffers();
+        return 0;
+    }
+    return 1;
+}
+
+int FrameWriterClose(void)
+{
+    if (writerBuffers == NULL)
+    {
+        return 1;
+    }
+
+    sem_post(&writerQueued);
+    pthread_join(writerThread, NULL);
+    sem_destroy(&writerFree);
+    sem_destroy(&writerQueued);
+
+    if ((writerFile != NULL) && (fclose(writerFile) != 0))
+    {
+        writerError = 1;
+    }
+    writerFile = NULL;
+    writerFreeBuffers();
+    return !writerError;
+}
+
+unsigned char * FrameWriterAcquire(void)
+{
+    if (sem_trywait(&writerFree) != 0)
+    {
+        ++writerStats.stalls;
+        writerWait(&writerFree);
+    }
+    return writerBuffers[writerHead % writerCount];
+}
+
+void FrameWriterSubmit(void)
+{
+    __atomic_store_n(&writerHead, writerHead + 1, __ATOMIC_RELEASE);
+    sem_post(&writerQueued);
+}
+
+void FrameWriterGetStats(FrameWriterStats * Stats)
+{
+    *Stats = writerStats;
+}
@@ -0,0 +1,49 @@
+/*
+ * Background writer of rendered frames.
+ *
+ * The render thread reads frames into a fixed pool of RGBA buffers (rows
+ * bottom-up, as glReadPixels() returns them) and hands them over in order;
+ * a writer thread converts and writes them while the next frames render.
+ * The render thread only waits when every buffer is still queued.
+ *
+ * Targets:
+ *   name.y4m   YUV4MPEG2, 4:2:0 full range BT.601, for any video tool
+ *   mem        nothing written, the frames are only checksummed
+ *   other      raw RGBA, rows top-down
+ *
+ * Every frame is checksummed (FNV-1a over its pixels), so automated runs
+ * can compare the last frame or the whole sequence.
+ */
+
+#ifndef FRAMEWRITER_H
+#define FRAMEWRITER_H
+
+typedef struct _FrameWriterStats
+{
+    unsigned long long  frames;
+    unsigned long long  bytes;          // written to the file
+    unsigned long long  stalls;         // FrameWriterAcquire() waited for the writer
+    unsigned int        lastChecksum;   // of the last frame
+    unsigned int        checksum;       // of all frames, in order
+}
+FrameWriterStats;
+
+// Rate is the frame rate put in a Y4M header.
+// returns 0: fail
+//         1: success
+int FrameWriterOpen(const char * Target, int Width, int Height, int Rate, int Buffers);
+
+// Writes everything queued and stops the thread.
+// returns 0: write error, the file is incomplete
+//         1: success
+int FrameWriterClose(void);
+
+// A free buffer of Width * Height * 4 bytes for the next frame.
+unsigned char * FrameWriterAcquire(void);
+
+// Queues the buffer of the last FrameWriterAcquire().
+void FrameWriterSubmit(void);
+
+void FrameWriterGetStats(FrameWriterStats * Stats);
+
+#endif /* FRAMEWRITER_H */
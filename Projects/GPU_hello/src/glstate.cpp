@@ -0,0 +1,463 @@
+/*
+ * Redundant GL state-change filter.
+ *
+ * Each shadow value has a valid flag; after a reset nothing is valid and
+ * the first call of each kind goes to the driver. Uniform values are kept
+ * per program, for the first few programs and locations only; others are
+ * passed through.
+ */
+
+#include "glstate.h"
+#include <string.h>
+#include "gltrace.h"
+
+#define STATE_MAX_ATTRIBS   16
+#define STATE_MAX_PROGRAMS  16
+#define STATE_MAX_UNIFORMS  64      // locations per program
+
+typedef struct _StateAttrib
+{
+    int             valid;
+    int             enabledValid;
+    GLboolean       enabled;
+    GLuint          buffer;
+    GLint           size;
+    GLenum          type;
+    GLboolean       normalized;
+    GLsizei         stride;
+    const GLvoid *  pointer;
+}
+StateAttrib;
+
+typedef struct _StateUniform
+{
+    int             floats;     // 0 = unknown
+    GLfloat         value[16];
+}
+StateUniform;
+
+typedef struct _StateProgram
+{
+    GLuint          program;    // 0 = free slot
+    StateUniform    uniforms[STATE_MAX_UNIFORMS];
+}
+StateProgram;
+
+// Enables tracked, one bit each.
+static const GLenum stateCaps[] =
+{
+    GL_BLEND,
+    GL_DEPTH_TEST,
+    GL_CULL_FACE,
+    GL_SCISSOR_TEST,
+    GL_STENCIL_TEST,
+    GL_DITHER,
+    GL_POLYGON_OFFSET_FILL,
+};
+#define STATE_CAP_COUNT ((int)(sizeof(stateCaps) / sizeof(stateCaps[0])))
+
+static const char * stateGroupNames[GL_STATE_GROUP_COUNT] =
+{
+    "program",
+    "uniform",
+    "buffer",
+    "attrib",
+    "clear",
+    "blend",
+    "depth",
+    "enable",
+};
+
+static int stateFiltering = 1;
+static GlStateStats stateStats;
+
+static int stateProgramValid;
+static GLuint stateProgram;
+static StateProgram statePrograms[STATE_MAX_PROGRAMS];
+static StateProgram * stateCurrent;     // uniforms of stateProgram, or NULL
+static int stateNextSlot;
+
+static int stateArrayBufferValid;
+static GLuint stateArrayBuffer;
+static int stateElementBufferValid;
+static GLuint stateElementBuffer;
+static StateAttrib stateAttribs[STATE_MAX_ATTRIBS];
+
+static int stateClearColorValid;
+static GLfloat stateClearColor[4];
+static int stateClearDepthValid;
+static GLfloat stateClearDepth;
+
+static unsigned int stateCapsValid;
+static unsigned int stateCapsEnabled;
+static int stateBlendValid;
+static GLenum stateBlend[2];
+static int stateDepthFuncValid;
+static GLenum stateDepthFunc;
+static int stateDepthMaskValid;
+static GLboolean stateDepthMask;
+
+/***************************************************************************************
+***************************************************************************************/
+
+// returns 1 when the call has to be issued, counting it either way
+static int stateIssue(int Group, int Redundant)
+{
+    if (Redundant && stateFiltering)
+    {
+        ++stateStats.elided[Group];
+        return 0;
+    }
+    ++stateStats.issued[Group];
+    return 1;
+}
+
+static StateProgram * stateFindProgram(GLuint Program, int Create)
+{
+    if (Program == 0)
+    {
+        return NULL;
+    }
+
+    for (int i = 0; i < STATE_MAX_PROGRAMS; ++i)
+    {
+        if (statePrograms[i].program == Program)
+        {
+            return &statePrograms[i];
+        }
+    }
+    if (!Create)
+    {
+        return NULL;
+    }
+
+    // Round robin; an evicted program just loses its shadow.
+    StateProgram * slot = &statePrograms[stateNextSlot];
+    stateNextSlot = (stateNextSlot + 1) % STATE_MAX_PROGRAMS;
+    memset(slot, 0, sizeof(*slot));
+    slot->program = Program;
+    return slot;
+}
+
+// Filters one uniform upload of Floats values.
+static int stateUniform(GLint Location, GLsizei Count, const GLfloat * Value, int Floats)
+{
+    StateUniform * uniform = NULL;
+    if ((stateCurrent != NULL) && (Location >= 0) && (Location < STATE_MAX_UNIFORMS))
+    {
+        uniform = &stateCurrent->uniforms[Location];
+    }
+
+    if ((uniform == NULL) || (Count != 1))
+    {
+        if (uniform != NULL)
+        {
+            uniform->floats = 0;
+        }
+        return stateIssue(GL_STATE_UNIFORM, 0);
+    }
+
+    int redundant = (uniform->floats == Floats)
+                 && (memcmp(uniform->value, Value, sizeof (GLfloat) * Floats) == 0);
+    if (!stateIssue(GL_STATE_UNIFORM, redundant))
+    {
+        return 0;
+    }
+
+    uniform->floats = Floats;
+    memcpy(uniform->value, Value, sizeof (GLfloat) * Floats);
+    return 1;
+}
+
+static int stateCapBit(GLenum Cap)
+{
+    for (int i = 0; i < STATE_CAP_COUNT; ++i)
+    {
+        if (stateCaps[i] == Cap)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static int stateCapGroup(GLenum Cap)
+{
+    return (Cap == GL_BLEND) ? GL_STATE_BLEND : ((Cap == GL_DEPTH_TEST) ? GL_STATE_DEPTH : GL_STATE_ENABLE);
+}
+
+/***************************************************************************************
+***************************************************************************************/
+
+void GlStateReset(void)
+{
+    stateProgramValid = 0;
+    stateCurrent = NULL;
+    memset(statePrograms, 0, sizeof(statePrograms));
+    stateNextSlot = 0;
+
+    stateArrayBufferValid = stateElementBufferValid = 0;
+    memset(stateAttribs, 0, sizeof(stateAttribs));
+
+    stateClearColorValid = stateClearDepthValid = 0;
+    stateCapsValid = 0;
+    stateBlendValid = stateDepthFuncValid = stateDepthMaskValid = 0;
+}
+
+void GlStateSetFiltering(int Enabled)
+{
+    stateFiltering = Enabled;
+}
+
+void GlStateUseProgram(GLuint Program)
+{
+    if (stateIssue(GL_STATE_PROGRAM, stateProgramValid && (stateProgram == Program)))
+    {
+        glUseProgram(Program);
+        stateProgramValid = 1;
+        stateProgram = Program;
+        stateCurrent = stateFindProgram(Program, 1);
+    }
+}
+
+void GlStateDeleteProgram(GLuint Program)
+{
+    glDeleteProgram(Program);
+
+    StateProgram * slot = stateFindProgram(Program, 0);
+    if (slot != NULL)
+    {
+        // Still in use until the next glUseProgram, but no longer shadowed.
+        memset(slot, 0, sizeof(*slot));
+        if (stateCurrent == slot)
+        {
+            stateCurrent = NULL;
+        }
+    }
+}
+
+void GlStateUniform1i(GLint Location, GLint Value)
+{
+    // Stored as the bits of a float, only compared.
+    GLfloat bits;
+    memcpy(&bits, &Value, sizeof(bits));
+    if (stateUniform(Location, 1, &bits, 1))
+    {
+        glUniform1i(Location, Value);
+    }
+}
+
+void GlStateUniform4fv(GLint Location, GLsizei Count, const GLfloat * Value)
+{
+    if (stateUniform(Location, Count, Value, 4))
+    {
+        glUniform4fv(Location, Count, Value);
+    }
+}
+
+void GlStateUniformMatrix4fv(GLint Location, GLsizei Count, const GLfloat * Value)
+{
+    if (stateUniform(Location, Count, Value, 16))
+    {
+        glUniformMatrix4fv(Location, Count, GL_FALSE, Value);
+    }
+}
+
+void GlStateBindBuffer(GLenum Target, GLuint Buffer)
+{
+    int * valid = (Target == GL_ARRAY_BUFFER) ? &stateArrayBufferValid : &stateElementBufferValid;
+    GLuint * bound = (Target == GL_ARRAY_BUFFER) ? &stateArrayBuffer : &stateElementBuffer;
+
+    if (stateIssue(GL_STATE_BUFFER, *valid && (*bound == Buffer)))
+    {
+        glBindBuffer(Target, Buffer);
+        *valid = 1;
+        *bound = Buffer;
+    }
+}
+
+void GlStateDeleteBuffers(GLsizei Count, const GLuint * Buffers)
+{
+    glDeleteBuffers(Count, Buffers);
+
+    for (GLsizei i = 0; i < Count; ++i)
+    {
+        // Deleting a bound buffer binds 0 in its place.
+        if (stateArrayBuffer == Buffers[i])
+        {
+            stateArrayBuffer = 0;
+        }
+        if (stateElementBuffer == Buffers[i])
+        {
+            stateElementBuffer = 0;
+        }
+        for (int a = 0; a < STATE_MAX_ATTRIBS; ++a)
+        {
+            if (stateAttribs[a].buffer == Buffers[i])
+            {
+                stateAttribs[a].valid = 0;
+            }
+        }
+    }
+}
+
+void GlStateEnableAttrib(GLuint Index)
+{
+    StateAttrib * attrib = (Index < STATE_MAX_ATTRIBS) ? &stateAttribs[Index] : NULL;
+    if (stateIssue(GL_STATE_ATTRIB, (attrib != NULL) && attrib->enabledValid && attrib->enabled))
+    {
+        glEnableVertexAttribArray(Index);
+        if (attrib != NULL)
+        {
+            attrib->enabledValid = 1;
+            attrib->enabled = GL_TRUE;
+        }
+    }
+}
+
+void GlStateDisableAttrib(GLuint Index)
+{
+    StateAttrib * attrib = (Index < STATE_MAX_ATTRIBS) ? &stateAttribs[Index] : NULL;
+    if (stateIssue(GL_STATE_ATTRIB, (attrib != NULL) && attrib->enabledValid && !attrib->enabled))
+    {
+        glDisableVertexAttribArray(Index);
+        if (attrib != NULL)
+        {
+            attrib->enabledValid = 1;
+            attrib->enabled = GL_FALSE;
+        }
+    }
+}
+
+void GlStateAttribPointer(GLuint Index, GLint Size, GLenum Type, GLboolean Normalized,
+                          GLsizei Stride, const GLvoid * Pointer)
+{
+    StateAttrib * attrib = (Index < STATE_MAX_ATTRIBS) ? &stateAttribs[Index] : NULL;
+
+    // The pointer is relative to the array buffer bound now, so the binding
+    // is part of the state; an unknown binding is never redundant.
+    int redundant = (attrib != NULL) && attrib->valid && stateArrayBufferValid
+                 && (attrib->buffer == stateArrayBuffer) && (attrib->size == Size)
+                 && (attrib->type == Type) && (attrib->normalized == Normalized)
+                 && (attrib->stride == Stride) && (attrib->pointer == Pointer);
+
+    if (stateIssue(GL_STATE_ATTRIB, redundant))
+    {
+        glVertexAttribPointer(Index, Size, Type, Normalized, Stride, Pointer);
+        if (attrib != NULL)
+        {
+            attrib->valid      = stateArrayBufferValid;
+            attrib->buffer     = stateArrayBuffer;
+            attrib->size       = Size;
+            attrib->type       = Type;
+            attrib->normalized = Normalized;
+            attrib->stride     = Stride;
+            attrib->pointer    = Pointer;
+        }
+    }
+}
+
+void GlStateClearColor(GLfloat Red, GLfloat Green, GLfloat Blue, GLfloat Alpha)
+{
+    GLfloat color[4] = {Red, Green, Blue, Alpha};
+    if (stateIssue(GL_STATE_CLEAR, stateClearColorValid && (memcmp(stateClearColor, color, sizeof(color)) == 0)))
+    {
+        glClearColor(Red, Green, Blue, Alpha);
+        stateClearColorValid = 1;
+        memcpy(stateClearColor, color, sizeof(color));
+    }
+}
+
+void GlStateClearDepth(GLfloat Depth)
+{
+    if (stateIssue(GL_STATE_CLEAR, stateClearDepthValid && (stateClearDepth == Depth)))
+    {
+        glClearDepthf(Depth);
+        stateClearDepthValid = 1;
+        stateClearDepth = Depth;
+    }
+}
+
+void GlStateEnable(GLenum Cap)
+{
+    int bit = stateCapBit(Cap);
+    unsigned int mask = (bit >= 0) ? (1u << bit) : 0;
+    if (stateIssue(stateCapGroup(Cap), (stateCapsValid & stateCapsEnabled & mask) != 0))
+    {
+        glEnable(Cap);
+        stateCapsValid   |= mask;
+        stateCapsEnabled |= mask;
+    }
+}
+
+void GlStateDisable(GLenum Cap)
+{
+    int bit = stateCapBit(Cap);
+    unsigned int mask = (bit >= 0) ? (1u << bit) : 0;
+    if (stateIssue(stateCapGroup(Cap), (stateCapsValid & ~stateCapsEnabled & mask) != 0))
+    {
+        glDisable(Cap);
+        stateCapsValid   |= mask;
+        stateCapsEnabled &= ~mask;
+    }
+}
+
+void GlStateBlendFunc(GLenum Source, GLenum Destination)
+{
+    if (stateIssue(GL_STATE_BLEND, stateBlendValid && (stateBlend[0] == Source) && (stateBlend[1] == Destination)))
+    {
+        glBlendFunc(Source, Destination);
+        stateBlendValid = 1;
+        stateBlend[0] = Source;
+        stateBlend[1] = Destination;
+    }
+}
+
+void GlStateDepthFunc(GLenum Func)
+{
+    if (stateIssue(GL_STATE_DEPTH, stateDepthFuncValid && (stateDepthFunc == Func)))
+    {
+        glDepthFunc(Func);
+        stateDepthFuncValid = 1;
+        stateDepthFunc = Func;
+    }
+}
+
+void GlStateDepthMask(GLboolean Flag)
+{
+    if (stateIssue(GL_STATE_DEPTH, stateDepthMaskValid && (stateDepthMask == Flag)))
+    {
+        glDepthMask(Flag);
+        stateDepthMaskValid = 1;
+        stateDepthMask = Flag;
+    }
+}
+
+void GlStateGetStats(GlStateStats * Stats)
+{
+    *Stats = stateStats;
+}
+
+void GlStatePrint(FILE * Stream)
+{
+    unsigned long long issued = 0;
+    unsigned long long elided = 0;
+    for (int i = 0; i < GL_STATE_GROUP_COUNT; ++i)
+    {
+        issued += stateStats.issued[i];
+        elided += stateStats.elided[i];
+    }
+
+    unsigned long long total = issued + elided;
+    fprintf(Stream, "state: %llu calls issued, %llu elided (%.1f%%)%s\n", issued, elided,
+            (total > 0) ? 100.0 * elided / total : 0.0, stateFiltering ? "" : ", filtering off");
+
+    for (int i = 0; i < GL_STATE_GROUP_COUNT; ++i)
+    {
+        if (stateStats.issued[i] + stateStats.elided[i] > 0)
+        {
+            fprintf(Stream, "  %-10s %10llu issued %10llu elided\n", stateGroupNames[i],
+                    stateStats.issued[i], stateStats.elided[i]);
+        }
+    }
+}
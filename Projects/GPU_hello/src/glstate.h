@@ -0,0 +1,78 @@
+/*
+ * Redundant GL state-change filter.
+ *
+ * A shadow copy of the state the application sets (program, uniforms,
+ * buffer bindings, vertex attributes, clear values, blend and depth state
+ * and enables). A call that would set the value already current returns
+ * without reaching the driver, whose per-call validation is the main CPU
+ * cost per draw. Every call is counted as issued or elided.
+ *
+ * The shadow is only right while all of these calls go through this layer:
+ * call GlStateReset() after creating the context and after any code that
+ * changes the state directly. Programs and buffers must be deleted here too,
+ * so a recycled name does not inherit stale values; a relinked program also
+ * needs GlStateReset(), as linking resets its uniforms.
+ */
+
+#ifndef GLSTATE_H
+#define GLSTATE_H
+
+#include <GLES2/gl2.h>
+#include <stdio.h>
+
+// Counter groups.
+enum
+{
+    GL_STATE_PROGRAM,
+    GL_STATE_UNIFORM,
+    GL_STATE_BUFFER,
+    GL_STATE_ATTRIB,
+    GL_STATE_CLEAR,
+    GL_STATE_BLEND,
+    GL_STATE_DEPTH,
+    GL_STATE_ENABLE,
+    GL_STATE_GROUP_COUNT
+};
+
+typedef struct _GlStateStats
+{
+    unsigned long long issued[GL_STATE_GROUP_COUNT];
+    unsigned long long elided[GL_STATE_GROUP_COUNT];
+}
+GlStateStats;
+
+// Forgets the whole shadow; the next call of each kind is issued.
+void GlStateReset(void);
+
+// Filtering off passes every call through (still counted), for comparison.
+void GlStateSetFiltering(int Enabled);
+
+void GlStateUseProgram(GLuint Program);
+void GlStateDeleteProgram(GLuint Program);
+
+// Uniforms of the current program. Arrays (Count > 1) are not filtered.
+void GlStateUniform1i(GLint Location, GLint Value);
+void GlStateUniform4fv(GLint Location, GLsizei Count, const GLfloat * Value);
+void GlStateUniformMatrix4fv(GLint Location, GLsizei Count, const GLfloat * Value);
+
+void GlStateBindBuffer(GLenum Target, GLuint Buffer);
+void GlStateDeleteBuffers(GLsizei Count, const GLuint * Buffers);
+
+void GlStateEnableAttrib(GLuint Index);
+void GlStateDisableAttrib(GLuint Index);
+void GlStateAttribPointer(GLuint Index, GLint Size, GLenum Type, GLboolean Normalized,
+                          GLsizei Stride, const GLvoid * Pointer);
+
+void GlStateClearColor(GLfloat Red, GLfloat Green, GLfloat Blue, GLfloat Alpha);
+void GlStateClearDepth(GLfloat Depth);
+
+void GlStateEnable(GLenum Cap);
+void GlStateDisable(GLenum Cap);
+void GlStateBlendFunc(GLenum Source, GLenum Destination);
+void GlStateDepthFunc(GLenum Func);
+void GlStateDepthMask(GLboolean Flag);
+
+void GlStateGetStats(GlStateStats * Stats);
+void GlStatePrint(FILE * Stream);
+
+#endif /* GLSTATE_H */
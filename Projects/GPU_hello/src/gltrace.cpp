@@ -0,0 +1,835 @@
+/*
+ * GL command stream recorder.
+ *
+ * Every wrapper calls the driver first, then appends its record if a trace
+ * is open. Vertex attributes that point into client memory are tracked so
+ * the vertices a draw reads can be written with it.
+ */
+
+#define GL_TRACE_NO_REDIRECT
+#include "gltrace.h"
+#include "framestats.h"
+#include <GLES2/gl2ext.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TRACE_MAX_ATTRIBS   16
+#define TRACE_BUFFER_SIZE   (1 << 20)
+
+typedef struct _TraceAttrib
+{
+    int             enabled;
+    int             client;     // pointer is client memory, not a buffer offset
+    GLint           size;
+    GLenum          type;
+    GLboolean       normalized;
+    GLsizei         stride;
+    const void *    pointer;
+    int             written;    // the vertices below are in the trace
+    unsigned int    writtenSize;
+    unsigned int    writtenHash;
+}
+TraceAttrib;
+
+static FILE * traceFile = NULL;
+static char * traceBuffer = NULL;
+static int traceError = 0;
+static unsigned long long traceStart = 0;
+static unsigned long long traceRecords = 0;
+static unsigned long long traceBytes = 0;
+static GLuint traceArrayBuffer = 0;
+static GLuint traceElementBuffer = 0;
+static TraceAttrib traceAttribs[TRACE_MAX_ATTRIBS];
+static GLint traceUnpackAlignment = 4;
+static int traceWarned = 0;
+
+/***************************************************************************************
+***************************************************************************************/
+
+static void traceWrite(const void * Data, size_t Size)
+{
+    if ((Size > 0) && (fwrite(Data, Size, 1, traceFile) != 1))
+    {
+        traceError = 1;
+    }
+    traceBytes += Size;
+}
+
+static void traceRecord(unsigned int Op, const unsigned int * Args, int ArgCount,
+                        const void * Data, unsigned int DataSize)
+{
+    static const unsigned char padding[4] = {0, 0, 0, 0};
+
+    GlTraceRecord record;
+    record.op       = (unsigned short)Op;
+    record.argCount = (unsigned short)ArgCount;
+    record.dataSize = DataSize;
+
+    traceWrite(&record, sizeof(record));
+    traceWrite(Args, sizeof (unsigned int) * ArgCount);
+    traceWrite(Data, DataSize);
+    traceWrite(padding, (4 - (DataSize & 3)) & 3);
+    ++traceRecords;
+}
+
+static void traceArgs(unsigned int Op, int ArgCount,
+                      unsigned int A0 = 0, unsigned int A1 = 0, unsigned int A2 = 0,
+                      unsigned int A3 = 0, unsigned int A4 = 0, unsigned int A5 = 0)
+{
+    unsigned int args[6] = {A0, A1, A2, A3, A4, A5};
+    traceRecord(Op, args, ArgCount, NULL, 0);
+}
+
+static unsigned int floatBits(GLfloat Value)
+{
+    unsigned int bits;
+    memcpy(&bits, &Value, sizeof(bits));
+    return bits;
+}
+
+static unsigned int typeSize(GLenum Type)
+{
+    switch (Type)
+    {
+    case GL_BYTE:
+    case GL_UNSIGNED_BYTE:
+        return 1;
+    case GL_SHORT:
+    case GL_UNSIGNED_SHORT:
+    case GL_HALF_FLOAT_OES:
+        return 2;
+    default:
+        return 4;
+    }
+}
+
+// Bytes of a Width x Height image as glTexImage2D() reads it.
+static unsigned int imageSize(GLsizei Width, GLsizei Height, GLenum Format, GLenum Type)
+{
+    unsigned int pixel;
+    if ((Type == GL_UNSIGNED_SHORT_5_6_5) || (Type == GL_UNSIGNED_SHORT_4_4_4_4) || (Type == GL_UNSIGNED_SHORT_5_5_5_1))
+    {
+        pixel = 2;
+    }
+    else
+    {
+        switch (Format)
+        {
+        case GL_RGBA:               pixel = 4; break;
+        case GL_RGB:                pixel = 3; break;
+        case GL_LUMINANCE_ALPHA:    pixel = 2; break;
+        default:                    pixel = 1; break;
+        }
+    }
+
+    unsigned int row = (Width * pixel + traceUnpackAlignment - 1) / traceUnpackAlignment * traceUnpackAlignment;
+    return (Height > 0) ? row * (Height - 1) + Width * pixel : 0;
+}
+
+// Writes the client arrays a draw reads, vertices [0, VertexCount).
+static void traceClientArrays(unsigned int VertexCount)
+{
+    for (unsigned int i = 0; i < TRACE_MAX_ATTRIBS; ++i)
+    {
+        TraceAttrib & attrib = traceAttribs[i];
+        if (!attrib.enabled || !attrib.client || (attrib.pointer == NULL) || (VertexCount == 0))
+        {
+            continue;
+        }
+
+        unsigned int element = attrib.size * typeSize(attrib.type);
+        unsigned int stride  = (attrib.stride != 0) ? attrib.stride : element;
+        unsigned int size    = stride * (VertexCount - 1) + element;
+
+        // Unchanged vertices stay in the replayer's copy, as the pointer
+        // stays set there; only what the application rewrote is recorded.
+        unsigned int hash = 2166136261u;
+        const unsigned char * bytes = (const unsigned char *)attrib.pointer;
+        for (unsigned int b = 0; b < size; ++b)
+        {
+            hash = (hash ^ bytes[b]) * 16777619u;
+        }
+        if (attrib.written && (attrib.writtenSize >= size) && (attrib.writtenHash == hash))
+        {
+            continue;
+        }
+
+        unsigned int args[5] = {i, (unsigned int)attrib.size, attrib.type, attrib.normalized, stride};
+        traceRecord(GL_TRACE_CLIENT_ARRAY, args, 5, attrib.pointer, size);
+        attrib.written     = 1;
+        attrib.writtenSize = size;
+        attrib.writtenHash = hash;
+    }
+}
+
+/***************************************************************************************
+***************************************************************************************/
+
+int GlTraceOpen(const char * FName, int Width, int Height)
+{
+    GlTraceClose();
+
+    traceFile = fopen(FName, "wb");
+    if (traceFile == NULL)
+    {
+        fprintf(stderr, "Cannot create trace file '%s'\n", FName);
+        return 0;
+    }
+
+    // Fewer, larger writes keep the recording cost out of the frame times.
+    traceBuffer = (char *)malloc(TRACE_BUFFER_SIZE);
+    if (traceBuffer != NULL)
+    {
+        setvbuf(traceFile, traceBuffer, _IOFBF, TRACE_BUFFER_SIZE);
+    }
+
+    traceError = 0;
+    traceRecords = traceBytes = 0;
+    traceArrayBuffer = traceElementBuffer = 0;
+    memset(traceAttribs, 0, sizeof(traceAttribs));
+    traceWarned = 0;
+
+    GlTraceHeader header;
+    header.magic   = GL_TRACE_MAGIC;
+    header.version = GL_TRACE_VERSION;
+    header.width   = Width;
+    header.height  = Height;
+    traceWrite(&header, sizeof(header));
+
+    traceStart = FrameStatsNs();
+    return 1;
+}
+
+int GlTraceClose(void)
+{
+    if (traceFile == NULL)
+    {
+        return 1;
+    }
+
+    int result = (fclose(traceFile) == 0) && !traceError;
+    traceFile = NULL;
+    free(traceBuffer);
+    traceBuffer = NULL;
+
+    if (!result)
+    {
+        fprintf(stderr, "Error writing the trace file, it is incomplete.\n");
+    }
+    return result;
+}
+
+int GlTraceActive(void)
+{
+    return traceFile != NULL;
+}
+
+void GlTraceFrame(void)
+{
+    if (traceFile != NULL)
+    {
+        unsigned long long ns = FrameStatsNs() - traceStart;
+        traceArgs(GL_TRACE_FRAME, 2, (unsigned int)ns, (unsigned int)(ns >> 32));
+
+        // Every frame sets its own client arrays, so frames can be looped.
+        for (int i = 0; i < TRACE_MAX_ATTRIBS; ++i)
+        {
+            traceAttribs[i].written = 0;
+        }
+    }
+}
+
+void GlTraceGetStats(unsigned long long * Records, unsigned long long * Bytes)
+{
+    *Records = traceRecords;
+    *Bytes = traceBytes;
+}
+
+/***************************************************************************************
+***************************************************************************************/
+
+void GL_APIENTRY GlTraceClear(GLbitfield mask)
+{
+    glClear(mask);
+    if (traceFile != NULL)
+    {
+        traceArgs(GL_TRACE_CLEAR, 1, mask);
+    }
+}
+
+void GL_APIENTRY GlTraceClearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha)
+{
+    glClearColor(red, green, blue, alpha);
+    if (traceFile != NULL)
+    {
+        traceArgs(GL_TRACE_CLEAR_COLOR, 4, floatBits(red), floatBits(green), floatBits(blue), floatBits(alpha));
+    }
+}
+
+void GL_APIENTRY GlTraceViewport(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+    glViewport(x, y, width, height);
+    if (traceFile != NULL)
+    {
+        traceArgs(GL_TRACE_VIEWPORT, 4, x, y, width, height);
+    }
+}
+
+void GL_APIENTRY GlTraceFlush(void)
+{
+    glFlush();
+    if (traceFile != NULL)
+    {
+        traceArgs(GL_TRACE_FLUSH, 0);
+    }
+}
+
+void GL_APIENTRY GlTraceFinish(void)
+{
+    glFinish();
+    if (traceFile != NULL)
+    {
+        traceArgs(GL_TRACE_FINISH, 0);
+    }
+}
+
+GLuint GL_APIENTRY GlTraceCreateShader(GLenum type)
+{
+    GLuint shader = glCreateShader(type);
+    if (traceFile != NULL)
+    {
+        traceArgs(GL_TRACE_CREATE_SHADER, 2, type, shader);
+    }
+    return shader;
+}
+
+void GL_APIENTRY GlTraceShaderSource(GLuint shader, GLsizei count, const GLchar * const * string, const GLint * length)
+{
+    glShaderSource(shader, count, string, length);
+    if (traceFile == NULL)
+    {
+        return;
+    }
+
+    // The strings are joined into one source, as the compiler sees them.
+    size_t total = 0;
+    for (GLsizei i = 0; i < count; ++i)
+    {
+        total += ((length != NULL) && (length[i] >= 0)) ? length[i] : strlen(string[i]);
+    }
+
+    char * source = (char *)malloc(total + 1);
+    if (source == NULL)
+    {
+        fprintf(stderr, "Out of memory.\n");
+        traceError = 1;
+        return;
+    }
+
+    size_t offset = 0;
+    for (GLsizei i = 0; i < count; ++i)
+    {
+        size_t part = ((length != NULL) && (length[i] >= 0)) ? length[i] : strlen(string[i]);
+        memcpy(source + offset, string[i], part);
+        offset += part;
+    }
+
+    unsigned int args[1] = {shader};
+    traceRecord(GL_TRACE_SHADER_SOURCE, args, 1, source, (unsigned int)total);
+    free(source);
+}
+
+void GL_APIENTRY GlTraceCompileShader(GLuint shader)
+{
+    glCompileShader(shader);
+    if (traceFile != NULL)
+    {
+        traceArgs(GL_TRACE_COMPILE_SHADER, 1, shader);
+    }
+}
+
+void GL_APIENTRY GlTraceDeleteShader(GLuint shader)
+{
+    glDeleteShader(shader);
+    if (traceFile != NULL)
+    {
+        traceArgs(GL_TRACE_DELETE_SHADER, 1, shader);
+    }
+}
+
+GLuint GL_APIENTRY GlTraceCreateProgram(void)
+{
+    GLuint program = glCreateProgram();
+    if (traceFile != NULL)
+    {
+        traceArgs(GL_TRACE_CREATE_PROGRAM, 1, program);
+    }
+    return program;
+}
+
+void GL_APIENTRY GlTraceAttachShader(GLuint program, GLuint shader)
+{
+    glAttachShader(program, shader);
+    if (traceFile != NULL)
+    {
+        traceArgs(GL_TRACE_ATTACH_SHADER, 2, program, shader);
+    }
+}
+
+void GL_APIENTRY GlTraceLinkProgram(GLuint program)
+{
+    glLinkProgram(program);
+    if (traceFile != NULL)
+    {
+        traceArgs(GL_TRACE_LINK_PROGRAM, 1, program);
+    }
+}
+
+void GL_APIENTRY GlTraceUseProgram(GLuint program)
+{
+    glUseProgram(program);
+    if (traceFile != NULL)
+    {
+        traceArgs(GL_TRACE_USE_PROGRAM, 1, program);
+    }
+}
+
+void GL_APIENTRY GlTraceDeleteProgram(GLuint program)
+{
+    glDeleteProgram(program);
+    if (traceFile != NULL)
+    {
+        traceArgs(GL_TRACE_DELETE_PROGRAM, 1, program);
+    }
+}
+
+GLint GL_APIENTRY GlTraceGetAttribLocation(GLuint program, const GLchar * name)
+{
+    GLint location = glGetAttribLocation(program, name);
+    if (traceFile != NULL)
+    {
+        unsigned int args[2] = {program, (unsigned int)location};
+        traceRecord(GL_TRACE_GET_ATTRIB_LOCATION, args, 2, name, (unsigned int)strlen(name) + 1);
+    }
+    return location;
+}
+
+GLint GL_APIENTRY GlTraceGetUniformLocation(GLuint program, const GLchar * name)
+{
+    GLint location = glGetUniformLocation(program, name);
+    if (traceFile != NULL)
+    {
+        unsigned int args[2] = {program, (unsigned int)location};
+        traceRecord(GL_TRACE_GET_UNIFORM_LOCATION, args, 2, name, (unsigned int)strlen(name) + 1);
+    }
+    return location;
+}
+
+void GL_APIENTRY GlTraceGenBuffers(GLsizei n, GLuint * buffers)
+{
+    glGenBuffers(n, buffers);
+    for (GLsizei i = 0; (traceFile != NULL) && (i < n); ++i)
+    {
+        traceArgs(GL_TRACE_GEN_BUFFER, 1, buffers[i]);
+    }
+}
+
+void GL_APIENTRY GlTraceDeleteBuffers(GLsizei n, const GLuint * buffers)
+{
+    glDeleteBuffers(n, buffers);
+    for (GLsizei i = 0; i < n; ++i)
+    {
+        // Deleting a bound buffer unbinds it.
+        if (buffers[i] == traceArrayBuffer)
+        {
+            traceArrayBuffer = 0;
+        }
+        if (buffers[i] == traceElementBuffer)
+        {
+            traceElementBuffer = 0;
+        }
+        if (traceFile != NULL)
+        {
+            traceArgs(GL_TRACE_DELETE_BUFFER, 1, buffers[i]);
+        }
+    }
+}
+
+void GL_APIENTRY GlTraceBindBuffer(GLenum target, GLuint buffer)
+{
+    glBindBuffer(target, buffer);
+    if (target == GL_ARRAY_BUFFER)
+    {
+        traceArrayBuffer = buffer;
+    }
+    else if (target == GL_ELEMENT_ARRAY_BUFFER)
+    {
+        traceElementBuffer = buffer;
+    }
+
+    if (traceFile != NULL)
+    {
+        traceArgs(GL_TRACE_BIND_BUFFER, 2, target, buffer);
+    }
+}
+
+void GL_APIENTRY GlTraceBufferData(GLenum target, GLsizeiptr size, const void * data, GLenum usage)
+{
+    glBufferData(target, size, data, usage);
+    if (traceFile != NULL)
+    {
+        unsigned int args[4] = {target, (unsigned int)size, usage, data != NULL};
+        traceRecord(GL_TRACE_BUFFER_DATA, args, 4, data, (data != NULL) ? (unsigned int)size : 0);
+    }
+}
+
+void GL_APIENTRY GlTraceBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void * data)
+{
+    glBufferSubData(target, offset, size, data);
+    if (traceFile != NULL)
+    {
+        unsigned int args[2] = {target, (unsigned int)offset};
+        traceRecord(GL_TRACE_BUFFER_SUB_DATA, args, 2, data, (unsigned int)size);
+    }
+}
+
+void GL_APIENTRY GlTraceEnableVertexAttribArray(GLuint index)
+{
+    glEnableVertexAttribArray(index);
+    if (index < TRACE_MAX_ATTRIBS)
+    {
+        traceAttribs[index].enabled = 1;
+    }
+    if (traceFile != NULL)
+    {
+        traceArgs(GL_TRACE_ENABLE_ATTRIB, 1, index);
+    }
+}
+
+void GL_APIENTRY GlTraceDisableVertexAttribArray(GLuint index)
+{
+    glDisableVertexAttribArray(index);
+    if (index < TRACE_MAX_ATTRIBS)
+    {
+        traceAttribs[index].enabled = 0;
+    }
+    if (traceFile != NULL)
+    {
+        traceArgs(GL_TRACE_DISABLE_ATTRIB, 1, index);
+    }
+}
+
+void GL_APIENTRY GlTraceVertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void * pointer)
+{
+    glVertexAttribPointer(index, size, type, normalized, stride, pointer);
+    if (index < TRACE_MAX_ATTRIBS)
+    {
+        TraceAttrib & attrib = traceAttribs[index];
+        attrib.client     = (traceArrayBuffer == 0);
+        attrib.size       = size;
+        attrib.type       = type;
+        attrib.normalized = normalized;
+        attrib.stride     = stride;
+        attrib.pointer    = pointer;
+        attrib.written    = 0;
+    }
+
+    // Client arrays are written with each draw, when their extent is known.
+    if ((traceFile != NULL) && (traceArrayBuffer != 0))
+    {
+        traceArgs(GL_TRACE_ATTRIB_POINTER, 6, index, size, type, normalized, stride,
+                  (unsigned int)(size_t)pointer);
+    }
+}
+
+void GL_APIENTRY GlTraceUniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat * value)
+{
+    glUniformMatrix4fv(location, count, transpose, value);
+    if (traceFile != NULL)
+    {
+        unsigned int args[2] = {(unsigned int)location, (unsigned int)count};
+        traceRecord(GL_TRACE_UNIFORM_MATRIX4, args, 2, value, sizeof (GLfloat) * 16 * count);
+    }
+}
+
+void GL_APIENTRY GlTraceDrawArrays(GLenum mode, GLint first, GLsizei count)
+{
+    glDrawArrays(mode, first, count);
+    if (traceFile != NULL)
+    {
+        traceClientArrays(first + count);
+        traceArgs(GL_TRACE_DRAW_ARRAYS, 3, mode, first, count);
+    }
+}
+
+void GL_APIENTRY GlTraceDrawElements(GLenum mode, GLsizei count, GLenum type, const void * indices)
+{
+    glDrawElements(mode, count, type, indices);
+    if (traceFile == NULL)
+    {
+        return;
+    }
+
+    unsigned int size = count * typeSize(type);
+    if (traceElementBuffer != 0)
+    {
+        // The index buffer cannot be read back in ES 2.0, so client arrays
+        // drawn through it are written for the first count vertices only.
+        if (!traceWarned)
+        {
+            for (int i = 0; i < TRACE_MAX_ATTRIBS; ++i)
+            {
+                traceWarned |= traceAttribs[i].enabled && traceAttribs[i].client;
+            }
+            if (traceWarned)
+            {
+                fprintf(stderr, "Client arrays with an index buffer are traced approximately.\n");
+            }
+        }
+        traceClientArrays(count);
+
+        unsigned int args[5] = {mode, (unsigned int)count, type, (unsigned int)(size_t)indices, 0};
+        traceRecord(GL_TRACE_DRAW_ELEMENTS, args, 5, NULL, 0);
+        return;
+    }
+
+    unsigned int vertices = 0;
+    for (GLsizei i = 0; i < count; ++i)
+    {
+        unsigned int index = (type == GL_UNSIGNED_BYTE)  ? ((const GLubyte *)indices)[i]
+                           : (type == GL_UNSIGNED_SHORT) ? ((const GLushort *)indices)[i]
+                                                         : ((const GLuint *)indices)[i];
+        vertices = (index + 1 > vertices) ? index + 1 : vertices;
+    }
+    traceClientArrays(vertices);
+
+    unsigned int args[5] = {mode, (unsigned int)count, type, 0, 1};
+    traceRecord(GL_TRACE_DRAW_ELEMENTS, args, 5, indices, size);
+}
+
+void GL_APIENTRY GlTraceClearDepthf(GLfloat d)
+{
+    glClearDepthf(d);
+    if (traceFile != NULL)
+    {
+        traceArgs(GL_TRACE_CLEAR_DEPTH, 1, floatBits(d));
+    }
+}
+
+void GL_APIENTRY GlTraceEnable(GLenum cap)
+{
+    glEnable(cap);
+    if (traceFile != NULL)
+    {
+        traceArgs(GL_TRACE_ENABLE, 1, cap);
+    }
+}
+
+void GL_APIENTRY GlTraceDisable(GLenum cap)
+{
+    glDisable(cap);
+    if (traceFile != NULL)
+    {
+        traceArgs(GL_TRACE_DISABLE, 1, cap);
+    }
+}
+
+void GL_APIENTRY GlTraceBlendFunc(GLenum sfactor, GLenum dfactor)
+{
+    glBlendFunc(sfactor, dfactor);
+    if (traceFile != NULL)
+    {
+        traceArgs(GL_TRACE_BLEND_FUNC, 2, sfactor, dfactor);
+    }
+}
+
+void GL_APIENTRY GlTraceDepthFunc(GLenum func)
+{
+    glDepthFunc(func);
+    if (traceFile != NULL)
+    {
+        traceArgs(GL_TRACE_DEPTH_FUNC, 1, func);
+    }
+}
+
+void GL_APIENTRY GlTraceDepthMask(GLboolean flag)
+{
+    glDepthMask(flag);
+    if (traceFile != NULL)
+    {
+        traceArgs(GL_TRACE_DEPTH_MASK, 1, flag);
+    }
+}
+
+void GL_APIENTRY GlTraceUniform1i(GLint location, GLint v0)
+{
+    glUniform1i(location, v0);
+    if (traceFile != NULL)
+    {
+        traceArgs(GL_TRACE_UNIFORM1I, 2, location, v0);
+    }
+}
+
+void GL_APIENTRY GlTraceUniform4fv(GLint location, GLsizei count, const GLfloat * value)
+{
+    glUniform4fv(location, count, value);
+    if (traceFile != NULL)
+    {
+        unsigned int args[2] = {(unsigned int)location, (unsigned int)count};
+        traceRecord(GL_TRACE_UNIFORM4, args, 2, value, sizeof (GLfloat) * 4 * count);
+    }
+}
+
+void GL_APIENTRY GlTraceScissor(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+    glScissor(x, y, width, height);
+    if (traceFile != NULL)
+    {
+        traceArgs(GL_TRACE_SCISSOR, 4, x, y, width, height);
+    }
+}
+
+void GL_APIENTRY GlTraceGenTextures(GLsizei n, GLuint * textures)
+{
+    glGenTextures(n, textures);
+    for (GLsizei i = 0; (traceFile != NULL) && (i < n); ++i)
+    {
+        traceArgs(GL_TRACE_GEN_TEXTURE, 1, textures[i]);
+    }
+}
+
+void GL_APIENTRY GlTraceDeleteTextures(GLsizei n, const GLuint * textures)
+{
+    glDeleteTextures(n, textures);
+    for (GLsizei i = 0; (traceFile != NULL) && (i < n); ++i)
+    {
+        traceArgs(GL_TRACE_DELETE_TEXTURE, 1, textures[i]);
+    }
+}
+
+void GL_APIENTRY GlTraceBindTexture(GLenum target, GLuint texture)
+{
+    glBindTexture(target, texture);
+    if (traceFile != NULL)
+    {
+        traceArgs(GL_TRACE_BIND_TEXTURE, 2, target, texture);
+    }
+}
+
+void GL_APIENTRY GlTraceTexParameteri(GLenum target, GLenum pname, GLint param)
+{
+    glTexParameteri(target, pname, param);
+    if (traceFile != NULL)
+    {
+        traceArgs(GL_TRACE_TEX_PARAMETERI, 3, target, pname, param);
+    }
+}
+
+void GL_APIENTRY GlTraceTexImage2D(GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height,
+                                   GLint border, GLenum format, GLenum type, const void * pixels)
+{
+    glTexImage2D(target, level, internalformat, width, height, border, format, type, pixels);
+    if (traceFile != NULL)
+    {
+        unsigned int args[8] = {target, (unsigned int)level, (unsigned int)internalformat, (unsigned int)width,
+                                (unsigned int)height, format, type, pixels != NULL};
+        traceRecord(GL_TRACE_TEX_IMAGE_2D, args, 8, pixels,
+                    (pixels != NULL) ? imageSize(width, height, format, type) : 0);
+    }
+}
+
+void GL_APIENTRY GlTraceGenFramebuffers(GLsizei n, GLuint * framebuffers)
+{
+    glGenFramebuffers(n, framebuffers);
+    for (GLsizei i = 0; (traceFile != NULL) && (i < n); ++i)
+    {
+        traceArgs(GL_TRACE_GEN_FRAMEBUFFER, 1, framebuffers[i]);
+    }
+}
+
+void GL_APIENTRY GlTraceDeleteFramebuffers(GLsizei n, const GLuint * framebuffers)
+{
+    glDeleteFramebuffers(n, framebuffers);
+    for (GLsizei i = 0; (traceFile != NULL) && (i < n); ++i)
+    {
+        traceArgs(GL_TRACE_DELETE_FRAMEBUFFER, 1, framebuffers[i]);
+    }
+}
+
+void GL_APIENTRY GlTraceBindFramebuffer(GLenum target, GLuint framebuffer)
+{
+    glBindFramebuffer(target, framebuffer);
+    if (traceFile != NULL)
+    {
+        traceArgs(GL_TRACE_BIND_FRAMEBUFFER, 2, target, framebuffer);
+    }
+}
+
+void GL_APIENTRY GlTraceFramebufferTexture2D(GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level)
+{
+    glFramebufferTexture2D(target, attachment, textarget, texture, level);
+    if (traceFile != NULL)
+    {
+        traceArgs(GL_TRACE_FRAMEBUFFER_TEXTURE_2D, 5, target, attachment, textarget, texture, level);
+    }
+}
+
+void GL_APIENTRY GlTraceReadPixels(GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, void * pixels)
+{
+    glReadPixels(x, y, width, height, format, type, pixels);
+    if (traceFile != NULL)
+    {
+        traceArgs(GL_TRACE_READ_PIXELS, 6, x, y, width, height, format, type);
+    }
+}
+
+void GL_APIENTRY GlTracePixelStorei(GLenum pname, GLint param)
+{
+    glPixelStorei(pname, param);
+    if (pname == GL_UNPACK_ALIGNMENT)
+    {
+        traceUnpackAlignment = param;
+    }
+    if (traceFile != NULL)
+    {
+        traceArgs(GL_TRACE_PIXEL_STOREI, 2, pname, param);
+    }
+}
+
+void GL_APIENTRY GlTraceTexSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLsizei width, GLsizei height,
+                                      GLenum format, GLenum type, const void * pixels)
+{
+    glTexSubImage2D(target, level, xoffset, yoffset, width, height, format, type, pixels);
+    if (traceFile != NULL)
+    {
+        unsigned int args[8] = {target, (unsigned int)level, (unsigned int)xoffset, (unsigned int)yoffset,
+                                (unsigned int)width, (unsigned int)height, format, type};
+        traceRecord(GL_TRACE_TEX_SUB_IMAGE_2D, args, 8, pixels, imageSize(width, height, format, type));
+    }
+}
+
+void GL_APIENTRY GlTraceActiveTexture(GLenum texture)
+{
+    glActiveTexture(texture);
+    if (traceFile != NULL)
+    {
+        traceArgs(GL_TRACE_ACTIVE_TEXTURE, 1, texture);
+    }
+}
+
+void GlTraceTexDirectMap(GLenum Target, GLsizei Width, GLsizei Height, GLenum Format)
+{
+    if (traceFile != NULL)
+    {
+        traceArgs(GL_TRACE_TEX_DIRECT_MAP, 4, Target, Width, Height, Format);
+    }
+}
+
+void GlTraceTexDirectInvalidate(GLenum Target)
+{
+    if (traceFile != NULL)
+    {
+        traceArgs(GL_TRACE_TEX_DIRECT_INVALIDATE, 1, Target);
+    }
+}
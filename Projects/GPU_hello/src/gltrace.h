@@ -0,0 +1,240 @@
+/*
+ * GL command stream recorder.
+ *
+ * While a trace is open every GL call of the traced modules is forwarded to
+ * the driver and appended to a compact binary file, together with the data
+ * it references (shader sources, buffer contents, uniforms, client arrays
+ * and client indices), so GPU_replay can reissue the exact workload without
+ * the application. Queries that only read state are not recorded, except
+ * the ones whose result the stream depends on (object names, locations).
+ * Read-backs are recorded without their pixels, the replayer repeats the
+ * transfer into a scratch buffer.
+ *
+ * A module is traced by including this header after the GLES headers: the
+ * macros at the end route its gl* calls through the recorder. With no trace
+ * open the cost is one branch per call.
+ *
+ * File layout, all little-endian 32-bit words:
+ *   GlTraceHeader
+ *   records: GlTraceRecord, argCount words, dataSize bytes padded to 4
+ * Object names and locations are the ones seen while recording; the
+ * replayer maps them to its own. A GL_TRACE_FRAME record marks every swap
+ * and carries the nanoseconds since the trace was opened.
+ */
+
+#ifndef GLTRACE_H
+#define GLTRACE_H
+
+#include <GLES2/gl2.h>
+
+#define GL_TRACE_MAGIC      0x52544C47u     // "GLTR"
+#define GL_TRACE_VERSION    1u
+
+typedef struct _GlTraceHeader
+{
+    unsigned int magic;
+    unsigned int version;
+    unsigned int width;     // window size asked for when recording, 0 = fullscreen
+    unsigned int height;
+}
+GlTraceHeader;
+
+typedef struct _GlTraceRecord
+{
+    unsigned short op;
+    unsigned short argCount;
+    unsigned int   dataSize;
+}
+GlTraceRecord;
+
+// Record opcodes; the argument words are listed after each, [data] is the
+// payload. Values never change meaning, new calls are appended.
+enum
+{
+    GL_TRACE_FRAME = 1,                 // ns low, ns high
+    GL_TRACE_CLEAR,                     // mask
+    GL_TRACE_CLEAR_COLOR,               // r, g, b, a as float bits
+    GL_TRACE_VIEWPORT,                  // x, y, width, height
+    GL_TRACE_FLUSH,
+    GL_TRACE_FINISH,
+    GL_TRACE_CREATE_SHADER,             // type, name
+    GL_TRACE_SHADER_SOURCE,             // shader; [source]
+    GL_TRACE_COMPILE_SHADER,            // shader
+    GL_TRACE_DELETE_SHADER,             // shader
+    GL_TRACE_CREATE_PROGRAM,            // name
+    GL_TRACE_ATTACH_SHADER,             // program, shader
+    GL_TRACE_LINK_PROGRAM,              // program
+    GL_TRACE_USE_PROGRAM,               // program
+    GL_TRACE_DELETE_PROGRAM,            // program
+    GL_TRACE_GET_ATTRIB_LOCATION,       // program, location; [name]
+    GL_TRACE_GET_UNIFORM_LOCATION,      // program, location; [name]
+    GL_TRACE_GEN_BUFFER,                // name
+    GL_TRACE_DELETE_BUFFER,             // name
+    GL_TRACE_BIND_BUFFER,               // target, name
+    GL_TRACE_BUFFER_DATA,               // target, size, usage, has data; [data]
+    GL_TRACE_BUFFER_SUB_DATA,           // target, offset; [data]
+    GL_TRACE_ENABLE_ATTRIB,             // index
+    GL_TRACE_DISABLE_ATTRIB,            // index
+    GL_TRACE_ATTRIB_POINTER,            // index, size, type, normalized, stride, offset
+    GL_TRACE_CLIENT_ARRAY,              // index, size, type, normalized, stride; [vertices]
+    GL_TRACE_UNIFORM_MATRIX4,           // location, count; [matrices]
+    GL_TRACE_DRAW_ARRAYS,               // mode, first, count
+    GL_TRACE_DRAW_ELEMENTS,             // mode, count, type, offset, client; [indices]
+    GL_TRACE_CLEAR_DEPTH,               // depth as float bits
+    GL_TRACE_ENABLE,                    // cap
+    GL_TRACE_DISABLE,                   // cap
+    GL_TRACE_BLEND_FUNC,                // source, destination
+    GL_TRACE_DEPTH_FUNC,                // func
+    GL_TRACE_DEPTH_MASK,                // flag
+    GL_TRACE_UNIFORM1I,                 // location, value
+    GL_TRACE_UNIFORM4,                  // location, count; [vectors]
+    GL_TRACE_SCISSOR,                   // x, y, width, height
+    GL_TRACE_GEN_TEXTURE,               // name
+    GL_TRACE_DELETE_TEXTURE,            // name
+    GL_TRACE_BIND_TEXTURE,              // target, name
+    GL_TRACE_TEX_PARAMETERI,            // target, pname, param
+    GL_TRACE_TEX_IMAGE_2D,              // target, level, internal format, width, height, format, type, has data; [pixels]
+    GL_TRACE_GEN_FRAMEBUFFER,           // name
+    GL_TRACE_DELETE_FRAMEBUFFER,        // name
+    GL_TRACE_BIND_FRAMEBUFFER,          // target, name
+    GL_TRACE_FRAMEBUFFER_TEXTURE_2D,    // target, attachment, texture target, texture, level
+    GL_TRACE_READ_PIXELS,               // x, y, width, height, format, type
+    GL_TRACE_PIXEL_STOREI,              // pname, param
+    GL_TRACE_TEX_SUB_IMAGE_2D,          // target, level, x, y, width, height, format, type; [pixels]
+    GL_TRACE_ACTIVE_TEXTURE,            // texture unit
+    GL_TRACE_TEX_DIRECT_MAP,            // target, width, height, format; GL_VIV_direct_texture
+    GL_TRACE_TEX_DIRECT_INVALIDATE,     // target
+    GL_TRACE_OP_COUNT
+};
+
+// Starts recording to FName; Width and Height are stored for the replayer.
+// returns 0: fail
+//         1: success
+int GlTraceOpen(const char * FName, int Width, int Height);
+
+// returns 0: write error, the trace is incomplete
+//         1: success
+int GlTraceClose(void);
+
+int GlTraceActive(void);
+
+// Marks the end of a frame, call right before the swap.
+void GlTraceFrame(void);
+
+// Records written so far, and bytes.
+void GlTraceGetStats(unsigned long long * Records, unsigned long long * Bytes);
+
+/***************************************************************************************
+***************************************************************************************/
+
+void GL_APIENTRY GlTraceClear(GLbitfield mask);
+void GL_APIENTRY GlTraceClearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha);
+void GL_APIENTRY GlTraceViewport(GLint x, GLint y, GLsizei width, GLsizei height);
+void GL_APIENTRY GlTraceFlush(void);
+void GL_APIENTRY GlTraceFinish(void);
+GLuint GL_APIENTRY GlTraceCreateShader(GLenum type);
+void GL_APIENTRY GlTraceShaderSource(GLuint shader, GLsizei count, const GLchar * const * string, const GLint * length);
+void GL_APIENTRY GlTraceCompileShader(GLuint shader);
+void GL_APIENTRY GlTraceDeleteShader(GLuint shader);
+GLuint GL_APIENTRY GlTraceCreateProgram(void);
+void GL_APIENTRY GlTraceAttachShader(GLuint program, GLuint shader);
+void GL_APIENTRY GlTraceLinkProgram(GLuint program);
+void GL_APIENTRY GlTraceUseProgram(GLuint program);
+void GL_APIENTRY GlTraceDeleteProgram(GLuint program);
+GLint GL_APIENTRY GlTraceGetAttribLocation(GLuint program, const GLchar * name);
+GLint GL_APIENTRY GlTraceGetUniformLocation(GLuint program, const GLchar * name);
+void GL_APIENTRY GlTraceGenBuffers(GLsizei n, GLuint * buffers);
+void GL_APIENTRY GlTraceDeleteBuffers(GLsizei n, const GLuint * buffers);
+void GL_APIENTRY GlTraceBindBuffer(GLenum target, GLuint buffer);
+void GL_APIENTRY GlTraceBufferData(GLenum target, GLsizeiptr size, const void * data, GLenum usage);
+void GL_APIENTRY GlTraceBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void * data);
+void GL_APIENTRY GlTraceEnableVertexAttribArray(GLuint index);
+void GL_APIENTRY GlTraceDisableVertexAttribArray(GLuint index);
+void GL_APIENTRY GlTraceVertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void * pointer);
+void GL_APIENTRY GlTraceUniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat * value);
+void GL_APIENTRY GlTraceDrawArrays(GLenum mode, GLint first, GLsizei count);
+void GL_APIENTRY GlTraceDrawElements(GLenum mode, GLsizei count, GLenum type, const void * indices);
+void GL_APIENTRY GlTraceClearDepthf(GLfloat d);
+void GL_APIENTRY GlTraceEnable(GLenum cap);
+void GL_APIENTRY GlTraceDisable(GLenum cap);
+void GL_APIENTRY GlTraceBlendFunc(GLenum sfactor, GLenum dfactor);
+void GL_APIENTRY GlTraceDepthFunc(GLenum func);
+void GL_APIENTRY GlTraceDepthMask(GLboolean flag);
+void GL_APIENTRY GlTraceUniform1i(GLint location, GLint v0);
+void GL_APIENTRY GlTraceUniform4fv(GLint location, GLsizei count, const GLfloat * value);
+void GL_APIENTRY GlTraceScissor(GLint x, GLint y, GLsizei width, GLsizei height);
+void GL_APIENTRY GlTraceGenTextures(GLsizei n, GLuint * textures);
+void GL_APIENTRY GlTraceDeleteTextures(GLsizei n, const GLuint * textures);
+void GL_APIENTRY GlTraceBindTexture(GLenum target, GLuint texture);
+void GL_APIENTRY GlTraceTexParameteri(GLenum target, GLenum pname, GLint param);
+void GL_APIENTRY GlTraceTexImage2D(GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height,
+                                   GLint border, GLenum format, GLenum type, const void * pixels);
+void GL_APIENTRY GlTraceGenFramebuffers(GLsizei n, GLuint * framebuffers);
+void GL_APIENTRY GlTraceDeleteFramebuffers(GLsizei n, const GLuint * framebuffers);
+void GL_APIENTRY GlTraceBindFramebuffer(GLenum target, GLuint framebuffer);
+void GL_APIENTRY GlTraceFramebufferTexture2D(GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level);
+void GL_APIENTRY GlTraceReadPixels(GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, void * pixels);
+void GL_APIENTRY GlTracePixelStorei(GLenum pname, GLint param);
+void GL_APIENTRY GlTraceTexSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLsizei width, GLsizei height,
+                                      GLenum format, GLenum type, const void * pixels);
+void GL_APIENTRY GlTraceActiveTexture(GLenum texture);
+
+// Extension calls go through function pointers and are not redirected; the
+// caller makes them and records them here. The mapped memory is not
+// recorded, the replayer maps a blank buffer.
+void GlTraceTexDirectMap(GLenum Target, GLsizei Width, GLsizei Height, GLenum Format);
+void GlTraceTexDirectInvalidate(GLenum Target);
+
+#ifndef GL_TRACE_NO_REDIRECT
+#define glClear                     GlTraceClear
+#define glClearColor                GlTraceClearColor
+#define glViewport                  GlTraceViewport
+#define glFlush                     GlTraceFlush
+#define glFinish                    GlTraceFinish
+#define glCreateShader              GlTraceCreateShader
+#define glShaderSource              GlTraceShaderSource
+#define glCompileShader             GlTraceCompileShader
+#define glDeleteShader              GlTraceDeleteShader
+#define glCreateProgram             GlTraceCreateProgram
+#define glAttachShader              GlTraceAttachShader
+#define glLinkProgram               GlTraceLinkProgram
+#define glUseProgram                GlTraceUseProgram
+#define glDeleteProgram             GlTraceDeleteProgram
+#define glGetAttribLocation         GlTraceGetAttribLocation
+#define glGetUniformLocation        GlTraceGetUniformLocation
+#define glGenBuffers                GlTraceGenBuffers
+#define glDeleteBuffers             GlTraceDeleteBuffers
+#define glBindBuffer                GlTraceBindBuffer
+#define glBufferData                GlTraceBufferData
+#define glBufferSubData             GlTraceBufferSubData
+#define glEnableVertexAttribArray   GlTraceEnableVertexAttribArray
+#define glDisableVertexAttribArray  GlTraceDisableVertexAttribArray
+#define glVertexAttribPointer       GlTraceVertexAttribPointer
+#define glUniformMatrix4fv          GlTraceUniformMatrix4fv
+#define glDrawArrays                GlTraceDrawArrays
+#define glDrawElements              GlTraceDrawElements
+#define glClearDepthf               GlTraceClearDepthf
+#define glEnable                    GlTraceEnable
+#define glDisable                   GlTraceDisable
+#define glBlendFunc                 GlTraceBlendFunc
+#define glDepthFunc                 GlTraceDepthFunc
+#define glDepthMask                 GlTraceDepthMask
+#define glUniform1i                 GlTraceUniform1i
+#define glUniform4fv                GlTraceUniform4fv
+#define glScissor                   GlTraceScissor
+#define glGenTextures               GlTraceGenTextures
+#define glDeleteTextures            GlTraceDeleteTextures
+#define glBindTexture               GlTraceBindTexture
+#define glTexParameteri             GlTraceTexParameteri
+#define glTexImage2D                GlTraceTexImage2D
+#define glGenFramebuffers           GlTraceGenFramebuffers
+#define glDeleteFramebuffers        GlTraceDeleteFramebuffers
+#define glBindFramebuffer           GlTraceBindFramebuffer
+#define glFramebufferTexture2D      GlTraceFramebufferTexture2D
+#define glReadPixels                GlTraceReadPixels
+#define glPixelStorei               GlTracePixelStorei
+#define glTexSubImage2D             GlTraceTexSubImage2D
+#define glActiveTexture             GlTraceActiveTexture
+#endif
+
+#endif /* GLTRACE_H */
@@ -0,0 +1,300 @@
+/*
+ * Headless EGL for host builds.
+ *
+ * Hands out dummy handles; the window surface is owned by vdk_host.cpp.
+ */
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include "host_internal.h"
+#include <stddef.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+
+// Emulated display refresh for swap intervals above 0.
+#define HOST_VBLANK_NS  16666667ULL
+
+static int hostEglTag = 0;
+static EGLint hostEglError = EGL_SUCCESS;
+static unsigned long long hostLastVblank = 0;
+
+// Headless: swaps do not wait for a display unless asked to.
+int hostSwapInterval = 0;
+
+EGLDisplay EGLAPIENTRY eglGetDisplay(EGLNativeDisplayType display_id)
+{
+    HOST_VDK_CALL(eglGetDisplay);
+    (void)display_id;
+    return (EGLDisplay)&hostEglTag;
+}
+
+EGLBoolean EGLAPIENTRY eglInitialize(EGLDisplay dpy, EGLint * major, EGLint * minor)
+{
+    HOST_VDK_CALL(eglInitialize);
+    (void)dpy;
+    if (major != NULL)
+    {
+        *major = 1;
+    }
+    if (minor != NULL)
+    {
+        *minor = 4;
+    }
+    return EGL_TRUE;
+}
+
+EGLBoolean EGLAPIENTRY eglTerminate(EGLDisplay dpy)
+{
+    HOST_VDK_CALL(eglTerminate);
+    (void)dpy;
+    return EGL_TRUE;
+}
+
+EGLint EGLAPIENTRY eglGetError(void)
+{
+    HOST_VDK_CALL(eglGetError);
+    EGLint error = hostEglError;
+    hostEglError = EGL_SUCCESS;
+    return error;
+}
+
+const char * EGLAPIENTRY eglQueryString(EGLDisplay dpy, EGLint name)
+{
+    HOST_VDK_CALL(eglQueryString);
+    (void)dpy;
+    switch (name)
+    {
+    case EGL_VENDOR:
+        return "gpu_hello";
+    case EGL_VERSION:
+        return "1.4 host";
+    case EGL_CLIENT_APIS:
+        return "OpenGL_ES";
+    case EGL_EXTENSIONS:
+        return "EGL_KHR_swap_buffers_with_damage EGL_KHR_partial_update EGL_EXT_buffer_age EGL_KHR_fence_sync";
+    default:
+        hostEglError = EGL_BAD_PARAMETER;
+        return NULL;
+    }
+}
+
+static EGLBoolean EGLAPIENTRY hostSwapBuffersWithDamage(EGLDisplay dpy, EGLSurface surface, EGLint * rects, EGLint n_rects)
+{
+    HOST_VDK_CALL(eglSwapBuffersWithDamageKHR);
+    (void)dpy;
+    (void)surface;
+    (void)rects;
+    (void)n_rects;
+    hostWaitVsync();
+    hostEndFrame();
+    return EGL_TRUE;
+}
+
+static EGLBoolean EGLAPIENTRY hostSetDamageRegion(EGLDisplay dpy, EGLSurface surface, EGLint * rects, EGLint n_rects)
+{
+    HOST_VDK_CALL(eglSetDamageRegionKHR);
+    (void)dpy;
+    (void)surface;
+    (void)rects;
+    (void)n_rects;
+    return EGL_TRUE;
+}
+
+// Fences: the headless GL executes every call at once, so they are created
+// signaled.
+static EGLSyncKHR EGLAPIENTRY hostCreateSync(EGLDisplay dpy, EGLenum type, const EGLint * attrib_list)
+{
+    HOST_VDK_CALL(eglCreateSyncKHR);
+    (void)dpy;
+    (void)attrib_list;
+    if (type != EGL_SYNC_FENCE_KHR)
+    {
+        hostEglError = EGL_BAD_ATTRIBUTE;
+        return EGL_NO_SYNC_KHR;
+    }
+    return (EGLSyncKHR)&hostEglTag;
+}
+
+static EGLBoolean EGLAPIENTRY hostDestroySync(EGLDisplay dpy, EGLSyncKHR sync)
+{
+    HOST_VDK_CALL(eglDestroySyncKHR);
+    (void)dpy;
+    (void)sync;
+    return EGL_TRUE;
+}
+
+static EGLint EGLAPIENTRY hostClientWaitSync(EGLDisplay dpy, EGLSyncKHR sync, EGLint flags, EGLTimeKHR timeout)
+{
+    HOST_VDK_CALL(eglClientWaitSyncKHR);
+    (void)dpy;
+    (void)sync;
+    (void)flags;
+    (void)timeout;
+    return EGL_CONDITION_SATISFIED_KHR;
+}
+
+__eglMustCastToProperFunctionPointerType EGLAPIENTRY eglGetProcAddress(const char * procname)
+{
+    HOST_VDK_CALL(eglGetProcAddress);
+    if ((strcmp(procname, "eglSwapBuffersWithDamageKHR") == 0) || (strcmp(procname, "eglSwapBuffersWithDamageEXT") == 0))
+    {
+        return (__eglMustCastToProperFunctionPointerType)hostSwapBuffersWithDamage;
+    }
+    if (strcmp(procname, "eglSetDamageRegionKHR") == 0)
+    {
+        return (__eglMustCastToProperFunctionPointerType)hostSetDamageRegion;
+    }
+    if (strcmp(procname, "eglCreateSyncKHR") == 0)
+    {
+        return (__eglMustCastToProperFunctionPointerType)hostCreateSync;
+    }
+    if (strcmp(procname, "eglDestroySyncKHR") == 0)
+    {
+        return (__eglMustCastToProperFunctionPointerType)hostDestroySync;
+    }
+    if (strcmp(procname, "eglClientWaitSyncKHR") == 0)
+    {
+        return (__eglMustCastToProperFunctionPointerType)hostClientWaitSync;
+    }
+    return (__eglMustCastToProperFunctionPointerType)hostGlProcAddress(procname);
+}
+
+EGLBoolean EGLAPIENTRY eglChooseConfig(EGLDisplay dpy, const EGLint * attrib_list, EGLConfig * configs, EGLint config_size, EGLint * num_config)
+{
+    HOST_VDK_CALL(eglChooseConfig);
+    (void)dpy;
+    (void)attrib_list;
+    if ((configs != NULL) && (config_size > 0))
+    {
+        configs[0] = (EGLConfig)&hostEglTag;
+    }
+    *num_config = 1;
+    return EGL_TRUE;
+}
+
+EGLContext EGLAPIENTRY eglCreateContext(EGLDisplay dpy, EGLConfig config, EGLContext share_context, const EGLint * attrib_list)
+{
+    HOST_VDK_CALL(eglCreateContext);
+    (void)dpy;
+    (void)config;
+    (void)share_context;
+    (void)attrib_list;
+    return (EGLContext)&hostEglTag;
+}
+
+EGLBoolean EGLAPIENTRY eglDestroyContext(EGLDisplay dpy, EGLContext ctx)
+{
+    HOST_VDK_CALL(eglDestroyContext);
+    (void)dpy;
+    (void)ctx;
+    return EGL_TRUE;
+}
+
+EGLSurface EGLAPIENTRY eglCreatePbufferSurface(EGLDisplay dpy, EGLConfig config, const EGLint * attrib_list)
+{
+    HOST_VDK_CALL(eglCreatePbufferSurface);
+    (void)dpy;
+    (void)config;
+    (void)attrib_list;
+    return (EGLSurface)&hostEglTag;
+}
+
+EGLBoolean EGLAPIENTRY eglDestroySurface(EGLDisplay dpy, EGLSurface surface)
+{
+    HOST_VDK_CALL(eglDestroySurface);
+    (void)dpy;
+    (void)surface;
+    return EGL_TRUE;
+}
+
+EGLBoolean EGLAPIENTRY eglQuerySurface(EGLDisplay dpy, EGLSurface surface, EGLint attribute, EGLint * value)
+{
+    HOST_VDK_CALL(eglQuerySurface);
+    (void)dpy;
+    (void)surface;
+    switch (attribute)
+    {
+    case EGL_WIDTH:
+        *value = 1920;
+        break;
+    case EGL_HEIGHT:
+        *value = 1080;
+        break;
+    case EGL_BUFFER_AGE_EXT:
+        // Double buffered: the back buffer is undefined until both were shown.
+        *value = (hostSwaps >= 2) ? 2 : 0;
+        break;
+    default:
+        *value = 0;
+        break;
+    }
+    return EGL_TRUE;
+}
+
+EGLBoolean EGLAPIENTRY eglMakeCurrent(EGLDisplay dpy, EGLSurface draw, EGLSurface read, EGLContext ctx)
+{
+    HOST_VDK_CALL(eglMakeCurrent);
+    (void)dpy;
+    (void)draw;
+    (void)read;
+    (void)ctx;
+    return EGL_TRUE;
+}
+
+EGLBoolean EGLAPIENTRY eglBindAPI(EGLenum api)
+{
+    HOST_VDK_CALL(eglBindAPI);
+    return (api == EGL_OPENGL_ES_API) ? EGL_TRUE : EGL_FALSE;
+}
+
+EGLBoolean EGLAPIENTRY eglReleaseThread(void)
+{
+    HOST_VDK_CALL(eglReleaseThread);
+    return EGL_TRUE;
+}
+
+EGLBoolean EGLAPIENTRY eglSwapInterval(EGLDisplay dpy, EGLint interval)
+{
+    HOST_VDK_CALL(eglSwapInterval);
+    (void)dpy;
+    hostSwapInterval = (interval > 0) ? interval : 0;
+    return EGL_TRUE;
+}
+
+void hostWaitVsync(void)
+{
+    if (hostSwapInterval == 0)
+    {
+        return;
+    }
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    unsigned long long ns = now.tv_sec * 1000000000ULL + now.tv_nsec;
+
+    // The next vblank, and at least Interval after the last swap's.
+    unsigned long long vblank = (ns / HOST_VBLANK_NS + 1) * HOST_VBLANK_NS;
+    if (vblank < hostLastVblank + hostSwapInterval * HOST_VBLANK_NS)
+    {
+        vblank = hostLastVblank + hostSwapInterval * HOST_VBLANK_NS;
+    }
+    hostLastVblank = vblank;
+
+    struct timespec until;
+    until.tv_sec = vblank / 1000000000ULL;
+    until.tv_nsec = vblank % 1000000000ULL;
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &until, NULL) == EINTR)
+    {
+    }
+}
+
+EGLBoolean EGLAPIENTRY eglSwapBuffers(EGLDisplay dpy, EGLSurface surface)
+{
+    HOST_VDK_CALL(eglSwapBuffers);
+    (void)dpy;
+    (void)surface;
+    hostWaitVsync();
+    hostEndFrame();
+    return EGL_TRUE;
+}
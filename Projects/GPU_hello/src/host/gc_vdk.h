@@ -0,0 +1,112 @@
+/*
+ * Host stand-in for the Vivante VDK header.
+ *
+ * Declares the subset of gc_vdk.h used by gpu_hello so the application can
+ * be built on a plain Linux box and linked against the headless EGL/GLES2
+ * layer in this directory instead of -lEGL -lGLESv2 -lVDK.
+ */
+
+#ifndef HOST_GC_VDK_H
+#define HOST_GC_VDK_H
+
+#include <EGL/egl.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef void * vdkPrivate;
+typedef void * vdkDisplay;
+typedef void * vdkWindow;
+
+typedef struct _vdkEGL
+{
+    vdkPrivate   vdk;
+    vdkDisplay   display;
+    vdkWindow    window;
+    EGLDisplay   eglDisplay;
+    EGLConfig    eglConfig;
+    EGLSurface   eglSurface;
+    EGLContext   eglContext;
+}
+vdkEGL;
+
+typedef enum _vdkEventType
+{
+    VDK_KEYBOARD,
+    VDK_BUTTON,
+    VDK_POINTER,
+    VDK_CLOSE,
+}
+vdkEventType;
+
+typedef enum _vdkKeys
+{
+    VDK_UNKNOWN = -1,
+    VDK_BACKSPACE = 0x08,
+    VDK_TAB       = 0x09,
+    VDK_ENTER     = 0x0D,
+    VDK_ESCAPE    = 0x1B,
+    VDK_SPACE     = 0x20,
+    VDK_LEFT      = 0x100,
+    VDK_RIGHT,
+    VDK_UP,
+    VDK_DOWN,
+}
+vdkKeys;
+
+typedef struct _vdkEvent
+{
+    vdkEventType type;
+
+    union
+    {
+        struct
+        {
+            vdkKeys scancode;
+            char    key;
+            int     pressed;
+        }
+        keyboard;
+
+        struct
+        {
+            int left;
+            int right;
+            int middle;
+            int x;
+            int y;
+        }
+        button;
+
+        struct
+        {
+            int x;
+            int y;
+        }
+        pointer;
+    }
+    data;
+}
+vdkEvent;
+
+int vdkSetupEGL(int X, int Y, int Width, int Height,
+                const EGLint * ConfigurationAttributes,
+                const EGLint * SurfaceAttributes,
+                const EGLint * ContextAttributes,
+                vdkEGL * Egl);
+int vdkSwapEGL(vdkEGL * Egl);
+void vdkFinishEGL(vdkEGL * Egl);
+
+int vdkSetWindowTitle(vdkWindow Window, const char * Title);
+int vdkShowWindow(vdkWindow Window);
+int vdkHideWindow(vdkWindow Window);
+int vdkGetEvent(vdkWindow Window, vdkEvent * Event);
+
+unsigned int vdkGetTicks(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HOST_GC_VDK_H */
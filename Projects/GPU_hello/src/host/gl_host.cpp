@@ -0,0 +1,1293 @@
+/*
+ * Headless OpenGL ES 2.0 for host builds.
+ *
+ * Every entry point is counted and the state that matters for CPU-side
+ * profiling is shadowed: object names, program attribute/uniform names,
+ * vertex attribute arrays and the fixed-function state. Nothing is drawn.
+ * Client-side vertex arrays are charged to bytesClientArray at draw time,
+ * which is the copy the Vivante driver makes on every draw.
+ */
+
+#include <GLES2/gl2.h>
+#include <GLES2/gl2ext.h>
+#include "host_internal.h"
+#include <pthread.h>
+#include <string.h>
+
+#define HOST_MAX_ATTRIBS    16
+#define HOST_MAX_PROGRAMS   256
+#define HOST_MAX_NAMES      64
+#define HOST_MAX_UNIFORM    16
+#define HOST_NAME_LENGTH    64
+#define HOST_MAX_TEXUNITS   8
+
+typedef struct _HostAttrib
+{
+    GLboolean       enabled;
+    GLint           size;
+    GLenum          type;
+    GLboolean       normalized;
+    GLsizei         stride;
+    const void *    pointer;
+    GLuint          buffer;
+}
+HostAttrib;
+
+typedef struct _HostProgram
+{
+    GLuint  name;
+    GLint   linked;
+    int     attribCount;
+    int     uniformCount;
+    char    attribs[HOST_MAX_ATTRIBS][HOST_NAME_LENGTH];
+    char    bound[HOST_MAX_ATTRIBS][HOST_NAME_LENGTH];
+    char    uniforms[HOST_MAX_NAMES][HOST_NAME_LENGTH];
+    GLfloat values[HOST_MAX_NAMES][HOST_MAX_UNIFORM];
+}
+HostProgram;
+
+// GL_OES_get_program_binary blob: the linked attribute table, so locations
+// survive a reload like they do on a real driver.
+#define HOST_BINARY_FORMAT  0x484F5354      // "HOST"
+
+typedef struct _HostProgramBinary
+{
+    GLuint  magic;
+    int     attribCount;
+    char    attribs[HOST_MAX_ATTRIBS][HOST_NAME_LENGTH];
+}
+HostProgramBinary;
+
+static pthread_mutex_t hostObjectLock = PTHREAD_MUTEX_INITIALIZER;
+static GLuint hostNextName = 1;
+
+static HostProgram hostPrograms[HOST_MAX_PROGRAMS];
+static HostAttrib hostAttribs[HOST_MAX_ATTRIBS];
+
+static GLuint hostProgram = 0;
+static GLuint hostArrayBuffer = 0;
+static GLuint hostElementBuffer = 0;
+static GLuint hostFramebuffer = 0;
+static GLuint hostRenderbuffer = 0;
+static GLuint hostTextures[HOST_MAX_TEXUNITS];
+static GLenum hostActiveUnit = 0;
+static GLenum hostError = GL_NO_ERROR;
+
+static GLfloat hostClearColor[4];
+static GLfloat hostClearDepth = 1.0f;
+static GLint hostViewport[4];
+static GLint hostScissor[4];
+static GLenum hostBlend[4] = { GL_ONE, GL_ZERO, GL_ONE, GL_ZERO };
+static GLenum hostDepthFunc = GL_LESS;
+static GLboolean hostDepthMask = GL_TRUE;
+static GLboolean hostColorMask[4] = { GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE };
+static unsigned int hostCaps = 0;
+
+/***************************************************************************************
+***************************************************************************************/
+
+static GLuint hostGenName(void)
+{
+    return __sync_fetch_and_add(&hostNextName, 1u);
+}
+
+static void hostGenNames(GLsizei n, GLuint * names)
+{
+    for (GLsizei i = 0; i < n; ++i)
+    {
+        names[i] = hostGenName();
+    }
+}
+
+// Counts one state change, flagging it when it did not change anything.
+static void hostState(int changed)
+{
+    HOST_ADD(stateChanges, 1);
+    if (!changed)
+    {
+        HOST_ADD(redundantChanges, 1);
+    }
+}
+
+static unsigned int hostTypeSize(GLenum type)
+{
+    switch (type)
+    {
+    case GL_BYTE:
+    case GL_UNSIGNED_BYTE:
+        return 1;
+    case GL_SHORT:
+    case GL_UNSIGNED_SHORT:
+    case GL_HALF_FLOAT_OES:
+        return 2;
+    default:
+        return 4;
+    }
+}
+
+static unsigned int hostPixelSize(GLenum format, GLenum type)
+{
+    if ((type == GL_UNSIGNED_SHORT_5_6_5) || (type == GL_UNSIGNED_SHORT_4_4_4_4) || (type == GL_UNSIGNED_SHORT_5_5_5_1))
+    {
+        return 2;
+    }
+
+    unsigned int components;
+    switch (format)
+    {
+    case GL_ALPHA:
+    case GL_LUMINANCE:
+        components = 1;
+        break;
+    case GL_LUMINANCE_ALPHA:
+        components = 2;
+        break;
+    case GL_RGB:
+        components = 3;
+        break;
+    default:
+        components = 4;
+        break;
+    }
+    return components * hostTypeSize(type);
+}
+
+static unsigned int hostCapBit(GLenum cap)
+{
+    switch (cap)
+    {
+    case GL_BLEND:                    return 1u << 0;
+    case GL_CULL_FACE:                return 1u << 1;
+    case GL_DEPTH_TEST:               return 1u << 2;
+    case GL_DITHER:                   return 1u << 3;
+    case GL_POLYGON_OFFSET_FILL:      return 1u << 4;
+    case GL_SAMPLE_ALPHA_TO_COVERAGE: return 1u << 5;
+    case GL_SAMPLE_COVERAGE:          return 1u << 6;
+    case GL_SCISSOR_TEST:             return 1u << 7;
+    case GL_STENCIL_TEST:             return 1u << 8;
+    default:                          return 0;
+    }
+}
+
+// Caller holds hostObjectLock.
+static HostProgram * hostFindProgram(GLuint name)
+{
+    for (int i = 0; i < HOST_MAX_PROGRAMS; ++i)
+    {
+        if ((name != 0) && (hostPrograms[i].name == name))
+        {
+            return &hostPrograms[i];
+        }
+    }
+    return NULL;
+}
+
+static int hostFindName(char (*names)[HOST_NAME_LENGTH], int * count, int max, const char * name)
+{
+    for (int i = 0; i < *count; ++i)
+    {
+        if (strcmp(names[i], name) == 0)
+        {
+            return i;
+        }
+    }
+    if (*count >= max)
+    {
+        return -1;
+    }
+    strncpy(names[*count], name, HOST_NAME_LENGTH - 1);
+    return (*count)++;
+}
+
+// Charges the client-side arrays a draw of vertices [0, vertexCount) reads.
+static void hostChargeClientArrays(GLsizei vertexCount)
+{
+    for (int i = 0; i < HOST_MAX_ATTRIBS; ++i)
+    {
+        const HostAttrib * attrib = &hostAttribs[i];
+        if (attrib->enabled && (attrib->buffer == 0) && (attrib->pointer != NULL))
+        {
+            unsigned int element = attrib->size * hostTypeSize(attrib->type);
+            unsigned int stride = (attrib->stride != 0) ? attrib->stride : element;
+            HOST_ADD(bytesClientArray, (unsigned long long)stride * vertexCount);
+        }
+    }
+}
+
+static void hostUniform(GLint location, GLsizei floats, const void * value)
+{
+    HOST_ADD(uniformUploads, 1);
+    HOST_ADD(bytesUploaded, floats * 4);
+
+    int changed = 1;
+    pthread_mutex_lock(&hostObjectLock);
+    HostProgram * program = hostFindProgram(hostProgram);
+    if ((program != NULL) && (location >= 0) && (location < HOST_MAX_NAMES) && (floats <= HOST_MAX_UNIFORM))
+    {
+        changed = memcmp(program->values[location], value, floats * 4) != 0;
+        memcpy(program->values[location], value, floats * 4);
+    }
+    pthread_mutex_unlock(&hostObjectLock);
+
+    if (!changed)
+    {
+        HOST_ADD(redundantChanges, 1);
+    }
+}
+
+/***************************************************************************************
+***************************************************************************************/
+
+// Shaders and programs.
+
+GLuint GL_APIENTRY glCreateShader(GLenum type)
+{
+    HOST_GL_CALL(glCreateShader);
+    (void)type;
+    return hostGenName();
+}
+
+void GL_APIENTRY glShaderSource(GLuint shader, GLsizei count, const GLchar * const * string, const GLint * length)
+{
+    HOST_GL_CALL(glShaderSource);
+    (void)shader;
+    for (GLsizei i = 0; i < count; ++i)
+    {
+        HOST_ADD(bytesUploaded, ((length != NULL) && (length[i] >= 0)) ? (unsigned int)length[i] : strlen(string[i]));
+    }
+}
+
+void GL_APIENTRY glShaderBinary(GLsizei count, const GLuint * shaders, GLenum binaryformat, const void * binary, GLsizei length)
+{
+    HOST_GL_CALL(glShaderBinary);
+    (void)count;
+    (void)shaders;
+    (void)binaryformat;
+    (void)binary;
+    HOST_ADD(bytesUploaded, length);
+}
+
+void GL_APIENTRY glCompileShader(GLuint shader)
+{
+    HOST_GL_CALL(glCompileShader);
+    (void)shader;
+}
+
+void GL_APIENTRY glReleaseShaderCompiler(void)
+{
+    HOST_GL_CALL(glReleaseShaderCompiler);
+}
+
+void GL_APIENTRY glGetShaderiv(GLuint shader, GLenum pname, GLint * params)
+{
+    HOST_GL_CALL(glGetShaderiv);
+    (void)shader;
+    *params = (pname == GL_COMPILE_STATUS) ? GL_TRUE : 0;
+}
+
+void GL_APIENTRY glGetShaderInfoLog(GLuint shader, GLsizei bufSize, GLsizei * length, GLchar * infoLog)
+{
+    HOST_GL_CALL(glGetShaderInfoLog);
+    (void)shader;
+    if (length != NULL)
+    {
+        *length = 0;
+    }
+    if ((infoLog != NULL) && (bufSize > 0))
+    {
+        infoLog[0] = '\0';
+    }
+}
+
+void GL_APIENTRY glGetShaderPrecisionFormat(GLenum shadertype, GLenum precisiontype, GLint * range, GLint * precision)
+{
+    HOST_GL_CALL(glGetShaderPrecisionFormat);
+    (void)shadertype;
+    (void)precisiontype;
+    range[0] = range[1] = 127;
+    *precision = 23;
+}
+
+void GL_APIENTRY glDeleteShader(GLuint shader)
+{
+    HOST_GL_CALL(glDeleteShader);
+    (void)shader;
+}
+
+GLuint GL_APIENTRY glCreateProgram(void)
+{
+    HOST_GL_CALL(glCreateProgram);
+    GLuint name = hostGenName();
+
+    pthread_mutex_lock(&hostObjectLock);
+    HostProgram * program = NULL;
+    for (int i = 0; (program == NULL) && (i < HOST_MAX_PROGRAMS); ++i)
+    {
+        if (hostPrograms[i].name == 0)
+        {
+            program = &hostPrograms[i];
+        }
+    }
+    if (program != NULL)
+    {
+        memset(program, 0, sizeof(*program));
+        program->name = name;
+    }
+    pthread_mutex_unlock(&hostObjectLock);
+
+    return name;
+}
+
+void GL_APIENTRY glAttachShader(GLuint program, GLuint shader)
+{
+    HOST_GL_CALL(glAttachShader);
+    (void)program;
+    (void)shader;
+}
+
+void GL_APIENTRY glDetachShader(GLuint program, GLuint shader)
+{
+    HOST_GL_CALL(glDetachShader);
+    (void)program;
+    (void)shader;
+}
+
+void GL_APIENTRY glBindAttribLocation(GLuint program, GLuint index, const GLchar * name)
+{
+    HOST_GL_CALL(glBindAttribLocation);
+
+    pthread_mutex_lock(&hostObjectLock);
+    HostProgram * shadow = hostFindProgram(program);
+    if ((shadow != NULL) && (index < HOST_MAX_ATTRIBS))
+    {
+        strncpy(shadow->bound[index], name, HOST_NAME_LENGTH - 1);
+    }
+    pthread_mutex_unlock(&hostObjectLock);
+}
+
+void GL_APIENTRY glLinkProgram(GLuint program)
+{
+    HOST_GL_CALL(glLinkProgram);
+
+    pthread_mutex_lock(&hostObjectLock);
+    HostProgram * shadow = hostFindProgram(program);
+    if (shadow != NULL)
+    {
+        // Explicit bindings take the slot of the same index.
+        memcpy(shadow->attribs, shadow->bound, sizeof(shadow->attribs));
+        shadow->attribCount = HOST_MAX_ATTRIBS;
+        while ((shadow->attribCount > 0) && (shadow->attribs[shadow->attribCount - 1][0] == '\0'))
+        {
+            --shadow->attribCount;
+        }
+        shadow->linked = GL_TRUE;
+    }
+    pthread_mutex_unlock(&hostObjectLock);
+}
+
+void GL_APIENTRY glValidateProgram(GLuint program)
+{
+    HOST_GL_CALL(glValidateProgram);
+    (void)program;
+}
+
+void GL_APIENTRY glGetProgramiv(GLuint program, GLenum pname, GLint * params)
+{
+    HOST_GL_CALL(glGetProgramiv);
+
+    pthread_mutex_lock(&hostObjectLock);
+    HostProgram * shadow = hostFindProgram(program);
+    switch (pname)
+    {
+    case GL_LINK_STATUS:
+        *params = (shadow != NULL) ? shadow->linked : GL_FALSE;
+        break;
+    case GL_VALIDATE_STATUS:
+    case GL_DELETE_STATUS:
+        *params = GL_TRUE;
+        break;
+    case GL_PROGRAM_BINARY_LENGTH_OES:
+        *params = ((shadow != NULL) && shadow->linked) ? (GLint)sizeof(HostProgramBinary) : 0;
+        break;
+    default:
+        *params = 0;
+        break;
+    }
+    pthread_mutex_unlock(&hostObjectLock);
+}
+
+void GL_APIENTRY glGetProgramBinaryOES(GLuint program, GLsizei bufSize, GLsizei * length, GLenum * binaryFormat, void * binary)
+{
+    HOST_GL_CALL(glGetProgramBinaryOES);
+    GLsizei written = 0;
+
+    pthread_mutex_lock(&hostObjectLock);
+    HostProgram * shadow = hostFindProgram(program);
+    if ((shadow != NULL) && shadow->linked && (bufSize >= (GLsizei)sizeof(HostProgramBinary)))
+    {
+        HostProgramBinary * blob = (HostProgramBinary *)binary;
+        memset(blob, 0, sizeof(*blob));
+        blob->magic = HOST_BINARY_FORMAT;
+        blob->attribCount = shadow->attribCount;
+        memcpy(blob->attribs, shadow->attribs, sizeof(blob->attribs));
+        written = sizeof(HostProgramBinary);
+        *binaryFormat = HOST_BINARY_FORMAT;
+    }
+    else
+    {
+        hostError = GL_INVALID_OPERATION;
+    }
+    pthread_mutex_unlock(&hostObjectLock);
+
+    if (length != NULL)
+    {
+        *length = written;
+    }
+}
+
+void GL_APIENTRY glProgramBinaryOES(GLuint program, GLenum binaryFormat, const void * binary, GLint length)
+{
+    HOST_GL_CALL(glProgramBinaryOES);
+
+    pthread_mutex_lock(&hostObjectLock);
+    HostProgram * shadow = hostFindProgram(program);
+    if (shadow != NULL)
+    {
+        // A foreign or truncated blob fails the link, as the spec requires.
+        const HostProgramBinary * blob = (const HostProgramBinary *)binary;
+        shadow->linked = (binaryFormat == HOST_BINARY_FORMAT)
+                      && (length == (GLint)sizeof(HostProgramBinary))
+                      && (blob->magic == HOST_BINARY_FORMAT);
+        if (shadow->linked)
+        {
+            shadow->attribCount = blob->attribCount;
+            memcpy(shadow->attribs, blob->attribs, sizeof(shadow->attribs));
+        }
+    }
+    pthread_mutex_unlock(&hostObjectLock);
+}
+
+void GL_APIENTRY glGetProgramInfoLog(GLuint program, GLsizei bufSize, GLsizei * length, GLchar * infoLog)
+{
+    HOST_GL_CALL(glGetProgramInfoLog);
+    (void)program;
+    if (length != NULL)
+    {
+        *length = 0;
+    }
+    if ((infoLog != NULL) && (bufSize > 0))
+    {
+        infoLog[0] = '\0';
+    }
+}
+
+void GL_APIENTRY glDeleteProgram(GLuint program)
+{
+    HOST_GL_CALL(glDeleteProgram);
+
+    pthread_mutex_lock(&hostObjectLock);
+    HostProgram * shadow = hostFindProgram(program);
+    if (shadow != NULL)
+    {
+        shadow->name = 0;
+    }
+    pthread_mutex_unlock(&hostObjectLock);
+}
+
+void GL_APIENTRY glUseProgram(GLuint program)
+{
+    HOST_GL_CALL(glUseProgram);
+    hostState(hostProgram != program);
+    hostProgram = program;
+}
+
+GLint GL_APIENTRY glGetAttribLocation(GLuint program, const GLchar * name)
+{
+    HOST_GL_CALL(glGetAttribLocation);
+    GLint location = -1;
+
+    pthread_mutex_lock(&hostObjectLock);
+    HostProgram * shadow = hostFindProgram(program);
+    if (shadow != NULL)
+    {
+        location = hostFindName(shadow->attribs, &shadow->attribCount, HOST_MAX_ATTRIBS, name);
+    }
+    pthread_mutex_unlock(&hostObjectLock);
+
+    return location;
+}
+
+GLint GL_APIENTRY glGetUniformLocation(GLuint program, const GLchar * name)
+{
+    HOST_GL_CALL(glGetUniformLocation);
+    GLint location = -1;
+
+    pthread_mutex_lock(&hostObjectLock);
+    HostProgram * shadow = hostFindProgram(program);
+    if (shadow != NULL)
+    {
+        location = hostFindName(shadow->uniforms, &shadow->uniformCount, HOST_MAX_NAMES, name);
+    }
+    pthread_mutex_unlock(&hostObjectLock);
+
+    return location;
+}
+
+/***************************************************************************************
+***************************************************************************************/
+
+// Uniforms.
+
+void GL_APIENTRY glUniform1f(GLint location, GLfloat v0)
+{
+    HOST_GL_CALL(glUniform1f);
+    GLfloat v[1] = { v0 };
+    hostUniform(location, 1, v);
+}
+
+void GL_APIENTRY glUniform2f(GLint location, GLfloat v0, GLfloat v1)
+{
+    HOST_GL_CALL(glUniform2f);
+    GLfloat v[2] = { v0, v1 };
+    hostUniform(location, 2, v);
+}
+
+void GL_APIENTRY glUniform3f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2)
+{
+    HOST_GL_CALL(glUniform3f);
+    GLfloat v[3] = { v0, v1, v2 };
+    hostUniform(location, 3, v);
+}
+
+void GL_APIENTRY glUniform4f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2, GLfloat v3)
+{
+    HOST_GL_CALL(glUniform4f);
+    GLfloat v[4] = { v0, v1, v2, v3 };
+    hostUniform(location, 4, v);
+}
+
+void GL_APIENTRY glUniform1i(GLint location, GLint v0)
+{
+    HOST_GL_CALL(glUniform1i);
+    GLint v[1] = { v0 };
+    hostUniform(location, 1, v);
+}
+
+void GL_APIENTRY glUniform2i(GLint location, GLint v0, GLint v1)
+{
+    HOST_GL_CALL(glUniform2i);
+    GLint v[2] = { v0, v1 };
+    hostUniform(location, 2, v);
+}
+
+void GL_APIENTRY glUniform1fv(GLint location, GLsizei count, const GLfloat * value)
+{
+    HOST_GL_CALL(glUniform1fv);
+    hostUniform(location, count, value);
+}
+
+void GL_APIENTRY glUniform2fv(GLint location, GLsizei count, const GLfloat * value)
+{
+    HOST_GL_CALL(glUniform2fv);
+    hostUniform(location, 2 * count, value);
+}
+
+void GL_APIENTRY glUniform3fv(GLint location, GLsizei count, const GLfloat * value)
+{
+    HOST_GL_CALL(glUniform3fv);
+    hostUniform(location, 3 * count, value);
+}
+
+void GL_APIENTRY glUniform4fv(GLint location, GLsizei count, const GLfloat * value)
+{
+    HOST_GL_CALL(glUniform4fv);
+    hostUniform(location, 4 * count, value);
+}
+
+void GL_APIENTRY glUniform1iv(GLint location, GLsizei count, const GLint * value)
+{
+    HOST_GL_CALL(glUniform1iv);
+    hostUniform(location, count, value);
+}
+
+void GL_APIENTRY glUniformMatrix3fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat * value)
+{
+    HOST_GL_CALL(glUniformMatrix3fv);
+    (void)transpose;
+    hostUniform(location, 9 * count, value);
+}
+
+void GL_APIENTRY glUniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat * value)
+{
+    HOST_GL_CALL(glUniformMatrix4fv);
+    (void)transpose;
+    hostUniform(location, 16 * count, value);
+}
+
+/***************************************************************************************
+***************************************************************************************/
+
+// Vertex attributes and draws.
+
+void GL_APIENTRY glEnableVertexAttribArray(GLuint index)
+{
+    HOST_GL_CALL(glEnableVertexAttribArray);
+    if (index < HOST_MAX_ATTRIBS)
+    {
+        hostState(!hostAttribs[index].enabled);
+        hostAttribs[index].enabled = GL_TRUE;
+    }
+}
+
+void GL_APIENTRY glDisableVertexAttribArray(GLuint index)
+{
+    HOST_GL_CALL(glDisableVertexAttribArray);
+    if (index < HOST_MAX_ATTRIBS)
+    {
+        hostState(hostAttribs[index].enabled);
+        hostAttribs[index].enabled = GL_FALSE;
+    }
+}
+
+void GL_APIENTRY glVertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void * pointer)
+{
+    HOST_GL_CALL(glVertexAttribPointer);
+    if (index < HOST_MAX_ATTRIBS)
+    {
+        HostAttrib * attrib = &hostAttribs[index];
+        hostState((attrib->size != size) || (attrib->type != type) || (attrib->normalized != normalized)
+               || (attrib->stride != stride) || (attrib->pointer != pointer) || (attrib->buffer != hostArrayBuffer));
+        attrib->size       = size;
+        attrib->type       = type;
+        attrib->normalized = normalized;
+        attrib->stride     = stride;
+        attrib->pointer    = pointer;
+        attrib->buffer     = hostArrayBuffer;
+    }
+}
+
+void GL_APIENTRY glVertexAttrib4f(GLuint index, GLfloat x, GLfloat y, GLfloat z, GLfloat w)
+{
+    HOST_GL_CALL(glVertexAttrib4f);
+    (void)index;
+    (void)x;
+    (void)y;
+    (void)z;
+    (void)w;
+    hostState(1);
+}
+
+void GL_APIENTRY glVertexAttrib4fv(GLuint index, const GLfloat * v)
+{
+    HOST_GL_CALL(glVertexAttrib4fv);
+    (void)index;
+    (void)v;
+    hostState(1);
+}
+
+void GL_APIENTRY glDrawArrays(GLenum mode, GLint first, GLsizei count)
+{
+    HOST_GL_CALL(glDrawArrays);
+    (void)mode;
+    HOST_ADD(drawCalls, 1);
+    hostChargeClientArrays(first + count);
+}
+
+void GL_APIENTRY glDrawElements(GLenum mode, GLsizei count, GLenum type, const void * indices)
+{
+    HOST_GL_CALL(glDrawElements);
+    (void)mode;
+    HOST_ADD(drawCalls, 1);
+
+    GLsizei vertexCount = count;
+    if (hostElementBuffer == 0)
+    {
+        // Client-side indices are copied as well; the referenced range is their maximum.
+        HOST_ADD(bytesClientArray, count * hostTypeSize(type));
+        vertexCount = 0;
+        for (GLsizei i = 0; i < count; ++i)
+        {
+            GLsizei index = (type == GL_UNSIGNED_BYTE) ? ((const GLubyte *)indices)[i]
+                          : (type == GL_UNSIGNED_SHORT) ? ((const GLushort *)indices)[i]
+                          : (GLsizei)((const GLuint *)indices)[i];
+            if (index + 1 > vertexCount)
+            {
+                vertexCount = index + 1;
+            }
+        }
+    }
+    // Indices in a buffer object are not shadowed; assume one vertex per index.
+    hostChargeClientArrays(vertexCount);
+}
+
+/***************************************************************************************
+***************************************************************************************/
+
+// Buffer objects.
+
+void GL_APIENTRY glGenBuffers(GLsizei n, GLuint * buffers)
+{
+    HOST_GL_CALL(glGenBuffers);
+    hostGenNames(n, buffers);
+}
+
+void GL_APIENTRY glDeleteBuffers(GLsizei n, const GLuint * buffers)
+{
+    HOST_GL_CALL(glDeleteBuffers);
+    for (GLsizei i = 0; i < n; ++i)
+    {
+        if (buffers[i] == hostArrayBuffer)
+        {
+            hostArrayBuffer = 0;
+        }
+        if (buffers[i] == hostElementBuffer)
+        {
+            hostElementBuffer = 0;
+        }
+    }
+}
+
+void GL_APIENTRY glBindBuffer(GLenum target, GLuint buffer)
+{
+    HOST_GL_CALL(glBindBuffer);
+    GLuint * binding = (target == GL_ELEMENT_ARRAY_BUFFER) ? &hostElementBuffer : &hostArrayBuffer;
+    hostState(*binding != buffer);
+    *binding = buffer;
+}
+
+void GL_APIENTRY glBufferData(GLenum target, GLsizeiptr size, const void * data, GLenum usage)
+{
+    HOST_GL_CALL(glBufferData);
+    (void)target;
+    (void)usage;
+    if (data != NULL)
+    {
+        HOST_ADD(bytesUploaded, size);
+    }
+}
+
+void GL_APIENTRY glBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void * data)
+{
+    HOST_GL_CALL(glBufferSubData);
+    (void)target;
+    (void)offset;
+    (void)data;
+    HOST_ADD(bytesUploaded, size);
+}
+
+void GL_APIENTRY glGetBufferParameteriv(GLenum target, GLenum pname, GLint * params)
+{
+    HOST_GL_CALL(glGetBufferParameteriv);
+    (void)target;
+    (void)pname;
+    *params = 0;
+}
+
+/***************************************************************************************
+***************************************************************************************/
+
+// Textures, framebuffers and renderbuffers.
+
+void GL_APIENTRY glGenTextures(GLsizei n, GLuint * textures)
+{
+    HOST_GL_CALL(glGenTextures);
+    hostGenNames(n, textures);
+}
+
+void GL_APIENTRY glDeleteTextures(GLsizei n, const GLuint * textures)
+{
+    HOST_GL_CALL(glDeleteTextures);
+    for (GLsizei i = 0; i < n; ++i)
+    {
+        for (int unit = 0; unit < HOST_MAX_TEXUNITS; ++unit)
+        {
+            if (hostTextures[unit] == textures[i])
+            {
+                hostTextures[unit] = 0;
+            }
+        }
+    }
+}
+
+void GL_APIENTRY glActiveTexture(GLenum texture)
+{
+    HOST_GL_CALL(glActiveTexture);
+    GLenum unit = texture - GL_TEXTURE0;
+    hostState(hostActiveUnit != unit);
+    hostActiveUnit = (unit < HOST_MAX_TEXUNITS) ? unit : 0;
+}
+
+void GL_APIENTRY glBindTexture(GLenum target, GLuint texture)
+{
+    HOST_GL_CALL(glBindTexture);
+    (void)target;
+    hostState(hostTextures[hostActiveUnit] != texture);
+    hostTextures[hostActiveUnit] = texture;
+}
+
+void GL_APIENTRY glTexParameteri(GLenum target, GLenum pname, GLint param)
+{
+    HOST_GL_CALL(glTexParameteri);
+    (void)target;
+    (void)pname;
+    (void)param;
+    hostState(1);
+}
+
+void GL_APIENTRY glTexParameterf(GLenum target, GLenum pname, GLfloat param)
+{
+    HOST_GL_CALL(glTexParameterf);
+    (void)target;
+    (void)pname;
+    (void)param;
+    hostState(1);
+}
+
+void GL_APIENTRY glPixelStorei(GLenum pname, GLint param)
+{
+    HOST_GL_CALL(glPixelStorei);
+    (void)pname;
+    (void)param;
+    hostState(1);
+}
+
+void GL_APIENTRY glTexImage2D(GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const void * pixels)
+{
+    HOST_GL_CALL(glTexImage2D);
+    (void)target;
+    (void)level;
+    (void)internalformat;
+    (void)border;
+    if (pixels != NULL)
+    {
+        HOST_ADD(bytesUploaded, (unsigned long long)width * height * hostPixelSize(format, type));
+    }
+}
+
+void GL_APIENTRY glTexSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLsizei width, GLsizei height, GLenum format, GLenum type, const void * pixels)
+{
+    HOST_GL_CALL(glTexSubImage2D);
+    (void)target;
+    (void)level;
+    (void)xoffset;
+    (void)yoffset;
+    (void)pixels;
+    HOST_ADD(bytesUploaded, (unsigned long long)width * height * hostPixelSize(format, type));
+}
+
+// GL_VIV_direct_texture: the texture samples client memory in place, so
+// neither the map nor an invalidate uploads anything.
+static void GL_APIENTRY hostTexDirectVIVMap(GLenum Target, GLsizei Width, GLsizei Height, GLenum Format,
+                                            GLvoid ** Logical, const GLuint * Physical)
+{
+    HOST_GL_CALL(glTexDirectVIVMap);
+    (void)Target;
+    (void)Width;
+    (void)Height;
+    (void)Format;
+    (void)Logical;
+    (void)Physical;
+}
+
+static void GL_APIENTRY hostTexDirectInvalidateVIV(GLenum Target)
+{
+    HOST_GL_CALL(glTexDirectInvalidateVIV);
+    (void)Target;
+}
+
+void GL_APIENTRY glGenerateMipmap(GLenum target)
+{
+    HOST_GL_CALL(glGenerateMipmap);
+    (void)target;
+}
+
+void GL_APIENTRY glGenFramebuffers(GLsizei n, GLuint * framebuffers)
+{
+    HOST_GL_CALL(glGenFramebuffers);
+    hostGenNames(n, framebuffers);
+}
+
+void GL_APIENTRY glDeleteFramebuffers(GLsizei n, const GLuint * framebuffers)
+{
+    HOST_GL_CALL(glDeleteFramebuffers);
+    for (GLsizei i = 0; i < n; ++i)
+    {
+        if (framebuffers[i] == hostFramebuffer)
+        {
+            hostFramebuffer = 0;
+        }
+    }
+}
+
+void GL_APIENTRY glBindFramebuffer(GLenum target, GLuint framebuffer)
+{
+    HOST_GL_CALL(glBindFramebuffer);
+    (void)target;
+    hostState(hostFramebuffer != framebuffer);
+    hostFramebuffer = framebuffer;
+}
+
+void GL_APIENTRY glFramebufferTexture2D(GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level)
+{
+    HOST_GL_CALL(glFramebufferTexture2D);
+    (void)target;
+    (void)attachment;
+    (void)textarget;
+    (void)texture;
+    (void)level;
+    hostState(1);
+}
+
+void GL_APIENTRY glFramebufferRenderbuffer(GLenum target, GLenum attachment, GLenum renderbuffertarget, GLuint renderbuffer)
+{
+    HOST_GL_CALL(glFramebufferRenderbuffer);
+    (void)target;
+    (void)attachment;
+    (void)renderbuffertarget;
+    (void)renderbuffer;
+    hostState(1);
+}
+
+GLenum GL_APIENTRY glCheckFramebufferStatus(GLenum target)
+{
+    HOST_GL_CALL(glCheckFramebufferStatus);
+    (void)target;
+    return GL_FRAMEBUFFER_COMPLETE;
+}
+
+void GL_APIENTRY glGenRenderbuffers(GLsizei n, GLuint * renderbuffers)
+{
+    HOST_GL_CALL(glGenRenderbuffers);
+    hostGenNames(n, renderbuffers);
+}
+
+void GL_APIENTRY glDeleteRenderbuffers(GLsizei n, const GLuint * renderbuffers)
+{
+    HOST_GL_CALL(glDeleteRenderbuffers);
+    (void)n;
+    (void)renderbuffers;
+}
+
+void GL_APIENTRY glBindRenderbuffer(GLenum target, GLuint renderbuffer)
+{
+    HOST_GL_CALL(glBindRenderbuffer);
+    (void)target;
+    hostState(hostRenderbuffer != renderbuffer);
+    hostRenderbuffer = renderbuffer;
+}
+
+void GL_APIENTRY glRenderbufferStorage(GLenum target, GLenum internalformat, GLsizei width, GLsizei height)
+{
+    HOST_GL_CALL(glRenderbufferStorage);
+    (void)target;
+    (void)internalformat;
+    (void)width;
+    (void)height;
+}
+
+void GL_APIENTRY glReadPixels(GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, void * pixels)
+{
+    HOST_GL_CALL(glReadPixels);
+    (void)x;
+    (void)y;
+    size_t size = (size_t)width * height * hostPixelSize(format, type);
+    memset(pixels, 0, size);
+    HOST_ADD(bytesReadBack, size);
+}
+
+/***************************************************************************************
+***************************************************************************************/
+
+// Fixed-function state.
+
+void GL_APIENTRY glEnable(GLenum cap)
+{
+    HOST_GL_CALL(glEnable);
+    unsigned int bit = hostCapBit(cap);
+    hostState((hostCaps & bit) == 0);
+    hostCaps |= bit;
+}
+
+void GL_APIENTRY glDisable(GLenum cap)
+{
+    HOST_GL_CALL(glDisable);
+    unsigned int bit = hostCapBit(cap);
+    hostState((hostCaps & bit) != 0);
+    hostCaps &= ~bit;
+}
+
+GLboolean GL_APIENTRY glIsEnabled(GLenum cap)
+{
+    HOST_GL_CALL(glIsEnabled);
+    return (hostCaps & hostCapBit(cap)) ? GL_TRUE : GL_FALSE;
+}
+
+void GL_APIENTRY glClearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha)
+{
+    HOST_GL_CALL(glClearColor);
+    GLfloat color[4] = { red, green, blue, alpha };
+    hostState(memcmp(hostClearColor, color, sizeof(color)) != 0);
+    memcpy(hostClearColor, color, sizeof(color));
+}
+
+void GL_APIENTRY glClearDepthf(GLfloat d)
+{
+    HOST_GL_CALL(glClearDepthf);
+    hostState(hostClearDepth != d);
+    hostClearDepth = d;
+}
+
+void GL_APIENTRY glClearStencil(GLint s)
+{
+    HOST_GL_CALL(glClearStencil);
+    (void)s;
+    hostState(1);
+}
+
+void GL_APIENTRY glClear(GLbitfield mask)
+{
+    HOST_GL_CALL(glClear);
+    (void)mask;
+}
+
+void GL_APIENTRY glBlendFunc(GLenum sfactor, GLenum dfactor)
+{
+    HOST_GL_CALL(glBlendFunc);
+    hostState((hostBlend[0] != sfactor) || (hostBlend[1] != dfactor) || (hostBlend[2] != sfactor) || (hostBlend[3] != dfactor));
+    hostBlend[0] = hostBlend[2] = sfactor;
+    hostBlend[1] = hostBlend[3] = dfactor;
+}
+
+void GL_APIENTRY glBlendFuncSeparate(GLenum sfactorRGB, GLenum dfactorRGB, GLenum sfactorAlpha, GLenum dfactorAlpha)
+{
+    HOST_GL_CALL(glBlendFuncSeparate);
+    hostState((hostBlend[0] != sfactorRGB) || (hostBlend[1] != dfactorRGB) || (hostBlend[2] != sfactorAlpha) || (hostBlend[3] != dfactorAlpha));
+    hostBlend[0] = sfactorRGB;
+    hostBlend[1] = dfactorRGB;
+    hostBlend[2] = sfactorAlpha;
+    hostBlend[3] = dfactorAlpha;
+}
+
+void GL_APIENTRY glBlendEquation(GLenum mode)
+{
+    HOST_GL_CALL(glBlendEquation);
+    (void)mode;
+    hostState(1);
+}
+
+void GL_APIENTRY glDepthFunc(GLenum func)
+{
+    HOST_GL_CALL(glDepthFunc);
+    hostState(hostDepthFunc != func);
+    hostDepthFunc = func;
+}
+
+void GL_APIENTRY glDepthMask(GLboolean flag)
+{
+    HOST_GL_CALL(glDepthMask);
+    hostState(hostDepthMask != flag);
+    hostDepthMask = flag;
+}
+
+void GL_APIENTRY glDepthRangef(GLfloat n, GLfloat f)
+{
+    HOST_GL_CALL(glDepthRangef);
+    (void)n;
+    (void)f;
+    hostState(1);
+}
+
+void GL_APIENTRY glColorMask(GLboolean red, GLboolean green, GLboolean blue, GLboolean alpha)
+{
+    HOST_GL_CALL(glColorMask);
+    GLboolean mask[4] = { red, green, blue, alpha };
+    hostState(memcmp(hostColorMask, mask, sizeof(mask)) != 0);
+    memcpy(hostColorMask, mask, sizeof(mask));
+}
+
+void GL_APIENTRY glCullFace(GLenum mode)
+{
+    HOST_GL_CALL(glCullFace);
+    (void)mode;
+    hostState(1);
+}
+
+void GL_APIENTRY glFrontFace(GLenum mode)
+{
+    HOST_GL_CALL(glFrontFace);
+    (void)mode;
+    hostState(1);
+}
+
+void GL_APIENTRY glLineWidth(GLfloat width)
+{
+    HOST_GL_CALL(glLineWidth);
+    (void)width;
+    hostState(1);
+}
+
+void GL_APIENTRY glPolygonOffset(GLfloat factor, GLfloat units)
+{
+    HOST_GL_CALL(glPolygonOffset);
+    (void)factor;
+    (void)units;
+    hostState(1);
+}
+
+void GL_APIENTRY glViewport(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+    HOST_GL_CALL(glViewport);
+    GLint viewport[4] = { x, y, width, height };
+    hostState(memcmp(hostViewport, viewport, sizeof(viewport)) != 0);
+    memcpy(hostViewport, viewport, sizeof(viewport));
+}
+
+void GL_APIENTRY glScissor(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+    HOST_GL_CALL(glScissor);
+    GLint scissor[4] = { x, y, width, height };
+    hostState(memcmp(hostScissor, scissor, sizeof(scissor)) != 0);
+    memcpy(hostScissor, scissor, sizeof(scissor));
+}
+
+void GL_APIENTRY glHint(GLenum target, GLenum mode)
+{
+    HOST_GL_CALL(glHint);
+    (void)target;
+    (void)mode;
+}
+
+/***************************************************************************************
+***************************************************************************************/
+
+// Queries and synchronisation.
+
+const GLubyte * GL_APIENTRY glGetString(GLenum name)
+{
+    HOST_GL_CALL(glGetString);
+    switch (name)
+    {
+    case GL_VENDOR:
+        return (const GLubyte *)"gpu_hello";
+    case GL_RENDERER:
+        return (const GLubyte *)"Headless host GLES2";
+    case GL_VERSION:
+        return (const GLubyte *)"OpenGL ES 2.0 host";
+    case GL_SHADING_LANGUAGE_VERSION:
+        return (const GLubyte *)"OpenGL ES GLSL ES 1.00";
+    case GL_EXTENSIONS:
+        return (const GLubyte *)"GL_OES_vertex_half_float GL_OES_element_index_uint GL_OES_get_program_binary GL_VIV_direct_texture";
+    default:
+        hostError = GL_INVALID_ENUM;
+        return NULL;
+    }
+}
+
+void GL_APIENTRY glGetIntegerv(GLenum pname, GLint * data)
+{
+    HOST_GL_CALL(glGetIntegerv);
+    switch (pname)
+    {
+    case GL_MAX_VERTEX_ATTRIBS:
+        *data = HOST_MAX_ATTRIBS;
+        break;
+    case GL_MAX_VERTEX_UNIFORM_VECTORS:
+        *data = 256;
+        break;
+    case GL_MAX_FRAGMENT_UNIFORM_VECTORS:
+        *data = 64;
+        break;
+    case GL_MAX_VARYING_VECTORS:
+        *data = 12;
+        break;
+    case GL_MAX_TEXTURE_SIZE:
+    case GL_MAX_RENDERBUFFER_SIZE:
+        *data = 8192;
+        break;
+    case GL_MAX_TEXTURE_IMAGE_UNITS:
+    case GL_MAX_COMBINED_TEXTURE_IMAGE_UNITS:
+        *data = HOST_MAX_TEXUNITS;
+        break;
+    case GL_MAX_VERTEX_TEXTURE_IMAGE_UNITS:
+        *data = 0;
+        break;
+    case GL_NUM_PROGRAM_BINARY_FORMATS_OES:
+        *data = 1;
+        break;
+    case GL_PROGRAM_BINARY_FORMATS_OES:
+        *data = HOST_BINARY_FORMAT;
+        break;
+    case GL_CURRENT_PROGRAM:
+        *data = hostProgram;
+        break;
+    case GL_ARRAY_BUFFER_BINDING:
+        *data = hostArrayBuffer;
+        break;
+    case GL_ELEMENT_ARRAY_BUFFER_BINDING:
+        *data = hostElementBuffer;
+        break;
+    case GL_FRAMEBUFFER_BINDING:
+        *data = hostFramebuffer;
+        break;
+    case GL_VIEWPORT:
+        memcpy(data, hostViewport, sizeof(hostViewport));
+        break;
+    default:
+        *data = 0;
+        break;
+    }
+}
+
+void GL_APIENTRY glGetFloatv(GLenum pname, GLfloat * data)
+{
+    HOST_GL_CALL(glGetFloatv);
+    if (pname == GL_COLOR_CLEAR_VALUE)
+    {
+        memcpy(data, hostClearColor, sizeof(hostClearColor));
+    }
+    else
+    {
+        *data = 0.0f;
+    }
+}
+
+void GL_APIENTRY glGetBooleanv(GLenum pname, GLboolean * data)
+{
+    HOST_GL_CALL(glGetBooleanv);
+    (void)pname;
+    *data = GL_FALSE;
+}
+
+GLenum GL_APIENTRY glGetError(void)
+{
+    HOST_GL_CALL(glGetError);
+    GLenum error = hostError;
+    hostError = GL_NO_ERROR;
+    return error;
+}
+
+void GL_APIENTRY glFlush(void)
+{
+    HOST_GL_CALL(glFlush);
+}
+
+void GL_APIENTRY glFinish(void)
+{
+    HOST_GL_CALL(glFinish);
+}
+
+/***************************************************************************************
+***************************************************************************************/
+
+void * hostGlProcAddress(const char * Name)
+{
+    if (strcmp(Name, "glTexDirectVIVMap") == 0)
+    {
+        return (void *)hostTexDirectVIVMap;
+    }
+    if (strcmp(Name, "glTexDirectInvalidateVIV") == 0)
+    {
+        return (void *)hostTexDirectInvalidateVIV;
+    }
+    return NULL;
+}
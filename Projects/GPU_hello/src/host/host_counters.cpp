@@ -0,0 +1,157 @@
+/*
+ * Call and traffic counters of the headless EGL/GLES2/VDK layer.
+ */
+
+#include "host_internal.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+
+HostCounters hostFrame;
+unsigned long long hostSwaps = 0;
+
+static HostCounters hostTotal;
+static HostCounters hostMax;
+static unsigned long long hostFrames = 0;
+
+static HostCallSite * hostSites = NULL;
+static pthread_mutex_t hostSiteLock = PTHREAD_MUTEX_INITIALIZER;
+
+#define HOST_FIELD_COUNT (sizeof(HostCounters) / sizeof(unsigned long long))
+
+void hostCountCall(HostCallSite * Site)
+{
+    if (!Site->registered)
+    {
+        pthread_mutex_lock(&hostSiteLock);
+        if (!Site->registered)
+        {
+            Site->next = hostSites;
+            hostSites = Site;
+            Site->registered = 1;
+        }
+        pthread_mutex_unlock(&hostSiteLock);
+    }
+
+    __sync_fetch_and_add(&Site->count, 1ULL);
+}
+
+void hostEndFrame(void)
+{
+    ++hostSwaps;
+
+    unsigned long long * frame = (unsigned long long *)&hostFrame;
+    unsigned long long * total = (unsigned long long *)&hostTotal;
+    unsigned long long * max = (unsigned long long *)&hostMax;
+
+    for (unsigned int i = 0; i < HOST_FIELD_COUNT; ++i)
+    {
+        // Other threads (e.g. event polling) may count concurrently.
+        unsigned long long value = __atomic_exchange_n(&frame[i], 0ULL, __ATOMIC_RELAXED);
+        total[i] += value;
+        if (value > max[i])
+        {
+            max[i] = value;
+        }
+    }
+
+    ++hostFrames;
+}
+
+void hostGetFrameCounters(HostCounters * Frame)
+{
+    *Frame = hostFrame;
+}
+
+void hostGetTotalCounters(HostCounters * Total, HostCounters * Max, unsigned long long * Frames)
+{
+    if (Total != NULL)
+    {
+        *Total = hostTotal;
+    }
+    if (Max != NULL)
+    {
+        *Max = hostMax;
+    }
+    if (Frames != NULL)
+    {
+        *Frames = hostFrames;
+    }
+}
+
+void hostResetCounters(void)
+{
+    memset(&hostFrame, 0, sizeof(hostFrame));
+    memset(&hostTotal, 0, sizeof(hostTotal));
+    memset(&hostMax, 0, sizeof(hostMax));
+    hostFrames = 0;
+
+    pthread_mutex_lock(&hostSiteLock);
+    for (HostCallSite * site = hostSites; site != NULL; site = site->next)
+    {
+        site->count = 0;
+    }
+    pthread_mutex_unlock(&hostSiteLock);
+}
+
+void hostPrintReport(void)
+{
+    static const char * names[HOST_FIELD_COUNT] =
+    {
+        "gl calls",
+        "draw calls",
+        "state changes",
+        "redundant changes",
+        "uniform uploads",
+        "bytes uploaded",
+        "client array bytes",
+        "bytes read back",
+        "vdk/egl calls",
+        "events",
+    };
+
+    const unsigned long long * total = (const unsigned long long *)&hostTotal;
+    const unsigned long long * max = (const unsigned long long *)&hostMax;
+    double frames = (hostFrames > 0) ? (double)hostFrames : 1.0;
+
+    printf("host: %llu frames\n", hostFrames);
+    printf("host: %-20s %14s %12s %12s\n", "counter", "total", "per frame", "max frame");
+    for (unsigned int i = 0; i < HOST_FIELD_COUNT; ++i)
+    {
+        printf("host: %-20s %14llu %12.1f %12llu\n", names[i], total[i], total[i] / frames, max[i]);
+    }
+
+    // Most frequent entry points, insertion sort over the short site list.
+    HostCallSite * top[16];
+    int topCount = 0;
+
+    pthread_mutex_lock(&hostSiteLock);
+    for (HostCallSite * site = hostSites; site != NULL; site = site->next)
+    {
+        if (site->count == 0)
+        {
+            continue;
+        }
+
+        int i = (topCount < 16) ? topCount++ : 16;
+        while ((i > 0) && (top[i - 1]->count < site->count))
+        {
+            if (i < 16)
+            {
+                top[i] = top[i - 1];
+            }
+            --i;
+        }
+        if (i < 16)
+        {
+            top[i] = site;
+        }
+    }
+    pthread_mutex_unlock(&hostSiteLock);
+
+    printf("host: top entry points\n");
+    for (int i = 0; i < topCount; ++i)
+    {
+        printf("host:   %-28s %12llu %10.2f/frame\n", top[i]->name, top[i]->count, top[i]->count / frames);
+    }
+}
@@ -0,0 +1,47 @@
+/*
+ * Counters kept by the headless EGL/GLES2/VDK layer.
+ *
+ * Every stubbed entry point is counted. A frame ends at vdkSwapEGL(); the
+ * per-frame numbers are folded into the run totals there and the full
+ * report is printed by vdkFinishEGL().
+ */
+
+#ifndef HOST_COUNTERS_H
+#define HOST_COUNTERS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct _HostCounters
+{
+    unsigned long long glCalls;          // GL entry points called
+    unsigned long long drawCalls;        // glDrawArrays/glDrawElements
+    unsigned long long stateChanges;     // binds, enables, pointers, clear/blend/depth state
+    unsigned long long redundantChanges; // state changes that set the current value again
+    unsigned long long uniformUploads;   // glUniform* calls
+    unsigned long long bytesUploaded;    // buffer, texture and uniform data
+    unsigned long long bytesClientArray; // client-side vertex data copied at draw time
+    unsigned long long bytesReadBack;    // glReadPixels
+    unsigned long long vdkCalls;         // VDK/EGL entry points called
+    unsigned long long events;           // events returned by vdkGetEvent
+}
+HostCounters;
+
+// Counters of the frame in flight (since the last vdkSwapEGL).
+void hostGetFrameCounters(HostCounters * Frame);
+
+// Run totals, number of completed frames and the per-field maximum of any frame.
+void hostGetTotalCounters(HostCounters * Total, HostCounters * Max, unsigned long long * Frames);
+
+// Clears all counters, e.g. after warm-up.
+void hostResetCounters(void);
+
+// Prints the per-frame report and the most frequent entry points.
+void hostPrintReport(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HOST_COUNTERS_H */
@@ -0,0 +1,49 @@
+/*
+ * Shared bookkeeping of the headless EGL/GLES2/VDK layer.
+ */
+
+#ifndef HOST_INTERNAL_H
+#define HOST_INTERNAL_H
+
+#include "host_counters.h"
+
+// One per stubbed entry point, linked into a list on its first call.
+typedef struct _HostCallSite
+{
+    const char *            name;
+    unsigned long long      count;
+    struct _HostCallSite *  next;
+    int                     registered;
+}
+HostCallSite;
+
+extern HostCounters hostFrame;
+
+// Swaps since start, never reset; the surface's buffer age follows it.
+extern unsigned long long hostSwaps;
+
+void hostCountCall(HostCallSite * Site);
+void hostEndFrame(void);
+
+// Set by eglSwapInterval(); every swap then waits for that many vblanks of
+// an emulated 60 Hz display.
+extern int hostSwapInterval;
+void hostWaitVsync(void);
+
+// GL extension entry points for eglGetProcAddress(), NULL if unknown.
+void * hostGlProcAddress(const char * Name);
+
+// Counters may be bumped from the event and loader threads as well.
+#define HOST_ADD(field, value) __sync_fetch_and_add(&hostFrame.field, (unsigned long long)(value))
+
+#define HOST_GL_CALL(fn)                                                     \
+    static HostCallSite site_##fn = { #fn, 0, 0, 0 };                        \
+    hostCountCall(&site_##fn);                                               \
+    HOST_ADD(glCalls, 1)
+
+#define HOST_VDK_CALL(fn)                                                    \
+    static HostCallSite site_##fn = { #fn, 0, 0, 0 };                        \
+    hostCountCall(&site_##fn);                                               \
+    HOST_ADD(vdkCalls, 1)
+
+#endif /* HOST_INTERNAL_H */
@@ -0,0 +1,133 @@
+/*
+ * Headless VDK for host builds.
+ *
+ * vdkSetupEGL() hands out dummy EGL handles, vdkSwapEGL() closes a frame of
+ * the host counters and vdkFinishEGL() prints the counter report.
+ */
+
+#include <gc_vdk.h>
+#include "host_internal.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static int hostWindowTag = 0;
+
+static unsigned long long hostNs(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+int vdkSetupEGL(int X, int Y, int Width, int Height,
+                const EGLint * ConfigurationAttributes,
+                const EGLint * SurfaceAttributes,
+                const EGLint * ContextAttributes,
+                vdkEGL * Egl)
+{
+    HOST_VDK_CALL(vdkSetupEGL);
+    (void)X;
+    (void)Y;
+    (void)ConfigurationAttributes;
+    (void)SurfaceAttributes;
+    (void)ContextAttributes;
+
+    Egl->vdk        = (vdkPrivate)&hostWindowTag;
+    Egl->display    = (vdkDisplay)&hostWindowTag;
+    Egl->window     = (vdkWindow)&hostWindowTag;
+    Egl->eglDisplay = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    Egl->eglConfig  = (EGLConfig)&hostWindowTag;
+    Egl->eglSurface = (EGLSurface)&hostWindowTag;
+    Egl->eglContext = (EGLContext)&hostWindowTag;
+
+    printf("host: headless EGL %dx%d\n", (Width > 0) ? Width : 1920, (Height > 0) ? Height : 1080);
+    return 1;
+}
+
+int vdkSwapEGL(vdkEGL * Egl)
+{
+    HOST_VDK_CALL(vdkSwapEGL);
+    (void)Egl;
+
+    hostWaitVsync();
+    hostEndFrame();
+    return 1;
+}
+
+void vdkFinishEGL(vdkEGL * Egl)
+{
+    HOST_VDK_CALL(vdkFinishEGL);
+    (void)Egl;
+
+    hostPrintReport();
+}
+
+int vdkSetWindowTitle(vdkWindow Window, const char * Title)
+{
+    HOST_VDK_CALL(vdkSetWindowTitle);
+    (void)Window;
+    (void)Title;
+    return 1;
+}
+
+int vdkShowWindow(vdkWindow Window)
+{
+    HOST_VDK_CALL(vdkShowWindow);
+    (void)Window;
+    return 1;
+}
+
+int vdkHideWindow(vdkWindow Window)
+{
+    HOST_VDK_CALL(vdkHideWindow);
+    (void)Window;
+    return 1;
+}
+
+// No input device on the host. HOST_EVENT_RATE=<events per second> feeds
+// synthetic pointer motion instead, to load the event path.
+int vdkGetEvent(vdkWindow Window, vdkEvent * Event)
+{
+    HOST_VDK_CALL(vdkGetEvent);
+    (void)Window;
+
+    static int rate = -1;
+    static unsigned long long start = 0;
+    static unsigned long long sent = 0;
+
+    if (rate < 0)
+    {
+        const char * env = getenv("HOST_EVENT_RATE");
+        rate = (env != NULL) ? atoi(env) : 0;
+        start = hostNs();
+    }
+    if (rate <= 0)
+    {
+        return 0;
+    }
+
+    // Every event that is due by now, as a real device backlog would be.
+    unsigned long long due = (hostNs() - start) * rate / 1000000000ULL;
+    if (sent >= due)
+    {
+        return 0;
+    }
+
+    memset(Event, 0, sizeof(*Event));
+    Event->type = VDK_POINTER;
+    Event->data.pointer.x = (int)(sent % 1920);
+    Event->data.pointer.y = (int)(sent % 1080);
+    ++sent;
+
+    HOST_ADD(events, 1);
+    return 1;
+}
+
+unsigned int vdkGetTicks(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (unsigned int)(now.tv_sec * 1000u + now.tv_nsec / 1000000);
+}
@@ -0,0 +1,288 @@
+/*
+ * CPU image filters.
+ *
+ * Each filter is split into a row kernel over the pixels whose taps all lie
+ * inside the image, vectorised, and the border pixels done one at a time
+ * with clamped coordinates.
+ */
+
+#include "imagefilter.h"
+#include <stdlib.h>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define IMAGEFILTER_NEON 1
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define IMAGEFILTER_SSE 1
+#endif
+
+static int filterSimd = 1;
+
+static inline int clampIndex(int Index, int Count)
+{
+    return (Index < 0) ? 0 : ((Index >= Count) ? Count - 1 : Index);
+}
+
+#if IMAGEFILTER_SSE
+// Eight bytes widened to 16-bit lanes.
+static inline __m128i load8(const unsigned char * Src)
+{
+    return _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)Src), _mm_setzero_si128());
+}
+
+// (A + 4 B + 6 C + 4 D + E + 8) / 16 in 16-bit lanes.
+static inline __m128i blurLanes(__m128i A, __m128i B, __m128i C, __m128i D, __m128i E)
+{
+    __m128i sum = _mm_add_epi16(_mm_add_epi16(A, E), _mm_slli_epi16(_mm_add_epi16(B, D), 2));
+    sum = _mm_add_epi16(sum, _mm_add_epi16(_mm_slli_epi16(C, 2), _mm_slli_epi16(C, 1)));
+    return _mm_srli_epi16(_mm_add_epi16(sum, _mm_set1_epi16(8)), 4);
+}
+
+// Luma of four RGBA pixels, one per 32-bit lane.
+static inline __m128i grayLanes(__m128i Pixels)
+{
+    const __m128i mask = _mm_set1_epi32(0xFF);
+    __m128i r = _mm_and_si128(Pixels, mask);
+    __m128i g = _mm_and_si128(_mm_srli_epi32(Pixels, 8), mask);
+    __m128i b = _mm_and_si128(_mm_srli_epi32(Pixels, 16), mask);
+
+    // The products fit the low 16 bits of each lane, the high halves stay 0.
+    __m128i sum = _mm_add_epi32(_mm_mullo_epi16(r, _mm_set1_epi32(77)), _mm_mullo_epi16(g, _mm_set1_epi32(150)));
+    sum = _mm_add_epi32(sum, _mm_mullo_epi16(b, _mm_set1_epi32(29)));
+    return _mm_srli_epi32(_mm_add_epi32(sum, _mm_set1_epi32(128)), 8);
+}
+#endif
+
+/***************************************************************************************
+***************************************************************************************/
+
+static void grayRow(const unsigned char * Rgba, unsigned char * Dst, int Count)
+{
+    int i = 0;
+#if IMAGEFILTER_NEON
+    for (; filterSimd && (i + 16 <= Count); i += 16)
+    {
+        uint8x16x4_t pixels = vld4q_u8(Rgba + i * 4);
+        uint16x8_t low = vmull_u8(vget_low_u8(pixels.val[0]), vdup_n_u8(77));
+        low = vmlal_u8(low, vget_low_u8(pixels.val[1]), vdup_n_u8(150));
+        low = vmlal_u8(low, vget_low_u8(pixels.val[2]), vdup_n_u8(29));
+        uint16x8_t high = vmull_u8(vget_high_u8(pixels.val[0]), vdup_n_u8(77));
+        high = vmlal_u8(high, vget_high_u8(pixels.val[1]), vdup_n_u8(150));
+        high = vmlal_u8(high, vget_high_u8(pixels.val[2]), vdup_n_u8(29));
+        vst1q_u8(Dst + i, vcombine_u8(vrshrn_n_u16(low, 8), vrshrn_n_u16(high, 8)));
+    }
+#elif IMAGEFILTER_SSE
+    for (; filterSimd && (i + 16 <= Count); i += 16)
+    {
+        const __m128i * src = (const __m128i *)(Rgba + i * 4);
+        __m128i low = _mm_packs_epi32(grayLanes(_mm_loadu_si128(src + 0)), grayLanes(_mm_loadu_si128(src + 1)));
+        __m128i high = _mm_packs_epi32(grayLanes(_mm_loadu_si128(src + 2)), grayLanes(_mm_loadu_si128(src + 3)));
+        _mm_storeu_si128((__m128i *)(Dst + i), _mm_packus_epi16(low, high));
+    }
+#endif
+    for (; i < Count; ++i)
+    {
+        const unsigned char * p = Rgba + i * 4;
+        Dst[i] = (unsigned char)((77 * p[0] + 150 * p[1] + 29 * p[2] + 128) >> 8);
+    }
+}
+
+// Dst[i] from A[i] .. E[i], the five taps.
+static void blurRow(const unsigned char * A, const unsigned char * B, const unsigned char * C,
+                    const unsigned char * D, const unsigned char * E, unsigned char * Dst, int Count)
+{
+    int i = 0;
+#if IMAGEFILTER_NEON
+    for (; filterSimd && (i + 8 <= Count); i += 8)
+    {
+        uint16x8_t sum = vaddl_u8(vld1_u8(A + i), vld1_u8(E + i));
+        sum = vaddq_u16(sum, vshlq_n_u16(vaddl_u8(vld1_u8(B + i), vld1_u8(D + i)), 2));
+        sum = vmlal_u8(sum, vld1_u8(C + i), vdup_n_u8(6));
+        vst1_u8(Dst + i, vrshrn_n_u16(sum, 4));
+    }
+#elif IMAGEFILTER_SSE
+    const __m128i zero = _mm_setzero_si128();
+    for (; filterSimd && (i + 16 <= Count); i += 16)
+    {
+        __m128i a = _mm_loadu_si128((const __m128i *)(A + i));
+        __m128i b = _mm_loadu_si128((const __m128i *)(B + i));
+        __m128i c = _mm_loadu_si128((const __m128i *)(C + i));
+        __m128i d = _mm_loadu_si128((const __m128i *)(D + i));
+        __m128i e = _mm_loadu_si128((const __m128i *)(E + i));
+        __m128i low = blurLanes(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero), _mm_unpacklo_epi8(c, zero),
+                                _mm_unpacklo_epi8(d, zero), _mm_unpacklo_epi8(e, zero));
+        __m128i high = blurLanes(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero), _mm_unpackhi_epi8(c, zero),
+                                 _mm_unpackhi_epi8(d, zero), _mm_unpackhi_epi8(e, zero));
+        _mm_storeu_si128((__m128i *)(Dst + i), _mm_packus_epi16(low, high));
+    }
+#endif
+    for (; i < Count; ++i)
+    {
+        Dst[i] = (unsigned char)((A[i] + 4 * (B[i] + D[i]) + 6 * C[i] + E[i] + 8) >> 4);
+    }
+}
+
+// One blurred pixel of a row, taps clamped to the row.
+static inline unsigned char blurClamped(const unsigned char * Row, int X, int Width)
+{
+    return (unsigned char)((Row[clampIndex(X - 2, Width)] + 4 * Row[clampIndex(X - 1, Width)] + 6 * Row[X]
+                          + 4 * Row[clampIndex(X + 1, Width)] + Row[clampIndex(X + 2, Width)] + 8) >> 4);
+}
+
+// One Sobel pixel from the rows above, at and below, columns L, C and R.
+static inline unsigned char sobelPixel(const unsigned char * A, const unsigned char * M, const unsigned char * B,
+                                       int L, int C, int R)
+{
+    int gx = (A[R] + 2 * M[R] + B[R]) - (A[L] + 2 * M[L] + B[L]);
+    int gy = (B[L] + 2 * B[C] + B[R]) - (A[L] + 2 * A[C] + A[R]);
+    return (unsigned char)((abs(gx) + abs(gy)) >> 3);
+}
+
+// Dst[i] centred on column i + 1 of the three rows.
+static void sobelRow(const unsigned char * A, const unsigned char * M, const unsigned char * B,
+                     unsigned char * Dst, int Count)
+{
+    int i = 0;
+#if IMAGEFILTER_NEON
+    for (; filterSimd && (i + 8 <= Count); i += 8)
+    {
+        int16x8_t al = vreinterpretq_s16_u16(vmovl_u8(vld1_u8(A + i)));
+        int16x8_t ac = vreinterpretq_s16_u16(vmovl_u8(vld1_u8(A + i + 1)));
+        int16x8_t ar = vreinterpretq_s16_u16(vmovl_u8(vld1_u8(A + i + 2)));
+        int16x8_t ml = vreinterpretq_s16_u16(vmovl_u8(vld1_u8(M + i)));
+        int16x8_t mr = vreinterpretq_s16_u16(vmovl_u8(vld1_u8(M + i + 2)));
+        int16x8_t bl = vreinterpretq_s16_u16(vmovl_u8(vld1_u8(B + i)));
+        int16x8_t bc = vreinterpretq_s16_u16(vmovl_u8(vld1_u8(B + i + 1)));
+        int16x8_t br = vreinterpretq_s16_u16(vmovl_u8(vld1_u8(B + i + 2)));
+        int16x8_t gx = vsubq_s16(vaddq_s16(vaddq_s16(ar, br), vshlq_n_s16(mr, 1)),
+                                 vaddq_s16(vaddq_s16(al, bl), vshlq_n_s16(ml, 1)));
+        int16x8_t gy = vsubq_s16(vaddq_s16(vaddq_s16(bl, br), vshlq_n_s16(bc, 1)),
+                                 vaddq_s16(vaddq_s16(al, ar), vshlq_n_s16(ac, 1)));
+        uint16x8_t sum = vreinterpretq_u16_s16(vaddq_s16(vabsq_s16(gx), vabsq_s16(gy)));
+        vst1_u8(Dst + i, vshrn_n_u16(sum, 3));
+    }
+#elif IMAGEFILTER_SSE
+    const __m128i zero = _mm_setzero_si128();
+    for (; filterSimd && (i + 8 <= Count); i += 8)
+    {
+        __m128i al = load8(A + i), ac = load8(A + i + 1), ar = load8(A + i + 2);
+        __m128i ml = load8(M + i), mr = load8(M + i + 2);
+        __m128i bl = load8(B + i), bc = load8(B + i + 1), br = load8(B + i + 2);
+        __m128i gx = _mm_sub_epi16(_mm_add_epi16(_mm_add_epi16(ar, br), _mm_slli_epi16(mr, 1)),
+                                   _mm_add_epi16(_mm_add_epi16(al, bl), _mm_slli_epi16(ml, 1)));
+        __m128i gy = _mm_sub_epi16(_mm_add_epi16(_mm_add_epi16(bl, br), _mm_slli_epi16(bc, 1)),
+                                   _mm_add_epi16(_mm_add_epi16(al, ar), _mm_slli_epi16(ac, 1)));
+        // SSE2 has no abs: max(x, -x).
+        gx = _mm_max_epi16(gx, _mm_sub_epi16(zero, gx));
+        gy = _mm_max_epi16(gy, _mm_sub_epi16(zero, gy));
+        __m128i sum = _mm_srli_epi16(_mm_add_epi16(gx, gy), 3);
+        _mm_storel_epi64((__m128i *)(Dst + i), _mm_packus_epi16(sum, sum));
+    }
+#endif
+    for (; i < Count; ++i)
+    {
+        Dst[i] = sobelPixel(A + i, M + i, B + i, 0, 1, 2);
+    }
+}
+
+// Dst[i] from the 2x2 block at column 2 i of rows A and B.
+static void downRow(const unsigned char * A, const unsigned char * B, unsigned char * Dst, int Count)
+{
+    int i = 0;
+#if IMAGEFILTER_NEON
+    for (; filterSimd && (i + 8 <= Count); i += 8)
+    {
+        uint16x8_t sum = vaddq_u16(vpaddlq_u8(vld1q_u8(A + i * 2)), vpaddlq_u8(vld1q_u8(B + i * 2)));
+        vst1_u8(Dst + i, vrshrn_n_u16(sum, 2));
+    }
+#elif IMAGEFILTER_SSE
+    const __m128i mask = _mm_set1_epi16(0xFF);
+    for (; filterSimd && (i + 8 <= Count); i += 8)
+    {
+        __m128i a = _mm_loadu_si128((const __m128i *)(A + i * 2));
+        __m128i b = _mm_loadu_si128((const __m128i *)(B + i * 2));
+        __m128i sum = _mm_add_epi16(_mm_add_epi16(_mm_and_si128(a, mask), _mm_srli_epi16(a, 8)),
+                                    _mm_add_epi16(_mm_and_si128(b, mask), _mm_srli_epi16(b, 8)));
+        sum = _mm_srli_epi16(_mm_add_epi16(sum, _mm_set1_epi16(2)), 2);
+        _mm_storel_epi64((__m128i *)(Dst + i), _mm_packus_epi16(sum, sum));
+    }
+#endif
+    for (; i < Count; ++i)
+    {
+        Dst[i] = (unsigned char)((A[i * 2] + A[i * 2 + 1] + B[i * 2] + B[i * 2 + 1] + 2) >> 2);
+    }
+}
+
+/***************************************************************************************
+***************************************************************************************/
+
+void ImageFilterSetSimd(int Enabled)
+{
+    filterSimd = Enabled;
+}
+
+void ImageGray(const unsigned char * Rgba, int Width, int Height, unsigned char * Dst)
+{
+    // Rows are packed: the image is one long row.
+    grayRow(Rgba, Dst, Width * Height);
+}
+
+void ImageBlurH(const unsigned char * Src, int Width, int Height, unsigned char * Dst)
+{
+    for (int y = 0; y < Height; ++y)
+    {
+        const unsigned char * row = Src + y * Width;
+        unsigned char * out = Dst + y * Width;
+
+        // Columns 2 .. Width - 3 have all five taps inside.
+        int inner = (Width > 4) ? Width - 4 : 0;
+        blurRow(row, row + 1, row + 2, row + 3, row + 4, out + 2, inner);
+
+        for (int x = 0; (x < 2) && (x < Width); ++x)
+        {
+            out[x] = blurClamped(row, x, Width);
+        }
+        for (int x = (inner > 0) ? Width - 2 : 2; x < Width; ++x)
+        {
+            out[x] = blurClamped(row, x, Width);
+        }
+    }
+}
+
+void ImageBlurV(const unsigned char * Src, int Width, int Height, unsigned char * Dst)
+{
+    for (int y = 0; y < Height; ++y)
+    {
+        blurRow(Src + clampIndex(y - 2, Height) * Width, Src + clampIndex(y - 1, Height) * Width,
+                Src + y * Width, Src + clampIndex(y + 1, Height) * Width,
+                Src + clampIndex(y + 2, Height) * Width, Dst + y * Width, Width);
+    }
+}
+
+void ImageSobel(const unsigned char * Src, int Width, int Height, unsigned char * Dst)
+{
+    for (int y = 0; y < Height; ++y)
+    {
+        const unsigned char * above = Src + clampIndex(y - 1, Height) * Width;
+        const unsigned char * row = Src + y * Width;
+        const unsigned char * below = Src + clampIndex(y + 1, Height) * Width;
+        unsigned char * out = Dst + y * Width;
+
+        if (Width > 2)
+        {
+            sobelRow(above, row, below, out + 1, Width - 2);
+        }
+        out[0] = sobelPixel(above, row, below, 0, 0, clampIndex(1, Width));
+        out[Width - 1] = sobelPixel(above, row, below, clampIndex(Width - 2, Width), Width - 1, Width - 1);
+    }
+}
+
+void ImageDownsample(const unsigned char * Src, int Width, int Height, unsigned char * Dst)
+{
+    int width = Width / 2;
+    for (int y = 0; y < Height / 2; ++y)
+    {
+        downRow(Src + y * 2 * Width, Src + (y * 2 + 1) * Width, Dst + y * width, width);
+    }
+}
@@ -0,0 +1,32 @@
+/*
+ * CPU image filters.
+ *
+ * The references of the GPU image pipeline (imagepipe.h), one function per
+ * filter step, with NEON or SSE2 kernels and plain C for the borders and
+ * for comparison. Images are 8-bit luma with rows of exactly Width bytes,
+ * except the RGBA input of ImageGray(); pixels outside the image repeat
+ * the edge, like GL_CLAMP_TO_EDGE. Integer arithmetic throughout, rounded
+ * to nearest, so the vector and scalar paths give identical results.
+ */
+
+#ifndef IMAGEFILTER_H
+#define IMAGEFILTER_H
+
+// Vector kernels off runs the scalar code everywhere, for comparison.
+void ImageFilterSetSimd(int Enabled);
+
+// BT.601 luma: (77 R + 150 G + 29 B) / 256.
+void ImageGray(const unsigned char * Rgba, int Width, int Height, unsigned char * Dst);
+
+// Binomial 5-tap Gaussian [1 4 6 4 1] / 16 along rows or columns.
+void ImageBlurH(const unsigned char * Src, int Width, int Height, unsigned char * Dst);
+void ImageBlurV(const unsigned char * Src, int Width, int Height, unsigned char * Dst);
+
+// Sobel gradient magnitude (|gx| + |gy|) / 8 rounded down, which spans 0 .. 255.
+void ImageSobel(const unsigned char * Src, int Width, int Height, unsigned char * Dst);
+
+// One pyramid level: Dst is Width / 2 x Height / 2, each pixel the mean of
+// a 2x2 block.
+void ImageDownsample(const unsigned char * Src, int Width, int Height, unsigned char * Dst);
+
+#endif /* IMAGEFILTER_H */
@@ -0,0 +1,450 @@
+/*
+ * Image processing on the GPU.
+ *
+ * The steps are expanded into pipePasses once at init; a pass holds its
+ * program variant, the tap uniform for its input size and its output
+ * size. pipeResult is the pool entry of the last run's output.
+ */
+
+#include "imagepipe.h"
+#include "framestats.h"
+#include "glstate.h"
+#include "shaderprogram.h"
+#include <GLES2/gl2.h>
+#include "gltrace.h"
+#include <stdio.h>
+#include <string.h>
+
+#define IMAGE_POOL_SIZE     8
+
+enum
+{
+    PASS_COPY,
+    PASS_BLUR_H,
+    PASS_BLUR_V,
+    PASS_SOBEL,
+};
+
+typedef struct _ImagePass
+{
+    int             kind;
+    int             gray;       // converts its input to luma while sampling
+    int             half;       // output of half size, 2x2 means of the input
+    int             width;      // of the output
+    int             height;
+    GLuint          program;
+    GLint           locVertex;
+    GLint           locTap;
+    GLfloat         tap[4];
+    ImagePassStats  stats;
+}
+ImagePass;
+
+typedef struct _PoolEntry
+{
+    GLuint  texture;
+    GLuint  framebuffer;
+    int     width;
+    int     height;
+    int     busy;
+}
+PoolEntry;
+
+// Full-viewport strip: xy position, zw texture coordinate.
+static const GLfloat pipeQuad[16] =
+{
+    -1.0f, -1.0f, 0.0f, 0.0f,
+     1.0f, -1.0f, 1.0f, 0.0f,
+    -1.0f,  1.0f, 0.0f, 1.0f,
+     1.0f,  1.0f, 1.0f, 1.0f,
+};
+
+static const char * const pipeKindNames[] = { "copy", "blur-h", "blur-v", "sobel" };
+
+static ImagePass pipePasses[IMAGE_MAX_PASSES];
+static int pipePassCount = 0;
+static PoolEntry pipePool[IMAGE_POOL_SIZE];
+static int pipeResult = -1;
+static int pipeWidth = 0;       // of the source
+static int pipeHeight = 0;
+static GLuint pipeVbo = 0;
+
+// One per kind and gray input; the two blur passes share theirs.
+static GLuint pipePrograms[4][2];
+
+/***************************************************************************************
+***************************************************************************************/
+
+static GLuint pipeProgram(int Kind, int Gray)
+{
+    if (Kind == PASS_BLUR_V)
+    {
+        Kind = PASS_BLUR_H;
+    }
+    if (pipePrograms[Kind][Gray] == 0)
+    {
+        char defines[128];
+        snprintf(defines, sizeof(defines), "%s%s",
+                 (Kind == PASS_BLUR_H) ? "#define IMAGE_BLUR 1\n" :
+                 (Kind == PASS_SOBEL) ? "#define IMAGE_SOBEL 1\n" : "",
+                 Gray ? "#define IMAGE_GRAY_INPUT 1\n" : "");
+        pipePrograms[Kind][Gray] = ShaderProgramLoad("imagepipe.vert", "imagepipe.frag", defines, NULL);
+    }
+    return pipePrograms[Kind][Gray];
+}
+
+// Appends a pass reading an InWidth x InHeight input.
+// returns the pass, or NULL when there are too many
+static ImagePass * pipeAdd(int Kind, int Gray, int InWidth, int InHeight)
+{
+    if (pipePassCount == IMAGE_MAX_PASSES)
+    {
+        fprintf(stderr, "Image pipeline has more than %d passes.\n", IMAGE_MAX_PASSES);
+        return NULL;
+    }
+    ImagePass * pass = &pipePasses[pipePassCount++];
+    memset(pass, 0, sizeof(*pass));
+    pass->kind = Kind;
+    pass->gray = Gray;
+    pass->width = InWidth;
+    pass->height = InHeight;
+    return pass;
+}
+
+// The tap uniform depends on the input size and, for the vertical blur, on
+// whether it also downsamples.
+static void pipeSetTap(ImagePass * Pass, int InWidth, int InHeight)
+{
+    GLfloat * tap = Pass->tap;
+    switch (Pass->kind)
+    {
+    case PASS_BLUR_H:
+    case PASS_BLUR_V:
+        {
+            // [1 4 6 4 1] / 16: center 6/16, the 4 and 1 together 5/16 at
+            // 1.2 texels. Sampled between two rows, the 2x2 mean of the
+            // blur is [1 5 10 10 5 1] / 32: 20/32 from the center tap, 6/32
+            // at 5/3 texels from it on each side.
+            int down = Pass->half && (Pass->kind == PASS_BLUR_V);
+            GLfloat offset = down ? 5.0f / 3.0f : 1.2f;
+            tap[0] = (Pass->kind == PASS_BLUR_H) ? offset / InWidth : 0.0f;
+            tap[1] = (Pass->kind == PASS_BLUR_V) ? offset / InHeight : 0.0f;
+            tap[2] = down ? 0.625f : 0.375f;
+            tap[3] = down ? 0.1875f : 0.3125f;
+        }
+        break;
+    case PASS_SOBEL:
+        tap[0] = 1.0f / InWidth;
+        tap[1] = 1.0f / InHeight;
+        break;
+    }
+}
+
+static void pipeName(ImagePass * Pass)
+{
+    char * name = Pass->stats.name;
+    size_t size = sizeof(Pass->stats.name);
+    if (Pass->kind == PASS_COPY)
+    {
+        // A copy is only there for the steps it carries.
+        snprintf(name, size, "%s", Pass->gray ? (Pass->half ? "gray+down" : "gray") : (Pass->half ? "down" : "copy"));
+    }
+    else
+    {
+        snprintf(name, size, "%s%s%s", Pass->gray ? "gray+" : "", pipeKindNames[Pass->kind], Pass->half ? "+down" : "");
+    }
+}
+
+// returns the index of a free Width x Height pool entry, or -1
+static int pipeAcquire(int Width, int Height)
+{
+    int empty = -1;
+    for (int i = 0; i < IMAGE_POOL_SIZE; ++i)
+    {
+        PoolEntry * entry = &pipePool[i];
+        if (entry->texture == 0)
+        {
+            if (empty < 0)
+            {
+                empty = i;
+            }
+        }
+        else if (!entry->busy && (entry->width == Width) && (entry->height == Height))
+        {
+            entry->busy = 1;
+            return i;
+        }
+    }
+    if (empty < 0)
+    {
+        fprintf(stderr, "Image pipeline texture pool is exhausted.\n");
+        return -1;
+    }
+
+    PoolEntry * entry = &pipePool[empty];
+    glGenTextures(1, &entry->texture);
+    glBindTexture(GL_TEXTURE_2D, entry->texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, Width, Height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+
+    glGenFramebuffers(1, &entry->framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, entry->framebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, entry->texture, 0);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+    {
+        fprintf(stderr, "Image pipeline framebuffer %dx%d is incomplete.\n", Width, Height);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glDeleteFramebuffers(1, &entry->framebuffer);
+        glDeleteTextures(1, &entry->texture);
+        memset(entry, 0, sizeof(*entry));
+        return -1;
+    }
+    entry->width = Width;
+    entry->height = Height;
+    entry->busy = 1;
+    return empty;
+}
+
+static void pipeRelease(int Entry)
+{
+    if (Entry >= 0)
+    {
+        pipePool[Entry].busy = 0;
+    }
+}
+
+/***************************************************************************************
+***************************************************************************************/
+
+int ImagePipeInit(const int * Ops, int Count, int Width, int Height, int Fuse)
+{
+    ImagePipeDestroy();
+    pipeWidth = Width;
+    pipeHeight = Height;
+
+    // The input size of the next pass; gray is a conversion waiting for
+    // the pass that samples it.
+    int width = Width;
+    int height = Height;
+    int gray = 0;
+    int ok = 1;
+    for (int i = 0; ok && (i < Count); ++i)
+    {
+        ImagePass * last = (pipePassCount > 0) ? &pipePasses[pipePassCount - 1] : NULL;
+        ImagePass * pass = NULL;
+        switch (Ops[i])
+        {
+        case IMAGE_OP_GRAY:
+            if (Fuse)
+            {
+                gray = 1;
+                continue;
+            }
+            pass = pipeAdd(PASS_COPY, 1, width, height);
+            break;
+        case IMAGE_OP_BLUR:
+            pass = pipeAdd(PASS_BLUR_H, gray, width, height);
+            if (pass != NULL)
+            {
+                pass = pipeAdd(PASS_BLUR_V, 0, width, height);
+            }
+            break;
+        case IMAGE_OP_SOBEL:
+            pass = pipeAdd(PASS_SOBEL, gray, width, height);
+            break;
+        case IMAGE_OP_DOWNSAMPLE:
+            // Sampling a linear pass's input at block corners gives the
+            // 2x2 mean of its output.
+            if (Fuse && !gray && (last != NULL) && !last->half &&
+                ((last->kind == PASS_COPY) || (last->kind == PASS_BLUR_V)))
+            {
+                pass = last;
+            }
+            else
+            {
+                pass = pipeAdd(PASS_COPY, gray, width, height);
+            }
+            if (pass != NULL)
+            {
+                pass->half = 1;
+                pass->width = width / 2;
+                pass->height = height / 2;
+            }
+            break;
+        default:
+            fprintf(stderr, "Unknown image operation %d.\n", Ops[i]);
+            break;
+        }
+        ok = (pass != NULL);
+        if (ok)
+        {
+            width = pass->width;
+            height = pass->height;
+        }
+        gray = 0;
+    }
+    if (ok && gray)
+    {
+        ok = (pipeAdd(PASS_COPY, 1, width, height) != NULL);
+    }
+    if (!ok)
+    {
+        ImagePipeDestroy();
+        return 0;
+    }
+
+    // Taps need each pass's input size, which is the output of the one
+    // before.
+    width = Width;
+    height = Height;
+    for (int i = 0; i < pipePassCount; ++i)
+    {
+        ImagePass * pass = &pipePasses[i];
+        pass->program = pipeProgram(pass->kind, pass->gray);
+        if (pass->program == 0)
+        {
+            ImagePipeDestroy();
+            return 0;
+        }
+        pass->locVertex = glGetAttribLocation(pass->program, "my_Vertex");
+        pass->locTap = glGetUniformLocation(pass->program, "my_Tap");
+        GlStateUseProgram(pass->program);
+        GlStateUniform1i(glGetUniformLocation(pass->program, "my_Texture"), 0);
+        pipeSetTap(pass, width, height);
+        pipeName(pass);
+        pass->stats.width = pass->width;
+        pass->stats.height = pass->height;
+        width = pass->width;
+        height = pass->height;
+    }
+
+    glGenBuffers(1, &pipeVbo);
+    GlStateBindBuffer(GL_ARRAY_BUFFER, pipeVbo);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(pipeQuad), pipeQuad, GL_STATIC_DRAW);
+    return 1;
+}
+
+void ImagePipeDestroy(void)
+{
+    for (int i = 0; i < IMAGE_POOL_SIZE; ++i)
+    {
+        PoolEntry * entry = &pipePool[i];
+        if (entry->framebuffer != 0)
+        {
+            glDeleteFramebuffers(1, &entry->framebuffer);
+        }
+        if (entry->texture != 0)
+        {
+            glDeleteTextures(1, &entry->texture);
+        }
+    }
+    memset(pipePool, 0, sizeof(pipePool));
+    pipeResult = -1;
+
+    for (int i = 0; i < 4; ++i)
+    {
+        for (int j = 0; j < 2; ++j)
+        {
+            if (pipePrograms[i][j] != 0)
+            {
+                GlStateDeleteProgram(pipePrograms[i][j]);
+                pipePrograms[i][j] = 0;
+            }
+        }
+    }
+    if (pipeVbo != 0)
+    {
+        GlStateDeleteBuffers(1, &pipeVbo);
+        pipeVbo = 0;
+    }
+    pipePassCount = 0;
+}
+
+GLuint ImagePipeRun(GLuint Source, int Finish)
+{
+    pipeRelease(pipeResult);
+    pipeResult = -1;
+
+    glBindTexture(GL_TEXTURE_2D, Source);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    GlStateDisable(GL_SCISSOR_TEST);
+    GlStateDisable(GL_BLEND);
+    GlStateBindBuffer(GL_ARRAY_BUFFER, pipeVbo);
+
+    GLuint input = Source;
+    int inputEntry = -1;
+    for (int i = 0; i < pipePassCount; ++i)
+    {
+        ImagePass * pass = &pipePasses[i];
+        unsigned long long start = FrameStatsNs();
+
+        int output = pipeAcquire(pass->width, pass->height);
+        if (output < 0)
+        {
+            pipeRelease(inputEntry);
+            glBindFramebuffer(GL_FRAMEBUFFER, 0);
+            return 0;
+        }
+        glBindFramebuffer(GL_FRAMEBUFFER, pipePool[output].framebuffer);
+        glViewport(0, 0, pass->width, pass->height);
+        GlStateUseProgram(pass->program);
+        if (pass->locTap >= 0)
+        {
+            GlStateUniform4fv(pass->locTap, 1, pass->tap);
+        }
+        glBindTexture(GL_TEXTURE_2D, input);
+        GlStateEnableAttrib(pass->locVertex);
+        GlStateAttribPointer(pass->locVertex, 4, GL_FLOAT, GL_FALSE, 0, 0);
+        glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+        GlStateDisableAttrib(pass->locVertex);
+        if (Finish)
+        {
+            glFinish();
+        }
+
+        // The draw is queued; the driver keeps the texture alive until it
+        // has run, so the next pass may render into it.
+        pipeRelease(inputEntry);
+        inputEntry = output;
+        input = pipePool[output].texture;
+
+        pass->stats.ms += (FrameStatsNs() - start) / 1e6;
+        ++pass->stats.runs;
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    pipeResult = inputEntry;
+    return (pipeResult >= 0) ? input : Source;
+}
+
+int ImagePipeGetPassCount(void)
+{
+    return pipePassCount;
+}
+
+void ImagePipeGetPassStats(int Pass, ImagePassStats * Stats)
+{
+    *Stats = pipePasses[Pass].stats;
+}
+
+void ImagePipeGetOutputSize(int * Width, int * Height)
+{
+    *Width = (pipePassCount > 0) ? pipePasses[pipePassCount - 1].width : pipeWidth;
+    *Height = (pipePassCount > 0) ? pipePasses[pipePassCount - 1].height : pipeHeight;
+}
+
+int ImagePipeGetPoolSize(void)
+{
+    int count = 0;
+    for (int i = 0; i < IMAGE_POOL_SIZE; ++i)
+    {
+        count += (pipePool[i].texture != 0);
+    }
+    return count;
+}
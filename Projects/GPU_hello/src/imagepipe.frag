@@ -0,0 +1,48 @@
+// Texture coordinates of 1280-texel images need more than mediump.
+#ifdef GL_FRAGMENT_PRECISION_HIGH
+precision highp float;
+#else
+precision mediump float;
+#endif
+
+// One pass of the image pipeline; the variant is picked with defines:
+// IMAGE_BLUR or IMAGE_SOBEL (a plain copy otherwise), and IMAGE_GRAY_INPUT
+// to convert the input to luma as it is sampled.
+uniform sampler2D my_Texture;
+uniform vec4 my_Tap;	// blur: tap offset, center and side weight; sobel: one texel
+
+varying vec2 texCoord;
+
+vec4 fetch(vec2 coord)
+{
+#ifdef IMAGE_GRAY_INPUT
+	float y = dot(texture2D(my_Texture, coord).rgb, vec3(0.299, 0.587, 0.114));
+	return vec4(y, y, y, 1.0);
+#else
+	return texture2D(my_Texture, coord);
+#endif
+}
+
+void main (void)
+{
+#if defined(IMAGE_BLUR)
+	// Two bilinear taps each cover a pair of the binomial weights.
+	gl_FragColor = fetch(texCoord) * my_Tap.z
+	             + (fetch(texCoord - my_Tap.xy) + fetch(texCoord + my_Tap.xy)) * my_Tap.w;
+#elif defined(IMAGE_SOBEL)
+	float tl = fetch(texCoord + vec2(-my_Tap.x, -my_Tap.y)).r;
+	float t  = fetch(texCoord + vec2(0.0, -my_Tap.y)).r;
+	float tr = fetch(texCoord + vec2(my_Tap.x, -my_Tap.y)).r;
+	float l  = fetch(texCoord + vec2(-my_Tap.x, 0.0)).r;
+	float r  = fetch(texCoord + vec2(my_Tap.x, 0.0)).r;
+	float bl = fetch(texCoord + vec2(-my_Tap.x, my_Tap.y)).r;
+	float b  = fetch(texCoord + vec2(0.0, my_Tap.y)).r;
+	float br = fetch(texCoord + vec2(my_Tap.x, my_Tap.y)).r;
+	float gx = (tr + 2.0 * r + br) - (tl + 2.0 * l + bl);
+	float gy = (bl + 2.0 * b + br) - (tl + 2.0 * t + tr);
+	float m = (abs(gx) + abs(gy)) * 0.125;
+	gl_FragColor = vec4(m, m, m, 1.0);
+#else
+	gl_FragColor = fetch(texCoord);
+#endif
+}
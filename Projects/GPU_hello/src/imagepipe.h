@@ -0,0 +1,68 @@
+/*
+ * Image processing on the GPU.
+ *
+ * A chain of filter steps runs as fragment shader passes, each drawing a
+ * full-size quad into a texture-backed framebuffer and sampling the output
+ * of the pass before it (ping-pong). The textures come from a small pool
+ * keyed by size, so a chain needs only as many as are alive at once: the
+ * input of a pass goes back to the pool as soon as the pass is drawn.
+ *
+ * With fusion, neighbouring steps share a pass where the result is the
+ * same: a gray conversion becomes part of the next pass's texture fetch,
+ * and a downsample after a linear pass (copy, vertical blur) samples that
+ * pass at the corners of 2x2 blocks, where bilinear filtering averages
+ * them. The blur uses two bilinear taps per side pair of the 5-tap
+ * binomial kernel, so it costs three fetches per direction.
+ *
+ * imagefilter.h has the same steps on the CPU. Images are RGBA8; sizes
+ * should be even at every downsample.
+ */
+
+#ifndef IMAGEPIPE_H
+#define IMAGEPIPE_H
+
+#include <GLES2/gl2.h>
+
+#define IMAGE_MAX_PASSES    16
+
+enum
+{
+    IMAGE_OP_GRAY,          // BT.601 luma into r, g and b
+    IMAGE_OP_BLUR,          // 5-tap Gaussian, horizontal and vertical pass
+    IMAGE_OP_SOBEL,         // gradient magnitude of r
+    IMAGE_OP_DOWNSAMPLE,    // half size, 2x2 mean
+};
+
+typedef struct _ImagePassStats
+{
+    char                name[32];   // the steps of the pass, e.g. "gray+blur-h"
+    int                 width;      // of its output
+    int                 height;
+    unsigned long long  runs;
+    double              ms;         // GPU time when run with Finish, else submission
+}
+ImagePassStats;
+
+// Builds the passes for Count steps on a Width x Height source. Fuse == 0
+// gives every step its own passes. Needs a current context.
+// returns 0: fail
+//         1: success
+int ImagePipeInit(const int * Ops, int Count, int Width, int Height, int Fuse);
+void ImagePipeDestroy(void);
+
+// Runs the chain on the RGBA texture Source, whose filtering it sets to
+// linear. The result stays valid until the next run. Finish waits for each
+// pass (glFinish()) so the pass times are GPU times. Leaves framebuffer 0
+// bound, the viewport at the last pass's size, and scissor and blending
+// disabled.
+// returns the result texture, or 0 if the pool ran out
+GLuint ImagePipeRun(GLuint Source, int Finish);
+
+int ImagePipeGetPassCount(void);
+void ImagePipeGetPassStats(int Pass, ImagePassStats * Stats);
+void ImagePipeGetOutputSize(int * Width, int * Height);
+
+// Textures the pool has allocated.
+int ImagePipeGetPoolSize(void);
+
+#endif /* IMAGEPIPE_H */
@@ -35,9 +35,61 @@
 #include <gc_vdk.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <unistd.h>
 #include <math.h>
+#include "arena.h"
+#include "batch.h"
+#include "bench.h"
+#include "camerasource.h"
+#include "cull.h"
+#include "damage.h"
+#include "eventthread.h"
+#include "framepacer.h"
+#include "framestats.h"
+#include "framewriter.h"
+#include "glstate.h"
+#include "meshfile.h"
+#include "offscreen.h"
+#include "programcache.h"
+#include "renderqueue.h"
+#include "scenario.h"
+#include "scene.h"
+#include "shaderprogram.h"
+#include "shadersource.h"
+#include "shadervariant.h"
+#include "streambuffer.h"
+#include "simulation.h"
+#include "startup.h"
+#include "swrast.h"
+#include "texstream.h"
+#include "vecmath.h"
+#include "vertexbuffer.h"
+#include "gltrace.h"
 
 #define TUTORIAL_NAME "OpenGL ES 2.0 Tutorial 1"
+
+// Idle waits: a paused demo only needs input, a still one checks again
+// every frame period.
+#define IDLE_PAUSED_MS  100
+#define IDLE_FRAME_MS   16
+
+// Frames the dump writer may queue before rendering waits for it.
+#define DUMP_BUFFERS    4
+
+// Synthetic camera of -z: 720p at 30 fps, four buffers in the ring.
+#define CAMERA_WIDTH    1280
+#define CAMERA_HEIGHT   720
+#define CAMERA_RATE     30
+#define CAMERA_BUFFERS  4
+
+// Per-frame geometry is streamed through three 1 MB buffers.
+#define STREAM_BYTES    (1 << 20)
+#define STREAM_BUFFERS  3
+
+// Frame arena, on top of the culling output of every object.
+#define FRAME_ARENA_BYTES   (256 << 10)
 // to hold vdk information.
 vdkEGL egl;
 int width  = 0;
@@ -46,20 +98,51 @@ int posX   = -1;
 int posY   = -1;
 int samples = 0;
 int frames = 0;
+int renderer = 0;
+int objects = 1;
+int threads = 0;
+const char * goldenFName = NULL;
+int warmupFrames = 0;
+const char * statsFName = NULL;
+int vertexFormat = VERTEX_FORMAT_FLOAT;
+const char * cacheDir = "none";
+const char * shaderDir = NULL;
+const char * benchName = NULL;
+int simulationThread = 1;
+const char * traceFName = NULL;
+int stateFilter = 1;
+int idleAware = 1;
+int animatedObjects = -1;
+int targetRate = 60;
+int latePolicy = FRAME_PACE_DROP;
+const char * dumpTarget = NULL;
+int readbackDepth = 3;
+const char * cameraSpec = NULL;
+int camera = 0;
+int batchMode = BATCH_PALETTE;
+int streamMode = STREAM_ORPHAN;
+const char * meshFName = NULL;
+int cullThreads = 1;
+int parallelStartup = 1;
+const char * scenarioFName = NULL;
+const char * baselineFName = NULL;
+
+// Renderers selected with -r.
+#define RENDERER_GLES2  0
+#define RENDERER_CPU    1
 
 // Global Variables, attribute and uniform
 GLint locVertices     = 0;
 GLint locColors       = 0;
 GLint locTransformMat = 0;
 
-// Global Variables, shader handle and program handle
-GLuint vertShaderNum  = 0;
-GLuint pixelShaderNum = 0;
+// Global Variables, program handle: the program of triangleVariant.
 GLuint programHandle  = 0;
+const ShaderVariant * triangleVariant = NULL;
 
-int argCount = 6;
+int argCount = 33;
 char argSpec = '-';
-char argNames[] = {'x', 'y', 'w', 'h', 's', 'f'};
+char argNames[] = {'x', 'y', 'w', 'h', 's', 'f', 'r', 'n', 't', 'g', 'u', 'o', 'v', 'c', 'd', 'b', 'm', 'p', 'e', 'i', 'a', 'k', 'l', 'j', 'q', 'z', 'B', 'S', 'M', 'T', 'P', 'R', 'Q'};
 char argValues[][255] = {
     "x_coord",
     "y_coord",
@@ -67,6 +150,33 @@ char argValues[][255] = {
     "height",
     "samples",
     "frames",
+    "renderer",
+    "objects",
+    "threads",
+    "ppm_file",
+    "warmup",
+    "stats_file",
+    "vertex_format",
+    "cache_dir",
+    "shader_dir",
+    "benchmark",
+    "sim_thread",
+    "trace_file",
+    "state_filter",
+    "idle_aware",
+    "animated",
+    "target_hz",
+    "late_policy",
+    "dump_target",
+    "readbacks",
+    "camera",
+    "batch",
+    "stream_mode",
+    "mesh_file",
+    "cull_threads",
+    "parallel_startup",
+    "scenario_file",
+    "baseline_file",
 };
 char argDescs[][255] = {
     "x coordinate of the window, default is -1(screen center)",
@@ -75,6 +185,33 @@ char argDescs[][255] = {
     "height of the window in pixels, default is 0(fullscreen)",
     "sample count for MSAA, 0/2/4, default is 0 (no MSAA)",
     "frames to run, default is 0 (no frame limit, escape to exit)",
+    "renderer, 0 = GLES2, 1 = CPU rasterizer, default is 0 (CPU if EGL fails)",
+    "number of triangles in the scene, default is 1",
+    "CPU rasterizer threads, default is 0 (one per core)",
+    "write the last CPU rendered frame to a PPM file (golden reference)",
+    "warm-up frames left out of the frame statistics, default is 0",
+    "write frame statistics to a file, .csv for CSV, JSON otherwise",
+    "0 = client arrays, 1 = VBO float, 2 = VBO half float, 3 = VBO short, default is 1",
+    "program binary cache directory, default is none (no cache)",
+    "load shaders from this directory instead of the embedded copies",
+    "run a microbenchmark and exit (math, upload, filters, batch, queue, cull, arena, shaders)",
+    "1 = scene simulation on its own thread at a fixed timestep, 0 = one step per frame on the render thread, default is 1",
+    "record the GL command stream to a trace file for GPU_replay",
+    "1 = skip redundant GL state changes, 0 = issue every call, default is 1",
+    "1 = skip unchanged frames, repaint and swap only the damage, default is 1",
+    "number of spinning triangles, the others stay still, default is -1 (all)",
+    "frame rate to pace to, 0 = uncapped, default is 60",
+    "late frames with -m 0: 0 = drop them, 1 = catch up the simulation, default is 0",
+    "render offscreen and stream the frames to a .y4m or raw RGBA file, 'mem' only checksums them",
+    "offscreen frames in flight before their readback, 1 = synchronous, default is 3",
+    "camera background, nv12 or yuyv; ':copy' uploads instead of mapping (nv12:copy)",
+    "0 = one draw per triangle, 1 = matrix palette batches, 2 = CPU transformed batches, default is 1",
+    "streamed vertex buffers: 0 = orphaned when reused, 1 = fenced ring, default is 0",
+    "draw this mesh (from gpu_meshconv) instead of the triangle, one draw per object, no idle-aware rendering",
+    "threads for frustum culling, 0 = no culling, default is 1",
+    "1 = load assets and build programs on worker threads during startup, 0 = one after the other, default is 1",
+    "run every scenario of a benchmark matrix file and exit, the JSON report to -o (default stdout)",
+    "report of an earlier -R run to compare with, fails on significant regressions",
 };
 int noteCount = 1;
 char argNotes[][255] = {
@@ -95,198 +232,466 @@ const GLfloat color[3][3] = {
     {0.0f, 0.0f, 1.0f}
 };
 
-// Start with an identity matrix.
-GLfloat transformMatrix[16] =
-{
-    1.0f, 0.0f, 0.0f, 0.0f,
-    0.0f, 1.0f, 0.0f, 0.0f,
-    0.0f, 0.0f, 1.0f, 0.0f,
-    0.0f, 0.0f, 0.0f, 1.0f
-};
+// Triangle indices for the index buffer.
+const GLushort indices[3] = {0, 1, 2};
+
+// Triangle geometry in buffer objects (or client arrays, see -v).
+VertexBuffer triangle;
+DamageTracker damage;
+
+// Triangles of the scene, each with its own transform matrix.
+Scene scene;
+
+// A mesh file of -M replaces the triangle; quantized positions are scaled
+// back by the DEQUANTIZE variant with meshDequantize (scale, offset).
+MeshFile mesh;
+int meshQuantized = 0;
+GLfloat meshDequantize[2][4];
+
+// Unbatched objects go through the render queue, in the triangle program.
+int queueProgram = 0;
+
+// Bounding spheres of the objects; the visible ones are listed in the
+// frame arena. The matrices go straight to clip space, so the frustum is
+// the identity's.
+CullBounds cullBounds;
+CullFrustum cullFrustum;
+
+// Set by SIGINT to stop the CPU renderer, which has no window to close.
+volatile sig_atomic_t interrupted = 0;
 
 /***************************************************************************************
 ***************************************************************************************/
 
-void RenderInit()
+// Radius of the sphere around the model origin holding the mesh.
+float MeshRadius(const MeshFile * Mesh)
 {
-    // Grab location of shader attributes.
-    locVertices = glGetAttribLocation(programHandle, "my_Vertex");
-    locColors   = glGetAttribLocation(programHandle, "my_Color");
-    // Transform Matrix is uniform for all vertices here.
-    locTransformMat = glGetUniformLocation(programHandle, "my_TransformMatrix");
-
-    // enable vertex arrays to push the data.
-    glEnableVertexAttribArray(locVertices);
-    glEnableVertexAttribArray(locColors);
-
-    // set data in the arrays.
-    glVertexAttribPointer(locVertices, 2, GL_FLOAT, GL_FALSE, 0, &vertices[0][0]);
-    glVertexAttribPointer(locColors, 3, GL_FLOAT, GL_FALSE, 0, &color[0][0]);
-    glUniformMatrix4fv(locTransformMat, 1, GL_FALSE, transformMatrix);
+    const MeshHeader * header = Mesh->header;
+    float squared = 0.0f;
+    if (header->flags & MESH_QUANTIZED)
+    {
+        // The corners of the bounding box.
+        for (int k = 0; k < 3; ++k)
+        {
+            float extent = fabsf(header->offset[k]) + fabsf(header->scale[k]);
+            squared += extent * extent;
+        }
+    }
+    else
+    {
+        const MeshVertexFloat * vertex = (const MeshVertexFloat *)Mesh->vertices;
+        for (unsigned int v = 0; v < header->vertexCount; ++v)
+        {
+            const float * p = vertex[v].position;
+            float d = p[0] * p[0] + p[1] * p[1] + p[2] * p[2];
+            squared = (d > squared) ? d : squared;
+        }
+    }
+    return sqrtf(squared);
 }
 
-// Actual rendering here.
-void Render()
+// Makes the variant of Features the triangle program, built the first time:
+// from the program cache if possible, otherwise compiled from source and
+// stored for the next start. A variant that fails keeps the one before.
+void LoadShaders(unsigned int Features)
 {
-    static float angle = 0;
+    const ShaderVariant * variant = ShaderVariantGet(Features);
 
-    // Clear background.
-    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-    glClear(GL_COLOR_BUFFER_BIT);
+    if (variant != NULL)
+    {
+        triangleVariant = variant;
+        programHandle = variant->program;
+        StartupMark(variant->cached ? "shaders (cached)" : "shaders (compiled)");
+        GlStateUseProgram(programHandle);
+    }
+}
+
+// Cleanup the shaders.
+void DestroyShaders()
+{
+    ShaderVariantDestroy();
+    GlStateUseProgram(0);
+}
+
+void RenderInit()
+{
+    // Around the model origin, which objects rotate about.
+    float triangleRadius = 0.0f;
+    for (int v = 0; v < 3; ++v)
+    {
+        float r = sqrtf(vertices[v][0] * vertices[v][0] + vertices[v][1] * vertices[v][1]);
+        triangleRadius = (r > triangleRadius) ? r : triangleRadius;
+    }
+    float modelRadius = triangleRadius;
+
+    // upload the triangle once and point the arrays into the buffer;
+    // client arrays keep the plain glDrawArrays path.
+    const GLushort * triangleIndices = (vertexFormat == VERTEX_FORMAT_CLIENT) ? NULL : indices;
+    if (mesh.header != NULL)
+    {
+        // Uploaded from the mapping, which is not needed afterwards.
+        unsigned long long start = FrameStatsNs();
+        modelRadius = MeshRadius(&mesh);
+        if (VertexBufferCreateFromMesh(&triangle, &mesh))
+        {
+            printf("mesh: uploaded in %.2f ms\n", (FrameStatsNs() - start) / 1e6);
+        }
+        else
+        {
+            VertexBufferCreate(&triangle, VERTEX_FORMAT_FLOAT, &vertices[0][0], &color[0][0], 3, indices, 3);
+            meshQuantized = 0;
+            modelRadius = triangleRadius;
+            LoadShaders(SHADER_FEATURE_VERTEX_COLOR);
+        }
+        MeshFileClose(&mesh);
+    }
+    else if (!VertexBufferCreate(&triangle, vertexFormat, &vertices[0][0], &color[0][0], 3, triangleIndices, 3))
+    {
+        VertexBufferCreate(&triangle, VERTEX_FORMAT_CLIENT, &vertices[0][0], &color[0][0], 3, NULL, 0);
+    }
+
+    // The locations come with the variant.
+    locVertices = triangleVariant->attribs[SHADER_ATTRIB_VERTEX];
+    locColors   = triangleVariant->attribs[SHADER_ATTRIB_COLOR];
+    locTransformMat = triangleVariant->uniforms[SHADER_UNIFORM_TRANSFORM];
+
+    // Geometry that changes every frame goes through the stream buffers.
+    if (!StreamBufferInit(egl.eglDisplay, STREAM_BYTES, STREAM_BUFFERS, streamMode))
+    {
+        fprintf(stderr, "Stream buffers unavailable.\n");
+    }
+
+    // Batches draw with their own program and buffer; the triangle buffer
+    // stays for the per-triangle path and the damage tracker.
+    if ((batchMode != BATCH_OFF) && !BatchInit(batchMode, 0, &vertices[0][0], &color[0][0], 3))
+    {
+        fprintf(stderr, "Batching unavailable, one draw per triangle.\n");
+        batchMode = BATCH_OFF;
+    }
+    if (batchMode == BATCH_OFF)
+    {
+        // enable vertex arrays to push the data.
+        GlStateEnableAttrib(locVertices);
+        GlStateEnableAttrib(locColors);
+        VertexBufferBind(&triangle, locVertices, locColors);
+        GlStateUniformMatrix4fv(locTransformMat, 1, scene.matrices);
+        if (meshQuantized)
+        {
+            GlStateUniform4fv(triangleVariant->uniforms[SHADER_UNIFORM_DEQUANTIZE], 2, &meshDequantize[0][0]);
+        }
+        if (!RenderQueueInit(scene.count))
+        {
+            fprintf(stderr, "Out of memory for the render queue.\n");
+        }
+        queueProgram = RenderQueueProgram(programHandle);
+    }
 
-    // Set up rotation matrix rotating by angle around y axis.
-    transformMatrix[0] = transformMatrix[10] = (GLfloat)cos(angle);
-    transformMatrix[2] = (GLfloat)sin(angle);
-    transformMatrix[8] = -transformMatrix[2];
-    angle += 0.1f;
+    // Objects stay in their grid cell, so the bounds are set once.
+    if (cullThreads > 0)
+    {
+        if (!CullBoundsInit(&cullBounds, scene.count) || !CullStart(cullThreads))
+        {
+            fprintf(stderr, "Out of memory, no culling.\n");
+            CullBoundsDestroy(&cullBounds);
+            cullThreads = 0;
+        }
+        else
+        {
+            for (int i = 0; i < scene.count; ++i)
+            {
+                cullBounds.centerX[i] = scene.offsetX[i];
+                cullBounds.centerY[i] = scene.offsetY[i];
+                cullBounds.radius[i] = scene.scale[i] * modelRadius;
+            }
+            Mat4 identity = MAT4_IDENTITY;
+            CullFrustumFromMatrix(&cullFrustum, &identity);
+        }
+    }
 
-    /*According to Linux programer's manual, need to clamp the input value of sin or cos to valid value,
-        otherwise return NaN and exception may be raised.*/
-    if(angle >= 6.3)
+    // Without the tracker every frame is drawn whole.
+    if (idleAware && !DamageTrackerInit(&damage, &vertices[0][0], 3, scene.count))
     {
-        angle = fmod(angle, (float)6.3);
+        fprintf(stderr, "Out of memory, idle-aware rendering disabled.\n");
+        idleAware = 0;
     }
+    DamageSurfaceInit(&egl);
+}
 
-    glUniformMatrix4fv(locTransformMat, 1, GL_FALSE, transformMatrix);
+// One object of the render queue; Frame is the snapshot drawn.
+static void renderObject(unsigned int Payload, void * Frame)
+{
+    GlStateUniformMatrix4fv(locTransformMat, 1, &((const SceneFrame *)Frame)->matrices[Payload * 16]);
+    VertexBufferDraw(&triangle);
+}
 
-    glDrawArrays(GL_TRIANGLES, 0, 3);
+// Actual rendering here, of one simulation snapshot. With a Repaint area
+// only the triangles touching it are drawn.
+void Render(const SceneFrame * Frame, const float * Repaint)
+{
+    // Clear background.
+    GlStateClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
 
-	// flush all commands.
-	glFlush ();
+    // The camera picture goes under the triangles, drawn with its own
+    // program and vertex array.
+    if (camera)
+    {
+        // BatchBegin() enables the batch's arrays again.
+        if (batchMode != BATCH_OFF)
+        {
+            BatchDisableArrays();
+            TexStreamDraw();
+        }
+        else
+        {
+            GlStateDisableAttrib(locVertices);
+            GlStateDisableAttrib(locColors);
+            TexStreamDraw();
+            GlStateEnableAttrib(locVertices);
+            GlStateEnableAttrib(locColors);
+            VertexBufferBind(&triangle, locVertices, locColors);
+            GlStateUseProgram(programHandle);
+        }
+    }
 
-	// swap display with drawn surface.
-	vdkSwapEGL(&egl);
+    // Only the objects in view are drawn; visible is NULL for all of them.
+    const int * visible = NULL;
+    int visibleCount = Frame->count;
+    int * visibleList = (cullThreads > 0) ? (int *)FrameAlloc(((Frame->count + 3) & ~3) * sizeof(int)) : NULL;
+    if (visibleList != NULL)
+    {
+        visibleCount = CullRun(&cullFrustum, &cullBounds, visibleList);
+        visible = (visibleCount < Frame->count) ? visibleList : NULL;
+    }
+
+    // Many triangles per draw call; a whole frame goes straight from the
+    // snapshot's matrix array.
+    if (batchMode != BATCH_OFF)
+    {
+        BatchBegin();
+        if ((Repaint == NULL) && (visible == NULL))
+        {
+            BatchAddArray(Frame->matrices, Frame->count);
+        }
+        else
+        {
+            for (int v = 0; v < visibleCount; ++v)
+            {
+                int i = (visible != NULL) ? visible[v] : v;
+                if ((Repaint == NULL) || DamageTrackerOverlaps(&damage, i, Repaint))
+                {
+                    BatchAdd(&Frame->matrices[i * 16]);
+                }
+            }
+        }
+        BatchEnd();
+        return;
+    }
 
+    // Every triangle with its own rotation around the y axis, opaque. The
+    // scene is flat (z = 0) and the surface has no depth buffer, so the key
+    // carries no depth; the sort is stable and keeps the submission order.
+    RenderQueueBegin();
+    for (int v = 0; v < visibleCount; ++v)
+    {
+        int i = (visible != NULL) ? visible[v] : v;
+        if ((Repaint != NULL) && !DamageTrackerOverlaps(&damage, i, Repaint))
+        {
+            continue;
+        }
+        if (!RenderQueueSubmit(RenderQueueKey(0, 0, queueProgram, 0, 0.0f), i))
+        {
+            renderObject(i, (void *)Frame);     // queue full or missing
+        }
+    }
+    RenderQueueSort();
+    RenderQueueExecute(renderObject, (void *)Frame);
 }
 
 void RenderCleanup()
 {
     // cleanup
-    glDisableVertexAttribArray(locVertices);
-    glDisableVertexAttribArray(locColors);
+    GlStateDisableAttrib(locVertices);
+    GlStateDisableAttrib(locColors);
+    if (batchMode != BATCH_OFF)
+    {
+        BatchDestroy();
+    }
+    StreamBufferDestroy();
+    RenderQueueDestroy();
+    if (cullThreads > 0)
+    {
+        CullStop();
+        CullBoundsDestroy(&cullBounds);
+    }
+    VertexBufferDestroy(&triangle);
+    DamageTrackerDestroy(&damage);
 }
 
-/***************************************************************************************
-***************************************************************************************/
-
-// Compile a vertex or pixel shader.
+// Starts the camera of -z and its texture stream.
 // returns 0: fail
 //         1: success
-int CompileShader(const char * FName, GLuint ShaderNum)
+int CameraInit(const char * Spec)
 {
-    FILE * fptr = NULL;
+    char name[16];
+    const char * option = strchr(Spec, ':');
+    size_t length = (option != NULL) ? (size_t)(option - Spec) : strlen(Spec);
+    snprintf(name, sizeof(name), "%.*s", (int)length, Spec);
 
-    fptr = fopen(FName, "rb");
-
-    if (fptr == NULL)
+    int format = CameraFormatParse(name);
+    if (format < 0)
     {
-        fprintf(stderr, "Cannot open file '%s'\n", FName);
+        fprintf(stderr, "Unknown camera format '%s'.\n", name);
         return 0;
     }
-
-    int length;
-    fseek(fptr, 0, SEEK_END);
-    length = ftell(fptr);
-    fseek(fptr, 0 ,SEEK_SET);
-
-    char * shaderSource = (char*)malloc(sizeof (char) * length);
-    if (shaderSource == NULL)
+    if (!CameraSourceStart(format, CAMERA_WIDTH, CAMERA_HEIGHT, CAMERA_BUFFERS, CAMERA_RATE))
     {
-        fprintf(stderr, "Out of memory.\n");
         return 0;
     }
 
-    fread(shaderSource, length, 1, fptr);
+    int direct = (option == NULL) || (strcmp(option, ":copy") != 0);
+    int result = TexStreamInit(egl.eglDisplay, format, CAMERA_WIDTH, CAMERA_HEIGHT, CAMERA_BUFFERS, direct);
+    if (!result)
+    {
+        CameraSourceStop();
+    }
+    GlStateUseProgram(programHandle);
+    return result;
+}
 
-    glShaderSource(ShaderNum, 1, (const char**)&shaderSource, &length);
-    glCompileShader(ShaderNum);
+void CameraCleanup()
+{
+    TexStreamDestroy();
+    CameraSourceStop();
+}
 
-    free(shaderSource);
-    fclose(fptr);
+// Same frame on the CPU rasterizer.
+void RenderSoftware(const SceneFrame * Frame)
+{
+    static const float clearColor[4] = {0.0f, 0.0f, 0.0f, 1.0f};
 
-    GLint compiled = 0;
-    glGetShaderiv(ShaderNum, GL_COMPILE_STATUS, &compiled);
-    if (!compiled)
-    {
-        // Retrieve error buffer size.
-        GLint errorBufSize, errorLength;
-        glGetShaderiv(ShaderNum, GL_INFO_LOG_LENGTH, &errorBufSize);
+    SwRastDraw(clearColor, &vertices[0][0], &color[0][0], 3, Frame->matrices, Frame->count);
+}
 
-        char * infoLog = (char*)malloc(errorBufSize * sizeof(char) + 1);
-        if (!infoLog)
-        {
-            // Retrieve error.
-            glGetShaderInfoLog(ShaderNum, errorBufSize, &errorLength, infoLog);
-            infoLog[errorBufSize + 1] = '\0';
-            fprintf(stderr, "%s\n", infoLog);
+void OnInterrupt(int Signal)
+{
+    (void)Signal;
+    interrupted = 1;
+}
 
-            free(infoLog);
-        }
-        fprintf(stderr, "Error compiling shader '%s'\n", FName);
-        return 0;
-    }
+// End-of-run report: average fps plus the per-phase frame time distribution.
+void ReportFrames(int FrameCount, unsigned long long StartNs)
+{
+    unsigned long long elapsed = FrameStatsNs() - StartNs;
+    float fps = (elapsed > 0) ? (float)(FrameCount * 1e9 / elapsed) : 0.0f;
+    printf("%d frames in %d ticks -> %.3f fps\n", FrameCount, (int)(elapsed / 1000000), fps);
 
-    return 1;
+    FrameStatsPrint(stdout);
+    if (statsFName != NULL)
+    {
+        FrameStatsWrite(statsFName);
+    }
 }
 
-/***************************************************************************************
-***************************************************************************************/
-
-// Wrapper to load vetex and pixel shader.
-void LoadShaders(const char * vShaderFName, const char * pShaderFName)
+// Sleeps until input arrives or TimeoutMs passed. Without the event thread
+// the loop has to poll, so it naps at most 10 ms.
+void IdleWait(int EventThread, unsigned int TimeoutMs)
 {
-    vertShaderNum = glCreateShader(GL_VERTEX_SHADER);
-    pixelShaderNum = glCreateShader(GL_FRAGMENT_SHADER);
+    if (EventThread)
+    {
+        EventThreadWait(TimeoutMs);
+    }
+    else
+    {
+        usleep(((TimeoutMs < 10) ? TimeoutMs : 10) * 1000);
+    }
+}
 
-    if (CompileShader(vShaderFName, vertShaderNum) == 0)
+// Main loop of the CPU renderer: no window, no events.
+int RunSoftware()
+{
+    if (!SwRastInit((width > 0) ? width : 640, (height > 0) ? height : 480, threads))
     {
-        return;
+        return 1;
     }
 
-    if (CompileShader(pShaderFName, pixelShaderNum) == 0)
+    signal(SIGINT, OnInterrupt);
+
+    // A golden reference must not depend on the timing of the run.
+    SimulationStart(&scene, simulationThread && (goldenFName == NULL), targetRate);
+    FrameStatsInit(warmupFrames);
+
+    int frameCount = 0;
+    unsigned long long start = FrameStatsNs();
+
+    while (!interrupted)
     {
-        return;
+        const SceneFrame * frame = SimulationNext();
+        FrameStatsLap(FRAME_PHASE_SCENE);
+        RenderSoftware(frame);
+        FrameStatsLap(FRAME_PHASE_RENDER);
+        FrameStatsEnd();
+        ++ frameCount;
+
+        if ((frames > 0) && (--frames == 0)) {
+            break;
+        }
     }
 
-    programHandle = glCreateProgram();
+    SimulationStop();
+    ReportFrames(frameCount, start);
 
-    glAttachShader(programHandle, vertShaderNum);
-    glAttachShader(programHandle, pixelShaderNum);
+    double setupMs, rasterMs;
+    SwRastGetTimes(&setupMs, &rasterMs);
+    printf("cpu: %d triangles on %d threads, %.3f ms setup + %.3f ms raster per frame\n",
+           scene.count, SwRastThreads(), setupMs, rasterMs);
 
-    glLinkProgram(programHandle);
-    // Check if linking succeeded.
-    GLint linked = false;
-    glGetProgramiv(programHandle, GL_LINK_STATUS, &linked);
-    if (!linked)
+    if (goldenFName != NULL)
     {
-        // Retrieve error buffer size.
-        GLint errorBufSize, errorLength;
-        glGetShaderiv(programHandle, GL_INFO_LOG_LENGTH, &errorBufSize);
+        SwRastWritePPM(goldenFName);
+    }
 
-        char * infoLog = (char*)malloc(errorBufSize * sizeof (char) + 1);
-        if (!infoLog)
-        {
-            // Retrieve error.
-            glGetProgramInfoLog(programHandle, errorBufSize, &errorLength, infoLog);
-            infoLog[errorBufSize + 1] = '\0';
-            fprintf(stderr, "%s", infoLog);
+    SwRastDestroy();
+    return 0;
+}
 
-            free(infoLog);
-        }
+/***************************************************************************************
+***************************************************************************************/
 
-        fprintf(stderr, "Error linking program\n");
-        return;
+// Startup tasks: work that needs no context, run while EGL initialises.
+int sceneReady = 0;
+int meshMapped = 0;
+double meshMapMs = 0.0;
+
+static void startupScene(void * Arg)
+{
+    (void)Arg;
+    sceneReady = SceneInit(&scene, objects);
+    if (sceneReady)
+    {
+        SceneSetAnimated(&scene, animatedObjects);
     }
-    glUseProgram(programHandle);
 }
 
-// Cleanup the shaders.
-void DestroyShaders()
+// Mapped, faulted in and its indices checked, so the upload in RenderInit()
+// only copies.
+static void startupMesh(void * Arg)
+{
+    (void)Arg;
+    unsigned long long start = FrameStatsNs();
+    meshMapped = MeshFileOpen(meshFName, &mesh) && MeshFilePrefault(&mesh);
+    if (!meshMapped)
+    {
+        MeshFileClose(&mesh);
+    }
+    meshMapMs = (FrameStatsNs() - start) / 1e6;
+}
+
+static void startupFiles(void * Arg)
 {
-    glDeleteShader(vertShaderNum);
-    glDeleteShader(pixelShaderNum);
-    glDeleteProgram(programHandle);
-    glUseProgram(0);
+    (void)Arg;
+    ShaderSourcePrefetch();
+    ProgramCachePrefetch((strcmp(cacheDir, "none") != 0) ? cacheDir : NULL);
 }
 
 /***************************************************************************************
@@ -349,6 +754,222 @@ int ParseCommandLine(int argc, char * argv[])
                 else
                     result = 0;
                 break;
+
+            case 'r':
+                // r<renderer> for the renderer (defaults to 0, GLES2).
+                if (++i < argc)
+                    renderer = atoi(&argv[i][0]);
+                else
+                    result = 0;
+                break;
+
+            case 'n':
+                // n<count> for number of triangles (defaults to 1).
+                if (++i < argc)
+                    objects = atoi(&argv[i][0]);
+                else
+                    result = 0;
+                break;
+
+            case 't':
+                // t<count> for CPU rasterizer threads (defaults to 0, one per core).
+                if (++i < argc)
+                    threads = atoi(&argv[i][0]);
+                else
+                    result = 0;
+                break;
+
+            case 'g':
+                // g<file> for the golden reference image (defaults to none).
+                if (++i < argc)
+                    goldenFName = argv[i];
+                else
+                    result = 0;
+                break;
+
+            case 'u':
+                // u<count> for warm-up frames (defaults to 0).
+                if (++i < argc)
+                    warmupFrames = atoi(&argv[i][0]);
+                else
+                    result = 0;
+                break;
+
+            case 'v':
+                // v<format> for the vertex format (defaults to 1, VBO float).
+                if (++i < argc)
+                    vertexFormat = atoi(&argv[i][0]);
+                else
+                    result = 0;
+                break;
+
+            case 'o':
+                // o<file> for the frame statistics file (defaults to none).
+                if (++i < argc)
+                    statsFName = argv[i];
+                else
+                    result = 0;
+                break;
+
+            case 'c':
+                // c<dir> for the program binary cache (defaults to none, off).
+                if (++i < argc)
+                    cacheDir = argv[i];
+                else
+                    result = 0;
+                break;
+
+            case 'd':
+                // d<dir> for shader overrides (defaults to none, embedded shaders).
+                if (++i < argc)
+                    shaderDir = argv[i];
+                else
+                    result = 0;
+                break;
+
+            case 'b':
+                // b<name> for a microbenchmark instead of the demo.
+                if (++i < argc)
+                    benchName = argv[i];
+                else
+                    result = 0;
+                break;
+
+            case 'm':
+                // m<0|1> for the simulation thread (defaults to 1, on).
+                if (++i < argc)
+                    simulationThread = atoi(&argv[i][0]);
+                else
+                    result = 0;
+                break;
+
+            case 'p':
+                // p<file> for a GL trace (defaults to none).
+                if (++i < argc)
+                    traceFName = argv[i];
+                else
+                    result = 0;
+                break;
+
+            case 'e':
+                // e<0|1> for the redundant state filter (defaults to 1, on).
+                if (++i < argc)
+                    stateFilter = atoi(&argv[i][0]);
+                else
+                    result = 0;
+                break;
+
+            case 'i':
+                // i<0|1> for idle-aware rendering (defaults to 1, on).
+                if (++i < argc)
+                    idleAware = atoi(&argv[i][0]);
+                else
+                    result = 0;
+                break;
+
+            case 'a':
+                // a<count> for spinning triangles (defaults to -1, all).
+                if (++i < argc)
+                    animatedObjects = atoi(&argv[i][0]);
+                else
+                    result = 0;
+                break;
+
+            case 'k':
+                // k<hz> for the target frame rate (defaults to 60, 0 uncapped).
+                if (++i < argc)
+                    targetRate = atoi(&argv[i][0]);
+                else
+                    result = 0;
+                break;
+
+            case 'l':
+                // l<0|1> for the late frame policy (defaults to 0, drop).
+                if (++i < argc)
+                    latePolicy = (atoi(&argv[i][0]) != 0) ? FRAME_PACE_CATCH_UP : FRAME_PACE_DROP;
+                else
+                    result = 0;
+                break;
+
+            case 'j':
+                // j<file|mem> for offscreen rendering into a frame dump.
+                if (++i < argc)
+                    dumpTarget = argv[i];
+                else
+                    result = 0;
+                break;
+
+            case 'q':
+                // q<depth> for offscreen frames in flight (defaults to 3).
+                if (++i < argc)
+                    readbackDepth = atoi(&argv[i][0]);
+                else
+                    result = 0;
+                break;
+
+            case 'z':
+                // z<format[:copy]> for the camera background (defaults to none).
+                if (++i < argc)
+                    cameraSpec = argv[i];
+                else
+                    result = 0;
+                break;
+
+            case 'B':
+                // B<mode> for geometry batching (defaults to 1).
+                if (++i < argc)
+                    batchMode = atoi(&argv[i][0]);
+                else
+                    result = 0;
+                break;
+
+            case 'S':
+                // S<mode> for the stream buffer mode (defaults to 0).
+                if (++i < argc)
+                    streamMode = atoi(&argv[i][0]);
+                else
+                    result = 0;
+                break;
+
+            case 'M':
+                // M<file> for a mesh file to draw (defaults to the triangle).
+                if (++i < argc)
+                    meshFName = argv[i];
+                else
+                    result = 0;
+                break;
+
+            case 'T':
+                // T<count> for the culling threads (defaults to 1).
+                if (++i < argc)
+                    cullThreads = atoi(&argv[i][0]);
+                else
+                    result = 0;
+                break;
+
+            case 'P':
+                // P<0|1> for the parallel startup (defaults to 1).
+                if (++i < argc)
+                    parallelStartup = atoi(&argv[i][0]);
+                else
+                    result = 0;
+                break;
+
+            case 'R':
+                // R<file> for a benchmark scenario matrix instead of the demo.
+                if (++i < argc)
+                    scenarioFName = argv[i];
+                else
+                    result = 0;
+                break;
+
+            case 'Q':
+                // Q<file> for the baseline report of -R (defaults to none).
+                if (++i < argc)
+                    baselineFName = argv[i];
+                else
+                    result = 0;
+                break;
             default:
                 result = 0;
                 break;
@@ -416,43 +1037,195 @@ int main(int argc, char** argv)
         EGL_NONE
     };
 
+    StartupInit();
+
     // Parse the command line.
     if (!ParseCommandLine(argc, argv))
     {
         PrintHelp();
         return 0;
     }
+    StartupMark("command line");
+
+    if (scenarioFName != NULL)
+    {
+        return ScenarioRun(argv[0], scenarioFName, statsFName, baselineFName) ? 0 : 1;
+    }
+
+    // Before anything that builds shaders, whose info logs go there.
+    if (!FrameArenaInit(FRAME_ARENA_BYTES + ((objects + 3) & ~3) * sizeof(int)))
+    {
+        fprintf(stderr, "Out of memory.\n");
+        return 1;
+    }
+
+    if (benchName != NULL)
+    {
+        return BenchRun(benchName) ? 0 : 1;
+    }
 
     // Set multi-sampling.
     configAttribs[1] = samples;
 
-    // Initialize VDK, EGL, and GLES.
-    if (!vdkSetupEGL(posX, posY, width, height, configAttribs, NULL, attribListContext, &egl))
+    // Scene, mesh and files are made ready while EGL initialises.
+    ShaderSourceSetOverrideDir(shaderDir);
+    StartupTask sceneTask, meshTask, filesTask;
+    memset(&meshTask, 0, sizeof(meshTask));
+    StartupTaskStart(&sceneTask, "scene", startupScene, NULL, parallelStartup);
+    if (meshFName != NULL)
+    {
+        StartupTaskStart(&meshTask, "mesh map", startupMesh, NULL, parallelStartup);
+    }
+    StartupTaskStart(&filesTask, "file prefetch", startupFiles, NULL, parallelStartup);
+    StartupMark(parallelStartup ? "tasks started" : "scene, mesh, files");
+
+    // Initialize VDK, EGL, and GLES. Without a usable GPU fall back to the CPU.
+    if ((renderer == RENDERER_GLES2)
+    && !vdkSetupEGL(posX, posY, width, height, configAttribs, NULL, attribListContext, &egl))
+    {
+        fprintf(stderr, "EGL setup failed, using the CPU rasterizer.\n");
+        renderer = RENDERER_CPU;
+    }
+    StartupMark("egl");
+
+    StartupTaskJoin(&sceneTask);
+    StartupTaskJoin(&filesTask);
+    StartupTaskJoin(&meshTask);
+    StartupMark("tasks wait");
+    if (!sceneReady)
     {
+        fprintf(stderr, "Out of memory.\n");
+        MeshFileClose(&mesh);
         return 1;
     }
 
+    if (renderer != RENDERER_GLES2)
+    {
+        MeshFileClose(&mesh);
+        int result = RunSoftware();
+        SceneDestroy(&scene);
+        return result;
+    }
+
     // Set window title and show the window.
     vdkSetWindowTitle(egl.window, TUTORIAL_NAME);
     vdkShowWindow(egl.window);
+    StartupMark("window");
+
+    if (meshMapped)
+    {
+        const MeshHeader * header = mesh.header;
+        meshQuantized = (header->flags & MESH_QUANTIZED) != 0;
+        for (int c = 0; c < 3; ++c)
+        {
+            meshDequantize[0][c] = header->scale[c];
+            meshDequantize[1][c] = header->offset[c];
+        }
+        meshDequantize[0][3] = meshDequantize[1][3] = 0.0f;
+        printf("mesh: %s, %u vertices, %u triangles, %s positions, %d-bit indices, %lu bytes mapped in %.2f ms\n",
+               meshFName, header->vertexCount, header->indexCount / 3, meshQuantized ? "short" : "float",
+               (header->flags & MESH_INDEX32) ? 32 : 16, (unsigned long)mesh.size, meshMapMs);
+
+        // Batches and the damage tracker only know the triangle.
+        batchMode = BATCH_OFF;
+        idleAware = 0;
+    }
+
+    // A trace must compile its shaders; a cached binary only fits this driver.
+    if ((traceFName != NULL) && GlTraceOpen(traceFName, width, height))
+    {
+        cacheDir = "none";
+    }
 
-    // load and compiler vertex/fragment shaders.
-    LoadShaders("vs_es20t1.vert", "ps_es20t1.frag");
+    ProgramCacheInit((strcmp(cacheDir, "none") != 0) ? cacheDir : NULL);
+    GlStateReset();
+    GlStateSetFiltering(stateFilter);
+    ShaderVariantInit("vs_es20t1.vert", "ps_es20t1.frag");
+
+    // The other programs build on a shared context while this thread builds
+    // the triangle's; a trace keeps every GL call on this thread.
+    if (parallelStartup && ShaderProgramWorkerStart(egl.eglDisplay, egl.eglConfig, egl.eglContext))
+    {
+        if (batchMode != BATCH_OFF)
+        {
+            BatchPrepare(batchMode, 0, 3);
+        }
+    }
+
+    // load and compiler vertex/fragment shaders, the variant the geometry
+    // needs.
+    LoadShaders(SHADER_FEATURE_VERTEX_COLOR | (meshQuantized ? SHADER_FEATURE_DEQUANTIZE : 0));
 
     if (programHandle != 0)
     {
+        // A dump needs every frame whole, whatever changed.
+        if (dumpTarget != NULL)
+        {
+            idleAware = 0;
+        }
+
         RenderInit();
 
+        if (cameraSpec != NULL)
+        {
+            camera = CameraInit(cameraSpec);
+            if (!camera)
+            {
+                fprintf(stderr, "Camera streaming unavailable.\n");
+            }
+        }
+
+        int offscreen = 0;
+        if (dumpTarget != NULL)
+        {
+            EGLint surfaceWidth = 0;
+            EGLint surfaceHeight = 0;
+            eglQuerySurface(egl.eglDisplay, egl.eglSurface, EGL_WIDTH, &surfaceWidth);
+            eglQuerySurface(egl.eglDisplay, egl.eglSurface, EGL_HEIGHT, &surfaceHeight);
+
+            offscreen = FrameWriterOpen(dumpTarget, surfaceWidth, surfaceHeight,
+                                        (targetRate > 0) ? targetRate : FRAME_PACE_DISPLAY_HZ, DUMP_BUFFERS);
+            if (offscreen && !OffscreenInit(egl.eglDisplay, surfaceWidth, surfaceHeight, readbackDepth))
+            {
+                FrameWriterClose();
+                offscreen = 0;
+            }
+            if (!offscreen)
+            {
+                fprintf(stderr, "Offscreen rendering unavailable, rendering to the window.\n");
+            }
+        }
+        StartupMark("render init");
+
+        FrameStatsInit(warmupFrames);
+
         int frameCount = 0;
-        unsigned int start = vdkGetTicks();
+        int skippedFrames = 0;
+        HeapStats heapFirst;
+        memset(&heapFirst, 0, sizeof(heapFirst));
+        unsigned long long start = FrameStatsNs();
+
+        // Input is polled on its own thread; poll inline if it cannot start.
+        int eventThread = EventThreadStart(egl.window);
+        SimulationStart(&scene, simulationThread, targetRate);
+        FramePacerInit(offscreen ? EGL_NO_DISPLAY : egl.eglDisplay, targetRate, latePolicy);
 
         // Main loop
         for (bool done = false; !done;)
         {
-            // Get an event.
-            vdkEvent event;
-            if (vdkGetEvent(egl.window, &event))
+            // Input is read as late as possible, after waiting for the slot.
+            int steps = FramePacerBegin();
+            FrameStatsLap(FRAME_PHASE_PACE);
+
+            // Handle everything that arrived since the last frame in one batch.
+            vdkEvent events[EVENT_QUEUE_SIZE];
+            int eventCount = eventThread ? EventThreadDrain(events, EVENT_QUEUE_SIZE)
+                                         : vdkGetEvent(egl.window, &events[0]);
+
+            for (int e = 0; e < eventCount; ++e)
             {
+                const vdkEvent & event = events[e];
+
                 // Test for Keyboard event.
                 if ((event.type == VDK_KEYBOARD)
                 && event.data.keyboard.pressed
@@ -464,6 +1237,9 @@ int main(int argc, char** argv)
                     case VDK_SPACE:
                         // Use SPACE to pauseFlag.
                         pauseFlag = !pauseFlag;
+                        SimulationSetPaused(pauseFlag);
+                        // Paused time is not frame time.
+                        FrameStatsRestart();
                         break;
 
                     case VDK_ESCAPE:
@@ -481,29 +1257,251 @@ int main(int argc, char** argv)
                     done = true;
                 }
             }
-            else if (!pauseFlag)
+
+            if (done)
             {
-                // Render one frame if there is no event.
-                Render();
-                ++ frameCount;
+                break;
+            }
 
+            if (pauseFlag)
+            {
+                // Nothing to draw; sleep until the next key.
+                IdleWait(eventThread, IDLE_PAUSED_MS);
+                FrameStatsRestart();
+                FramePacerRestart();
+                continue;
+            }
+
+            // Render one frame.
+            FrameStatsLap(FRAME_PHASE_EVENTS);
+            const SceneFrame * frame = SimulationNext();
+            while (!SimulationThreaded() && (--steps > 0))
+            {
+                // Catching up inline: fixed steps, only the last one is
+                // drawn. The thread keeps wall-clock time on its own.
+                frame = SimulationNext();
+            }
+            FrameStatsLap(FRAME_PHASE_SCENE);
+
+            // A new camera frame changes the whole background.
+            const CameraBuffer * cameraFrame = camera ? CameraSourceAcquire() : NULL;
+            if (cameraFrame != NULL)
+            {
+                TexStreamUpdate(cameraFrame);
+            }
+
+            float area[4];
+            int moved = idleAware && DamageTrackerUpdate(&damage, frame->matrices, area);
+            if (idleAware && (cameraFrame != NULL))
+            {
+                area[0] = area[1] = -1.0f;
+                area[2] = area[3] = 1.0f;
+            }
+            else if (idleAware && !moved)
+            {
+                // Nothing moved: the presented frame stays. The pacer sleeps
+                // to the next slot, uncapped sleep one frame period.
+                ++ skippedFrames;
+                if (targetRate <= 0)
+                {
+                    IdleWait(eventThread, IDLE_FRAME_MS);
+                }
+                FramePacerSkip();
+                FrameStatsRestart();
                 if ((frames > 0) && (--frames == 0)) {
                     done = true;
                 }
+                continue;
+            }
+
+            // Repaint only what changed, and what this back buffer missed.
+            float repaint[4];
+            GLint scissor[4];
+            int partial = idleAware && DamageBeginFrame(area, repaint, scissor);
+            if (partial)
+            {
+                GlStateEnable(GL_SCISSOR_TEST);
+                glScissor(scissor[0], scissor[1], scissor[2], scissor[3]);
+            }
+            else
+            {
+                GlStateDisable(GL_SCISSOR_TEST);
+            }
+
+            if (offscreen)
+            {
+                OffscreenBegin();
+            }
+            Render(frame, partial ? repaint : NULL);
+            StreamBufferFrame();
+            FrameStatsLap(FRAME_PHASE_RENDER);
+
+            // swap display with drawn surface, which flushes all commands.
+            GlTraceFrame();
+            if (offscreen)
+            {
+                // No swap: the frame is fenced and read back when done.
+                OffscreenEnd();
+            }
+            else if (idleAware)
+            {
+                DamageSwap(&egl);
+            }
+            else
+            {
+                vdkSwapEGL(&egl);
+            }
+            FrameStatsLap(FRAME_PHASE_SWAP);
+            FrameArenaReset();
+            FramePacerPresented();
+            FrameStatsEnd();
+            ++ frameCount;
+
+            if (frameCount == 1)
+            {
+                StartupMark("first frame");
+                HeapGetStats(&heapFirst);
+            }
+
+            if ((frames > 0) && (--frames == 0)) {
+                done = true;
             }
         }
+        HeapStats heapLast;
+        int heapCounted = HeapGetStats(&heapLast);
 
+        EventThreadStop();
+        SimulationStop();
+
+        if (offscreen)
+        {
+            OffscreenFinish();
+        }
         glFinish();
-        unsigned int end = vdkGetTicks();
-        float fps = frameCount / ((end - start) / 1000.0f);
-        printf("%d frames in %d ticks -> %.3f fps\n", frameCount, end - start, fps);
+        StartupPrint(stdout);
+        ReportFrames(frameCount, start);
+
+        unsigned int vertexBytes = (triangle.format == VERTEX_FORMAT_CLIENT) ? 5 * sizeof (GLfloat) : triangle.stride;
+        printf("vertex: %s format, %u bytes per vertex, %u bytes copied from client memory per draw\n",
+               VertexFormatName(triangle.format), vertexBytes, VertexBufferClientBytesPerDraw(&triangle));
+        char variantName[128];
+        ShaderVariantName(triangleVariant->features, variantName, sizeof(variantName));
+        ShaderVariantStats variantStats;
+        ShaderVariantGetStats(&variantStats);
+        printf("shaders: %s variant, %d variants built (%d from the cache, %d failed) in %.2f ms\n",
+               variantName, variantStats.variants, variantStats.cached, variantStats.failed, variantStats.buildMs);
+        if (batchMode != BATCH_OFF)
+        {
+            BatchStats batchStats;
+            BatchGetStats(&batchStats);
+            printf("batch: %s, %llu triangles in %llu draws (%.1f per draw), %llu matrices uploaded, %llu vertex bytes streamed\n",
+                   BatchModeName(batchMode), batchStats.triangles, batchStats.draws,
+                   (batchStats.draws > 0) ? (double)batchStats.triangles / batchStats.draws : 0.0,
+                   batchStats.matrices, batchStats.bytes);
+        }
+        // Steady state: the frames after the first.
+        const Arena * arena = FrameArenaGet();
+        if (heapCounted)
+        {
+            printf("heap: %llu allocations, %llu frees in %d frames after the first, whole process\n",
+                   heapLast.allocations - heapFirst.allocations, heapLast.frees - heapFirst.frees,
+                   (frameCount > 1) ? frameCount - 1 : 0);
+        }
+        printf("frame arena: peak %lu of %lu bytes, %llu failures\n",
+               (unsigned long)arena->peak, (unsigned long)arena->size, arena->failures);
+        CullStats cullStats;
+        CullGetStats(&cullStats);
+        if (cullStats.runs > 0)
+        {
+            printf("cull: %d threads, %.1f of %d objects visible per frame, %.3f ms per frame\n", CullThreads(),
+                   (double)cullStats.visible / cullStats.runs, scene.count, cullStats.ms / cullStats.runs);
+        }
+        RenderQueueStats queueStats;
+        RenderQueueGetStats(&queueStats);
+        if (queueStats.frames > 0)
+        {
+            double queueFrames = (double)queueStats.frames;
+            printf("queue: %.1f draws per frame, %.1f program switches, %.1f texture binds, %.1f blend switches, "
+                   "%.3f ms sorting per frame\n", queueStats.draws / queueFrames, queueStats.programs / queueFrames,
+                   queueStats.textures / queueFrames, queueStats.blends / queueFrames, queueStats.sortMs / queueFrames);
+        }
+        StreamBufferStats ringStats;
+        StreamBufferGetStats(&ringStats);
+        if (ringStats.writes > 0)
+        {
+            printf("stream: %s, %.0f bytes per frame, %llu orphans, %llu waits (%.3f ms), %.3f ms in buffer updates\n",
+                   StreamModeName(ringStats.mode), (double)ringStats.bytes / ringStats.frames,
+                   ringStats.orphans, ringStats.waits, ringStats.waitMs, ringStats.uploadMs);
+        }
+
+        EventThreadStats eventStats;
+        EventThreadGetStats(&eventStats);
+        printf("events: %llu handled, max %u per frame, max queue depth %u, %llu producer stalls\n",
+               eventStats.events, eventStats.maxBatch, eventStats.maxDepth, eventStats.stalls);
+        GlStatePrint(stdout);
+        FramePacerPrint(stdout);
+        if (camera)
+        {
+            CameraSourceStats cameraStats;
+            CameraSourceGetStats(&cameraStats);
+            TexStreamStats streamStats;
+            TexStreamGetStats(&streamStats);
+            printf("camera: %llu frames produced, %llu shown, %llu dropped, %llu producer stalls\n",
+                   cameraStats.produced, streamStats.frames, cameraStats.dropped, cameraStats.stalls);
+            if (streamStats.direct)
+            {
+                printf("texstream: zero-copy mapping, %.3f ms per frame to invalidate\n",
+                       (streamStats.frames > 0) ? streamStats.mapMs / streamStats.frames : 0.0);
+            }
+            else
+            {
+                printf("texstream: upload, %llu bytes copied, %.3f ms per frame\n",
+                       streamStats.bytes, (streamStats.frames > 0) ? streamStats.uploadMs / streamStats.frames : 0.0);
+            }
+            CameraCleanup();
+        }
+        if (offscreen)
+        {
+            OffscreenStats readStats;
+            OffscreenGetStats(&readStats);
+            int written = FrameWriterClose();
+
+            FrameWriterStats dumpStats;
+            FrameWriterGetStats(&dumpStats);
+            printf("offscreen: %llu frames read back, %d in flight, %s, %llu waits (%.3f ms), %.3f ms per readback\n",
+                   readStats.frames, readStats.depth, readStats.fences ? "fenced" : "no fences",
+                   readStats.waits, readStats.waitMs,
+                   (readStats.frames > 0) ? readStats.readMs / readStats.frames : 0.0);
+            printf("dump: %llu frames, %llu bytes to %s%s, %llu writer stalls, checksum %08x, last frame %08x\n",
+                   dumpStats.frames, dumpStats.bytes, dumpTarget, written ? "" : " (write error)",
+                   dumpStats.stalls, dumpStats.checksum, dumpStats.lastChecksum);
+            OffscreenDestroy();
+        }
+        if (idleAware)
+        {
+            printf("idle: %d frames presented, %d unchanged frames skipped, %s\n",
+                   frameCount, skippedFrames, DamageSurfaceMode());
+        }
 
         RenderCleanup();
     }
 
     // cleanup
+    ShaderProgramWorkerStop();
     DestroyShaders();
+
+    if (GlTraceActive())
+    {
+        unsigned long long records, bytes;
+        GlTraceGetStats(&records, &bytes);
+        if (GlTraceClose())
+        {
+            printf("trace: %llu records, %llu bytes written to %s\n", records, bytes, traceFName);
+        }
+    }
     vdkFinishEGL(&egl);
+    SceneDestroy(&scene);
+    FrameArenaDestroy();
 
     return 0;
 }
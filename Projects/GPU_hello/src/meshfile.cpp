@@ -0,0 +1,149 @@
+/*
+ * Binary mesh files.
+ */
+
+#include "meshfile.h"
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/***************************************************************************************
+***************************************************************************************/
+
+int MeshFileCheck(const void * Data, size_t Size, const char ** Error)
+{
+    const MeshHeader * header = (const MeshHeader *)Data;
+    if ((Size < sizeof(MeshHeader)) || (header->magic != MESH_MAGIC))
+    {
+        *Error = "not a mesh file";
+        return 0;
+    }
+    if (header->version != MESH_VERSION)
+    {
+        *Error = "unsupported version";
+        return 0;
+    }
+
+    int quantized = (header->flags & MESH_QUANTIZED) != 0;
+    size_t stride = quantized ? sizeof(MeshVertexShort) : sizeof(MeshVertexFloat);
+    size_t indexSize = (header->flags & MESH_INDEX32) ? 4 : 2;
+    if ((header->vertexStride != stride) || (header->indexCount % 3 != 0) ||
+        (!(header->flags & MESH_INDEX32) && (header->vertexCount > 65536)))
+    {
+        *Error = "inconsistent header";
+        return 0;
+    }
+
+    // In size_t, so large counts cannot wrap around.
+    size_t vertexEnd = header->vertexOffset + (size_t)header->vertexCount * stride;
+    size_t indexEnd = header->indexOffset + (size_t)header->indexCount * indexSize;
+    if ((header->vertexOffset % MESH_ALIGN != 0) || (header->indexOffset % MESH_ALIGN != 0) ||
+        (header->vertexOffset < sizeof(MeshHeader)) || (header->indexOffset < vertexEnd) ||
+        (vertexEnd > Size) || (indexEnd > Size))
+    {
+        *Error = "blocks outside the file";
+        return 0;
+    }
+    return 1;
+}
+
+int MeshFileOpen(const char * Path, MeshFile * Mesh)
+{
+    memset(Mesh, 0, sizeof(*Mesh));
+
+    int fd = open(Path, O_RDONLY);
+    if (fd < 0)
+    {
+        fprintf(stderr, "Cannot open mesh file %s.\n", Path);
+        return 0;
+    }
+    struct stat info;
+    if ((fstat(fd, &info) != 0) || (info.st_size <= 0))
+    {
+        fprintf(stderr, "Cannot read mesh file %s.\n", Path);
+        close(fd);
+        return 0;
+    }
+
+    // The mapping stays valid after the descriptor is closed.
+    void * mapping = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED)
+    {
+        fprintf(stderr, "Cannot map mesh file %s.\n", Path);
+        return 0;
+    }
+
+    const char * error = NULL;
+    if (!MeshFileCheck(mapping, (size_t)info.st_size, &error))
+    {
+        fprintf(stderr, "Mesh file %s: %s.\n", Path, error);
+        munmap(mapping, (size_t)info.st_size);
+        return 0;
+    }
+
+    Mesh->mapping = mapping;
+    Mesh->size = (size_t)info.st_size;
+    Mesh->header = (const MeshHeader *)mapping;
+    Mesh->vertices = (const char *)mapping + Mesh->header->vertexOffset;
+    Mesh->indices = (const char *)mapping + Mesh->header->indexOffset;
+    return 1;
+}
+
+void MeshFileClose(MeshFile * Mesh)
+{
+    if (Mesh->mapping != NULL)
+    {
+        munmap(Mesh->mapping, Mesh->size);
+    }
+    memset(Mesh, 0, sizeof(*Mesh));
+}
+
+int MeshFilePrefault(const MeshFile * Mesh)
+{
+    if (Mesh->mapping == NULL)
+    {
+        return 0;
+    }
+    madvise(Mesh->mapping, Mesh->size, MADV_WILLNEED);
+
+    // One read per page; the sum keeps the reads from being optimised out.
+    long page = sysconf(_SC_PAGESIZE);
+    page = (page > 0) ? page : 4096;
+    const volatile unsigned char * bytes = (const volatile unsigned char *)Mesh->mapping;
+    unsigned int sum = 0;
+    for (size_t offset = 0; offset < Mesh->size; offset += (size_t)page)
+    {
+        sum += bytes[offset];
+    }
+    (void)sum;
+
+    // The indices are in memory now; the largest one is enough to check.
+    const MeshHeader * header = Mesh->header;
+    unsigned int largest = 0;
+    if (header->flags & MESH_INDEX32)
+    {
+        const unsigned int * indices = (const unsigned int *)Mesh->indices;
+        for (unsigned int i = 0; i < header->indexCount; ++i)
+        {
+            largest = (indices[i] > largest) ? indices[i] : largest;
+        }
+    }
+    else
+    {
+        const unsigned short * indices = (const unsigned short *)Mesh->indices;
+        for (unsigned int i = 0; i < header->indexCount; ++i)
+        {
+            largest = (indices[i] > largest) ? indices[i] : largest;
+        }
+    }
+    if ((header->indexCount > 0) && (largest >= header->vertexCount))
+    {
+        fprintf(stderr, "Mesh file: index %u of %u vertices.\n", largest, header->vertexCount);
+        return 0;
+    }
+    return 1;
+}
@@ -0,0 +1,91 @@
+/*
+ * Binary mesh files.
+ *
+ * Indexed triangle lists as the GPU takes them, written offline by
+ * gpu_meshconv (Projects/GPU_meshconv): a fixed header, then the
+ * interleaved vertices, then the indices, each block aligned to MESH_ALIGN
+ * from the start of the file. Loading maps the file and checks the header,
+ * prefaulting checks every index against the vertex count; the blocks go
+ * to glBufferData() straight from the mapping, nothing is copied on the
+ * way. The converter has already put the indices
+ * in vertex cache order and the vertices in the order of first use.
+ *
+ * Vertices hold a position and an RGBA8 color. Quantized positions are
+ * normalized shorts over the bounding box; the real position is
+ * stored * scale + offset, which the renderer folds into the object
+ * transform. Indices are 16-bit, or 32-bit beyond 65536 vertices (needs
+ * GL_OES_element_index_uint). Everything is little-endian.
+ */
+
+#ifndef MESHFILE_H
+#define MESHFILE_H
+
+#include <stddef.h>
+
+#define MESH_MAGIC      0x4853454D  // "MESH"
+#define MESH_VERSION    1
+#define MESH_ALIGN      64
+
+// Header flags.
+#define MESH_QUANTIZED  0x1         // positions are MeshVertexShort
+#define MESH_INDEX32    0x2         // indices are 32-bit
+
+typedef struct _MeshHeader
+{
+    unsigned int    magic;
+    unsigned int    version;
+    unsigned int    flags;
+    unsigned int    vertexCount;
+    unsigned int    indexCount;     // three per triangle
+    unsigned int    vertexStride;   // bytes
+    unsigned int    vertexOffset;   // bytes from the start of the file
+    unsigned int    indexOffset;
+    float           scale[3];       // position = stored * scale + offset
+    float           offset[3];
+}
+MeshHeader;
+
+typedef struct _MeshVertexFloat
+{
+    float           position[3];
+    unsigned char   color[4];
+}
+MeshVertexFloat;
+
+typedef struct _MeshVertexShort
+{
+    short           position[4];    // xyz, w is padding
+    unsigned char   color[4];
+}
+MeshVertexShort;
+
+typedef struct _MeshFile
+{
+    const MeshHeader *  header;
+    const void *        vertices;
+    const void *        indices;
+    void *              mapping;
+    size_t              size;
+}
+MeshFile;
+
+// Maps the file read-only and checks that the header and the blocks fit.
+// returns 0: fail
+//         1: success
+int MeshFileOpen(const char * Path, MeshFile * Mesh);
+void MeshFileClose(MeshFile * Mesh);
+
+// Faults every page of the mapping in, so the upload does not stop on page
+// faults, and checks that no index is past the vertices, which the header
+// check cannot see; meant for a thread of its own while the context is
+// created. A mesh that fails must not be drawn.
+// returns 0: fail
+//         1: success
+int MeshFilePrefault(const MeshFile * Mesh);
+
+// The same checks on a file image in memory; Error gets the reason.
+// returns 0: invalid
+//         1: valid
+int MeshFileCheck(const void * Data, size_t Size, const char ** Error);
+
+#endif /* MESHFILE_H */
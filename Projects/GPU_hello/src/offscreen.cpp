@@ -0,0 +1,175 @@
+/*
+ * Offscreen rendering with asynchronous readback.
+ *
+ * Slots are used round-robin: offscreenHead counts frames rendered,
+ * offscreenTail frames read back, and the slots in between are in flight.
+ */
+
+#include "offscreen.h"
+#include "extensions.h"
+#include "framestats.h"
+#include "framewriter.h"
+#include <GLES2/gl2.h>
+#include "gltrace.h"
+#include <string.h>
+
+typedef struct _OffscreenSlot
+{
+    GLuint      texture;
+    GLuint      framebuffer;
+    EGLSyncKHR  fence;
+    int         flushed;    // the fence's commands were flushed by a wait
+}
+OffscreenSlot;
+
+static OffscreenSlot offscreenSlots[OFFSCREEN_MAX_DEPTH];
+static int offscreenDepth = 0;
+static int offscreenWidth = 0;
+static int offscreenHeight = 0;
+static unsigned long long offscreenHead = 0;
+static unsigned long long offscreenTail = 0;
+static OffscreenStats offscreenStats;
+
+// Whether the oldest frame in flight has finished; with Wait it blocks until so.
+static int offscreenReady(int Wait)
+{
+    OffscreenSlot * slot = &offscreenSlots[offscreenTail % offscreenDepth];
+    if (slot->fence == EGL_NO_SYNC_KHR)
+    {
+        // No fences: only a full ring of newer frames is reason enough.
+        return Wait || (offscreenHead - offscreenTail >= (unsigned long long)offscreenDepth);
+    }
+
+    if (EglFenceWait(slot->fence, 0, &slot->flushed))
+    {
+        return 1;
+    }
+    if (!Wait)
+    {
+        return 0;
+    }
+
+    unsigned long long start = FrameStatsNs();
+    EglFenceWait(slot->fence, 1, &slot->flushed);
+    ++offscreenStats.waits;
+    offscreenStats.waitMs += (FrameStatsNs() - start) / 1e6;
+    return 1;
+}
+
+// Reads back the oldest frame in flight, which must have finished.
+static void offscreenRead(void)
+{
+    OffscreenSlot * slot = &offscreenSlots[offscreenTail % offscreenDepth];
+    EglFenceDestroy(slot->fence);
+    slot->fence = EGL_NO_SYNC_KHR;
+
+    unsigned char * pixels = FrameWriterAcquire();
+    unsigned long long start = FrameStatsNs();
+    glBindFramebuffer(GL_FRAMEBUFFER, slot->framebuffer);
+    glReadPixels(0, 0, offscreenWidth, offscreenHeight, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+    offscreenStats.readMs += (FrameStatsNs() - start) / 1e6;
+    FrameWriterSubmit();
+
+    ++offscreenStats.frames;
+    ++offscreenTail;
+}
+
+/***************************************************************************************
+***************************************************************************************/
+
+int OffscreenInit(EGLDisplay Display, int Width, int Height, int Depth)
+{
+    memset(offscreenSlots, 0, sizeof(offscreenSlots));
+    memset(&offscreenStats, 0, sizeof(offscreenStats));
+    offscreenWidth = Width;
+    offscreenHeight = Height;
+    offscreenDepth = (Depth < 1) ? 1 : ((Depth > OFFSCREEN_MAX_DEPTH) ? OFFSCREEN_MAX_DEPTH : Depth);
+    offscreenHead = offscreenTail = 0;
+
+    offscreenStats.fences = EglFenceInit(Display);
+
+    for (int i = 0; i < offscreenDepth; ++i)
+    {
+        OffscreenSlot * slot = &offscreenSlots[i];
+        glGenTextures(1, &slot->texture);
+        glBindTexture(GL_TEXTURE_2D, slot->texture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, Width, Height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+
+        glGenFramebuffers(1, &slot->framebuffer);
+        glBindFramebuffer(GL_FRAMEBUFFER, slot->framebuffer);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, slot->texture, 0);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        {
+            fprintf(stderr, "Offscreen framebuffer %dx%d is incomplete.\n", Width, Height);
+            OffscreenDestroy();
+            return 0;
+        }
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    offscreenStats.depth = offscreenDepth;
+    return 1;
+}
+
+void OffscreenDestroy(void)
+{
+    for (int i = 0; i < offscreenDepth; ++i)
+    {
+        OffscreenSlot * slot = &offscreenSlots[i];
+        EglFenceDestroy(slot->fence);
+        if (slot->framebuffer != 0)
+        {
+            glDeleteFramebuffers(1, &slot->framebuffer);
+        }
+        if (slot->texture != 0)
+        {
+            glDeleteTextures(1, &slot->texture);
+        }
+    }
+    memset(offscreenSlots, 0, sizeof(offscreenSlots));
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    offscreenDepth = 0;
+}
+
+void OffscreenBegin(void)
+{
+    // The ring is full: the oldest frame's framebuffer is the one to reuse.
+    if (offscreenHead - offscreenTail >= (unsigned long long)offscreenDepth)
+    {
+        offscreenReady(1);
+        offscreenRead();
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, offscreenSlots[offscreenHead % offscreenDepth].framebuffer);
+}
+
+void OffscreenEnd(void)
+{
+    OffscreenSlot * slot = &offscreenSlots[offscreenHead % offscreenDepth];
+    slot->fence = EglFenceCreate();
+    slot->flushed = 0;
+    ++offscreenHead;
+
+    while ((offscreenTail < offscreenHead) && offscreenReady(0))
+    {
+        offscreenRead();
+    }
+}
+
+void OffscreenFinish(void)
+{
+    while (offscreenTail < offscreenHead)
+    {
+        offscreenReady(1);
+        offscreenRead();
+    }
+}
+
+void OffscreenGetStats(OffscreenStats * Stats)
+{
+    *Stats = offscreenStats;
+}
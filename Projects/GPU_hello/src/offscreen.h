@@ -0,0 +1,54 @@
+/*
+ * Offscreen rendering with asynchronous readback.
+ *
+ * The scene renders into a ring of framebuffer objects instead of the
+ * window surface. Each frame ends with a fence (EGL_KHR_fence_sync) and is
+ * read back only once that fence has signaled, or when its framebuffer is
+ * needed again Depth frames later, so the readback of frame N overlaps the
+ * rendering of the frames after it instead of draining the pipeline every
+ * frame. GLES2 has no pixel buffer objects; the fence is what keeps
+ * glReadPixels() from waiting for unfinished work. Without fences a frame
+ * is read back once Depth - 1 newer frames were submitted.
+ *
+ * The pixels go to the frame writer (framewriter.h), which must be open.
+ */
+
+#ifndef OFFSCREEN_H
+#define OFFSCREEN_H
+
+#include <EGL/egl.h>
+#include <stdio.h>
+
+#define OFFSCREEN_MAX_DEPTH 8
+
+typedef struct _OffscreenStats
+{
+    unsigned long long  frames;     // read back
+    unsigned long long  waits;      // frames whose readback had to wait for the GPU
+    double              waitMs;     // in those waits
+    double              readMs;     // in glReadPixels()
+    int                 depth;
+    int                 fences;     // EGL_KHR_fence_sync is used
+}
+OffscreenStats;
+
+// RGBA8 framebuffers of Width x Height, Depth (1 .. OFFSCREEN_MAX_DEPTH)
+// frames in flight. Needs the current context on Display.
+// returns 0: fail
+//         1: success
+int OffscreenInit(EGLDisplay Display, int Width, int Height, int Depth);
+void OffscreenDestroy(void);
+
+// Binds the framebuffer of the next frame; reads back the frame that used
+// it before if that is still pending.
+void OffscreenBegin(void);
+
+// Fences the frame and reads back the ones that have finished.
+void OffscreenEnd(void);
+
+// Reads back every frame still in flight.
+void OffscreenFinish(void);
+
+void OffscreenGetStats(OffscreenStats * Stats);
+
+#endif /* OFFSCREEN_H */
@@ -0,0 +1,280 @@
+/*
+ * Persistent program binary cache.
+ *
+ * One file per program, <dir>/program-<key>.bin: a fixed header followed by
+ * the driver's binary blob. Entries are written to a unique temporary file
+ * in the same directory and renamed into place, so processes storing the
+ * same key at once each publish a whole entry.
+ */
+
+#include "programcache.h"
+#include "extensions.h"
+#include <GLES2/gl2ext.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#define CACHE_MAGIC     0x43425047u     // "GPBC"
+#define CACHE_VERSION   1u
+
+typedef struct _ProgramCacheHeader
+{
+    unsigned int        magic;
+    unsigned int        version;
+    unsigned long long  key;
+    unsigned int        format;
+    unsigned int        length;
+}
+ProgramCacheHeader;
+
+static char cacheDir[256];
+static int cacheEnabled = 0;
+// Counted from the shader worker as well.
+static int cacheHits = 0;
+static int cacheMisses = 0;
+
+/***************************************************************************************
+***************************************************************************************/
+
+static unsigned long long fnv1a(unsigned long long Hash, const void * Data, size_t Length)
+{
+    const unsigned char * bytes = (const unsigned char *)Data;
+    for (size_t i = 0; i < Length; ++i)
+    {
+        Hash ^= bytes[i];
+        Hash *= 0x100000001B3ULL;
+    }
+    return Hash;
+}
+
+static unsigned long long fnv1aString(unsigned long long Hash, const char * String)
+{
+    // Keep a separator so "ab" + "c" and "a" + "bc" differ.
+    if (String != NULL)
+    {
+        Hash = fnv1a(Hash, String, strlen(String));
+    }
+    return fnv1a(Hash, "", 1);
+}
+
+static void cachePath(char * Path, size_t Size, unsigned long long Key)
+{
+    snprintf(Path, Size, "%s/program-%016llx.bin", cacheDir, Key);
+}
+
+/***************************************************************************************
+***************************************************************************************/
+
+void ProgramCacheInit(const char * Dir)
+{
+    cacheEnabled = 0;
+    cacheHits = cacheMisses = 0;
+
+    if ((Dir == NULL) || (Dir[0] == '\0'))
+    {
+        return;
+    }
+
+    GLint formats = 0;
+    if (HasGLExtension("GL_OES_get_program_binary"))
+    {
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS_OES, &formats);
+    }
+    if (formats <= 0)
+    {
+        fprintf(stderr, "Program binaries not supported, shader cache disabled.\n");
+        return;
+    }
+
+    snprintf(cacheDir, sizeof(cacheDir), "%s", Dir);
+    cacheEnabled = 1;
+}
+
+int ProgramCacheEnabled(void)
+{
+    return cacheEnabled;
+}
+
+unsigned long long ProgramCacheKey(const char * VertexSource, int VertexLength,
+                                   const char * FragmentSource, int FragmentLength,
+                                   const char * Defines)
+{
+    unsigned long long hash = 0xCBF29CE484222325ULL;
+
+    hash = fnv1a(hash, VertexSource, VertexLength);
+    hash = fnv1a(hash, "", 1);
+    hash = fnv1a(hash, FragmentSource, FragmentLength);
+    hash = fnv1a(hash, "", 1);
+    hash = fnv1aString(hash, Defines);
+    hash = fnv1aString(hash, (const char *)glGetString(GL_VENDOR));
+    hash = fnv1aString(hash, (const char *)glGetString(GL_RENDERER));
+    hash = fnv1aString(hash, (const char *)glGetString(GL_VERSION));
+    return hash;
+}
+
+GLuint ProgramCacheLoad(unsigned long long Key)
+{
+    if (!cacheEnabled)
+    {
+        return 0;
+    }
+
+    char path[320];
+    cachePath(path, sizeof(path), Key);
+
+    FILE * fptr = fopen(path, "rb");
+    if (fptr == NULL)
+    {
+        __sync_fetch_and_add(&cacheMisses, 1);
+        return 0;
+    }
+
+    ProgramCacheHeader header;
+    void * binary = NULL;
+    int valid = (fread(&header, sizeof(header), 1, fptr) == 1)
+             && (header.magic == CACHE_MAGIC) && (header.version == CACHE_VERSION)
+             && (header.key == Key) && (header.length > 0);
+
+    if (valid)
+    {
+        binary = malloc(header.length);
+        valid = (binary != NULL) && (fread(binary, header.length, 1, fptr) == 1);
+    }
+    fclose(fptr);
+
+    GLuint program = 0;
+    if (valid)
+    {
+        program = glCreateProgram();
+        glProgramBinaryOES(program, header.format, binary, header.length);
+
+        GLint linked = GL_FALSE;
+        glGetProgramiv(program, GL_LINK_STATUS, &linked);
+        if (!linked)
+        {
+            glDeleteProgram(program);
+            program = 0;
+        }
+    }
+    free(binary);
+
+    if (program == 0)
+    {
+        // Stale or corrupt, e.g. the driver changed its binary format.
+        fprintf(stderr, "Discarding program cache entry '%s'\n", path);
+        remove(path);
+        __sync_fetch_and_add(&cacheMisses, 1);
+        return 0;
+    }
+
+    __sync_fetch_and_add(&cacheHits, 1);
+    return program;
+}
+
+int ProgramCacheStore(unsigned long long Key, GLuint Program)
+{
+    if (!cacheEnabled || (Program == 0))
+    {
+        return 0;
+    }
+
+    GLint length = 0;
+    glGetProgramiv(Program, GL_PROGRAM_BINARY_LENGTH_OES, &length);
+    if (length <= 0)
+    {
+        return 0;
+    }
+
+    void * binary = malloc(length);
+    if (binary == NULL)
+    {
+        fprintf(stderr, "Out of memory.\n");
+        return 0;
+    }
+
+    ProgramCacheHeader header;
+    GLsizei written = 0;
+    GLenum format = 0;
+    glGetProgramBinaryOES(Program, length, &written, &format, binary);
+
+    header.magic   = CACHE_MAGIC;
+    header.version = CACHE_VERSION;
+    header.key     = Key;
+    header.format  = format;
+    header.length  = written;
+
+    // Write to a temporary name of this process first so a crash or another
+    // process never leaves a torn entry; not "program-", so not prefetched.
+    char path[320];
+    char temp[330];
+    cachePath(path, sizeof(path), Key);
+    snprintf(temp, sizeof(temp), "%s/tmp-program-XXXXXX", cacheDir);
+
+    int result = 0;
+    int fd = mkstemp(temp);
+    FILE * fptr = (fd >= 0) ? fdopen(fd, "wb") : NULL;
+    if ((fptr == NULL) && (fd >= 0))
+    {
+        close(fd);
+        remove(temp);
+    }
+    if (fptr != NULL)
+    {
+        result = (written > 0)
+              && (fwrite(&header, sizeof(header), 1, fptr) == 1)
+              && (fwrite(binary, written, 1, fptr) == 1);
+        result = (fclose(fptr) == 0) && result;
+        result = result && (rename(temp, path) == 0);
+        if (!result)
+        {
+            remove(temp);
+        }
+    }
+    free(binary);
+
+    if (!result)
+    {
+        fprintf(stderr, "Cannot write program cache entry '%s'\n", path);
+    }
+    return result;
+}
+
+void ProgramCacheGetStats(int * Hits, int * Misses)
+{
+    *Hits = cacheHits;
+    *Misses = cacheMisses;
+}
+
+void ProgramCachePrefetch(const char * Dir)
+{
+    if ((Dir == NULL) || (Dir[0] == '\0'))
+    {
+        return;
+    }
+    DIR * dir = opendir(Dir);
+    if (dir == NULL)
+    {
+        return;
+    }
+
+    struct dirent * entry;
+    while ((entry = readdir(dir)) != NULL)
+    {
+        if (strncmp(entry->d_name, "program-", 8) != 0)
+        {
+            continue;
+        }
+        char path[320];
+        snprintf(path, sizeof(path), "%s/%s", Dir, entry->d_name);
+        int fd = open(path, O_RDONLY);
+        if (fd >= 0)
+        {
+            posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+            close(fd);
+        }
+    }
+    closedir(dir);
+}
@@ -0,0 +1,39 @@
+/*
+ * Persistent program binary cache.
+ *
+ * Linked programs are saved with GL_OES_get_program_binary and reloaded on
+ * the next start instead of compiling the shaders again. Entries are keyed
+ * by a 64-bit FNV-1a hash of both shader sources, the preprocessor defines
+ * and the GL vendor, renderer and version strings, so a new driver or an
+ * edited shader simply misses. An entry the driver rejects is deleted.
+ */
+
+#ifndef PROGRAMCACHE_H
+#define PROGRAMCACHE_H
+
+#include <GLES2/gl2.h>
+
+// Needs a current context. Dir == NULL or an unsupported driver disables
+// the cache; every lookup then misses and nothing is stored.
+void ProgramCacheInit(const char * Dir);
+int ProgramCacheEnabled(void);
+
+unsigned long long ProgramCacheKey(const char * VertexSource, int VertexLength,
+                                   const char * FragmentSource, int FragmentLength,
+                                   const char * Defines);
+
+// returns the linked program, or 0 on a miss
+GLuint ProgramCacheLoad(unsigned long long Key);
+
+// returns 0: fail
+//         1: success
+int ProgramCacheStore(unsigned long long Key, GLuint Program);
+
+void ProgramCacheGetStats(int * Hits, int * Misses);
+
+// Starts reading every entry in Dir into the page cache, so the loads after
+// ProgramCacheInit() do not wait for the disk. Needs no context; may run on
+// any thread before the cache is used.
+void ProgramCachePrefetch(const char * Dir);
+
+#endif /* PROGRAMCACHE_H */
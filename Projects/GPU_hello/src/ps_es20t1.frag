@@ -1,6 +1,27 @@
+#ifdef GL_ES
+precision mediump float;
+#endif
+
 varying vec4 color;
 
+#ifdef TEXTURED
+uniform sampler2D my_Texture;
+varying vec2 texCoord;
+#endif
+
+#ifdef FOG
+uniform vec4 my_FogColor;
+varying float fog;
+#endif
+
 void main (void)
 {
-gl_FragColor = color;
+vec4 result = color;
+#ifdef TEXTURED
+result *= texture2D(my_Texture, texCoord);
+#endif
+#ifdef FOG
+result.rgb = mix(result.rgb, my_FogColor.rgb, fog);
+#endif
+gl_FragColor = result;
 }
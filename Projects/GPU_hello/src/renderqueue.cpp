@@ -0,0 +1,228 @@
+/*
+ * Sort-keyed render queue.
+ *
+ * The sort is a least significant digit radix sort on bytes, ping-ponging
+ * between two arrays; a byte that is the same in every key (the unused
+ * low bits, one layer, one program) has a single bucket and its pass is
+ * skipped.
+ */
+
+#include "renderqueue.h"
+#include "framestats.h"
+#include "glstate.h"
+#include <stdlib.h>
+#include <string.h>
+#include "gltrace.h"
+
+#define KEY_LAYER_SHIFT         60
+#define KEY_TRANSLUCENT_SHIFT   59
+#define KEY_DEPTH_BITS          24
+
+typedef struct _QueueEntry
+{
+    unsigned long long  key;
+    unsigned int        payload;
+}
+QueueEntry;
+
+static QueueEntry * queueEntries = NULL;
+static QueueEntry * queueScratch = NULL;
+static int queueCapacity = 0;
+static int queueCount = 0;
+static GLuint queuePrograms[RENDER_QUEUE_PROGRAMS];
+static int queueProgramCount = 0;
+static GLuint queueTextures[RENDER_QUEUE_TEXTURES];
+static int queueTextureCount = 0;
+static RenderQueueStats queueStats;
+
+/***************************************************************************************
+***************************************************************************************/
+
+// returns the id of Name in Table, added if new, or -1 when full
+static int queueRegister(GLuint * Table, int * Count, int Size, GLuint Name)
+{
+    for (int i = 0; i < *Count; ++i)
+    {
+        if (Table[i] == Name)
+        {
+            return i;
+        }
+    }
+    if (*Count == Size)
+    {
+        return -1;
+    }
+    Table[*Count] = Name;
+    return (*Count)++;
+}
+
+/***************************************************************************************
+***************************************************************************************/
+
+int RenderQueueInit(int Capacity)
+{
+    RenderQueueDestroy();
+    queueEntries = (QueueEntry *)malloc(Capacity * sizeof(QueueEntry));
+    queueScratch = (QueueEntry *)malloc(Capacity * sizeof(QueueEntry));
+    if ((queueEntries == NULL) || (queueScratch == NULL))
+    {
+        RenderQueueDestroy();
+        return 0;
+    }
+    queueCapacity = Capacity;
+
+    // Id 0 is always "no texture".
+    queueTextures[0] = 0;
+    queueTextureCount = 1;
+    return 1;
+}
+
+void RenderQueueDestroy(void)
+{
+    free(queueEntries);
+    free(queueScratch);
+    queueEntries = NULL;
+    queueScratch = NULL;
+    queueCapacity = 0;
+    queueCount = 0;
+    queueProgramCount = 0;
+    queueTextureCount = 0;
+    memset(&queueStats, 0, sizeof(queueStats));
+}
+
+int RenderQueueProgram(GLuint Program)
+{
+    return queueRegister(queuePrograms, &queueProgramCount, RENDER_QUEUE_PROGRAMS, Program);
+}
+
+int RenderQueueTexture(GLuint Texture)
+{
+    return queueRegister(queueTextures, &queueTextureCount, RENDER_QUEUE_TEXTURES, Texture);
+}
+
+unsigned long long RenderQueueKey(int Layer, int Translucent, int Program, int Texture, float Depth)
+{
+    Depth = (Depth < 0.0f) ? 0.0f : ((Depth > 1.0f) ? 1.0f : Depth);
+    unsigned long long depth = (unsigned long long)(Depth * ((1 << KEY_DEPTH_BITS) - 1));
+    unsigned long long state = ((unsigned long long)(Program & 0xFF) << 10) | (Texture & 0x3FF);
+    unsigned long long key = (unsigned long long)(Layer & 0xF) << KEY_LAYER_SHIFT;
+    if (Translucent)
+    {
+        // Far first.
+        depth ^= (1 << KEY_DEPTH_BITS) - 1;
+        key |= (1ull << KEY_TRANSLUCENT_SHIFT) | (depth << 35) | (state << 17);
+    }
+    else
+    {
+        key |= (state << 41) | (depth << 17);
+    }
+    return key;
+}
+
+void RenderQueueBegin(void)
+{
+    queueCount = 0;
+}
+
+int RenderQueueSubmit(unsigned long long Key, unsigned int Payload)
+{
+    if (queueCount == queueCapacity)
+    {
+        return 0;
+    }
+    queueEntries[queueCount].key = Key;
+    queueEntries[queueCount].payload = Payload;
+    ++queueCount;
+    return 1;
+}
+
+void RenderQueueSort(void)
+{
+    unsigned long long start = FrameStatsNs();
+    for (int shift = 0; shift < 64; shift += 8)
+    {
+        int counts[256];
+        memset(counts, 0, sizeof(counts));
+        for (int i = 0; i < queueCount; ++i)
+        {
+            ++counts[(queueEntries[i].key >> shift) & 0xFF];
+        }
+        if ((queueCount == 0) || (counts[(queueEntries[0].key >> shift) & 0xFF] == queueCount))
+        {
+            continue;
+        }
+
+        int offset = 0;
+        for (int b = 0; b < 256; ++b)
+        {
+            int count = counts[b];
+            counts[b] = offset;
+            offset += count;
+        }
+        for (int i = 0; i < queueCount; ++i)
+        {
+            queueScratch[counts[(queueEntries[i].key >> shift) & 0xFF]++] = queueEntries[i];
+        }
+        QueueEntry * swap = queueEntries;
+        queueEntries = queueScratch;
+        queueScratch = swap;
+    }
+    queueStats.sortMs += (FrameStatsNs() - start) / 1e6;
+}
+
+void RenderQueueExecute(RenderQueueDraw Draw, void * User)
+{
+    int program = -1;
+    int texture = -1;
+    int translucent = -1;
+    for (int i = 0; i < queueCount; ++i)
+    {
+        unsigned long long key = queueEntries[i].key;
+        int keyTranslucent = (int)((key >> KEY_TRANSLUCENT_SHIFT) & 1);
+        unsigned int state = (unsigned int)(key >> (keyTranslucent ? 17 : 41)) & 0x3FFFF;
+        int keyProgram = (int)(state >> 10);
+        int keyTexture = (int)(state & 0x3FF);
+
+        if (keyTranslucent != translucent)
+        {
+            if (keyTranslucent)
+            {
+                GlStateEnable(GL_BLEND);
+                GlStateBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+                GlStateDepthMask(GL_FALSE);
+            }
+            else
+            {
+                GlStateDisable(GL_BLEND);
+                GlStateDepthMask(GL_TRUE);
+            }
+            translucent = keyTranslucent;
+            ++queueStats.blends;
+        }
+        if (keyProgram != program)
+        {
+            GlStateUseProgram((keyProgram < queueProgramCount) ? queuePrograms[keyProgram] : 0);
+            program = keyProgram;
+            ++queueStats.programs;
+        }
+        if (keyTexture != texture)
+        {
+            glBindTexture(GL_TEXTURE_2D, (keyTexture < queueTextureCount) ? queueTextures[keyTexture] : 0);
+            texture = keyTexture;
+            ++queueStats.textures;
+        }
+        Draw(queueEntries[i].payload, User);
+    }
+    queueStats.draws += queueCount;
+    ++queueStats.frames;
+}
+
+int RenderQueueCount(void)
+{
+    return queueCount;
+}
+
+void RenderQueueGetStats(RenderQueueStats * Stats)
+{
+    *Stats = queueStats;
+}
@@ -0,0 +1,83 @@
+/*
+ * Sort-keyed render queue.
+ *
+ * Draws are submitted as a 64-bit sort key and a payload index, radix
+ * sorted once per frame and executed in key order, so draws sharing a
+ * program, texture and blend mode run together and each state change is
+ * made once per run instead of once per draw. The key, most significant
+ * bits first:
+ *
+ *   opaque:       layer:4  0:1  program:8  texture:10  depth:24  0:17
+ *   translucent:  layer:4  1:1  ~depth:24  program:8  texture:10  0:17
+ *
+ * Layers are drawn in order, opaque before translucent within a layer.
+ * Opaque draws are grouped by state, then front to back, so the early
+ * depth test rejects hidden fragments on a fill-rate bound GPU.
+ * Translucent draws must blend back to front, which takes precedence
+ * over their state.
+ *
+ * Programs and textures go into the key as small ids, registered once
+ * with RenderQueueProgram()/RenderQueueTexture(). Execution switches
+ * program, blend state and depth writes through glstate.h and the
+ * texture of unit 0 itself; the draw callback only sets its uniforms and
+ * vertex arrays and draws.
+ */
+
+#ifndef RENDERQUEUE_H
+#define RENDERQUEUE_H
+
+#include <GLES2/gl2.h>
+
+#define RENDER_QUEUE_LAYERS     16
+#define RENDER_QUEUE_PROGRAMS   256
+#define RENDER_QUEUE_TEXTURES   1024
+
+typedef struct _RenderQueueStats
+{
+    unsigned long long  frames;     // executed
+    unsigned long long  draws;
+    unsigned long long  programs;   // program switches
+    unsigned long long  textures;   // texture binds
+    unsigned long long  blends;     // blend on/off switches
+    double              sortMs;
+}
+RenderQueueStats;
+
+// Called for each draw in key order, with the state of its key set.
+typedef void (*RenderQueueDraw)(unsigned int Payload, void * User);
+
+// Room for Capacity draws per frame.
+// returns 0: out of memory
+//         1: success
+int RenderQueueInit(int Capacity);
+void RenderQueueDestroy(void);
+
+// The id of Program or Texture (0 for none) in keys, registering it the
+// first time.
+// returns the id, or -1 when the table is full
+int RenderQueueProgram(GLuint Program);
+int RenderQueueTexture(GLuint Texture);
+
+// Depth is the view distance scaled to 0 (near) .. 1 (far), clamped.
+unsigned long long RenderQueueKey(int Layer, int Translucent, int Program, int Texture, float Depth);
+
+// Empties the queue for a new frame.
+void RenderQueueBegin(void);
+
+// returns 0: queue full, the draw is dropped
+//         1: success
+int RenderQueueSubmit(unsigned long long Key, unsigned int Payload);
+
+// Sorts the submitted draws by key; stable, so equal keys keep the order
+// they were submitted in.
+void RenderQueueSort(void);
+
+// Runs the draws in queue order: sorted, or as submitted without
+// RenderQueueSort(). The first draw sets all of its state.
+void RenderQueueExecute(RenderQueueDraw Draw, void * User);
+
+int RenderQueueCount(void);
+
+void RenderQueueGetStats(RenderQueueStats * Stats);
+
+#endif /* RENDERQUEUE_H */
@@ -0,0 +1,700 @@
+/*
+ * Benchmark scenarios.
+ *
+ * The runner only forks and reads files; the runs do all the GL work, in
+ * their own processes, with stdout closed so the report stays readable.
+ */
+
+#include "scenario.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+// Knob left out of the matrix: the run does not pass its flag.
+#define KNOB_DEFAULT        -1
+
+#define MATRIX_LINE         512
+
+typedef struct _ScenarioMatrix
+{
+    int     widths[SCENARIO_MAX_VALUES];
+    int     heights[SCENARIO_MAX_VALUES];
+    int     sizeCount;
+    int     samples[SCENARIO_MAX_VALUES];
+    int     sampleCount;
+    int     objects[SCENARIO_MAX_VALUES];
+    int     objectCount;
+    int     formats[SCENARIO_MAX_VALUES];
+    int     formatCount;
+    int     filters[SCENARIO_MAX_VALUES];
+    int     filterCount;
+    int     frames;
+    int     warmup;
+    int     repeats;
+    int     warmupRuns;
+    double  threshold;      // %
+    char    argText[MATRIX_LINE];
+    char *  args[SCENARIO_MAX_ARGS];
+    int     argCount;
+}
+ScenarioMatrix;
+
+typedef struct _Scenario
+{
+    int     width;
+    int     height;
+    int     samples;
+    int     objects;
+    int     format;
+    int     filter;
+}
+Scenario;
+
+typedef struct _ScenarioResult
+{
+    Scenario        scenario;
+    char            name[64];
+    int             runs;           // timed runs that succeeded
+    int             failed;
+    double          mean;           // ms, over the runs' mean frame times
+    double          stddev;
+    double          ci95;           // half width
+    double          p99;            // ms, mean of the runs' 99th percentiles
+    int             baseRuns;       // 0: not in the baseline
+    double          baseMean;
+    double          baseStddev;
+    double          change;         // % slower than the baseline
+    const char *    verdict;
+}
+ScenarioResult;
+
+/***************************************************************************************
+***************************************************************************************/
+
+// Two-sided 95% quantile of Student's t. Fractional degrees of freedom, as
+// Welch's test has, round down, which only makes the test stricter.
+static double scenarioT95(double Df)
+{
+    static const double table[30] =
+    {
+        12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+        2.201,  2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+        2.080,  2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042
+    };
+    if (Df < 1.0)
+    {
+        return table[0];
+    }
+    if (Df < 31.0)
+    {
+        return table[(int)Df - 1];
+    }
+    return (Df < 40.0) ? 2.042 : (Df < 60.0) ? 2.021 : (Df < 120.0) ? 2.000 : 1.980;
+}
+
+// Reads the values of a knob, the rest of the line strtok() is on.
+// returns 0: fail
+//         1: success
+static int matrixValues(const char * Key, int * Values, int * Count)
+{
+    char * token;
+    *Count = 0;
+    while ((token = strtok(NULL, " \t\r\n")) != NULL)
+    {
+        char * end;
+        long value = strtol(token, &end, 10);
+        if ((*end != '\0') || (value < 0) || (*Count == SCENARIO_MAX_VALUES))
+        {
+            fprintf(stderr, "Scenario matrix: bad value '%s' of %s.\n", token, Key);
+            return 0;
+        }
+        Values[(*Count)++] = (int)value;
+    }
+    if (*Count == 0)
+    {
+        fprintf(stderr, "Scenario matrix: %s has no value.\n", Key);
+        return 0;
+    }
+    return 1;
+}
+
+static int matrixValue(const char * Key, int * Value)
+{
+    int count;
+    if (!matrixValues(Key, Value, &count))
+    {
+        return 0;
+    }
+    if (count != 1)
+    {
+        fprintf(stderr, "Scenario matrix: %s takes one value.\n", Key);
+        return 0;
+    }
+    return 1;
+}
+
+// returns 0: fail
+//         1: success
+static int matrixRead(const char * FName, ScenarioMatrix * Matrix)
+{
+    memset(Matrix, 0, sizeof(*Matrix));
+    Matrix->frames = 300;
+    Matrix->warmup = 30;
+    Matrix->repeats = 5;
+    Matrix->warmupRuns = 1;
+    Matrix->threshold = 5.0;
+
+    FILE * fptr = fopen(FName, "r");
+    if (fptr == NULL)
+    {
+        fprintf(stderr, "Cannot open file '%s'\n", FName);
+        return 0;
+    }
+
+    int result = 1;
+    size_t argLength = 0;
+    char line[MATRIX_LINE];
+    while (result && (fgets(line, sizeof(line), fptr) != NULL))
+    {
+        if ((strchr(line, '\n') == NULL) && !feof(fptr))
+        {
+            fprintf(stderr, "Scenario matrix: line longer than %d characters.\n", MATRIX_LINE - 2);
+            result = 0;
+            break;
+        }
+        char * comment = strchr(line, '#');
+        if (comment != NULL)
+        {
+            *comment = '\0';
+        }
+        char * key = strtok(line, " \t\r\n");
+        if (key == NULL)
+        {
+            continue;
+        }
+
+        if (strcmp(key, "size") == 0)
+        {
+            char * token;
+            while (result && ((token = strtok(NULL, " \t\r\n")) != NULL))
+            {
+                int width, height;
+                char rest;
+                if ((Matrix->sizeCount == SCENARIO_MAX_VALUES)
+                || (sscanf(token, "%dx%d%c", &width, &height, &rest) != 2) || (width <= 0) || (height <= 0))
+                {
+                    fprintf(stderr, "Scenario matrix: bad size '%s', WIDTHxHEIGHT.\n", token);
+                    result = 0;
+                    break;
+                }
+                Matrix->widths[Matrix->sizeCount] = width;
+                Matrix->heights[Matrix->sizeCount] = height;
+                ++Matrix->sizeCount;
+            }
+        }
+        else if (strcmp(key, "samples") == 0)
+        {
+            result = matrixValues(key, Matrix->samples, &Matrix->sampleCount);
+        }
+        else if (strcmp(key, "objects") == 0)
+        {
+            result = matrixValues(key, Matrix->objects, &Matrix->objectCount);
+        }
+        else if (strcmp(key, "vertex_format") == 0)
+        {
+            result = matrixValues(key, Matrix->formats, &Matrix->formatCount);
+        }
+        else if (strcmp(key, "state_filter") == 0)
+        {
+            result = matrixValues(key, Matrix->filters, &Matrix->filterCount);
+        }
+        else if (strcmp(key, "frames") == 0)
+        {
+            result = matrixValue(key, &Matrix->frames);
+        }
+        else if (strcmp(key, "warmup") == 0)
+        {
+            result = matrixValue(key, &Matrix->warmup);
+        }
+        else if (strcmp(key, "repeats") == 0)
+        {
+            result = matrixValue(key, &Matrix->repeats);
+        }
+        else if (strcmp(key, "warmup_runs") == 0)
+        {
+            result = matrixValue(key, &Matrix->warmupRuns);
+        }
+        else if (strcmp(key, "threshold") == 0)
+        {
+            char * token = strtok(NULL, " \t\r\n");
+            Matrix->threshold = (token != NULL) ? atof(token) : -1.0;
+            if (Matrix->threshold < 0.0)
+            {
+                fprintf(stderr, "Scenario matrix: threshold takes a percentage.\n");
+                result = 0;
+            }
+        }
+        else if (strcmp(key, "args") == 0)
+        {
+            char * token;
+            while ((token = strtok(NULL, " \t\r\n")) != NULL)
+            {
+                size_t length = strlen(token) + 1;
+                if (Matrix->argCount == SCENARIO_MAX_ARGS)
+                {
+                    fprintf(stderr, "Scenario matrix: more than %d args.\n", SCENARIO_MAX_ARGS);
+                    result = 0;
+                    break;
+                }
+                if (argLength + length > sizeof(Matrix->argText))
+                {
+                    fprintf(stderr, "Scenario matrix: args longer than %d characters in all.\n", MATRIX_LINE);
+                    result = 0;
+                    break;
+                }
+                memcpy(&Matrix->argText[argLength], token, length);
+                Matrix->args[Matrix->argCount++] = &Matrix->argText[argLength];
+                argLength += length;
+            }
+        }
+        else
+        {
+            fprintf(stderr, "Scenario matrix: unknown knob '%s'.\n", key);
+            result = 0;
+        }
+    }
+    fclose(fptr);
+
+    if (result && ((Matrix->frames <= 0) || (Matrix->repeats <= 0)))
+    {
+        fprintf(stderr, "Scenario matrix: frames and repeats must be above 0.\n");
+        result = 0;
+    }
+
+    // A knob left out has the one value "default".
+    if (Matrix->sizeCount == 0)
+    {
+        Matrix->widths[0] = Matrix->heights[0] = KNOB_DEFAULT;
+        Matrix->sizeCount = 1;
+    }
+    int * values[4]  = { Matrix->samples, Matrix->objects, Matrix->formats, Matrix->filters };
+    int * counts[4]  = { &Matrix->sampleCount, &Matrix->objectCount, &Matrix->formatCount, &Matrix->filterCount };
+    for (int k = 0; k < 4; ++k)
+    {
+        if (*counts[k] == 0)
+        {
+            values[k][0] = KNOB_DEFAULT;
+            *counts[k] = 1;
+        }
+    }
+    return result;
+}
+
+// Scenario Index of the matrix, the size varying slowest.
+static void matrixScenario(const ScenarioMatrix * Matrix, int Index, Scenario * S)
+{
+    S->filter  = Matrix->filters[Index % Matrix->filterCount];
+    Index /= Matrix->filterCount;
+    S->format  = Matrix->formats[Index % Matrix->formatCount];
+    Index /= Matrix->formatCount;
+    S->objects = Matrix->objects[Index % Matrix->objectCount];
+    Index /= Matrix->objectCount;
+    S->samples = Matrix->samples[Index % Matrix->sampleCount];
+    Index /= Matrix->sampleCount;
+    S->width   = Matrix->widths[Index];
+    S->height  = Matrix->heights[Index];
+}
+
+// Name of a scenario by the flags it sets, e.g. "640x480/s4/n100/v1/e0".
+static void scenarioName(const Scenario * S, char * Name, size_t Size)
+{
+    size_t length = 0;
+    if (S->width != KNOB_DEFAULT)
+    {
+        length += (size_t)snprintf(Name, Size, "%dx%d", S->width, S->height);
+    }
+    else
+    {
+        length += (size_t)snprintf(Name, Size, "default");
+    }
+    const char flags[4] = { 's', 'n', 'v', 'e' };
+    const int values[4] = { S->samples, S->objects, S->format, S->filter };
+    for (int k = 0; (k < 4) && (length < Size); ++k)
+    {
+        if (values[k] != KNOB_DEFAULT)
+        {
+            length += (size_t)snprintf(Name + length, Size - length, "/%c%d", flags[k], values[k]);
+        }
+    }
+}
+
+/***************************************************************************************
+***************************************************************************************/
+
+// Mean and 99th percentile of the whole frame from a FrameStatsWrite() JSON
+// file.
+// returns 0: fail
+//         1: success
+static int runReadStats(const char * FName, double * Mean, double * P99)
+{
+    FILE * fptr = fopen(FName, "r");
+    if (fptr == NULL)
+    {
+        return 0;
+    }
+    char text[4096];
+    size_t size = fread(text, 1, sizeof(text) - 1, fptr);
+    fclose(fptr);
+    text[size] = '\0';
+
+    const char * frame = strstr(text, "\"frame\":");
+    const char * frames = (frame != NULL) ? strstr(frame, "\"frames\":") : NULL;
+    const char * mean = (frame != NULL) ? strstr(frame, "\"mean\":") : NULL;
+    const char * p99 = (frame != NULL) ? strstr(frame, "\"p99\":") : NULL;
+    if ((frames == NULL) || (mean == NULL) || (p99 == NULL) || (atol(frames + 9) <= 0))
+    {
+        return 0;
+    }
+    *Mean = atof(mean + 7);
+    *P99 = atof(p99 + 6);
+    return 1;
+}
+
+// One run of the demo in the scenario.
+// returns 0: fail
+//         1: success
+static int runOnce(const char * Exe, const ScenarioMatrix * Matrix, const Scenario * S, double * Mean, double * P99)
+{
+    char statsFName[] = "/tmp/gpu_hello_run_XXXXXX";
+    int fd = mkstemp(statsFName);
+    if (fd < 0)
+    {
+        fprintf(stderr, "Cannot create a temporary file.\n");
+        return 0;
+    }
+    close(fd);
+
+    const char * argv[32 + SCENARIO_MAX_ARGS];
+    char text[8][16];
+    int argc = 0;
+    argv[argc++] = Exe;
+
+    const char flags[6] = { 'w', 'h', 's', 'n', 'v', 'e' };
+    const int values[6] = { S->width, S->height, S->samples, S->objects, S->format, S->filter };
+    char flagText[6][3];
+    for (int k = 0; k < 6; ++k)
+    {
+        if (values[k] != KNOB_DEFAULT)
+        {
+            snprintf(flagText[k], sizeof(flagText[k]), "-%c", flags[k]);
+            snprintf(text[k], sizeof(text[k]), "%d", values[k]);
+            argv[argc++] = flagText[k];
+            argv[argc++] = text[k];
+        }
+    }
+    snprintf(text[6], sizeof(text[6]), "%d", Matrix->frames + Matrix->warmup);
+    snprintf(text[7], sizeof(text[7]), "%d", Matrix->warmup);
+    argv[argc++] = "-f";
+    argv[argc++] = text[6];
+    argv[argc++] = "-u";
+    argv[argc++] = text[7];
+    argv[argc++] = "-k";
+    argv[argc++] = "0";
+    argv[argc++] = "-i";
+    argv[argc++] = "0";
+    argv[argc++] = "-o";
+    argv[argc++] = statsFName;
+    for (int a = 0; a < Matrix->argCount; ++a)
+    {
+        argv[argc++] = Matrix->args[a];
+    }
+    argv[argc] = NULL;
+
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+        int null = open("/dev/null", O_WRONLY);
+        if (null >= 0)
+        {
+            dup2(null, STDOUT_FILENO);
+            close(null);
+        }
+        execv(Exe, (char * const *)argv);
+        fprintf(stderr, "Cannot run %s.\n", Exe);
+        _exit(127);
+    }
+
+    int result = 0;
+    int status = 0;
+    if (pid > 0)
+    {
+        while ((waitpid(pid, &status, 0) < 0) && (errno == EINTR))
+        {
+        }
+        result = WIFEXITED(status) && (WEXITSTATUS(status) == 0) && runReadStats(statsFName, Mean, P99);
+    }
+    else
+    {
+        fprintf(stderr, "Cannot fork a run.\n");
+    }
+    unlink(statsFName);
+    return result;
+}
+
+/***************************************************************************************
+***************************************************************************************/
+
+// Fills in the baseline of every result found in a report of FName.
+// returns 0: fail
+//         1: success
+static int baselineRead(const char * FName, ScenarioResult * Results, int Count)
+{
+    FILE * fptr = fopen(FName, "r");
+    if (fptr == NULL)
+    {
+        fprintf(stderr, "Cannot open file '%s'\n", FName);
+        return 0;
+    }
+
+    char line[MATRIX_LINE];
+    while (fgets(line, sizeof(line), fptr) != NULL)
+    {
+        const char * name = strstr(line, "\"name\": \"");
+        const char * runs = strstr(line, "\"runs\":");
+        const char * mean = strstr(line, "\"mean_ms\":");
+        const char * stddev = strstr(line, "\"stddev_ms\":");
+        if ((name == NULL) || (runs == NULL) || (mean == NULL) || (stddev == NULL))
+        {
+            continue;
+        }
+        name += 9;
+        size_t length = strcspn(name, "\"");
+        for (int i = 0; i < Count; ++i)
+        {
+            if ((strlen(Results[i].name) == length) && (strncmp(Results[i].name, name, length) == 0))
+            {
+                Results[i].baseRuns = atoi(runs + 7);
+                Results[i].baseMean = atof(mean + 10);
+                Results[i].baseStddev = atof(stddev + 12);
+                break;
+            }
+        }
+    }
+    fclose(fptr);
+    return 1;
+}
+
+// Welch's t-test of the result against its baseline, both ways.
+static void baselineCompare(ScenarioResult * Result, double Threshold)
+{
+    if (Result->runs == 0)
+    {
+        Result->verdict = "failed";
+        return;
+    }
+    if (Result->baseRuns == 0)
+    {
+        Result->verdict = "new";
+        return;
+    }
+
+    double diff = Result->mean - Result->baseMean;
+    Result->change = (Result->baseMean > 0.0) ? diff / Result->baseMean * 100.0 : 0.0;
+
+    // Without two runs on each side there is no spread to test against.
+    if ((Result->runs < 2) || (Result->baseRuns < 2))
+    {
+        Result->verdict = "inconclusive";
+        return;
+    }
+
+    double v1 = Result->stddev * Result->stddev / Result->runs;
+    double v2 = Result->baseStddev * Result->baseStddev / Result->baseRuns;
+    int significant;
+    if (v1 + v2 > 0.0)
+    {
+        // Welch-Satterthwaite.
+        double df = v1 * v1 / (Result->runs - 1) + v2 * v2 / (Result->baseRuns - 1);
+        df = (v1 + v2) * (v1 + v2) / df;
+        significant = fabs(diff) / sqrt(v1 + v2) > scenarioT95(df);
+    }
+    else
+    {
+        // Two or more identical runs on both sides.
+        significant = diff != 0.0;
+    }
+
+    if (significant && (Result->change > Threshold))
+    {
+        Result->verdict = "regression";
+    }
+    else if (significant && (Result->change < -Threshold))
+    {
+        Result->verdict = "improvement";
+    }
+    else
+    {
+        Result->verdict = "same";
+    }
+}
+
+static void reportWrite(FILE * Stream, const ScenarioMatrix * Matrix, const ScenarioResult * Results, int Count,
+                        const char * BaselineFName, int Failed, int Regressions)
+{
+    fprintf(Stream, "{\n  \"frames\": %d,\n  \"warmup\": %d,\n  \"repeats\": %d,\n  \"warmup_runs\": %d,\n"
+                    "  \"threshold_pct\": %.2f,\n  \"baseline\": \"%s\",\n  \"unit\": \"ms\",\n  \"scenarios\": [\n",
+            Matrix->frames, Matrix->warmup, Matrix->repeats, Matrix->warmupRuns, Matrix->threshold,
+            (BaselineFName != NULL) ? BaselineFName : "");
+    for (int i = 0; i < Count; ++i)
+    {
+        const ScenarioResult * r = &Results[i];
+        const Scenario * s = &r->scenario;
+        fprintf(Stream, "    { \"name\": \"%s\", \"width\": %d, \"height\": %d, \"samples\": %d, \"objects\": %d, "
+                        "\"vertex_format\": %d, \"state_filter\": %d, \"runs\": %d, \"failed\": %d, "
+                        "\"mean_ms\": %.6f, \"stddev_ms\": %.6f, \"ci95_ms\": %.6f, \"p99_ms\": %.6f, \"fps\": %.3f, "
+                        "\"baseline_ms\": %.6f, \"change_pct\": %.2f, \"verdict\": \"%s\" }%s\n",
+                r->name, s->width, s->height, s->samples, s->objects, s->format, s->filter, r->runs, r->failed,
+                r->mean, r->stddev, r->ci95, r->p99, (r->mean > 0.0) ? 1000.0 / r->mean : 0.0,
+                r->baseMean, r->change, r->verdict, (i + 1 < Count) ? "," : "");
+    }
+    fprintf(Stream, "  ],\n  \"failed\": %d,\n  \"regressions\": %d\n}\n", Failed, Regressions);
+}
+
+/***************************************************************************************
+***************************************************************************************/
+
+int ScenarioRun(const char * Argv0, const char * MatrixFName, const char * ReportFName, const char * BaselineFName)
+{
+    ScenarioMatrix matrix;
+    if (!matrixRead(MatrixFName, &matrix))
+    {
+        return 0;
+    }
+
+    long total = (long)matrix.sizeCount * matrix.sampleCount * matrix.objectCount * matrix.formatCount * matrix.filterCount;
+    if (total > SCENARIO_MAX)
+    {
+        fprintf(stderr, "Scenario matrix: %ld scenarios, at most %d.\n", total, SCENARIO_MAX);
+        return 0;
+    }
+    int count = (int)total;
+
+    char exe[256];
+    ssize_t length = readlink("/proc/self/exe", exe, sizeof(exe) - 1);
+    if (length > 0)
+    {
+        exe[length] = '\0';
+    }
+    else
+    {
+        snprintf(exe, sizeof(exe), "%s", Argv0);
+    }
+
+    ScenarioResult * results = (ScenarioResult *)malloc(count * sizeof(ScenarioResult));
+    double * means = (double *)malloc(matrix.repeats * sizeof(double));
+    if ((results == NULL) || (means == NULL))
+    {
+        fprintf(stderr, "Out of memory.\n");
+        free(results);
+        free(means);
+        return 0;
+    }
+    memset(results, 0, count * sizeof(ScenarioResult));
+    for (int i = 0; i < count; ++i)
+    {
+        matrixScenario(&matrix, i, &results[i].scenario);
+        scenarioName(&results[i].scenario, results[i].name, sizeof(results[i].name));
+    }
+
+    if ((BaselineFName != NULL) && !baselineRead(BaselineFName, results, count))
+    {
+        free(results);
+        free(means);
+        return 0;
+    }
+
+    printf("%d scenarios, %d+%d runs of %d+%d frames each\n",
+           count, matrix.warmupRuns, matrix.repeats, matrix.warmup, matrix.frames);
+    printf("%-32s %5s %10s %10s %10s %9s %9s %12s\n", "scenario", "runs", "mean ms", "ci95 ms", "p99 ms", "fps", "change", "verdict");
+
+    int failed = 0;
+    int regressions = 0;
+    for (int i = 0; i < count; ++i)
+    {
+        ScenarioResult * r = &results[i];
+        double mean, p99;
+        for (int w = 0; w < matrix.warmupRuns; ++w)
+        {
+            runOnce(exe, &matrix, &r->scenario, &mean, &p99);
+        }
+        for (int rep = 0; rep < matrix.repeats; ++rep)
+        {
+            if (runOnce(exe, &matrix, &r->scenario, &mean, &p99))
+            {
+                means[r->runs++] = mean;
+                r->p99 += p99;
+            }
+            else
+            {
+                ++r->failed;
+            }
+        }
+
+        if (r->runs > 0)
+        {
+            double sum = 0.0;
+            for (int k = 0; k < r->runs; ++k)
+            {
+                sum += means[k];
+            }
+            r->mean = sum / r->runs;
+            r->p99 /= r->runs;
+
+            double squares = 0.0;
+            for (int k = 0; k < r->runs; ++k)
+            {
+                squares += (means[k] - r->mean) * (means[k] - r->mean);
+            }
+            r->stddev = (r->runs > 1) ? sqrt(squares / (r->runs - 1)) : 0.0;
+            r->ci95 = (r->runs > 1) ? scenarioT95(r->runs - 1) * r->stddev / sqrt((double)r->runs) : 0.0;
+        }
+        baselineCompare(r, matrix.threshold);
+        failed += (r->failed > 0);
+        regressions += (strcmp(r->verdict, "regression") == 0);
+
+        printf("%-32s %5d %10.3f %10.3f %10.3f %9.1f %8.1f%% %12s\n", r->name, r->runs, r->mean, r->ci95, r->p99,
+               (r->mean > 0.0) ? 1000.0 / r->mean : 0.0, r->change, r->verdict);
+    }
+    printf("%d failed, %d regressed\n", failed, regressions);
+
+    int result = (failed == 0) && (regressions == 0);
+    FILE * fptr = stdout;
+    if (ReportFName != NULL)
+    {
+        fptr = fopen(ReportFName, "w");
+        if (fptr == NULL)
+        {
+            fprintf(stderr, "Cannot open file '%s'\n", ReportFName);
+            result = 0;
+        }
+    }
+    if (fptr != NULL)
+    {
+        reportWrite(fptr, &matrix, results, count, BaselineFName, failed, regressions);
+        if (fptr != stdout)
+        {
+            fclose(fptr);
+        }
+    }
+
+    free(results);
+    free(means);
+    return result;
+}
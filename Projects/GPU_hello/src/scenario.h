@@ -0,0 +1,55 @@
+/*
+ * Benchmark scenarios, run with -R <matrix file> instead of the demo.
+ *
+ * A matrix file lists the values of each knob, one knob per line; every
+ * combination of them is a scenario:
+ *
+ *   # knob           values
+ *   size             640x480 1280x720
+ *   samples          0 2 4          (EGL_SAMPLES, -s)
+ *   objects          1 100 1000     (-n)
+ *   vertex_format    1 3            (-v)
+ *   state_filter     0 1            (-e)
+ *   frames           300            timed frames per run
+ *   warmup           60             frames per run left out of the timing
+ *   repeats          5              timed runs per scenario
+ *   warmup_runs      1              untimed runs first (program cache, page cache)
+ *   threshold        5              smallest slowdown in % worth a regression
+ *   args             -B 0 -M a.mesh more arguments for every run
+ *
+ * Knobs left out keep the demo's default. Each run is its own process, the
+ * demo started again with the scenario's flags, uncapped (-k 0), without
+ * idle-aware rendering (-i 0) and its frame statistics written to a
+ * temporary file, so no run inherits GL or heap state from the last one. The
+ * figure of a run is its mean whole-frame time; a scenario reports the mean
+ * of its runs with the standard deviation and a 95% confidence interval
+ * from Student's t.
+ *
+ * The report is JSON, one scenario per line so it can be read back as a
+ * baseline. Against a baseline, a scenario regresses when Welch's t-test
+ * finds it slower at 95% and by more than the threshold; then, or when a
+ * run fails, the runner fails too. The verdict of a scenario is one of:
+ *
+ *   new            not in the baseline, or no baseline
+ *   same           no significant change beyond the threshold
+ *   regression     significantly slower, by more than the threshold
+ *   improvement    significantly faster, by more than the threshold
+ *   inconclusive   fewer than 2 successful runs on either side, no test
+ *   failed         no run succeeded
+ */
+
+#ifndef SCENARIO_H
+#define SCENARIO_H
+
+// Values per knob, extra arguments, and scenarios of one matrix.
+#define SCENARIO_MAX_VALUES     8
+#define SCENARIO_MAX_ARGS       16
+#define SCENARIO_MAX            512
+
+// Exe is the demo itself, Argv0 is used if /proc/self/exe is not there.
+// ReportFName NULL prints the report to stdout, BaselineFName may be NULL.
+// returns 0: a scenario failed or regressed against the baseline
+//         1: success
+int ScenarioRun(const char * Argv0, const char * MatrixFName, const char * ReportFName, const char * BaselineFName);
+
+#endif /* SCENARIO_H */
@@ -0,0 +1,116 @@
+/*
+ * Animated scene of gpu_hello.
+ */
+
+#include "scene.h"
+#include "vecmath.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+// Builds the matrices of objects [First, Last) for the current angle; both
+// are multiples of four.
+static void sceneBuild(const Scene * Scn, float * Matrices, int First, int Last)
+{
+    VmFloat4 zero  = vmSplat(0.0f);
+    VmFloat4 one   = vmSplat(1.0f);
+    VmFloat4 angle = vmSplat(Scn->angle);
+
+    // Four objects per step, one per lane; the padding makes the last group whole.
+    for (int i = First; i < Last; i += 4)
+    {
+        VmFloat4 sn, cs;
+        vmSinCos(vmAdd(angle, vmLoad(&Scn->phase[i])), &sn, &cs);
+
+        VmFloat4 s  = vmLoad(&Scn->scale[i]);
+        VmFloat4 sc = vmMul(s, cs);
+        VmFloat4 ss = vmMul(s, sn);
+
+        // Rotation around the y axis, then scale and move into the grid cell.
+        VmFloat4 e[16] =
+        {
+            sc,                 zero, ss,   zero,
+            zero,               s,    zero, zero,
+            vmSub(zero, ss),    zero, sc,   zero,
+            vmLoad(&Scn->offsetX[i]), vmLoad(&Scn->offsetY[i]), zero, one,
+        };
+        Mat4StoreSoA(e, &Matrices[i * 16], 4);
+    }
+}
+
+int SceneInit(Scene * Scn, int Count)
+{
+    memset(Scn, 0, sizeof(*Scn));
+    if (Count < 1)
+    {
+        Count = 1;
+    }
+
+    // SceneUpdate works on groups of four objects; the padding is never drawn.
+    int padded = (Count + 3) & ~3;
+
+    Scn->offsetX  = (float*)calloc(padded, sizeof (float));
+    Scn->offsetY  = (float*)calloc(padded, sizeof (float));
+    Scn->scale    = (float*)calloc(padded, sizeof (float));
+    Scn->phase    = (float*)calloc(padded, sizeof (float));
+    Scn->matrices = (float*)malloc(sizeof (float) * 16 * padded);
+    if ((Scn->offsetX == NULL) || (Scn->offsetY == NULL) || (Scn->scale == NULL)
+    ||  (Scn->phase == NULL) || (Scn->matrices == NULL))
+    {
+        SceneDestroy(Scn);
+        return 0;
+    }
+    Scn->count = Count;
+    Scn->animated = Count;
+
+    // Square grid over the viewport, one cell per object.
+    int columns = (int)ceil(sqrt((double)Count));
+    float cell = 2.0f / columns;
+
+    for (int i = 0; i < Count; ++i)
+    {
+        Scn->offsetX[i] = (Count == 1) ? 0.0f : -1.0f + cell * (i % columns + 0.5f);
+        Scn->offsetY[i] = (Count == 1) ? 0.0f :  1.0f - cell * (i / columns + 0.5f);
+        Scn->scale[i]   = (Count == 1) ? 1.0f : cell;
+        Scn->phase[i]   = fmodf(i * 0.37f, 6.3f);
+    }
+
+    // Everything at the start angle; static objects keep these matrices.
+    sceneBuild(Scn, Scn->matrices, 0, padded);
+
+    return 1;
+}
+
+void SceneDestroy(Scene * Scn)
+{
+    free(Scn->offsetX);
+    free(Scn->offsetY);
+    free(Scn->scale);
+    free(Scn->phase);
+    free(Scn->matrices);
+    memset(Scn, 0, sizeof(*Scn));
+}
+
+void SceneSetAnimated(Scene * Scn, int Count)
+{
+    Scn->animated = ((Count < 0) || (Count > Scn->count)) ? Scn->count : ((Count + 3) & ~3);
+}
+
+void SceneUpdate(Scene * Scn)
+{
+    SceneUpdateTo(Scn, Scn->matrices);
+}
+
+void SceneUpdateTo(Scene * Scn, float * Matrices)
+{
+    sceneBuild(Scn, Matrices, 0, (Scn->animated + 3) & ~3);
+
+    Scn->angle += 0.1f;
+
+    /*According to Linux programer's manual, need to clamp the input value of sin or cos to valid value,
+        otherwise return NaN and exception may be raised.*/
+    if (Scn->angle >= 6.3)
+    {
+        Scn->angle = fmod(Scn->angle, (float)6.3);
+    }
+}
@@ -0,0 +1,48 @@
+/*
+ * Animated scene of gpu_hello.
+ *
+ * Every object is one copy of the tutorial triangle, laid out on a grid and
+ * spinning around the y axis like the single triangle of Tutorial 1. With
+ * one object the transform is exactly the tutorial's rotation matrix.
+ * Only the first `animated` objects spin; the others stay at their start
+ * angle, which is what an idle-aware renderer can skip.
+ */
+
+#ifndef SCENE_H
+#define SCENE_H
+
+typedef struct _Scene
+{
+    int     count;      // number of objects
+    int     animated;   // objects that spin, a multiple of four or count
+    float   angle;      // rotation shared by all objects, in radians
+
+    // Per-object placement, structure of arrays. All arrays are padded to a
+    // multiple of four objects.
+    float * offsetX;
+    float * offsetY;
+    float * scale;
+    float * phase;
+
+    // Per-object column-major transform, 16 floats each.
+    float * matrices;
+}
+Scene;
+
+// returns 0: out of memory
+//         1: success
+int SceneInit(Scene * Scn, int Count);
+void SceneDestroy(Scene * Scn);
+
+// Lets only the first Count objects spin (rounded up to a multiple of four);
+// Count < 0 animates all of them. Call before the first update.
+void SceneSetAnimated(Scene * Scn, int Count);
+
+// Advances the animation by one frame and rebuilds the object matrices.
+void SceneUpdate(Scene * Scn);
+
+// Same, but writes the matrices to Matrices (16 floats per object, padded
+// to a multiple of four objects) instead of Scn->matrices.
+void SceneUpdateTo(Scene * Scn, float * Matrices);
+
+#endif /* SCENE_H */
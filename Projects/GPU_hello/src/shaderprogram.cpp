@@ -0,0 +1,433 @@
+/*
+ * Program building.
+ *
+ * Prepared programs are a small table under one lock. The worker takes the
+ * oldest queued entry, builds it and posts the entry's semaphore; a load
+ * that finds its entry marks it taken, so the worker skips it if it has not
+ * started on it yet, and otherwise waits on the semaphore. The worker calls
+ * glFinish() after each program: a program changed in one context may only
+ * be used in another once the change has completed.
+ */
+
+#include "shaderprogram.h"
+#include "arena.h"
+#include "extensions.h"
+#include "framestats.h"
+#include "glstate.h"
+#include "programcache.h"
+#include "shadersource.h"
+#include "startup.h"
+#include "gltrace.h"
+#include <pthread.h>
+#include <semaphore.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PREPARED_QUEUED     0
+#define PREPARED_BUILDING   1
+#define PREPARED_BUILT      2
+
+typedef struct _PreparedProgram
+{
+    const char *    vertexName;
+    const char *    fragmentName;
+    char            defines[256];
+    char            label[96];      // in the startup timeline
+    GLuint          program;
+    int             cached;
+    int             state;
+    int             taken;          // by a load
+    sem_t           built;
+}
+PreparedProgram;
+
+static PreparedProgram prepared[SHADER_PROGRAM_MAX_PREPARED];
+static int preparedCount = 0;
+static pthread_mutex_t preparedLock = PTHREAD_MUTEX_INITIALIZER;
+
+static pthread_t workerThread;
+static sem_t workerWake;
+static volatile int workerRunning = 0;
+static int workerStarted = 0;
+static EGLDisplay workerDisplay = EGL_NO_DISPLAY;
+static EGLContext workerContext = EGL_NO_CONTEXT;
+static EGLSurface workerSurface = EGL_NO_SURFACE;
+
+// Set on the worker, which must not use the frame arena or the GL state
+// shadow; both belong to the render thread.
+static __thread int onWorker = 0;
+
+/***************************************************************************************
+***************************************************************************************/
+
+// Info logs go to the frame arena, or the heap on the worker.
+static char * programLogAlloc(GLint Size)
+{
+    return onWorker ? (char *)malloc(Size) : (char *)FrameAlloc(Size);
+}
+
+static void programLogFree(char * Log)
+{
+    if (onWorker)
+    {
+        free(Log);
+    }
+}
+
+static void programDelete(GLuint Program)
+{
+    if (onWorker)
+    {
+        glDeleteProgram(Program);
+    }
+    else
+    {
+        GlStateDeleteProgram(Program);
+    }
+}
+
+// Compile a vertex or pixel shader.
+// returns the shader, or 0
+static GLuint programCompile(GLenum Type, const char * FName, const ShaderSource * Source, const char * Defines)
+{
+    const char * strings[2] = { Defines, Source->text };
+    GLint lengths[2] = { (GLint)strlen(Defines), Source->length };
+
+    GLuint shader = glCreateShader(Type);
+    glShaderSource(shader, 2, strings, lengths);
+    glCompileShader(shader);
+
+    GLint compiled = 0;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
+    if (!compiled)
+    {
+        // Retrieve error buffer size.
+        GLint errorBufSize = 0, errorLength = 0;
+        glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &errorBufSize);
+
+        // From the frame arena, which takes it back at the next swap.
+        char * infoLog = programLogAlloc(errorBufSize * sizeof(char) + 1);
+        if (infoLog)
+        {
+            // Retrieve error.
+            glGetShaderInfoLog(shader, errorBufSize, &errorLength, infoLog);
+            infoLog[errorLength] = '\0';
+            fprintf(stderr, "%s\n", infoLog);
+            programLogFree(infoLog);
+        }
+        fprintf(stderr, "Error compiling shader '%s'\n", FName);
+        glDeleteShader(shader);
+        return 0;
+    }
+
+    return shader;
+}
+
+// Compile and link both shaders.
+// returns the program, or 0
+static GLuint programBuild(const char * vShaderFName, const ShaderSource * vSource,
+                           const char * pShaderFName, const ShaderSource * pSource, const char * Defines)
+{
+    GLuint vertShaderNum = programCompile(GL_VERTEX_SHADER, vShaderFName, vSource, Defines);
+    GLuint pixelShaderNum = programCompile(GL_FRAGMENT_SHADER, pShaderFName, pSource, Defines);
+    GLuint program = 0;
+
+    if ((vertShaderNum != 0) && (pixelShaderNum != 0))
+    {
+        program = glCreateProgram();
+
+        glAttachShader(program, vertShaderNum);
+        glAttachShader(program, pixelShaderNum);
+
+        glLinkProgram(program);
+        // Check if linking succeeded.
+        GLint linked = GL_FALSE;
+        glGetProgramiv(program, GL_LINK_STATUS, &linked);
+        if (!linked)
+        {
+            // Retrieve error buffer size.
+            GLint errorBufSize = 0, errorLength = 0;
+            glGetProgramiv(program, GL_INFO_LOG_LENGTH, &errorBufSize);
+
+            char * infoLog = programLogAlloc(errorBufSize * sizeof (char) + 1);
+            if (infoLog)
+            {
+                // Retrieve error.
+                glGetProgramInfoLog(program, errorBufSize, &errorLength, infoLog);
+                infoLog[errorLength] = '\0';
+                fprintf(stderr, "%s", infoLog);
+                programLogFree(infoLog);
+            }
+
+            fprintf(stderr, "Error linking program %s + %s\n", vShaderFName, pShaderFName);
+            programDelete(program);
+            program = 0;
+        }
+    }
+
+    // Attached shaders are freed with the program.
+    if (vertShaderNum != 0)
+    {
+        glDeleteShader(vertShaderNum);
+    }
+    if (pixelShaderNum != 0)
+    {
+        glDeleteShader(pixelShaderNum);
+    }
+    return program;
+}
+
+// From the cache, or built and stored.
+// returns the program, or 0
+static GLuint programLoad(const char * VertexName, const char * FragmentName, const char * Defines, int * Cached)
+{
+    ShaderSource vShader, pShader;
+    int vFound = ShaderSourceGet(VertexName, &vShader);
+    int pFound = ShaderSourceGet(FragmentName, &pShader);
+    GLuint program = 0;
+    int cached = 0;
+
+    if (vFound && pFound)
+    {
+        unsigned long long key = ProgramCacheKey(vShader.text, vShader.length,
+                                                 pShader.text, pShader.length, Defines);
+        program = ProgramCacheLoad(key);
+        cached = (program != 0);
+
+        if (program == 0)
+        {
+            program = programBuild(VertexName, &vShader, FragmentName, &pShader, (Defines != NULL) ? Defines : "");
+            if ((program != 0) && ProgramCacheEnabled())
+            {
+                ProgramCacheStore(key, program);
+            }
+        }
+    }
+
+    ShaderSourceRelease(&vShader);
+    ShaderSourceRelease(&pShader);
+
+    *Cached = cached;
+    return program;
+}
+
+static void workerWait(sem_t * Semaphore)
+{
+    while ((sem_wait(Semaphore) != 0) && (errno == EINTR))
+    {
+    }
+}
+
+static void * workerMain(void * Arg)
+{
+    (void)Arg;
+    onWorker = 1;
+    eglBindAPI(EGL_OPENGL_ES_API);
+    if (!eglMakeCurrent(workerDisplay, workerSurface, workerSurface, workerContext))
+    {
+        // Whatever is prepared stays queued and is built when loaded.
+        fprintf(stderr, "Cannot make the shader worker context current.\n");
+        return NULL;
+    }
+
+    for (;;)
+    {
+        workerWait(&workerWake);
+        if (!__atomic_load_n(&workerRunning, __ATOMIC_ACQUIRE))
+        {
+            break;
+        }
+
+        PreparedProgram * entry = NULL;
+        pthread_mutex_lock(&preparedLock);
+        for (int i = 0; (entry == NULL) && (i < preparedCount); ++i)
+        {
+            if ((prepared[i].state == PREPARED_QUEUED) && !prepared[i].taken)
+            {
+                entry = &prepared[i];
+                entry->state = PREPARED_BUILDING;
+            }
+        }
+        pthread_mutex_unlock(&preparedLock);
+        if (entry == NULL)
+        {
+            continue;
+        }
+
+        unsigned long long begin = FrameStatsNs();
+        int cached = 0;
+        GLuint program = programLoad(entry->vertexName, entry->fragmentName, entry->defines, &cached);
+        glFinish();
+        if (cached)
+        {
+            strncat(entry->label, " (cached)", sizeof(entry->label) - strlen(entry->label) - 1);
+        }
+        StartupSpan(entry->label, begin, FrameStatsNs());
+
+        pthread_mutex_lock(&preparedLock);
+        entry->program = program;
+        entry->cached = cached;
+        entry->state = PREPARED_BUILT;
+        pthread_mutex_unlock(&preparedLock);
+        sem_post(&entry->built);
+    }
+
+    eglMakeCurrent(workerDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    eglReleaseThread();
+    return NULL;
+}
+
+/***************************************************************************************
+***************************************************************************************/
+
+GLuint ShaderProgramLoad(const char * VertexName, const char * FragmentName, const char * Defines, int * Cached)
+{
+    const char * defines = (Defines != NULL) ? Defines : "";
+    PreparedProgram * entry = NULL;
+    int queued = 0;
+
+    pthread_mutex_lock(&preparedLock);
+    for (int i = 0; (entry == NULL) && (i < preparedCount); ++i)
+    {
+        PreparedProgram * candidate = &prepared[i];
+        if (!candidate->taken && (strcmp(candidate->vertexName, VertexName) == 0)
+        && (strcmp(candidate->fragmentName, FragmentName) == 0) && (strcmp(candidate->defines, defines) == 0))
+        {
+            entry = candidate;
+            entry->taken = 1;
+            queued = (entry->state == PREPARED_QUEUED);
+        }
+    }
+    pthread_mutex_unlock(&preparedLock);
+
+    GLuint program = 0;
+    int cached = 0;
+    if ((entry != NULL) && !queued)
+    {
+        workerWait(&entry->built);
+        program = entry->program;
+        cached = entry->cached;
+    }
+    if (program == 0)
+    {
+        // Not started on, or failed on the worker: build it here, which
+        // also reports the errors on this thread.
+        program = programLoad(VertexName, FragmentName, Defines, &cached);
+    }
+
+    if (Cached != NULL)
+    {
+        *Cached = cached;
+    }
+    return program;
+}
+
+int ShaderProgramWorkerStart(EGLDisplay Display, EGLConfig Config, EGLContext Context)
+{
+    ShaderProgramWorkerStop();
+    if (GlTraceActive())
+    {
+        return 0;
+    }
+
+    static const EGLint contextAttribs[] = { EGL_CONTEXT_CLIENT_VERSION, 2, EGL_NONE };
+    static const EGLint surfaceAttribs[] = { EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE };
+    workerContext = eglCreateContext(Display, Config, Context, contextAttribs);
+    if (workerContext == EGL_NO_CONTEXT)
+    {
+        fprintf(stderr, "Cannot create a shared context, programs are built when loaded.\n");
+        return 0;
+    }
+    workerSurface = eglCreatePbufferSurface(Display, Config, surfaceAttribs);
+    if ((workerSurface == EGL_NO_SURFACE) && !HasEGLExtension(Display, "EGL_KHR_surfaceless_context"))
+    {
+        fprintf(stderr, "No surface for the shared context, programs are built when loaded.\n");
+        eglDestroyContext(Display, workerContext);
+        workerContext = EGL_NO_CONTEXT;
+        return 0;
+    }
+
+    workerDisplay = Display;
+    sem_init(&workerWake, 0, 0);
+    workerRunning = 1;
+    if (pthread_create(&workerThread, NULL, workerMain, NULL) != 0)
+    {
+        fprintf(stderr, "Cannot create the shader worker, programs are built when loaded.\n");
+        workerRunning = 0;
+        sem_destroy(&workerWake);
+        if (workerSurface != EGL_NO_SURFACE)
+        {
+            eglDestroySurface(Display, workerSurface);
+        }
+        eglDestroyContext(Display, workerContext);
+        workerSurface = EGL_NO_SURFACE;
+        workerContext = EGL_NO_CONTEXT;
+        return 0;
+    }
+    workerStarted = 1;
+    return 1;
+}
+
+void ShaderProgramWorkerStop(void)
+{
+    if (!workerStarted)
+    {
+        return;
+    }
+
+    __atomic_store_n(&workerRunning, 0, __ATOMIC_RELEASE);
+    sem_post(&workerWake);
+    pthread_join(workerThread, NULL);
+    sem_destroy(&workerWake);
+
+    for (int i = 0; i < preparedCount; ++i)
+    {
+        if ((prepared[i].state == PREPARED_BUILT) && !prepared[i].taken && (prepared[i].program != 0))
+        {
+            GlStateDeleteProgram(prepared[i].program);
+        }
+        sem_destroy(&prepared[i].built);
+    }
+    preparedCount = 0;
+
+    if (workerSurface != EGL_NO_SURFACE)
+    {
+        eglDestroySurface(workerDisplay, workerSurface);
+    }
+    eglDestroyContext(workerDisplay, workerContext);
+    workerSurface = EGL_NO_SURFACE;
+    workerContext = EGL_NO_CONTEXT;
+    workerDisplay = EGL_NO_DISPLAY;
+    workerStarted = 0;
+}
+
+void ShaderProgramPrepare(const char * VertexName, const char * FragmentName, const char * Defines)
+{
+    const char * defines = (Defines != NULL) ? Defines : "";
+    if (!workerStarted || (strlen(defines) >= sizeof(prepared[0].defines)))
+    {
+        return;
+    }
+
+    pthread_mutex_lock(&preparedLock);
+    int added = (preparedCount < SHADER_PROGRAM_MAX_PREPARED);
+    if (added)
+    {
+        PreparedProgram * entry = &prepared[preparedCount++];
+        memset(entry, 0, sizeof(*entry));
+        entry->vertexName = VertexName;
+        entry->fragmentName = FragmentName;
+        strcpy(entry->defines, defines);
+        snprintf(entry->label, sizeof(entry->label), "program %s + %s", VertexName, FragmentName);
+        entry->state = PREPARED_QUEUED;
+        sem_init(&entry->built, 0, 0);
+    }
+    pthread_mutex_unlock(&preparedLock);
+
+    if (added)
+    {
+        sem_post(&workerWake);
+    }
+}
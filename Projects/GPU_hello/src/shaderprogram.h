@@ -0,0 +1,51 @@
+/*
+ * Program building.
+ *
+ * Every program of the application is built here: the two shader files
+ * come from shadersource.h, the linked program from the program cache when
+ * it has it, otherwise the shaders are compiled and linked and the result
+ * stored for the next start.
+ *
+ * Defines are put in front of both sources, so one pair of files serves
+ * several variants (e.g. "#define IMAGE_GRAY_INPUT 1\n"); they are part of
+ * the cache key. The sources must then not start with #version.
+ *
+ * Programs can also be built ahead on a worker thread with a context of
+ * its own in the share group of the render context, where programs are
+ * shared: ShaderProgramPrepare() queues one, and the ShaderProgramLoad() of
+ * the same files and defines takes it when it is needed, waiting only if
+ * it is still being built. A program the worker has not started on yet is
+ * built by the caller instead, so preparing never makes a load slower than
+ * building in place. Without a worker, preparing does nothing and programs
+ * are built when loaded.
+ */
+
+#ifndef SHADERPROGRAM_H
+#define SHADERPROGRAM_H
+
+#include <GLES2/gl2.h>
+#include <EGL/egl.h>
+
+#define SHADER_PROGRAM_MAX_PREPARED 16
+
+// Defines may be NULL. Cached, if not NULL, tells whether the program came
+// from the cache. Compile and link errors go to stderr.
+// returns the linked program, or 0
+GLuint ShaderProgramLoad(const char * VertexName, const char * FragmentName, const char * Defines, int * Cached);
+
+// Starts the worker with a context made with Config in the share group of
+// Context and a 1x1 pbuffer (no surface with EGL_KHR_surfaceless_context).
+// It is not started while a trace records, which needs every GL call on
+// the render thread.
+// returns 0: fail, programs are built when loaded
+//         1: success
+int ShaderProgramWorkerStart(EGLDisplay Display, EGLConfig Config, EGLContext Context);
+
+// Finishes the program being built and stops the worker; prepared programs
+// never loaded are deleted. Needs the render context current.
+void ShaderProgramWorkerStop(void);
+
+// Queues a program for the worker. The names must stay valid.
+void ShaderProgramPrepare(const char * VertexName, const char * FragmentName, const char * Defines);
+
+#endif /* SHADERPROGRAM_H */
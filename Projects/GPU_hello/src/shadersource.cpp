@@ -0,0 +1,118 @@
+/*
+ * Shader sources: embedded tables plus mmap'd overrides.
+ */
+
+#include "shadersource.h"
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+typedef struct _EmbeddedShader
+{
+    const char *    name;
+    const char *    text;
+    int             length;
+}
+EmbeddedShader;
+
+// Generated into the build directory from the .vert/.frag files.
+#include "shaders_embedded.h"
+
+static const char * overrideDir = NULL;
+
+/***************************************************************************************
+***************************************************************************************/
+
+// returns 0: fail
+//         1: success
+static int mapOverride(const char * Name, ShaderSource * Source)
+{
+    char path[512];
+    snprintf(path, sizeof(path), "%s/%s", overrideDir, Name);
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        return 0;
+    }
+
+    struct stat info;
+    void * map = MAP_FAILED;
+    if ((fstat(fd, &info) == 0) && (info.st_size > 0))
+    {
+        map = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    // The mapping stays valid after the descriptor is closed.
+    close(fd);
+
+    if (map == MAP_FAILED)
+    {
+        fprintf(stderr, "Cannot map shader '%s', using the embedded copy.\n", path);
+        return 0;
+    }
+
+    Source->text      = (const char *)map;
+    Source->length    = (int)info.st_size;
+    Source->map       = map;
+    Source->mapLength = info.st_size;
+    return 1;
+}
+
+void ShaderSourceSetOverrideDir(const char * Dir)
+{
+    overrideDir = Dir;
+}
+
+int ShaderSourceGet(const char * Name, ShaderSource * Source)
+{
+    memset(Source, 0, sizeof(*Source));
+
+    if ((overrideDir != NULL) && mapOverride(Name, Source))
+    {
+        return 1;
+    }
+
+    for (size_t i = 0; i < sizeof(embeddedShaders) / sizeof(embeddedShaders[0]); ++i)
+    {
+        if (strcmp(embeddedShaders[i].name, Name) == 0)
+        {
+            Source->text   = embeddedShaders[i].text;
+            Source->length = embeddedShaders[i].length;
+            return 1;
+        }
+    }
+
+    fprintf(stderr, "Unknown shader '%s'\n", Name);
+    return 0;
+}
+
+void ShaderSourceRelease(ShaderSource * Source)
+{
+    if (Source->map != NULL)
+    {
+        munmap(Source->map, Source->mapLength);
+    }
+    memset(Source, 0, sizeof(*Source));
+}
+
+void ShaderSourcePrefetch(void)
+{
+    if (overrideDir == NULL)
+    {
+        return;
+    }
+    for (size_t i = 0; i < sizeof(embeddedShaders) / sizeof(embeddedShaders[0]); ++i)
+    {
+        char path[512];
+        snprintf(path, sizeof(path), "%s/%s", overrideDir, embeddedShaders[i].name);
+        int fd = open(path, O_RDONLY);
+        if (fd >= 0)
+        {
+            posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+            close(fd);
+        }
+    }
+}
@@ -0,0 +1,38 @@
+/*
+ * Shader sources.
+ *
+ * The GLSL files are embedded into the binary at build time (see the
+ * shaders_embedded.h rule in BUILD.mk), so no file is read at startup and
+ * the working directory does not matter. For shader development a directory
+ * can be set whose files override the embedded copies; those are mapped
+ * read-only with mmap and handed to the driver without a heap copy.
+ */
+
+#ifndef SHADERSOURCE_H
+#define SHADERSOURCE_H
+
+#include <stddef.h>
+
+typedef struct _ShaderSource
+{
+    const char *    text;       // not NUL-terminated
+    int             length;
+    void *          map;        // mmap'd override, NULL for embedded text
+    size_t          mapLength;
+}
+ShaderSource;
+
+// Dir == NULL uses the embedded sources only.
+void ShaderSourceSetOverrideDir(const char * Dir);
+
+// Name is the file name, e.g. "vs_es20t1.vert".
+// returns 0: fail (no override and not embedded)
+//         1: success
+int ShaderSourceGet(const char * Name, ShaderSource * Source);
+void ShaderSourceRelease(ShaderSource * Source);
+
+// Starts reading the override files into the page cache; no-op without an
+// override directory. May run on any thread.
+void ShaderSourcePrefetch(void);
+
+#endif /* SHADERSOURCE_H */
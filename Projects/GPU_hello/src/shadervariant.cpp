@@ -0,0 +1,249 @@
+/*
+ * Shader variants.
+ *
+ * The table is open addressing with linear probing on a multiplicative hash
+ * of the feature bits; variants are never removed one by one, so no
+ * tombstones are needed. A SKINNING variant of an old palette size stays in
+ * its slot as stale until it is built again.
+ */
+
+#include "shadervariant.h"
+#include "framestats.h"
+#include "glstate.h"
+#include "shaderprogram.h"
+#include "gltrace.h"
+#include <stdio.h>
+#include <string.h>
+
+#define SLOT_EMPTY      0
+#define SLOT_BUILT      1
+#define SLOT_FAILED     2
+#define SLOT_STALE      3
+
+typedef struct _VariantSlot
+{
+    int             state;
+    ShaderVariant   variant;
+}
+VariantSlot;
+
+static const char * featureDefines[SHADER_FEATURE_COUNT] =
+{
+    "VERTEX_COLOR", "TEXTURED", "FOG", "SKINNING", "DEQUANTIZE"
+};
+
+static const char * featureNames[SHADER_FEATURE_COUNT] =
+{
+    "vertex_color", "textured", "fog", "skinning", "dequantize"
+};
+
+static const char * attribNames[SHADER_ATTRIB_COUNT] =
+{
+    "my_Vertex", "my_Color", "my_TexCoord", "my_Index"
+};
+
+static const char * uniformNames[SHADER_UNIFORM_COUNT] =
+{
+    "my_TransformMatrix", "my_Color", "my_Texture", "my_FogColor", "my_FogRange", "my_Palette", "my_Dequantize"
+};
+
+static const char * variantVertex = NULL;
+static const char * variantFragment = NULL;
+static VariantSlot variantSlots[SHADER_VARIANT_SLOTS];
+static int variantBones = SHADER_SKINNING_BONES;
+static ShaderVariantStats variantStats;
+
+/***************************************************************************************
+***************************************************************************************/
+
+// returns the slot of Features, or NULL when the table is full
+static VariantSlot * variantFind(unsigned int Features)
+{
+    unsigned int slot = ((Features * 2654435761u) >> 16) & (SHADER_VARIANT_SLOTS - 1);
+    for (int probe = 0; probe < SHADER_VARIANT_SLOTS; ++probe)
+    {
+        VariantSlot * entry = &variantSlots[(slot + probe) & (SHADER_VARIANT_SLOTS - 1)];
+        if ((entry->state == SLOT_EMPTY) || (entry->variant.features == Features))
+        {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+// Looks up every location once; the ones a variant does not declare are
+// -1 whatever the driver says.
+static void variantLocations(ShaderVariant * Variant)
+{
+    unsigned int features = Variant->features;
+    for (int a = 0; a < SHADER_ATTRIB_COUNT; ++a)
+    {
+        Variant->attribs[a] = glGetAttribLocation(Variant->program, attribNames[a]);
+    }
+    for (int u = 0; u < SHADER_UNIFORM_COUNT; ++u)
+    {
+        Variant->uniforms[u] = glGetUniformLocation(Variant->program, uniformNames[u]);
+    }
+
+    if (features & SHADER_FEATURE_VERTEX_COLOR)
+    {
+        Variant->uniforms[SHADER_UNIFORM_COLOR] = -1;
+    }
+    else
+    {
+        Variant->attribs[SHADER_ATTRIB_COLOR] = -1;
+    }
+    if (!(features & SHADER_FEATURE_TEXTURED))
+    {
+        Variant->attribs[SHADER_ATTRIB_TEXCOORD] = -1;
+        Variant->uniforms[SHADER_UNIFORM_TEXTURE] = -1;
+    }
+    if (!(features & SHADER_FEATURE_FOG))
+    {
+        Variant->uniforms[SHADER_UNIFORM_FOG_COLOR] = -1;
+        Variant->uniforms[SHADER_UNIFORM_FOG_RANGE] = -1;
+    }
+    if (!(features & SHADER_FEATURE_SKINNING))
+    {
+        Variant->attribs[SHADER_ATTRIB_INDEX] = -1;
+        Variant->uniforms[SHADER_UNIFORM_PALETTE] = -1;
+    }
+    if (!(features & SHADER_FEATURE_DEQUANTIZE))
+    {
+        Variant->uniforms[SHADER_UNIFORM_DEQUANTIZE] = -1;
+    }
+}
+
+/***************************************************************************************
+***************************************************************************************/
+
+void ShaderVariantInit(const char * VertexName, const char * FragmentName)
+{
+    ShaderVariantDestroy();
+    variantVertex = VertexName;
+    variantFragment = FragmentName;
+}
+
+void ShaderVariantDestroy(void)
+{
+    for (int s = 0; s < SHADER_VARIANT_SLOTS; ++s)
+    {
+        if (variantSlots[s].state == SLOT_BUILT)
+        {
+            GlStateDeleteProgram(variantSlots[s].variant.program);
+        }
+    }
+    memset(variantSlots, 0, sizeof(variantSlots));
+    memset(&variantStats, 0, sizeof(variantStats));
+    variantBones = SHADER_SKINNING_BONES;
+}
+
+const ShaderVariant * ShaderVariantGet(unsigned int Features)
+{
+    VariantSlot * entry = variantFind(Features);
+    if (entry == NULL)
+    {
+        fprintf(stderr, "More than %d shader variants.\n", SHADER_VARIANT_SLOTS);
+        return NULL;
+    }
+    if ((entry->state != SLOT_EMPTY) && (entry->state != SLOT_STALE))
+    {
+        return (entry->state == SLOT_BUILT) ? &entry->variant : NULL;
+    }
+
+    char defines[256];
+    ShaderVariantDefines(Features, defines, sizeof(defines));
+    unsigned long long start = FrameStatsNs();
+
+    ShaderVariant * variant = &entry->variant;
+    memset(variant, 0, sizeof(*variant));
+    variant->features = Features;
+    variant->program = ShaderProgramLoad(variantVertex, variantFragment, defines, &variant->cached);
+    variantStats.buildMs += (FrameStatsNs() - start) / 1e6;
+
+    if (variant->program == 0)
+    {
+        char name[128];
+        ShaderVariantName(Features, name, sizeof(name));
+        fprintf(stderr, "Shader variant %s does not build.\n", name);
+        entry->state = SLOT_FAILED;
+        ++variantStats.failed;
+        return NULL;
+    }
+
+    variantLocations(variant);
+    entry->state = SLOT_BUILT;
+    ++variantStats.variants;
+    variantStats.cached += variant->cached;
+    return variant;
+}
+
+void ShaderVariantPrepare(unsigned int Features)
+{
+    VariantSlot * entry = variantFind(Features);
+    if ((entry != NULL) && ((entry->state == SLOT_EMPTY) || (entry->state == SLOT_STALE)))
+    {
+        char defines[256];
+        ShaderVariantDefines(Features, defines, sizeof(defines));
+        ShaderProgramPrepare(variantVertex, variantFragment, defines);
+    }
+}
+
+void ShaderVariantSetBones(int Bones)
+{
+    if (Bones == variantBones)
+    {
+        return;
+    }
+    variantBones = Bones;
+    for (int s = 0; s < SHADER_VARIANT_SLOTS; ++s)
+    {
+        VariantSlot * entry = &variantSlots[s];
+        if ((entry->state != SLOT_EMPTY) && (entry->variant.features & SHADER_FEATURE_SKINNING))
+        {
+            if (entry->state == SLOT_BUILT)
+            {
+                GlStateDeleteProgram(entry->variant.program);
+            }
+            entry->state = SLOT_STALE;
+        }
+    }
+}
+
+void ShaderVariantDefines(unsigned int Features, char * Defines, size_t Size)
+{
+    size_t length = (size_t)snprintf(Defines, Size, "#define SHADER_VARIANT 1\n");
+    for (int f = 0; (f < SHADER_FEATURE_COUNT) && (length < Size); ++f)
+    {
+        if (Features & (1u << f))
+        {
+            int value = ((1u << f) == SHADER_FEATURE_SKINNING) ? variantBones : 1;
+            length += (size_t)snprintf(Defines + length, Size - length, "#define %s %d\n", featureDefines[f], value);
+        }
+    }
+}
+
+void ShaderVariantName(unsigned int Features, char * Name, size_t Size)
+{
+    Name[0] = '\0';
+    for (int f = 0; f < SHADER_FEATURE_COUNT; ++f)
+    {
+        if (Features & (1u << f))
+        {
+            if (Name[0] != '\0')
+            {
+                strncat(Name, "+", Size - strlen(Name) - 1);
+            }
+            strncat(Name, featureNames[f], Size - strlen(Name) - 1);
+        }
+    }
+    if (Name[0] == '\0')
+    {
+        snprintf(Name, Size, "none");
+    }
+}
+
+void ShaderVariantGetStats(ShaderVariantStats * Stats)
+{
+    *Stats = variantStats;
+}
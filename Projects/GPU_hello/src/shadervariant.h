@@ -0,0 +1,113 @@
+/*
+ * Shader variants.
+ *
+ * One pair of shader files serves every variant of a program: a variant is
+ * a set of feature bits, each put in front of the sources as a #define
+ * (SHADER_FEATURE_FOG becomes "#define FOG 1"), so the compiler drops
+ * whatever a variant does not use instead of the shader branching on
+ * uniforms. A variant is built the first time it is asked for, through
+ * shaderprogram.h and so through the program cache and the shader worker,
+ * and kept in a hash table keyed by its feature bits together with the
+ * locations of every attribute and uniform the shared sources declare (-1
+ * where the variant has none), so no caller looks a location up by name.
+ *
+ * The shared sources are vs_es20t1.vert and ps_es20t1.frag:
+ *
+ *   VERTEX_COLOR   my_Color per vertex, otherwise a uniform colour
+ *   TEXTURED       my_TexCoord, modulated with my_Texture (unit 0)
+ *   FOG            linear fog towards my_FogColor over my_FogRange
+ *                  (start, 1 / (end - start)) of clip space w
+ *   SKINNING       my_Index picks one of the matrices of my_Palette, applied
+ *                  before my_TransformMatrix; SKINNING is the palette size,
+ *                  SHADER_SKINNING_BONES unless ShaderVariantSetBones() says
+ *   DEQUANTIZE     my_Dequantize[2], a scale and an offset for quantized
+ *                  positions, applied first
+ */
+
+#ifndef SHADERVARIANT_H
+#define SHADERVARIANT_H
+
+#include <GLES2/gl2.h>
+#include <stddef.h>
+
+#define SHADER_FEATURE_VERTEX_COLOR 0x01
+#define SHADER_FEATURE_TEXTURED     0x02
+#define SHADER_FEATURE_FOG          0x04
+#define SHADER_FEATURE_SKINNING     0x08
+#define SHADER_FEATURE_DEQUANTIZE   0x10
+#define SHADER_FEATURE_COUNT        5
+
+#define SHADER_SKINNING_BONES       16
+
+// Hash table slots, a power of two; more than the 2^SHADER_FEATURE_COUNT
+// variants there can be.
+#define SHADER_VARIANT_SLOTS        64
+
+enum
+{
+    SHADER_ATTRIB_VERTEX,
+    SHADER_ATTRIB_COLOR,
+    SHADER_ATTRIB_TEXCOORD,
+    SHADER_ATTRIB_INDEX,
+    SHADER_ATTRIB_COUNT
+};
+
+enum
+{
+    SHADER_UNIFORM_TRANSFORM,
+    SHADER_UNIFORM_COLOR,
+    SHADER_UNIFORM_TEXTURE,
+    SHADER_UNIFORM_FOG_COLOR,
+    SHADER_UNIFORM_FOG_RANGE,
+    SHADER_UNIFORM_PALETTE,
+    SHADER_UNIFORM_DEQUANTIZE,
+    SHADER_UNIFORM_COUNT
+};
+
+typedef struct _ShaderVariant
+{
+    unsigned int    features;
+    GLuint          program;
+    int             cached;         // came from the program cache
+    GLint           attribs[SHADER_ATTRIB_COUNT];
+    GLint           uniforms[SHADER_UNIFORM_COUNT];
+}
+ShaderVariant;
+
+typedef struct _ShaderVariantStats
+{
+    int             variants;       // built
+    int             cached;         // of which from the program cache
+    int             failed;
+    double          buildMs;
+}
+ShaderVariantStats;
+
+// The shared sources of all variants; the names must stay valid.
+void ShaderVariantInit(const char * VertexName, const char * FragmentName);
+
+// Deletes the programs of all variants.
+void ShaderVariantDestroy(void);
+
+// Builds the variant the first time. A variant that failed to build is
+// remembered and not tried again.
+// returns the variant, or NULL when it does not build
+const ShaderVariant * ShaderVariantGet(unsigned int Features);
+
+// Has the variant built ahead on the shader worker, see shaderprogram.h.
+void ShaderVariantPrepare(unsigned int Features);
+
+// Sets the palette size of the SKINNING variants; the ones built with
+// another size are deleted and built again when next asked for. The
+// pointers ShaderVariantGet() returned for them are no longer valid.
+void ShaderVariantSetBones(int Bones);
+
+// The defines of Features, e.g. "#define SHADER_VARIANT 1\n#define FOG 1\n".
+void ShaderVariantDefines(unsigned int Features, char * Defines, size_t Size);
+
+// Features as text, e.g. "vertex_color+fog", "none" for 0.
+void ShaderVariantName(unsigned int Features, char * Name, size_t Size);
+
+void ShaderVariantGetStats(ShaderVariantStats * Stats);
+
+#endif /* SHADERVARIANT_H */
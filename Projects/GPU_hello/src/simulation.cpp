@@ -0,0 +1,180 @@
+/*
+ * Scene simulation, optionally on its own thread.
+ *
+ * The thread sleeps on simStop until its next step is due, so
+ * SimulationStop() wakes it at once instead of after a whole step period.
+ */
+
+#include "simulation.h"
+#include "framestats.h"
+#include "triplebuffer.h"
+#include <pthread.h>
+#include <semaphore.h>
+#include <errno.h>
+#include <time.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static Scene * simScene = NULL;
+static SceneFrame simFrames[3];
+static TripleBuffer simBuffer;
+static sem_t simStop;
+static pthread_t simThread;
+static int simThreaded = 0;
+static unsigned long long simPeriodNs = 0;
+static int simPaused = 0;
+
+// Sleeps until the monotonic time DueNs, or until SimulationStop().
+// returns 0: stop
+//         1: due
+static int simSleep(unsigned long long DueNs)
+{
+    for (;;)
+    {
+        unsigned long long now = FrameStatsNs();
+        if (now >= DueNs)
+        {
+            // Stop may have been posted while stepping.
+            return sem_trywait(&simStop) != 0;
+        }
+
+        // sem_timedwait() takes CLOCK_REALTIME.
+        struct timespec until;
+        clock_gettime(CLOCK_REALTIME, &until);
+        unsigned long long ns = until.tv_nsec + (DueNs - now);
+        until.tv_sec += (time_t)(ns / 1000000000ULL);
+        until.tv_nsec = (long)(ns % 1000000000ULL);
+        if (sem_timedwait(&simStop, &until) == 0)
+        {
+            return 0;
+        }
+        if ((errno != ETIMEDOUT) && (errno != EINTR))
+        {
+            return 0;
+        }
+    }
+}
+
+static void * simMain(void * Arg)
+{
+    (void)Arg;
+    unsigned long long sequence = 0;
+    unsigned long long due = FrameStatsNs();
+
+    while (simSleep(due))
+    {
+        if (!__atomic_load_n(&simPaused, __ATOMIC_RELAXED))
+        {
+            SceneFrame * frame = (SceneFrame *)TripleBufferBack(&simBuffer);
+            SceneUpdateTo(simScene, frame->matrices);
+            frame->sequence = sequence++;
+            TripleBufferPublish(&simBuffer);
+        }
+
+        // Fixed steps; too far behind, the missed ones are given up.
+        due += simPeriodNs;
+        unsigned long long now = FrameStatsNs();
+        if (now > due + SIMULATION_MAX_BEHIND * simPeriodNs)
+        {
+            due = now;
+        }
+    }
+    return NULL;
+}
+
+static void simFreeFrames(void)
+{
+    for (int i = 0; i < 3; ++i)
+    {
+        free(simFrames[i].matrices);
+    }
+    memset(simFrames, 0, sizeof(simFrames));
+}
+
+/***************************************************************************************
+***************************************************************************************/
+
+int SimulationStart(Scene * Scn, int Threaded, int StepHz)
+{
+    simScene = Scn;
+    simThreaded = 0;
+    simPaused = 0;
+    simPeriodNs = 1000000000ULL / (unsigned long long)((StepHz > 0) ? StepHz : SIMULATION_DEFAULT_HZ);
+    memset(simFrames, 0, sizeof(simFrames));
+
+    // Inline: one frame that aliases the scene's own matrices.
+    simFrames[0].count = Scn->count;
+    simFrames[0].matrices = Scn->matrices;
+    if (!Threaded)
+    {
+        return 1;
+    }
+
+    // Same padding as the scene, SceneUpdateTo() writes whole groups of four.
+    size_t size = sizeof (float) * 16 * ((Scn->count + 3) & ~3);
+    for (int i = 0; i < 3; ++i)
+    {
+        simFrames[i].count = Scn->count;
+        simFrames[i].matrices = (float *)malloc(size);
+        if (simFrames[i].matrices == NULL)
+        {
+            fprintf(stderr, "Out of memory.\n");
+            simFreeFrames();
+            return 0;
+        }
+        memcpy(simFrames[i].matrices, Scn->matrices, size);
+    }
+    TripleBufferInit(&simBuffer, &simFrames[0], &simFrames[1], &simFrames[2]);
+
+    sem_init(&simStop, 0, 0);
+    if (pthread_create(&simThread, NULL, simMain, NULL) != 0)
+    {
+        fprintf(stderr, "Cannot create the simulation thread, updating inline.\n");
+        sem_destroy(&simStop);
+        simFreeFrames();
+        simFrames[0].count = Scn->count;
+        simFrames[0].matrices = Scn->matrices;
+        return 1;
+    }
+
+    simThreaded = 1;
+    return 1;
+}
+
+void SimulationStop(void)
+{
+    if (simThreaded)
+    {
+        sem_post(&simStop);
+        pthread_join(simThread, NULL);
+
+        sem_destroy(&simStop);
+        simFreeFrames();
+        simThreaded = 0;
+    }
+    simScene = NULL;
+}
+
+int SimulationThreaded(void)
+{
+    return simThreaded;
+}
+
+void SimulationSetPaused(int Paused)
+{
+    __atomic_store_n(&simPaused, Paused, __ATOMIC_RELAXED);
+}
+
+const SceneFrame * SimulationNext(void)
+{
+    if (!simThreaded)
+    {
+        SceneUpdate(simScene);
+        ++simFrames[0].sequence;
+        return &simFrames[0];
+    }
+
+    // No step since the last call: the front snapshot again.
+    return (const SceneFrame *)TripleBufferLatest(&simBuffer, NULL);
+}
@@ -0,0 +1,54 @@
+/*
+ * Scene simulation, optionally on its own thread.
+ *
+ * The simulation thread runs scene steps on a fixed timestep of its own
+ * and publishes each result as an immutable snapshot through a triple
+ * buffer. The render thread takes the latest snapshot without waiting, so
+ * the CPU scene update overlaps GL submission and the swap; a frame drawn
+ * before the next step is done shows the same snapshot again, and steps
+ * published faster than frames are drawn are skipped. The animation keeps
+ * wall-clock time whatever the frame rate, so the late policy of the frame
+ * pacer only matters inline.
+ *
+ * Inline (Threaded == 0) the scene takes exactly one step per frame, so the
+ * animation is the same on every run; golden references need that.
+ */
+
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+#include "scene.h"
+
+// Step rate of the thread when the caller has none (uncapped rendering).
+#define SIMULATION_DEFAULT_HZ   60
+
+// Steps the thread may fall behind before it gives them up.
+#define SIMULATION_MAX_BEHIND   4
+
+typedef struct _SceneFrame
+{
+    unsigned long long  sequence;   // simulation step that produced it
+    int                 count;      // objects
+    float *             matrices;   // column-major, 16 floats per object
+}
+SceneFrame;
+
+// Takes over the updates of Scn until SimulationStop(). The thread runs
+// StepHz steps per second, SIMULATION_DEFAULT_HZ for 0. Threaded == 0, or a
+// failure to start the thread, updates the scene inside SimulationNext().
+// returns 0: fail
+//         1: success
+int SimulationStart(Scene * Scn, int Threaded, int StepHz);
+void SimulationStop(void);
+int SimulationThreaded(void);
+
+// Stops and resumes the animation; the thread keeps its timestep but skips
+// the steps while paused.
+void SimulationSetPaused(int Paused);
+
+// Render thread: the snapshot to draw next. Inline, one simulation step per
+// call; threaded, the latest published step, never waiting. It stays valid
+// until the next call.
+const SceneFrame * SimulationNext(void);
+
+#endif /* SIMULATION_H */
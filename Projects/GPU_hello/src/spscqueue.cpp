@@ -0,0 +1,78 @@
+/*
+ * Bounded single-producer / single-consumer queue.
+ */
+
+#include "spscqueue.h"
+#include <stdlib.h>
+#include <string.h>
+
+int SpscQueueInit(SpscQueue * Queue, unsigned int ItemSize, unsigned int Capacity)
+{
+    memset(Queue, 0, sizeof(*Queue));
+
+    unsigned int capacity = 1;
+    while (capacity < Capacity)
+    {
+        capacity <<= 1;
+    }
+
+    Queue->items = (unsigned char *)malloc((size_t)ItemSize * capacity);
+    if (Queue->items == NULL)
+    {
+        return 0;
+    }
+    Queue->itemSize = ItemSize;
+    Queue->mask = capacity - 1;
+    return 1;
+}
+
+void SpscQueueDestroy(SpscQueue * Queue)
+{
+    free(Queue->items);
+    memset(Queue, 0, sizeof(*Queue));
+}
+
+int SpscQueuePush(SpscQueue * Queue, const void * Item)
+{
+    unsigned int head = Queue->head;
+
+    if (head - Queue->cachedTail > Queue->mask)
+    {
+        Queue->cachedTail = __atomic_load_n(&Queue->tail, __ATOMIC_ACQUIRE);
+        if (head - Queue->cachedTail > Queue->mask)
+        {
+            return 0;
+        }
+    }
+
+    memcpy(Queue->items + (size_t)(head & Queue->mask) * Queue->itemSize, Item, Queue->itemSize);
+    // Publish the item before the new head.
+    __atomic_store_n(&Queue->head, head + 1, __ATOMIC_RELEASE);
+    return 1;
+}
+
+int SpscQueuePopBatch(SpscQueue * Queue, void * Items, int Max)
+{
+    unsigned int tail = Queue->tail;
+    unsigned int available = __atomic_load_n(&Queue->head, __ATOMIC_ACQUIRE) - tail;
+    int count = (available < (unsigned int)Max) ? (int)available : Max;
+
+    unsigned char * out = (unsigned char *)Items;
+    for (int i = 0; i < count; ++i)
+    {
+        memcpy(out + (size_t)i * Queue->itemSize,
+               Queue->items + (size_t)((tail + i) & Queue->mask) * Queue->itemSize, Queue->itemSize);
+    }
+
+    if (count > 0)
+    {
+        // Hand the slots back only after they have been copied out.
+        __atomic_store_n(&Queue->tail, tail + count, __ATOMIC_RELEASE);
+    }
+    return count;
+}
+
+unsigned int SpscQueueSize(const SpscQueue * Queue)
+{
+    return __atomic_load_n(&Queue->head, __ATOMIC_ACQUIRE) - __atomic_load_n(&Queue->tail, __ATOMIC_ACQUIRE);
+}
@@ -0,0 +1,49 @@
+/*
+ * Bounded single-producer / single-consumer queue.
+ *
+ * A power-of-two ring of fixed-size items with free-running head and tail
+ * counters. Only the producer writes head and only the consumer writes
+ * tail, so push and pop need no lock: one acquire load of the other side's
+ * counter and one release store of their own. The producer keeps a cached
+ * copy of tail and re-reads it only when the ring looks full; the consumer
+ * is meant to drain in batches, one head load per batch.
+ */
+
+#ifndef SPSCQUEUE_H
+#define SPSCQUEUE_H
+
+#define SPSC_CACHE_LINE 64
+
+typedef struct _SpscQueue
+{
+    unsigned char * items;
+    unsigned int    itemSize;
+    unsigned int    mask;
+
+    // Producer side.
+    unsigned int    head __attribute__((aligned(SPSC_CACHE_LINE)));
+    unsigned int    cachedTail;
+
+    // Consumer side.
+    unsigned int    tail __attribute__((aligned(SPSC_CACHE_LINE)));
+}
+SpscQueue;
+
+// Capacity is rounded up to a power of two.
+// returns 0: out of memory
+//         1: success
+int SpscQueueInit(SpscQueue * Queue, unsigned int ItemSize, unsigned int Capacity);
+void SpscQueueDestroy(SpscQueue * Queue);
+
+// Producer only.
+// returns 0: full, nothing pushed
+//         1: success
+int SpscQueuePush(SpscQueue * Queue, const void * Item);
+
+// Consumer only. Pops up to Max items into Items, returns the number popped.
+int SpscQueuePopBatch(SpscQueue * Queue, void * Items, int Max);
+
+// Items queued right now; exact only on the consumer side.
+unsigned int SpscQueueSize(const SpscQueue * Queue);
+
+#endif /* SPSCQUEUE_H */
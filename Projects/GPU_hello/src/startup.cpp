@@ -0,0 +1,127 @@
+/*
+ * Startup phase timeline.
+ *
+ * Spans may come from any thread, so their slots are claimed with an atomic
+ * counter; they are only read by StartupPrint() once the work is joined.
+ */
+
+#include "startup.h"
+#include "framestats.h"
+
+typedef struct _StartupPhase
+{
+    const char *        name;
+    unsigned long long  ns;
+}
+StartupPhase;
+
+typedef struct _StartupSpanEntry
+{
+    const char *        name;
+    unsigned long long  beginNs;
+    unsigned long long  endNs;
+}
+StartupSpanEntry;
+
+static StartupPhase phases[STARTUP_MAX_PHASES];
+static int phaseCount = 0;
+static StartupSpanEntry spans[STARTUP_MAX_SPANS];
+static int spanCount = 0;
+static unsigned long long startNs = 0;
+static unsigned long long lastNs = 0;
+
+/***************************************************************************************
+***************************************************************************************/
+
+static void * startupTaskMain(void * Arg)
+{
+    StartupTask * task = (StartupTask *)Arg;
+    unsigned long long begin = FrameStatsNs();
+    task->main(task->arg);
+    StartupSpan(task->name, begin, FrameStatsNs());
+    return NULL;
+}
+
+/***************************************************************************************
+***************************************************************************************/
+
+void StartupInit(void)
+{
+    phaseCount = 0;
+    spanCount = 0;
+    startNs = lastNs = FrameStatsNs();
+}
+
+void StartupMark(const char * Name)
+{
+    unsigned long long now = FrameStatsNs();
+    if (phaseCount < STARTUP_MAX_PHASES)
+    {
+        phases[phaseCount].name = Name;
+        phases[phaseCount].ns   = now - lastNs;
+        ++phaseCount;
+    }
+    lastNs = now;
+}
+
+double StartupTotalMs(void)
+{
+    return (lastNs - startNs) / 1e6;
+}
+
+void StartupTaskStart(StartupTask * Task, const char * Name, StartupTaskMain Main, void * Arg, int Threaded)
+{
+    Task->name = Name;
+    Task->main = Main;
+    Task->arg = Arg;
+    Task->threaded = Threaded && (pthread_create(&Task->thread, NULL, startupTaskMain, Task) == 0);
+    if (!Task->threaded)
+    {
+        startupTaskMain(Task);
+    }
+}
+
+void StartupTaskJoin(StartupTask * Task)
+{
+    if (Task->threaded)
+    {
+        pthread_join(Task->thread, NULL);
+        Task->threaded = 0;
+    }
+}
+
+void StartupSpan(const char * Name, unsigned long long BeginNs, unsigned long long EndNs)
+{
+    int slot = __sync_fetch_and_add(&spanCount, 1);
+    if (slot < STARTUP_MAX_SPANS)
+    {
+        spans[slot].name    = Name;
+        spans[slot].beginNs = BeginNs;
+        spans[slot].endNs   = EndNs;
+    }
+}
+
+void StartupPrint(FILE * Stream)
+{
+    fprintf(Stream, "startup: %.3f ms\n", StartupTotalMs());
+    fprintf(Stream, "  %-40s %10s %10s %10s\n", "main thread", "start", "end", "ms");
+    unsigned long long at = startNs;
+    for (int i = 0; i < phaseCount; ++i)
+    {
+        fprintf(Stream, "  %-40s %10.3f %10.3f %10.3f\n", phases[i].name,
+                (at - startNs) / 1e6, (at + phases[i].ns - startNs) / 1e6, phases[i].ns / 1e6);
+        at += phases[i].ns;
+    }
+
+    int count = (spanCount < STARTUP_MAX_SPANS) ? spanCount : STARTUP_MAX_SPANS;
+    if (count > 0)
+    {
+        fprintf(Stream, "  tasks and background builds\n");
+    }
+    for (int i = 0; i < count; ++i)
+    {
+        fprintf(Stream, "  %-40s %10.3f %10.3f %10.3f\n", spans[i].name,
+                (spans[i].beginNs - startNs) / 1e6, (spans[i].endNs - startNs) / 1e6,
+                (spans[i].endNs - spans[i].beginNs) / 1e6);
+    }
+}
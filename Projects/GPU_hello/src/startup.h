@@ -0,0 +1,60 @@
+/*
+ * Startup phase timeline.
+ *
+ * Startup is cut into named phases on the monotonic clock: each mark closes
+ * the phase that ran since the previous mark (or StartupInit). The report
+ * shows where the boot budget goes, e.g. shader compile vs. program cache.
+ *
+ * Work that does not need the GL context (scene setup, mapping assets,
+ * warming the page cache) runs as tasks on threads of their own while the
+ * main thread initialises EGL, and is joined right before its result is
+ * needed. Tasks and other background work (programs built on the shader
+ * worker, see shaderprogram.h) are recorded as spans next to the phases, so
+ * the report is a timeline of what overlapped: a phase named "... wait" is
+ * time the main thread still spent waiting for a span to end.
+ */
+
+#ifndef STARTUP_H
+#define STARTUP_H
+
+#include <stdio.h>
+#include <pthread.h>
+
+#define STARTUP_MAX_PHASES  32
+#define STARTUP_MAX_SPANS   32
+
+typedef void (*StartupTaskMain)(void * Arg);
+
+typedef struct _StartupTask
+{
+    const char *        name;
+    StartupTaskMain     main;
+    void *              arg;
+    pthread_t           thread;
+    int                 threaded;   // 0: ran in StartupTaskStart()
+}
+StartupTask;
+
+void StartupInit(void);
+
+// Ends the current phase now and names it; Name must stay valid.
+void StartupMark(const char * Name);
+
+// Milliseconds from StartupInit to the last mark.
+double StartupTotalMs(void);
+
+// Runs Main(Arg) on a thread of its own, or right away on the calling
+// thread when Threaded is 0 or no thread can be created. Name must stay
+// valid.
+void StartupTaskStart(StartupTask * Task, const char * Name, StartupTaskMain Main, void * Arg, int Threaded);
+
+// Waits for the task; call once per started task.
+void StartupTaskJoin(StartupTask * Task);
+
+// Records work from BeginNs to EndNs (FrameStatsNs()) on another thread.
+// May be called from any thread; Name must stay valid.
+void StartupSpan(const char * Name, unsigned long long BeginNs, unsigned long long EndNs);
+
+void StartupPrint(FILE * Stream);
+
+#endif /* STARTUP_H */
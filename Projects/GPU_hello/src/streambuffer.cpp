@@ -0,0 +1,181 @@
+/*
+ * Streaming vertex data.
+ *
+ * streamCurrent is the buffer written, streamOffset its first free byte.
+ * A buffer is dirty from its first write until it is orphaned or its
+ * fence waited for, which happens at the first write after the ring comes
+ * back to it.
+ */
+
+#include "streambuffer.h"
+#include "extensions.h"
+#include "framestats.h"
+#include "glstate.h"
+#include "gltrace.h"
+#include <stdio.h>
+#include <string.h>
+
+typedef struct _StreamSlot
+{
+    GLuint      buffer;
+    EGLSyncKHR  fence;
+    int         dirty;
+}
+StreamSlot;
+
+static const char * modeNames[] = { "orphan", "fenced" };
+
+static StreamSlot streamSlots[STREAM_MAX_BUFFERS];
+static int streamCount = 0;
+static int streamSize = 0;
+static int streamMode = STREAM_ORPHAN;
+static int streamCurrent = 0;
+static int streamOffset = 0;
+static StreamBufferStats streamStats;
+
+/***************************************************************************************
+***************************************************************************************/
+
+// Makes the current buffer safe to overwrite; it is bound.
+static void streamReclaim(StreamSlot * Slot)
+{
+    if (Slot->fence != EGL_NO_SYNC_KHR)
+    {
+        int flushed = 0;
+        if (!EglFenceWait(Slot->fence, 0, &flushed))
+        {
+            unsigned long long start = FrameStatsNs();
+            EglFenceWait(Slot->fence, 1, &flushed);
+            ++streamStats.waits;
+            streamStats.waitMs += (FrameStatsNs() - start) / 1e6;
+        }
+        EglFenceDestroy(Slot->fence);
+        Slot->fence = EGL_NO_SYNC_KHR;
+    }
+    else
+    {
+        unsigned long long start = FrameStatsNs();
+        glBufferData(GL_ARRAY_BUFFER, streamSize, NULL, GL_STREAM_DRAW);
+        streamStats.uploadMs += (FrameStatsNs() - start) / 1e6;
+        ++streamStats.orphans;
+    }
+    Slot->dirty = 0;
+}
+
+// Leaves the current buffer, fencing it if it was written.
+static void streamAdvance(void)
+{
+    StreamSlot * slot = &streamSlots[streamCurrent];
+    if ((streamOffset > 0) && (streamMode == STREAM_FENCED))
+    {
+        slot->fence = EglFenceCreate();
+    }
+    streamCurrent = (streamCurrent + 1) % streamCount;
+    streamOffset = 0;
+}
+
+/***************************************************************************************
+***************************************************************************************/
+
+int StreamBufferInit(EGLDisplay Display, int Size, int Count, int Mode)
+{
+    StreamBufferDestroy();
+    memset(&streamStats, 0, sizeof(streamStats));
+    streamCount = (Count < 1) ? 1 : ((Count > STREAM_MAX_BUFFERS) ? STREAM_MAX_BUFFERS : Count);
+    streamMode = STREAM_ORPHAN;
+
+    if ((Mode == STREAM_FENCED) && EglFenceInit(Display))
+    {
+        streamMode = STREAM_FENCED;
+    }
+    streamStats.mode = streamMode;
+
+    for (int i = 0; i < streamCount; ++i)
+    {
+        glGenBuffers(1, &streamSlots[i].buffer);
+        GlStateBindBuffer(GL_ARRAY_BUFFER, streamSlots[i].buffer);
+        glBufferData(GL_ARRAY_BUFFER, Size, NULL, GL_STREAM_DRAW);
+    }
+    if (glGetError() == GL_OUT_OF_MEMORY)
+    {
+        fprintf(stderr, "No memory for %d stream buffers of %d bytes.\n", streamCount, Size);
+        StreamBufferDestroy();
+        return 0;
+    }
+    streamSize = Size;
+    streamCurrent = 0;
+    streamOffset = 0;
+    return 1;
+}
+
+void StreamBufferDestroy(void)
+{
+    for (int i = 0; i < streamCount; ++i)
+    {
+        StreamSlot * slot = &streamSlots[i];
+        EglFenceDestroy(slot->fence);
+        if (slot->buffer != 0)
+        {
+            GlStateDeleteBuffers(1, &slot->buffer);
+        }
+    }
+    memset(streamSlots, 0, sizeof(streamSlots));
+    streamCount = 0;
+    streamSize = 0;
+}
+
+GLintptr StreamBufferWrite(const void * Data, GLsizeiptr Bytes)
+{
+    if ((Bytes <= 0) || (Bytes > streamSize))
+    {
+        return -1;
+    }
+
+    int offset = (streamOffset + STREAM_ALIGN - 1) & ~(STREAM_ALIGN - 1);
+    if (offset + Bytes > streamSize)
+    {
+        streamAdvance();
+        offset = 0;
+    }
+
+    StreamSlot * slot = &streamSlots[streamCurrent];
+    GlStateBindBuffer(GL_ARRAY_BUFFER, slot->buffer);
+    if (slot->dirty && (streamOffset == 0))
+    {
+        streamReclaim(slot);
+    }
+
+    unsigned long long start = FrameStatsNs();
+    glBufferSubData(GL_ARRAY_BUFFER, offset, Bytes, Data);
+    streamStats.uploadMs += (FrameStatsNs() - start) / 1e6;
+    streamStats.bytes += Bytes;
+    ++streamStats.writes;
+
+    slot->dirty = 1;
+    streamOffset = offset + (int)Bytes;
+    return offset;
+}
+
+void StreamBufferFrame(void)
+{
+    if (streamOffset > 0)
+    {
+        streamAdvance();
+    }
+    ++streamStats.frames;
+}
+
+int StreamBufferSize(void)
+{
+    return streamSize;
+}
+
+void StreamBufferGetStats(StreamBufferStats * Stats)
+{
+    *Stats = streamStats;
+}
+
+const char * StreamModeName(int Mode)
+{
+    return ((Mode >= STREAM_ORPHAN) && (Mode <= STREAM_FENCED)) ? modeNames[Mode] : "unknown";
+}
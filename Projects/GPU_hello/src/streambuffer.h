@@ -0,0 +1,76 @@
+/*
+ * Streaming vertex data.
+ *
+ * Geometry that changes every frame is sub-allocated from a ring of large
+ * GL buffers instead of being re-specified in a buffer of its own, which
+ * can make the driver wait for the draws still reading the old contents.
+ * Writes go to the current buffer at increasing, aligned offsets. Each
+ * frame, and whenever the current buffer is full, the ring moves on to the
+ * next buffer, which is made safe to overwrite in one of two ways:
+ *
+ *  - Orphaning: glBufferData(NULL) gives the buffer fresh storage; the
+ *    driver frees the old one once the GPU is done with it.
+ *  - Fenced ring: the buffer was fenced (EGL_KHR_fence_sync) when it was
+ *    left; with enough buffers the fence has signaled by the time the
+ *    ring comes round, otherwise the wait is counted as a stall. Without
+ *    fences this mode orphans.
+ *
+ * Time in the buffer update calls is counted too, since implicit
+ * synchronization shows up there.
+ */
+
+#ifndef STREAMBUFFER_H
+#define STREAMBUFFER_H
+
+#include <GLES2/gl2.h>
+#include <EGL/egl.h>
+
+#define STREAM_MAX_BUFFERS  8
+
+// Offsets are multiples of this: a cache line, and a multiple of every
+// vertex attribute size.
+#define STREAM_ALIGN        64
+
+enum
+{
+    STREAM_ORPHAN,
+    STREAM_FENCED,
+};
+
+typedef struct _StreamBufferStats
+{
+    unsigned long long  bytes;      // written
+    unsigned long long  writes;
+    unsigned long long  frames;
+    unsigned long long  orphans;
+    unsigned long long  waits;      // fences not signaled when their buffer came round
+    double              waitMs;     // in those waits
+    double              uploadMs;   // in glBufferSubData() and glBufferData()
+    int                 mode;       // the mode in use, STREAM_ORPHAN without fences
+}
+StreamBufferStats;
+
+// Count (1 .. STREAM_MAX_BUFFERS) buffers of Size bytes. Needs the current
+// context on Display.
+// returns 0: fail
+//         1: success
+int StreamBufferInit(EGLDisplay Display, int Size, int Count, int Mode);
+void StreamBufferDestroy(void);
+
+// Copies Bytes (at most the buffer size) into the ring and binds its
+// buffer to GL_ARRAY_BUFFER, so attribute pointers can be set from the
+// offset.
+// returns the offset of the data in the bound buffer, or -1
+GLintptr StreamBufferWrite(const void * Data, GLsizeiptr Bytes);
+
+// Ends the frame: the next frame writes to the next buffer.
+void StreamBufferFrame(void);
+
+// Bytes per buffer, 0 before init.
+int StreamBufferSize(void);
+
+void StreamBufferGetStats(StreamBufferStats * Stats);
+
+const char * StreamModeName(int Mode);
+
+#endif /* STREAMBUFFER_H */
@@ -0,0 +1,686 @@
+/*
+ * CPU rasterizer for the Tutorial 1 pipeline.
+ *
+ * A frame runs in two parallel stages:
+ *  1. setup: each thread transforms a contiguous range of objects, builds
+ *     the edge and color plane equations of their triangles and appends the
+ *     triangle indices to its own per-tile bins;
+ *  2. raster: threads pull tiles from a shared counter, clear them and walk
+ *     the bins of thread 0, 1, ... in order, so triangles are drawn in
+ *     submission order without any locking.
+ * Tiles are a multiple of four pixels wide, so a four-pixel group never
+ * straddles two tiles and the framebuffer stride is padded to four pixels.
+ */
+
+#include "swrast.h"
+#include <pthread.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define SWRAST_NEON 1
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define SWRAST_SSE 1
+#endif
+
+#define SWRAST_TILE         64
+#define SWRAST_MAX_THREADS  32
+
+/***************************************************************************************
+***************************************************************************************/
+
+// Four-wide float helpers: NEON, SSE2 or plain C.
+
+#if SWRAST_NEON
+
+typedef float32x4_t SwFloat4;
+typedef uint32x4_t  SwMask4;
+
+static inline SwFloat4 swSplat(float V)                 { return vdupq_n_f32(V); }
+static inline SwFloat4 swLanes(float A, float B, float C, float D)
+{
+    float lanes[4] = { A, B, C, D };
+    return vld1q_f32(lanes);
+}
+static inline SwFloat4 swAdd(SwFloat4 A, SwFloat4 B)    { return vaddq_f32(A, B); }
+static inline SwFloat4 swMadd(SwFloat4 A, SwFloat4 B, SwFloat4 C) { return vmlaq_f32(C, A, B); }
+static inline SwMask4 swAnd(SwMask4 A, SwMask4 B)       { return vandq_u32(A, B); }
+static inline int swAny(SwMask4 M)
+{
+    uint32x2_t halves = vorr_u32(vget_low_u32(M), vget_high_u32(M));
+    return (vget_lane_u32(halves, 0) | vget_lane_u32(halves, 1)) != 0;
+}
+// e > 0, or e == 0 on an edge that owns its pixels.
+static inline SwMask4 swInside(SwFloat4 E, SwMask4 Tie)
+{
+    SwFloat4 zero = vdupq_n_f32(0.0f);
+    return vorrq_u32(vcgtq_f32(E, zero), vandq_u32(vceqq_f32(E, zero), Tie));
+}
+static inline SwMask4 swTieMask(int Owns)               { return vdupq_n_u32(Owns ? ~0u : 0u); }
+static inline SwMask4 swChannel(SwFloat4 C)
+{
+    C = vminq_f32(vmaxq_f32(C, vdupq_n_f32(0.0f)), vdupq_n_f32(1.0f));
+    return vcvtq_u32_f32(vmlaq_f32(vdupq_n_f32(0.5f), C, vdupq_n_f32(255.0f)));
+}
+static inline void swStore(unsigned int * Dst, SwMask4 Mask, SwFloat4 R, SwFloat4 G, SwFloat4 B)
+{
+    SwMask4 rgba = vorrq_u32(vorrq_u32(swChannel(R), vshlq_n_u32(swChannel(G), 8)),
+                             vorrq_u32(vshlq_n_u32(swChannel(B), 16), vdupq_n_u32(0xFF000000u)));
+    vst1q_u32(Dst, vbslq_u32(Mask, rgba, vld1q_u32(Dst)));
+}
+
+#elif SWRAST_SSE
+
+typedef __m128 SwFloat4;
+typedef __m128 SwMask4;
+
+static inline SwFloat4 swSplat(float V)                 { return _mm_set1_ps(V); }
+static inline SwFloat4 swLanes(float A, float B, float C, float D) { return _mm_setr_ps(A, B, C, D); }
+static inline SwFloat4 swAdd(SwFloat4 A, SwFloat4 B)    { return _mm_add_ps(A, B); }
+static inline SwFloat4 swMadd(SwFloat4 A, SwFloat4 B, SwFloat4 C) { return _mm_add_ps(_mm_mul_ps(A, B), C); }
+static inline SwMask4 swAnd(SwMask4 A, SwMask4 B)       { return _mm_and_ps(A, B); }
+static inline int swAny(SwMask4 M)                      { return _mm_movemask_ps(M) != 0; }
+// e > 0, or e == 0 on an edge that owns its pixels.
+static inline SwMask4 swInside(SwFloat4 E, SwMask4 Tie)
+{
+    SwFloat4 zero = _mm_setzero_ps();
+    return _mm_or_ps(_mm_cmpgt_ps(E, zero), _mm_and_ps(_mm_cmpeq_ps(E, zero), Tie));
+}
+static inline SwMask4 swTieMask(int Owns)               { return _mm_castsi128_ps(_mm_set1_epi32(Owns ? -1 : 0)); }
+static inline __m128i swChannel(SwFloat4 C)
+{
+    C = _mm_min_ps(_mm_max_ps(C, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+    return _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(C, _mm_set1_ps(255.0f)), _mm_set1_ps(0.5f)));
+}
+static inline void swStore(unsigned int * Dst, SwMask4 Mask, SwFloat4 R, SwFloat4 G, SwFloat4 B)
+{
+    __m128i rgba = _mm_or_si128(_mm_or_si128(swChannel(R), _mm_slli_epi32(swChannel(G), 8)),
+                                _mm_or_si128(_mm_slli_epi32(swChannel(B), 16), _mm_set1_epi32((int)0xFF000000u)));
+    __m128i mask = _mm_castps_si128(Mask);
+    __m128i old = _mm_load_si128((const __m128i *)Dst);
+    _mm_store_si128((__m128i *)Dst, _mm_or_si128(_mm_and_si128(mask, rgba), _mm_andnot_si128(mask, old)));
+}
+
+#else
+
+typedef struct { float v[4]; } SwFloat4;
+typedef struct { unsigned int v[4]; } SwMask4;
+
+static inline SwFloat4 swSplat(float V)                 { SwFloat4 r = { { V, V, V, V } }; return r; }
+static inline SwFloat4 swLanes(float A, float B, float C, float D) { SwFloat4 r = { { A, B, C, D } }; return r; }
+static inline SwFloat4 swAdd(SwFloat4 A, SwFloat4 B)
+{
+    for (int i = 0; i < 4; ++i) A.v[i] += B.v[i];
+    return A;
+}
+static inline SwFloat4 swMadd(SwFloat4 A, SwFloat4 B, SwFloat4 C)
+{
+    for (int i = 0; i < 4; ++i) C.v[i] += A.v[i] * B.v[i];
+    return C;
+}
+static inline SwMask4 swAnd(SwMask4 A, SwMask4 B)
+{
+    for (int i = 0; i < 4; ++i) A.v[i] &= B.v[i];
+    return A;
+}
+static inline int swAny(SwMask4 M)                      { return (M.v[0] | M.v[1] | M.v[2] | M.v[3]) != 0; }
+static inline SwMask4 swInside(SwFloat4 E, SwMask4 Tie)
+{
+    SwMask4 r;
+    for (int i = 0; i < 4; ++i) r.v[i] = ((E.v[i] > 0.0f) || ((E.v[i] == 0.0f) && Tie.v[i])) ? ~0u : 0u;
+    return r;
+}
+static inline SwMask4 swTieMask(int Owns)               { unsigned int m = Owns ? ~0u : 0u; SwMask4 r = { { m, m, m, m } }; return r; }
+static inline unsigned int swChannel(float C)
+{
+    C = (C < 0.0f) ? 0.0f : ((C > 1.0f) ? 1.0f : C);
+    return (unsigned int)(C * 255.0f + 0.5f);
+}
+static inline void swStore(unsigned int * Dst, SwMask4 Mask, SwFloat4 R, SwFloat4 G, SwFloat4 B)
+{
+    for (int i = 0; i < 4; ++i)
+    {
+        if (Mask.v[i])
+        {
+            Dst[i] = swChannel(R.v[i]) | (swChannel(G.v[i]) << 8) | (swChannel(B.v[i]) << 16) | 0xFF000000u;
+        }
+    }
+}
+
+#endif
+
+/***************************************************************************************
+***************************************************************************************/
+
+// Screen-space triangle: edge and color planes a * x + b * y + c.
+// The edges are divided by the triangle area, so they are the barycentric
+// weights of vertex 0, 1 and 2 and positive inside.
+typedef struct _SwTriangle
+{
+    float   edge[3][3];
+    float   color[3][3];
+    int     minX, minY, maxX, maxY;
+    int     owns;       // bit i: edge i owns pixels exactly on it
+}
+SwTriangle;
+
+typedef struct _SwBin
+{
+    unsigned int *  items;
+    int             count;
+    int             capacity;
+}
+SwBin;
+
+typedef struct _SwWorker
+{
+    SwTriangle *    triangles;
+    int             count;
+    int             capacity;
+    SwBin *         bins;       // one per tile
+}
+SwWorker;
+
+static int swWidth = 0;
+static int swHeight = 0;
+static int swStride = 0;
+static int swTilesX = 0;
+static int swTilesY = 0;
+static unsigned int * swPixels = NULL;
+static SwWorker swWorkers[SWRAST_MAX_THREADS];
+
+static int swThreadCount = 0;
+static pthread_t swThreads[SWRAST_MAX_THREADS];
+static pthread_mutex_t swLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t swStart = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t swDone = PTHREAD_COND_INITIALIZER;
+static void (*swJob)(int) = NULL;
+static unsigned int swGeneration = 0;
+static int swPending = 0;
+static int swQuit = 0;
+
+// Parameters of the frame being drawn.
+static const float * swPositions = NULL;
+static const float * swColors = NULL;
+static const float * swMatrices = NULL;
+static int swVertexCount = 0;
+static int swObjectCount = 0;
+static unsigned int swClearPixel = 0;
+static int swNextTile = 0;
+
+static double swSetupMs = 0.0;
+static double swRasterMs = 0.0;
+static int swFrames = 0;
+
+/***************************************************************************************
+***************************************************************************************/
+
+static double swNow(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000.0 + now.tv_nsec / 1000000.0;
+}
+
+static void * swWorkerMain(void * Arg)
+{
+    int index = (int)(size_t)Arg;
+    unsigned int seen = 0;
+
+    for (;;)
+    {
+        pthread_mutex_lock(&swLock);
+        while (!swQuit && (swGeneration == seen))
+        {
+            pthread_cond_wait(&swStart, &swLock);
+        }
+        if (swQuit)
+        {
+            pthread_mutex_unlock(&swLock);
+            break;
+        }
+        seen = swGeneration;
+        void (*job)(int) = swJob;
+        pthread_mutex_unlock(&swLock);
+
+        job(index);
+
+        pthread_mutex_lock(&swLock);
+        if (--swPending == 0)
+        {
+            pthread_cond_signal(&swDone);
+        }
+        pthread_mutex_unlock(&swLock);
+    }
+
+    return NULL;
+}
+
+// Runs Job(0 .. swThreadCount - 1), the calling thread taking index 0.
+static void swRunParallel(void (*Job)(int))
+{
+    pthread_mutex_lock(&swLock);
+    swJob = Job;
+    swPending = swThreadCount - 1;
+    ++swGeneration;
+    pthread_cond_broadcast(&swStart);
+    pthread_mutex_unlock(&swLock);
+
+    Job(0);
+
+    pthread_mutex_lock(&swLock);
+    while (swPending > 0)
+    {
+        pthread_cond_wait(&swDone, &swLock);
+    }
+    pthread_mutex_unlock(&swLock);
+}
+
+static int swGrow(void ** Items, int * Capacity, int Needed, size_t Size)
+{
+    if (Needed <= *Capacity)
+    {
+        return 1;
+    }
+
+    int capacity = (*Capacity > 0) ? *Capacity * 2 : 64;
+    while (capacity < Needed)
+    {
+        capacity *= 2;
+    }
+
+    void * items = realloc(*Items, capacity * Size);
+    if (items == NULL)
+    {
+        return 0;
+    }
+    *Items = items;
+    *Capacity = capacity;
+    return 1;
+}
+
+/***************************************************************************************
+***************************************************************************************/
+
+// Builds the triangle from three window-space vertices.
+// returns 0: culled (degenerate or off-screen)
+//         1: visible
+static int swSetupTriangle(SwTriangle * Tri, const float X[3], const float Y[3], const float * C[3])
+{
+    float area = (X[1] - X[0]) * (Y[2] - Y[0]) - (Y[1] - Y[0]) * (X[2] - X[0]);
+    if (area == 0.0f)
+    {
+        return 0;
+    }
+
+    float minX = fminf(X[0], fminf(X[1], X[2]));
+    float maxX = fmaxf(X[0], fmaxf(X[1], X[2]));
+    float minY = fminf(Y[0], fminf(Y[1], Y[2]));
+    float maxY = fmaxf(Y[0], fmaxf(Y[1], Y[2]));
+
+    // Pixels whose centre lies in the bounding box.
+    Tri->minX = (int)ceilf(minX - 0.5f);
+    Tri->maxX = (int)floorf(maxX - 0.5f);
+    Tri->minY = (int)ceilf(minY - 0.5f);
+    Tri->maxY = (int)floorf(maxY - 0.5f);
+    if (Tri->minX < 0)            Tri->minX = 0;
+    if (Tri->minY < 0)            Tri->minY = 0;
+    if (Tri->maxX > swWidth - 1)  Tri->maxX = swWidth - 1;
+    if (Tri->maxY > swHeight - 1) Tri->maxY = swHeight - 1;
+    if ((Tri->minX > Tri->maxX) || (Tri->minY > Tri->maxY))
+    {
+        return 0;
+    }
+
+    // Edge i is opposite vertex i, weight of vertex i.
+    float inv = 1.0f / area;
+    Tri->owns = 0;
+    for (int i = 0; i < 3; ++i)
+    {
+        int a = (i + 1) % 3;
+        int b = (i + 2) % 3;
+        float ea = -(Y[b] - Y[a]) * inv;
+        float eb =  (X[b] - X[a]) * inv;
+        Tri->edge[i][0] = ea;
+        Tri->edge[i][1] = eb;
+        Tri->edge[i][2] = -(ea * X[a] + eb * Y[a]);
+
+        // Shared edges have opposite coefficients in the two triangles, so
+        // exactly one of them owns the pixels on the edge.
+        if ((ea > 0.0f) || ((ea == 0.0f) && (eb > 0.0f)))
+        {
+            Tri->owns |= 1 << i;
+        }
+    }
+
+    for (int c = 0; c < 3; ++c)
+    {
+        for (int k = 0; k < 3; ++k)
+        {
+            Tri->color[c][k] = Tri->edge[0][k] * C[0][c] + Tri->edge[1][k] * C[1][c] + Tri->edge[2][k] * C[2][c];
+        }
+    }
+
+    return 1;
+}
+
+static void swSetupJob(int Worker)
+{
+    SwWorker * worker = &swWorkers[Worker];
+    int first = (int)((long long)swObjectCount * Worker / swThreadCount);
+    int last  = (int)((long long)swObjectCount * (Worker + 1) / swThreadCount);
+    int tiles = swTilesX * swTilesY;
+
+    worker->count = 0;
+    for (int t = 0; t < tiles; ++t)
+    {
+        worker->bins[t].count = 0;
+    }
+
+    for (int o = first; o < last; ++o)
+    {
+        const float * m = &swMatrices[o * 16];
+
+        for (int v = 0; v + 2 < swVertexCount; v += 3)
+        {
+            float x[3], y[3];
+            const float * c[3];
+            int clipped = 0;
+
+            for (int k = 0; k < 3; ++k)
+            {
+                // my_TransformMatrix * vec4(my_Vertex.xy, 0, 1), then viewport.
+                const float * p = &swPositions[(v + k) * 2];
+                float cx = m[0] * p[0] + m[4] * p[1] + m[12];
+                float cy = m[1] * p[0] + m[5] * p[1] + m[13];
+                float cw = m[3] * p[0] + m[7] * p[1] + m[15];
+                if (cw <= 0.0f)
+                {
+                    clipped = 1;
+                    break;
+                }
+                x[k] = (cx / cw * 0.5f + 0.5f) * swWidth;
+                y[k] = (0.5f - cy / cw * 0.5f) * swHeight;
+                c[k] = &swColors[(v + k) * 3];
+            }
+
+            if (clipped || !swGrow((void **)&worker->triangles, &worker->capacity, worker->count + 1, sizeof(SwTriangle)))
+            {
+                continue;
+            }
+
+            SwTriangle * tri = &worker->triangles[worker->count];
+            if (!swSetupTriangle(tri, x, y, c))
+            {
+                continue;
+            }
+
+            for (int ty = tri->minY / SWRAST_TILE; ty <= tri->maxY / SWRAST_TILE; ++ty)
+            {
+                for (int tx = tri->minX / SWRAST_TILE; tx <= tri->maxX / SWRAST_TILE; ++tx)
+                {
+                    SwBin * bin = &worker->bins[ty * swTilesX + tx];
+                    if (swGrow((void **)&bin->items, &bin->capacity, bin->count + 1, sizeof(unsigned int)))
+                    {
+                        bin->items[bin->count++] = worker->count;
+                    }
+                }
+            }
+            ++worker->count;
+        }
+    }
+}
+
+static void swRasterTriangle(const SwTriangle * Tri, int X0, int Y0, int X1, int Y1)
+{
+    int minX = (Tri->minX > X0) ? Tri->minX : X0;
+    int maxX = (Tri->maxX < X1) ? Tri->maxX : X1;
+    int minY = (Tri->minY > Y0) ? Tri->minY : Y0;
+    int maxY = (Tri->maxY < Y1) ? Tri->maxY : Y1;
+    if ((minX > maxX) || (minY > maxY))
+    {
+        return;
+    }
+
+    int startX = minX & ~3;
+    SwFloat4 step = swSplat(4.0f);
+    SwMask4 tie0 = swTieMask(Tri->owns & 1);
+    SwMask4 tie1 = swTieMask(Tri->owns & 2);
+    SwMask4 tie2 = swTieMask(Tri->owns & 4);
+    SwFloat4 a0 = swSplat(Tri->edge[0][0]);
+    SwFloat4 a1 = swSplat(Tri->edge[1][0]);
+    SwFloat4 a2 = swSplat(Tri->edge[2][0]);
+    SwFloat4 ar = swSplat(Tri->color[0][0]);
+    SwFloat4 ag = swSplat(Tri->color[1][0]);
+    SwFloat4 ab = swSplat(Tri->color[2][0]);
+
+    for (int y = minY; y <= maxY; ++y)
+    {
+        float py = y + 0.5f;
+        SwFloat4 r0 = swSplat(Tri->edge[0][1] * py + Tri->edge[0][2]);
+        SwFloat4 r1 = swSplat(Tri->edge[1][1] * py + Tri->edge[1][2]);
+        SwFloat4 r2 = swSplat(Tri->edge[2][1] * py + Tri->edge[2][2]);
+        SwFloat4 px = swLanes(startX + 0.5f, startX + 1.5f, startX + 2.5f, startX + 3.5f);
+        unsigned int * dst = &swPixels[y * swStride + startX];
+
+        for (int x = startX; x <= maxX; x += 4, dst += 4, px = swAdd(px, step))
+        {
+            SwMask4 mask = swAnd(swInside(swMadd(a0, px, r0), tie0),
+                           swAnd(swInside(swMadd(a1, px, r1), tie1),
+                                 swInside(swMadd(a2, px, r2), tie2)));
+            if (!swAny(mask))
+            {
+                continue;
+            }
+
+            SwFloat4 red   = swMadd(ar, px, swSplat(Tri->color[0][1] * py + Tri->color[0][2]));
+            SwFloat4 green = swMadd(ag, px, swSplat(Tri->color[1][1] * py + Tri->color[1][2]));
+            SwFloat4 blue  = swMadd(ab, px, swSplat(Tri->color[2][1] * py + Tri->color[2][2]));
+            swStore(dst, mask, red, green, blue);
+        }
+    }
+}
+
+static void swRasterJob(int Worker)
+{
+    (void)Worker;
+    int tiles = swTilesX * swTilesY;
+
+    for (int tile = __sync_fetch_and_add(&swNextTile, 1); tile < tiles; tile = __sync_fetch_and_add(&swNextTile, 1))
+    {
+        int x0 = (tile % swTilesX) * SWRAST_TILE;
+        int y0 = (tile / swTilesX) * SWRAST_TILE;
+        int x1 = ((x0 + SWRAST_TILE < swWidth) ? x0 + SWRAST_TILE : swWidth) - 1;
+        int y1 = ((y0 + SWRAST_TILE < swHeight) ? y0 + SWRAST_TILE : swHeight) - 1;
+
+        for (int y = y0; y <= y1; ++y)
+        {
+            unsigned int * row = &swPixels[y * swStride];
+            for (int x = x0; x <= x1; ++x)
+            {
+                row[x] = swClearPixel;
+            }
+        }
+
+        for (int w = 0; w < swThreadCount; ++w)
+        {
+            const SwBin * bin = &swWorkers[w].bins[tile];
+            const SwTriangle * triangles = swWorkers[w].triangles;
+            for (int i = 0; i < bin->count; ++i)
+            {
+                swRasterTriangle(&triangles[bin->items[i]], x0, y0, x1, y1);
+            }
+        }
+    }
+}
+
+/***************************************************************************************
+***************************************************************************************/
+
+int SwRastInit(int Width, int Height, int Threads)
+{
+    if (Threads <= 0)
+    {
+        Threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    }
+    if (Threads < 1)
+    {
+        Threads = 1;
+    }
+    if (Threads > SWRAST_MAX_THREADS)
+    {
+        Threads = SWRAST_MAX_THREADS;
+    }
+
+    swWidth  = Width;
+    swHeight = Height;
+    swStride = (Width + 3) & ~3;
+    swTilesX = (Width + SWRAST_TILE - 1) / SWRAST_TILE;
+    swTilesY = (Height + SWRAST_TILE - 1) / SWRAST_TILE;
+
+    if (posix_memalign((void **)&swPixels, 16, sizeof (unsigned int) * swStride * Height) != 0)
+    {
+        swPixels = NULL;
+        fprintf(stderr, "Out of memory.\n");
+        return 0;
+    }
+    memset(swPixels, 0, sizeof (unsigned int) * swStride * Height);
+
+    memset(swWorkers, 0, sizeof(swWorkers));
+    for (int w = 0; w < Threads; ++w)
+    {
+        swWorkers[w].bins = (SwBin*)calloc(swTilesX * swTilesY, sizeof(SwBin));
+        if (swWorkers[w].bins == NULL)
+        {
+            fprintf(stderr, "Out of memory.\n");
+            SwRastDestroy();
+            return 0;
+        }
+    }
+
+    swQuit = 0;
+    swThreadCount = 1;
+    for (int w = 1; w < Threads; ++w)
+    {
+        if (pthread_create(&swThreads[w], NULL, swWorkerMain, (void *)(size_t)w) != 0)
+        {
+            break;
+        }
+        ++swThreadCount;
+    }
+
+    swSetupMs = swRasterMs = 0.0;
+    swFrames = 0;
+    return 1;
+}
+
+void SwRastDestroy(void)
+{
+    pthread_mutex_lock(&swLock);
+    swQuit = 1;
+    pthread_cond_broadcast(&swStart);
+    pthread_mutex_unlock(&swLock);
+
+    for (int w = 1; w < swThreadCount; ++w)
+    {
+        pthread_join(swThreads[w], NULL);
+    }
+
+    for (int w = 0; w < SWRAST_MAX_THREADS; ++w)
+    {
+        if (swWorkers[w].bins != NULL)
+        {
+            for (int t = 0; t < swTilesX * swTilesY; ++t)
+            {
+                free(swWorkers[w].bins[t].items);
+            }
+        }
+        free(swWorkers[w].bins);
+        free(swWorkers[w].triangles);
+    }
+    memset(swWorkers, 0, sizeof(swWorkers));
+
+    free(swPixels);
+    swPixels = NULL;
+    swThreadCount = 0;
+}
+
+void SwRastDraw(const float * ClearColor,
+                const float * Positions, const float * Colors, int VertexCount,
+                const float * Matrices, int ObjectCount)
+{
+    unsigned int rgba[4];
+    for (int c = 0; c < 4; ++c)
+    {
+        float v = (ClearColor[c] < 0.0f) ? 0.0f : ((ClearColor[c] > 1.0f) ? 1.0f : ClearColor[c]);
+        rgba[c] = (unsigned int)(v * 255.0f + 0.5f);
+    }
+    swClearPixel = rgba[0] | (rgba[1] << 8) | (rgba[2] << 16) | (rgba[3] << 24);
+
+    swPositions   = Positions;
+    swColors      = Colors;
+    swVertexCount = VertexCount;
+    swMatrices    = Matrices;
+    swObjectCount = ObjectCount;
+
+    double start = swNow();
+    swRunParallel(swSetupJob);
+
+    double binned = swNow();
+    swNextTile = 0;
+    swRunParallel(swRasterJob);
+
+    double end = swNow();
+    swSetupMs  += binned - start;
+    swRasterMs += end - binned;
+    ++swFrames;
+}
+
+const unsigned char * SwRastPixels(int * Stride)
+{
+    if (Stride != NULL)
+    {
+        *Stride = swStride * 4;
+    }
+    return (const unsigned char *)swPixels;
+}
+
+void SwRastGetTimes(double * SetupMs, double * RasterMs)
+{
+    *SetupMs  = (swFrames > 0) ? swSetupMs / swFrames : 0.0;
+    *RasterMs = (swFrames > 0) ? swRasterMs / swFrames : 0.0;
+}
+
+int SwRastThreads(void)
+{
+    return swThreadCount;
+}
+
+int SwRastWritePPM(const char * FName)
+{
+    FILE * fptr = fopen(FName, "wb");
+    if (fptr == NULL)
+    {
+        fprintf(stderr, "Cannot open file '%s'\n", FName);
+        return 0;
+    }
+
+    fprintf(fptr, "P6\n%d %d\n255\n", swWidth, swHeight);
+    for (int y = 0; y < swHeight; ++y)
+    {
+        const unsigned char * row = (const unsigned char *)&swPixels[y * swStride];
+        for (int x = 0; x < swWidth; ++x)
+        {
+            fwrite(&row[x * 4], 3, 1, fptr);
+        }
+    }
+
+    fclose(fptr);
+    return 1;
+}
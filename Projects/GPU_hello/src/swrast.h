@@ -0,0 +1,39 @@
+/*
+ * CPU rasterizer for the Tutorial 1 pipeline.
+ *
+ * Runs vs_es20t1.vert / ps_es20t1.frag on the CPU: every vertex is
+ * transformed by its object's matrix (my_TransformMatrix * my_Vertex) and
+ * the color varying is interpolated with barycentric weights into an RGBA8
+ * framebuffer. Triangles are binned into screen tiles and the tiles are
+ * rasterized in parallel, four pixels per SSE/NEON instruction.
+ */
+
+#ifndef SWRAST_H
+#define SWRAST_H
+
+// Threads = 0 uses one thread per online core.
+// returns 0: fail
+//         1: success
+int SwRastInit(int Width, int Height, int Threads);
+void SwRastDestroy(void);
+
+// Clears the frame to ClearColor (RGBA) and draws ObjectCount copies of the
+// triangle list Positions (2 floats per vertex) / Colors (3 floats per
+// vertex), copy i transformed by the column-major matrix Matrices[16 * i].
+// Submission order is kept: later triangles are drawn over earlier ones.
+void SwRastDraw(const float * ClearColor,
+                const float * Positions, const float * Colors, int VertexCount,
+                const float * Matrices, int ObjectCount);
+
+// Framebuffer of the last frame, RGBA8 rows from the top of the window.
+const unsigned char * SwRastPixels(int * Stride);
+
+// Average milliseconds per frame spent transforming/binning and rasterizing.
+void SwRastGetTimes(double * SetupMs, double * RasterMs);
+int SwRastThreads(void);
+
+// returns 0: fail
+//         1: success
+int SwRastWritePPM(const char * FName);
+
+#endif /* SWRAST_H */
@@ -0,0 +1,446 @@
+/*
+ * Camera frames as textures.
+ *
+ * streamSlot is the texture drawn. On the direct path streamShown is the
+ * camera buffer behind it; the buffers it replaced wait in streamRetired
+ * until the GPU is done with them.
+ */
+
+#include "texstream.h"
+#include "extensions.h"
+#include "framestats.h"
+#include "glstate.h"
+#include "shaderprogram.h"
+#include <GLES2/gl2.h>
+#include "gltrace.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define TEXSTREAM_NEON 1
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define TEXSTREAM_SSE 1
+#endif
+
+#define TEXSTREAM_MAX_BUFFERS   8
+
+// Frames drawn before a retired buffer is reused when there are no fences.
+#define TEXSTREAM_RETIRE_FRAMES 2
+
+#ifndef GL_VIV_direct_texture
+#define GL_VIV_NV12 0x8FC1
+#define GL_VIV_YUY2 0x8FC2
+#endif
+
+typedef void (GL_APIENTRY * TexDirectMapProc)(GLenum Target, GLsizei Width, GLsizei Height, GLenum Format,
+                                              GLvoid ** Logical, const GLuint * Physical);
+typedef void (GL_APIENTRY * TexDirectInvalidateProc)(GLenum Target);
+
+typedef struct _StreamSlot
+{
+    GLuint      luma;       // the mapped texture on the direct path
+    GLuint      chroma;     // upload path only
+    int         mapped;
+}
+StreamSlot;
+
+typedef struct _StreamRetired
+{
+    const CameraBuffer *    frame;
+    EGLSyncKHR              fence;
+    int                     flushed;
+    unsigned long long      draws;      // streamDraws when it was replaced
+}
+StreamRetired;
+
+// Full-viewport strip: xy position, zw texture coordinate. The first row of
+// a frame is its top, so t = 0 is the top of the screen.
+static const GLfloat streamQuad[16] =
+{
+    -1.0f, -1.0f, 0.0f, 1.0f,
+     1.0f, -1.0f, 1.0f, 1.0f,
+    -1.0f,  1.0f, 0.0f, 0.0f,
+     1.0f,  1.0f, 1.0f, 0.0f,
+};
+
+static TexDirectMapProc texDirectMap = NULL;
+static TexDirectInvalidateProc texDirectInvalidate = NULL;
+static int streamFences = 0;
+static StreamSlot streamSlots[TEXSTREAM_MAX_BUFFERS];
+static StreamRetired streamRetired[TEXSTREAM_MAX_BUFFERS];
+static int streamRetiredCount = 0;
+static int streamCount = 0;
+static int streamFormat = CAMERA_NV12;
+static int streamWidth = 0;
+static int streamHeight = 0;
+static int streamDirect = 0;
+static int streamSlot = -1;
+static const CameraBuffer * streamShown = NULL;
+static unsigned long long streamDraws = 0;
+static const char * streamFragment = NULL;
+static GLuint streamProgram = 0;
+static int streamProgramFailed = 0;
+static GLuint streamVbo = 0;
+static GLint streamLocVertex = -1;
+static unsigned char * streamScratch = NULL;
+static TexStreamStats streamStats;
+
+/***************************************************************************************
+***************************************************************************************/
+
+static GLuint streamTexture(GLenum Format, int Width, int Height, int Storage)
+{
+    GLuint texture = 0;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    if (Storage)
+    {
+        glTexImage2D(GL_TEXTURE_2D, 0, Format, Width, Height, 0, Format, GL_UNSIGNED_BYTE, NULL);
+    }
+    return texture;
+}
+
+// Gives back the retired buffers the GPU is done with; Wait gives back all.
+static void streamCollect(int Wait)
+{
+    int kept = 0;
+    for (int i = 0; i < streamRetiredCount; ++i)
+    {
+        StreamRetired * retired = &streamRetired[i];
+        int done;
+        if (retired->fence != EGL_NO_SYNC_KHR)
+        {
+            done = EglFenceWait(retired->fence, Wait, &retired->flushed);
+        }
+        else
+        {
+            done = Wait || (streamDraws - retired->draws >= TEXSTREAM_RETIRE_FRAMES);
+        }
+
+        if (!done)
+        {
+            streamRetired[kept++] = *retired;
+            continue;
+        }
+        EglFenceDestroy(retired->fence);
+        CameraSourceRelease(retired->frame);
+    }
+    streamRetiredCount = kept;
+}
+
+// Direct path: Frame's texture now shows what the camera wrote into it.
+static void streamMap(const CameraBuffer * Frame)
+{
+    StreamSlot * slot = &streamSlots[Frame->index];
+    GLenum format = (streamFormat == CAMERA_NV12) ? GL_VIV_NV12 : GL_VIV_YUY2;
+
+    glBindTexture(GL_TEXTURE_2D, slot->luma);
+    if (!slot->mapped)
+    {
+        // ~0u: no physical address, the driver maps the pages itself.
+        GLvoid * logical[2] = { Frame->planes[0], Frame->planes[1] };
+        GLuint physical = ~0u;
+        texDirectMap(GL_TEXTURE_2D, streamWidth, streamHeight, format, logical, &physical);
+        GlTraceTexDirectMap(GL_TEXTURE_2D, streamWidth, streamHeight, format);
+        slot->mapped = 1;
+    }
+    texDirectInvalidate(GL_TEXTURE_2D);
+    GlTraceTexDirectInvalidate(GL_TEXTURE_2D);
+
+    // The frame shown so far is drawn for the last time; fence that.
+    if (streamShown != NULL)
+    {
+        StreamRetired * retired = &streamRetired[streamRetiredCount++];
+        retired->frame = streamShown;
+        retired->fence = streamFences ? EglFenceCreate() : EGL_NO_SYNC_KHR;
+        retired->flushed = 0;
+        retired->draws = streamDraws;
+    }
+    streamShown = Frame;
+    streamSlot = Frame->index;
+}
+
+// Upload path: Frame goes into the next texture pair, so the upload never
+// waits for the draws still reading the previous one.
+static void streamUpload(const CameraBuffer * Frame)
+{
+    int w = streamWidth;
+    int h = streamHeight;
+    int chromaHeight = (streamFormat == CAMERA_NV12) ? h / 2 : h;
+    const unsigned char * luma = Frame->planes[0];
+    const unsigned char * chroma = Frame->planes[1];
+    unsigned char * lumaOut = streamScratch;
+    unsigned char * chromaOut = streamScratch + w * h;
+
+    if (streamFormat == CAMERA_YUYV)
+    {
+        for (int y = 0; y < h; ++y)
+        {
+            TexStreamSplitYUYV(Frame->planes[0] + y * Frame->strides[0], lumaOut + y * w, chromaOut + y * w, w);
+        }
+        luma = lumaOut;
+        chroma = chromaOut;
+    }
+    else
+    {
+        // GLES2 has no GL_UNPACK_ROW_LENGTH: padded rows are packed first.
+        if (Frame->strides[0] != w)
+        {
+            for (int y = 0; y < h; ++y)
+            {
+                memcpy(lumaOut + y * w, Frame->planes[0] + y * Frame->strides[0], w);
+            }
+            luma = lumaOut;
+        }
+        if (Frame->strides[1] != w)
+        {
+            for (int y = 0; y < chromaHeight; ++y)
+            {
+                memcpy(chromaOut + y * w, Frame->planes[1] + y * Frame->strides[1], w);
+            }
+            chroma = chromaOut;
+        }
+    }
+
+    streamSlot = (streamSlot + 1) % streamCount;
+    StreamSlot * slot = &streamSlots[streamSlot];
+    glBindTexture(GL_TEXTURE_2D, slot->luma);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, w, h, GL_LUMINANCE, GL_UNSIGNED_BYTE, luma);
+    glBindTexture(GL_TEXTURE_2D, slot->chroma);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, w / 2, chromaHeight, GL_LUMINANCE_ALPHA, GL_UNSIGNED_BYTE, chroma);
+    streamStats.bytes += (unsigned long long)w * h + (unsigned long long)w * chromaHeight;
+
+    // The driver has its copy.
+    CameraSourceRelease(Frame);
+}
+
+// returns the program, built on the first call, or 0
+static GLuint streamLoadProgram(void)
+{
+    if ((streamProgram == 0) && !streamProgramFailed)
+    {
+        streamProgram = ShaderProgramLoad("camera.vert", streamFragment, NULL, NULL);
+        if (streamProgram == 0)
+        {
+            streamProgramFailed = 1;
+            return 0;
+        }
+        streamLocVertex = glGetAttribLocation(streamProgram, "my_Vertex");
+        GlStateUseProgram(streamProgram);
+        GlStateUniform1i(glGetUniformLocation(streamProgram, "my_LumaTexture"), 0);
+        GlStateUniform1i(glGetUniformLocation(streamProgram, "my_ChromaTexture"), 1);
+    }
+    return streamProgram;
+}
+
+/***************************************************************************************
+***************************************************************************************/
+
+int TexStreamInit(EGLDisplay Display, int Format, int Width, int Height, int Buffers, int Direct)
+{
+    memset(streamSlots, 0, sizeof(streamSlots));
+    memset(&streamStats, 0, sizeof(streamStats));
+    streamFormat = Format;
+    streamWidth = Width & ~1;
+    streamHeight = Height & ~1;
+    streamCount = (Buffers < 1) ? 1 : ((Buffers > TEXSTREAM_MAX_BUFFERS) ? TEXSTREAM_MAX_BUFFERS : Buffers);
+    streamRetiredCount = 0;
+    streamSlot = -1;
+    streamShown = NULL;
+    streamDraws = 0;
+
+    // The driver takes the planes with rows of exactly the texture width,
+    // which the camera only hands out when no row needs padding.
+    int rowBytes = streamWidth * ((Format == CAMERA_YUYV) ? 2 : 1);
+    texDirectMap = NULL;
+    texDirectInvalidate = NULL;
+    if (Direct && ((rowBytes % CAMERA_ALIGN) == 0) && HasGLExtension("GL_VIV_direct_texture"))
+    {
+        texDirectMap = (TexDirectMapProc)eglGetProcAddress("glTexDirectVIVMap");
+        texDirectInvalidate = (TexDirectInvalidateProc)eglGetProcAddress("glTexDirectInvalidateVIV");
+    }
+    streamDirect = (texDirectMap != NULL) && (texDirectInvalidate != NULL);
+
+    streamFences = streamDirect && EglFenceInit(Display);
+
+    // The mapped texture samples as RGB already; uploaded planes are
+    // converted in the shader. Nothing is drawn before the first camera
+    // frame, so the program is only taken then.
+    streamFragment = streamDirect ? "camera_rgb.frag" : "camera_yuv.frag";
+    streamProgram = 0;
+    streamProgramFailed = 0;
+    ShaderProgramPrepare("camera.vert", streamFragment, NULL);
+
+    glGenBuffers(1, &streamVbo);
+    GlStateBindBuffer(GL_ARRAY_BUFFER, streamVbo);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(streamQuad), streamQuad, GL_STATIC_DRAW);
+
+    if (!streamDirect)
+    {
+        // Planes and split YUYV, both at most two bytes per pixel.
+        streamScratch = (unsigned char *)malloc((size_t)streamWidth * streamHeight * 2);
+        if (streamScratch == NULL)
+        {
+            fprintf(stderr, "Out of memory.\n");
+            TexStreamDestroy();
+            return 0;
+        }
+        // Luminance rows of an even width need not be a multiple of 4.
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    }
+
+    int chromaHeight = (Format == CAMERA_NV12) ? streamHeight / 2 : streamHeight;
+    for (int i = 0; i < streamCount; ++i)
+    {
+        StreamSlot * slot = &streamSlots[i];
+        slot->luma = streamTexture(GL_LUMINANCE, streamWidth, streamHeight, !streamDirect);
+        if (!streamDirect)
+        {
+            slot->chroma = streamTexture(GL_LUMINANCE_ALPHA, streamWidth / 2, chromaHeight, 1);
+        }
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    streamStats.direct = streamDirect;
+    return 1;
+}
+
+void TexStreamDestroy(void)
+{
+    TexStreamFinish();
+    for (int i = 0; i < streamCount; ++i)
+    {
+        StreamSlot * slot = &streamSlots[i];
+        if (slot->luma != 0)
+        {
+            glDeleteTextures(1, &slot->luma);
+        }
+        if (slot->chroma != 0)
+        {
+            glDeleteTextures(1, &slot->chroma);
+        }
+    }
+    memset(streamSlots, 0, sizeof(streamSlots));
+    streamCount = 0;
+    streamSlot = -1;
+
+    if (streamVbo != 0)
+    {
+        GlStateDeleteBuffers(1, &streamVbo);
+        streamVbo = 0;
+    }
+    if (streamProgram != 0)
+    {
+        GlStateDeleteProgram(streamProgram);
+        streamProgram = 0;
+    }
+    free(streamScratch);
+    streamScratch = NULL;
+}
+
+void TexStreamUpdate(const CameraBuffer * Frame)
+{
+    streamCollect(0);
+
+    unsigned long long start = FrameStatsNs();
+    if (streamDirect)
+    {
+        streamMap(Frame);
+        streamStats.mapMs += (FrameStatsNs() - start) / 1e6;
+    }
+    else
+    {
+        streamUpload(Frame);
+        streamStats.uploadMs += (FrameStatsNs() - start) / 1e6;
+    }
+    ++streamStats.frames;
+}
+
+void TexStreamDraw(void)
+{
+    if ((streamSlot < 0) || (streamLoadProgram() == 0))
+    {
+        return;
+    }
+
+    const StreamSlot * slot = &streamSlots[streamSlot];
+    GlStateUseProgram(streamProgram);
+    if (!streamDirect)
+    {
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D, slot->chroma);
+        glActiveTexture(GL_TEXTURE0);
+    }
+    glBindTexture(GL_TEXTURE_2D, slot->luma);
+
+    GlStateBindBuffer(GL_ARRAY_BUFFER, streamVbo);
+    GlStateEnableAttrib(streamLocVertex);
+    GlStateAttribPointer(streamLocVertex, 4, GL_FLOAT, GL_FALSE, 0, 0);
+    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    GlStateDisableAttrib(streamLocVertex);
+    ++streamDraws;
+
+    streamCollect(0);
+}
+
+void TexStreamFinish(void)
+{
+    streamCollect(1);
+    if (streamShown != NULL)
+    {
+        CameraSourceRelease(streamShown);
+        streamShown = NULL;
+    }
+}
+
+void TexStreamGetStats(TexStreamStats * Stats)
+{
+    *Stats = streamStats;
+}
+
+/***************************************************************************************
+***************************************************************************************/
+
+void TexStreamSplitYUYVScalar(const unsigned char * Src, unsigned char * Luma, unsigned char * Chroma, int Pixels)
+{
+    for (int i = 0; i < Pixels; i += 2)
+    {
+        Luma[i + 0]   = Src[i * 2 + 0];
+        Chroma[i + 0] = Src[i * 2 + 1];
+        Luma[i + 1]   = Src[i * 2 + 2];
+        Chroma[i + 1] = Src[i * 2 + 3];
+    }
+}
+
+// 16 pixels per step: even bytes are luma, odd bytes U and V in turn.
+void TexStreamSplitYUYV(const unsigned char * Src, unsigned char * Luma, unsigned char * Chroma, int Pixels)
+{
+    int i = 0;
+#if defined(TEXSTREAM_NEON)
+    for (; i + 16 <= Pixels; i += 16)
+    {
+        uint8x16x2_t pixels = vld2q_u8(Src + i * 2);
+        vst1q_u8(Luma + i, pixels.val[0]);
+        vst1q_u8(Chroma + i, pixels.val[1]);
+    }
+#elif defined(TEXSTREAM_SSE)
+    const __m128i mask = _mm_set1_epi16(0x00FF);
+    for (; i + 16 <= Pixels; i += 16)
+    {
+        __m128i low = _mm_loadu_si128((const __m128i *)(Src + i * 2));
+        __m128i high = _mm_loadu_si128((const __m128i *)(Src + i * 2 + 16));
+        _mm_storeu_si128((__m128i *)(Luma + i),
+                         _mm_packus_epi16(_mm_and_si128(low, mask), _mm_and_si128(high, mask)));
+        _mm_storeu_si128((__m128i *)(Chroma + i),
+                         _mm_packus_epi16(_mm_srli_epi16(low, 8), _mm_srli_epi16(high, 8)));
+    }
+#endif
+    TexStreamSplitYUYVScalar(Src + i * 2, Luma + i, Chroma + i, Pixels - i);
+}
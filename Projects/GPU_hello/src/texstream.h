@@ -0,0 +1,60 @@
+/*
+ * Camera frames as textures.
+ *
+ * Each camera buffer gets its own texture. With GL_VIV_direct_texture the
+ * buffer memory is mapped as an NV12 or YUY2 texture once and only
+ * invalidated when a new frame arrives: no CPU copy, the sampler converts
+ * to RGB. Otherwise the planes are uploaded into a luma and a chroma
+ * texture (YUYV is split into the two with NEON/SSE2 first) and
+ * camera_yuv.frag converts.
+ *
+ * A buffer returns to the camera once the GPU is done with it: the frame
+ * it replaces is fenced (EGL_KHR_fence_sync) after its last draw and
+ * released when the fence signals, or two frames later without fences.
+ * Copied buffers are released right after the upload.
+ */
+
+#ifndef TEXSTREAM_H
+#define TEXSTREAM_H
+
+#include "camerasource.h"
+#include <EGL/egl.h>
+
+typedef struct _TexStreamStats
+{
+    unsigned long long  frames;     // frames taken from the camera
+    unsigned long long  bytes;      // copied by the CPU upload path
+    double              uploadMs;   // repacking and glTexSubImage2D()
+    double              mapMs;      // invalidating mapped textures
+    int                 direct;     // zero-copy mapping is used
+}
+TexStreamStats;
+
+// Buffers is the camera's ring size. Direct == 0 forces the upload path.
+// Needs the current context on Display. The program is prepared on the
+// shader worker and taken at the first draw.
+// returns 0: fail
+//         1: success
+int TexStreamInit(EGLDisplay Display, int Format, int Width, int Height, int Buffers, int Direct);
+void TexStreamDestroy(void);
+
+// Shows Frame from now on; the frame shown before goes back to the camera
+// once the GPU no longer reads it.
+void TexStreamUpdate(const CameraBuffer * Frame);
+
+// Draws the current frame over the viewport with its own program, vertex
+// buffer and vertex array, which it disables again. The caller's arrays
+// must be disabled around it, and its program and buffers rebound after.
+// Nothing is drawn before the first update, or without the program.
+void TexStreamDraw(void);
+
+// Releases every frame, waiting for the GPU.
+void TexStreamFinish(void);
+
+void TexStreamGetStats(TexStreamStats * Stats);
+
+// YUYV row to a luma row and an interleaved UV row, Pixels even.
+void TexStreamSplitYUYV(const unsigned char * Src, unsigned char * Luma, unsigned char * Chroma, int Pixels);
+void TexStreamSplitYUYVScalar(const unsigned char * Src, unsigned char * Luma, unsigned char * Chroma, int Pixels);
+
+#endif /* TEXSTREAM_H */
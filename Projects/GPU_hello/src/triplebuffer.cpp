@@ -0,0 +1,45 @@
+/*
+ * Lock-free triple buffer.
+ */
+
+#include "triplebuffer.h"
+#include <stddef.h>
+
+void TripleBufferInit(TripleBuffer * Buffer, void * Slot0, void * Slot1, void * Slot2)
+{
+    Buffer->slots[0] = Slot0;
+    Buffer->slots[1] = Slot1;
+    Buffer->slots[2] = Slot2;
+    Buffer->front  = 0;
+    Buffer->middle = 1;
+    Buffer->back   = 2;
+}
+
+void * TripleBufferBack(TripleBuffer * Buffer)
+{
+    return Buffer->slots[Buffer->back];
+}
+
+void TripleBufferPublish(TripleBuffer * Buffer)
+{
+    // Release: the slot contents before the index; acquire: the slot we
+    // get back is no longer read by the consumer.
+    unsigned int old = __atomic_exchange_n(&Buffer->middle, Buffer->back | TRIPLE_BUFFER_FRESH, __ATOMIC_ACQ_REL);
+    Buffer->back = old & 3;
+}
+
+void * TripleBufferLatest(TripleBuffer * Buffer, int * Fresh)
+{
+    int fresh = (__atomic_load_n(&Buffer->middle, __ATOMIC_RELAXED) & TRIPLE_BUFFER_FRESH) != 0;
+    if (fresh)
+    {
+        unsigned int old = __atomic_exchange_n(&Buffer->middle, (unsigned int)Buffer->front, __ATOMIC_ACQ_REL);
+        Buffer->front = old & 3;
+    }
+
+    if (Fresh != NULL)
+    {
+        *Fresh = fresh;
+    }
+    return Buffer->slots[Buffer->front];
+}
@@ -0,0 +1,35 @@
+/*
+ * Lock-free triple buffer.
+ *
+ * One producer and one consumer share three caller-owned slots: the
+ * producer fills the back slot, the consumer reads the front slot and the
+ * middle slot holds the latest published one. Publishing and taking the
+ * latest slot are single atomic exchanges of the middle index, so neither
+ * side ever waits for the other or sees a slot that is being written.
+ */
+
+#ifndef TRIPLEBUFFER_H
+#define TRIPLEBUFFER_H
+
+typedef struct _TripleBuffer
+{
+    void *          slots[3];
+    int             back;       // producer only
+    int             front;      // consumer only
+    unsigned int    middle;     // slot index, TRIPLE_BUFFER_FRESH if unread
+}
+TripleBuffer;
+
+#define TRIPLE_BUFFER_FRESH 4u
+
+void TripleBufferInit(TripleBuffer * Buffer, void * Slot0, void * Slot1, void * Slot2);
+
+// Producer: the slot to fill next, then publish it as the latest.
+void * TripleBufferBack(TripleBuffer * Buffer);
+void TripleBufferPublish(TripleBuffer * Buffer);
+
+// Consumer: the latest published slot. *Fresh is 0 if nothing was
+// published since the last call, in which case the same slot comes back.
+void * TripleBufferLatest(TripleBuffer * Buffer, int * Fresh);
+
+#endif /* TRIPLEBUFFER_H */
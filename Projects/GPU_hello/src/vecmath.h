@@ -0,0 +1,539 @@
+/*
+ * Small 4x4 matrix / 4-vector math, header only.
+ *
+ * Matrices are column-major, as glUniformMatrix4fv takes them, and 16-byte
+ * aligned. The kernels use NEON or SSE2 when the compiler targets them and
+ * plain C otherwise; the *Scalar functions are straightforward references
+ * kept for testing and benchmarking the vector paths.
+ *
+ * Batched functions work on four objects per step with one object per
+ * vector lane (structure of arrays), so there are no horizontal operations:
+ * a 4x4 transpose turns four matrices into sixteen element vectors and back.
+ */
+
+#ifndef VECMATH_H
+#define VECMATH_H
+
+#include <math.h>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define VECMATH_NEON 1
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define VECMATH_SSE 1
+#endif
+
+#define VECMATH_ALIGNED __attribute__((aligned(16)))
+
+typedef struct _Vec4
+{
+    float v[4];
+}
+VECMATH_ALIGNED Vec4;
+
+typedef struct _Mat4
+{
+    float m[16];    // m[column * 4 + row]
+}
+VECMATH_ALIGNED Mat4;
+
+// Aggregate initializers, so constant matrices are built at compile time:
+//     static const Mat4 offset = MAT4_TRANSLATION(0.5f, 0.0f, 0.0f);
+#define MAT4_IDENTITY                   { { 1, 0, 0, 0,  0, 1, 0, 0,  0, 0, 1, 0,  0, 0, 0, 1 } }
+#define MAT4_TRANSLATION(X, Y, Z)       { { 1, 0, 0, 0,  0, 1, 0, 0,  0, 0, 1, 0,  X, Y, Z, 1 } }
+#define MAT4_SCALE(X, Y, Z)             { { X, 0, 0, 0,  0, Y, 0, 0,  0, 0, Z, 0,  0, 0, 0, 1 } }
+
+/***************************************************************************************
+***************************************************************************************/
+
+// Four-wide float helpers: NEON, SSE2 or plain C. Loads and stores need
+// no alignment. vmSignMask() has bit i set when lane i is negative.
+
+#if VECMATH_NEON
+
+typedef float32x4_t VmFloat4;
+
+static inline VmFloat4 vmLoad(const float * P)          { return vld1q_f32(P); }
+static inline void vmStore(float * P, VmFloat4 V)       { vst1q_f32(P, V); }
+static inline VmFloat4 vmSplat(float V)                 { return vdupq_n_f32(V); }
+static inline VmFloat4 vmAdd(VmFloat4 A, VmFloat4 B)    { return vaddq_f32(A, B); }
+static inline VmFloat4 vmSub(VmFloat4 A, VmFloat4 B)    { return vsubq_f32(A, B); }
+static inline VmFloat4 vmMul(VmFloat4 A, VmFloat4 B)    { return vmulq_f32(A, B); }
+static inline VmFloat4 vmMadd(VmFloat4 A, VmFloat4 B, VmFloat4 C) { return vmlaq_f32(C, A, B); }
+static inline VmFloat4 vmMin(VmFloat4 A, VmFloat4 B)    { return vminq_f32(A, B); }
+static inline VmFloat4 vmMax(VmFloat4 A, VmFloat4 B)    { return vmaxq_f32(A, B); }
+static inline int vmSignMask(VmFloat4 V)
+{
+    static const int32_t shifts[4] = { 0, 1, 2, 3 };
+    uint32x4_t bits = vshlq_u32(vshrq_n_u32(vreinterpretq_u32_f32(V), 31), vld1q_s32(shifts));
+    uint32x2_t sum = vpadd_u32(vget_low_u32(bits), vget_high_u32(bits));
+    return (int)vget_lane_u32(vpadd_u32(sum, sum), 0);
+}
+static inline VmFloat4 vmRcp(VmFloat4 A)
+{
+#if defined(__aarch64__)
+    return vdivq_f32(vdupq_n_f32(1.0f), A);
+#else
+    // Estimate plus two Newton-Raphson steps, ~23 bits.
+    VmFloat4 r = vrecpeq_f32(A);
+    r = vmulq_f32(vrecpsq_f32(A, r), r);
+    return vmulq_f32(vrecpsq_f32(A, r), r);
+#endif
+}
+static inline void vmTranspose(VmFloat4 * R)
+{
+    float32x4x2_t t01 = vtrnq_f32(R[0], R[1]);
+    float32x4x2_t t23 = vtrnq_f32(R[2], R[3]);
+    R[0] = vcombine_f32(vget_low_f32(t01.val[0]),  vget_low_f32(t23.val[0]));
+    R[1] = vcombine_f32(vget_low_f32(t01.val[1]),  vget_low_f32(t23.val[1]));
+    R[2] = vcombine_f32(vget_high_f32(t01.val[0]), vget_high_f32(t23.val[0]));
+    R[3] = vcombine_f32(vget_high_f32(t01.val[1]), vget_high_f32(t23.val[1]));
+}
+
+#elif VECMATH_SSE
+
+typedef __m128 VmFloat4;
+
+static inline VmFloat4 vmLoad(const float * P)          { return _mm_loadu_ps(P); }
+static inline void vmStore(float * P, VmFloat4 V)       { _mm_storeu_ps(P, V); }
+static inline VmFloat4 vmSplat(float V)                 { return _mm_set1_ps(V); }
+static inline VmFloat4 vmAdd(VmFloat4 A, VmFloat4 B)    { return _mm_add_ps(A, B); }
+static inline VmFloat4 vmSub(VmFloat4 A, VmFloat4 B)    { return _mm_sub_ps(A, B); }
+static inline VmFloat4 vmMul(VmFloat4 A, VmFloat4 B)    { return _mm_mul_ps(A, B); }
+static inline VmFloat4 vmMadd(VmFloat4 A, VmFloat4 B, VmFloat4 C) { return _mm_add_ps(_mm_mul_ps(A, B), C); }
+static inline VmFloat4 vmMin(VmFloat4 A, VmFloat4 B)    { return _mm_min_ps(A, B); }
+static inline VmFloat4 vmMax(VmFloat4 A, VmFloat4 B)    { return _mm_max_ps(A, B); }
+static inline int vmSignMask(VmFloat4 V)                { return _mm_movemask_ps(V); }
+static inline VmFloat4 vmRcp(VmFloat4 A)                { return _mm_div_ps(_mm_set1_ps(1.0f), A); }
+static inline void vmTranspose(VmFloat4 * R)
+{
+    _MM_TRANSPOSE4_PS(R[0], R[1], R[2], R[3]);
+}
+
+#else
+
+typedef struct { float v[4]; } VmFloat4;
+
+static inline VmFloat4 vmLoad(const float * P)          { VmFloat4 r = { { P[0], P[1], P[2], P[3] } }; return r; }
+static inline void vmStore(float * P, VmFloat4 V)       { for (int i = 0; i < 4; ++i) P[i] = V.v[i]; }
+static inline VmFloat4 vmSplat(float V)                 { VmFloat4 r = { { V, V, V, V } }; return r; }
+static inline VmFloat4 vmAdd(VmFloat4 A, VmFloat4 B)    { for (int i = 0; i < 4; ++i) A.v[i] += B.v[i]; return A; }
+static inline VmFloat4 vmSub(VmFloat4 A, VmFloat4 B)    { for (int i = 0; i < 4; ++i) A.v[i] -= B.v[i]; return A; }
+static inline VmFloat4 vmMul(VmFloat4 A, VmFloat4 B)    { for (int i = 0; i < 4; ++i) A.v[i] *= B.v[i]; return A; }
+static inline VmFloat4 vmMadd(VmFloat4 A, VmFloat4 B, VmFloat4 C) { for (int i = 0; i < 4; ++i) C.v[i] += A.v[i] * B.v[i]; return C; }
+static inline VmFloat4 vmMin(VmFloat4 A, VmFloat4 B)    { for (int i = 0; i < 4; ++i) A.v[i] = (A.v[i] < B.v[i]) ? A.v[i] : B.v[i]; return A; }
+static inline VmFloat4 vmMax(VmFloat4 A, VmFloat4 B)    { for (int i = 0; i < 4; ++i) A.v[i] = (A.v[i] > B.v[i]) ? A.v[i] : B.v[i]; return A; }
+static inline int vmSignMask(VmFloat4 V)                { int m = 0; for (int i = 0; i < 4; ++i) m |= signbit(V.v[i]) ? (1 << i) : 0; return m; }
+static inline VmFloat4 vmRcp(VmFloat4 A)                { for (int i = 0; i < 4; ++i) A.v[i] = 1.0f / A.v[i]; return A; }
+static inline void vmTranspose(VmFloat4 * R)
+{
+    for (int i = 0; i < 4; ++i)
+    {
+        for (int j = i + 1; j < 4; ++j)
+        {
+            float t = R[i].v[j];
+            R[i].v[j] = R[j].v[i];
+            R[j].v[i] = t;
+        }
+    }
+}
+
+#endif
+
+// Round to nearest for |V| < 2^22: adding 1.5 * 2^23 pushes the fraction
+// out of the mantissa.
+static inline VmFloat4 vmRound(VmFloat4 V)
+{
+#if VECMATH_NEON || VECMATH_SSE
+    VmFloat4 magic = vmSplat(12582912.0f);
+    return vmSub(vmAdd(V, magic), magic);
+#else
+    // x87 excess precision would defeat the trick.
+    for (int i = 0; i < 4; ++i) V.v[i] = floorf(V.v[i] + 0.5f);
+    return V;
+#endif
+}
+
+/***************************************************************************************
+***************************************************************************************/
+
+// sin(X) for X in [-pi/2, pi/2]: Taylor series to x^11, error < 6e-8.
+static inline VmFloat4 vmSinKernel(VmFloat4 X)
+{
+    VmFloat4 x2 = vmMul(X, X);
+    VmFloat4 p = vmSplat(-2.5052108e-8f);
+    p = vmMadd(p, x2, vmSplat( 2.7557319e-6f));
+    p = vmMadd(p, x2, vmSplat(-1.9841270e-4f));
+    p = vmMadd(p, x2, vmSplat( 8.3333333e-3f));
+    p = vmMadd(p, x2, vmSplat(-1.6666667e-1f));
+    p = vmMadd(p, x2, vmSplat(1.0f));
+    return vmMul(p, X);
+}
+
+// sin(X + Quarters * pi/2) for |X| < 4096 * 2pi; accuracy drops slowly
+// beyond. The shift is applied after the reduction, so cos (one quarter)
+// is as accurate as sin for large X.
+static inline VmFloat4 vmSinShifted(VmFloat4 X, float Quarters)
+{
+    // Reduce to [-pi, pi], then mirror [pi/2, pi] and [-pi, -pi/2] onto
+    // [-pi/2, pi/2]. 2pi is split in three parts (Cody-Waite) whose leading
+    // parts have few mantissa bits, so k * part stays exact.
+    VmFloat4 k = vmRound(vmAdd(vmMul(X, vmSplat(0.15915494f)), vmSplat(Quarters * 0.25f)));
+    VmFloat4 y = vmSub(X, vmMul(k, vmSplat(6.28125f)));
+    y = vmSub(y, vmMul(k, vmSplat(1.9354820e-3f)));
+    y = vmSub(y, vmMul(k, vmSplat(-1.7484555e-7f)));
+    y = vmAdd(y, vmSplat(Quarters * 1.57079633f));
+
+    VmFloat4 pi = vmSplat(3.14159265f);
+    y = vmMax(vmMin(y, vmSub(pi, y)), vmSub(vmSub(vmSplat(0.0f), pi), y));
+    return vmSinKernel(y);
+}
+
+static inline VmFloat4 vmSin(VmFloat4 X)
+{
+    return vmSinShifted(X, 0.0f);
+}
+
+static inline void vmSinCos(VmFloat4 X, VmFloat4 * Sin, VmFloat4 * Cos)
+{
+    *Sin = vmSinShifted(X, 0.0f);
+    *Cos = vmSinShifted(X, 1.0f);
+}
+
+// Fast float sine and cosine, ~1e-7 absolute error.
+static inline void FastSinCos(float X, float * Sin, float * Cos)
+{
+    float s[4], c[4];
+    VmFloat4 vs, vc;
+    vmSinCos(vmSplat(X), &vs, &vc);
+    vmStore(s, vs);
+    vmStore(c, vc);
+    *Sin = s[0];
+    *Cos = c[0];
+}
+
+// Four angles at once, e.g. one per object; the arrays hold 4 floats.
+static inline void FastSinCos4(const float * X, float * Sin, float * Cos)
+{
+    VmFloat4 s, c;
+    vmSinCos(vmLoad(X), &s, &c);
+    vmStore(Sin, s);
+    vmStore(Cos, c);
+}
+
+/***************************************************************************************
+***************************************************************************************/
+
+// Loads four matrices as sixteen element vectors: E[column * 4 + row]
+// holds that element of M0..M3 in lanes 0..3.
+static inline void vmLoadSoA(const float * M0, const float * M1, const float * M2, const float * M3,
+                             VmFloat4 * E)
+{
+    for (int c = 0; c < 4; ++c)
+    {
+        VmFloat4 * t = &E[c * 4];
+        t[0] = vmLoad(M0 + c * 4);
+        t[1] = vmLoad(M1 + c * 4);
+        t[2] = vmLoad(M2 + c * 4);
+        t[3] = vmLoad(M3 + c * 4);
+        vmTranspose(t);
+    }
+}
+
+// Stores sixteen element vectors back as Count (1..4) matrices, 16 floats
+// apart starting at Out.
+static inline void Mat4StoreSoA(const VmFloat4 * E, float * Out, int Count)
+{
+    for (int c = 0; c < 4; ++c)
+    {
+        VmFloat4 t[4] = { E[c * 4 + 0], E[c * 4 + 1], E[c * 4 + 2], E[c * 4 + 3] };
+        vmTranspose(t);
+        for (int i = 0; i < Count; ++i)
+        {
+            vmStore(Out + i * 16 + c * 4, t[i]);
+        }
+    }
+}
+
+// Out = A * B. Out may be A or B.
+static inline void Mat4Multiply(Mat4 * Out, const Mat4 * A, const Mat4 * B)
+{
+    VmFloat4 a0 = vmLoad(&A->m[0]);
+    VmFloat4 a1 = vmLoad(&A->m[4]);
+    VmFloat4 a2 = vmLoad(&A->m[8]);
+    VmFloat4 a3 = vmLoad(&A->m[12]);
+
+    for (int c = 0; c < 4; ++c)
+    {
+        const float * b = &B->m[c * 4];
+        VmFloat4 r = vmMul(a0, vmSplat(b[0]));
+        r = vmMadd(a1, vmSplat(b[1]), r);
+        r = vmMadd(a2, vmSplat(b[2]), r);
+        r = vmMadd(a3, vmSplat(b[3]), r);
+        vmStore(&Out->m[c * 4], r);
+    }
+}
+
+// Out[i] = A * B[i] for Count matrices.
+static inline void Mat4MultiplyBatch(Mat4 * Out, const Mat4 * A, const Mat4 * B, int Count)
+{
+    VmFloat4 a0 = vmLoad(&A->m[0]);
+    VmFloat4 a1 = vmLoad(&A->m[4]);
+    VmFloat4 a2 = vmLoad(&A->m[8]);
+    VmFloat4 a3 = vmLoad(&A->m[12]);
+
+    for (int i = 0; i < Count; ++i)
+    {
+        for (int c = 0; c < 4; ++c)
+        {
+            const float * b = &B[i].m[c * 4];
+            VmFloat4 r = vmMul(a0, vmSplat(b[0]));
+            r = vmMadd(a1, vmSplat(b[1]), r);
+            r = vmMadd(a2, vmSplat(b[2]), r);
+            r = vmMadd(a3, vmSplat(b[3]), r);
+            vmStore(&Out[i].m[c * 4], r);
+        }
+    }
+}
+
+static inline void Mat4Transpose(Mat4 * Out, const Mat4 * A)
+{
+    VmFloat4 t[4] = { vmLoad(&A->m[0]), vmLoad(&A->m[4]), vmLoad(&A->m[8]), vmLoad(&A->m[12]) };
+    vmTranspose(t);
+    for (int c = 0; c < 4; ++c)
+    {
+        vmStore(&Out->m[c * 4], t[c]);
+    }
+}
+
+// Out = M * V.
+static inline void Mat4MulVec4(Vec4 * Out, const Mat4 * M, const Vec4 * V)
+{
+    VmFloat4 r = vmMul(vmLoad(&M->m[0]), vmSplat(V->v[0]));
+    r = vmMadd(vmLoad(&M->m[4]),  vmSplat(V->v[1]), r);
+    r = vmMadd(vmLoad(&M->m[8]),  vmSplat(V->v[2]), r);
+    r = vmMadd(vmLoad(&M->m[12]), vmSplat(V->v[3]), r);
+    vmStore(Out->v, r);
+}
+
+// Inverse of four matrices, one per lane, by cofactor expansion over 2x2
+// sub-determinants. E and Inv are element vectors as from vmLoadSoA. The
+// formula is symmetric under transposition, so the storage order does not
+// matter.
+static inline void vmInverseSoA(const VmFloat4 * E, VmFloat4 * Inv, VmFloat4 * Det)
+{
+#define A(r, c) E[(r) * 4 + (c)]
+    VmFloat4 s0 = vmSub(vmMul(A(0, 0), A(1, 1)), vmMul(A(1, 0), A(0, 1)));
+    VmFloat4 s1 = vmSub(vmMul(A(0, 0), A(1, 2)), vmMul(A(1, 0), A(0, 2)));
+    VmFloat4 s2 = vmSub(vmMul(A(0, 0), A(1, 3)), vmMul(A(1, 0), A(0, 3)));
+    VmFloat4 s3 = vmSub(vmMul(A(0, 1), A(1, 2)), vmMul(A(1, 1), A(0, 2)));
+    VmFloat4 s4 = vmSub(vmMul(A(0, 1), A(1, 3)), vmMul(A(1, 1), A(0, 3)));
+    VmFloat4 s5 = vmSub(vmMul(A(0, 2), A(1, 3)), vmMul(A(1, 2), A(0, 3)));
+    VmFloat4 c5 = vmSub(vmMul(A(2, 2), A(3, 3)), vmMul(A(3, 2), A(2, 3)));
+    VmFloat4 c4 = vmSub(vmMul(A(2, 1), A(3, 3)), vmMul(A(3, 1), A(2, 3)));
+    VmFloat4 c3 = vmSub(vmMul(A(2, 1), A(3, 2)), vmMul(A(3, 1), A(2, 2)));
+    VmFloat4 c2 = vmSub(vmMul(A(2, 0), A(3, 3)), vmMul(A(3, 0), A(2, 3)));
+    VmFloat4 c1 = vmSub(vmMul(A(2, 0), A(3, 2)), vmMul(A(3, 0), A(2, 2)));
+    VmFloat4 c0 = vmSub(vmMul(A(2, 0), A(3, 1)), vmMul(A(3, 0), A(2, 1)));
+
+    VmFloat4 det = vmMul(s0, c5);
+    det = vmSub(det, vmMul(s1, c4));
+    det = vmMadd(s2, c3, det);
+    det = vmMadd(s3, c2, det);
+    det = vmSub(det, vmMul(s4, c1));
+    det = vmMadd(s5, c0, det);
+    *Det = det;
+
+    VmFloat4 rcp = vmRcp(det);
+    VmFloat4 neg = vmSub(vmSplat(0.0f), rcp);
+
+// X * a - Y * b + Z * c, scaled by S
+#define COF(X, a, Y, b, Z, c, S) vmMul(vmMadd(Z, c, vmSub(vmMul(X, a), vmMul(Y, b))), S)
+    Inv[ 0] = COF(A(1, 1), c5, A(1, 2), c4, A(1, 3), c3, rcp);
+    Inv[ 1] = COF(A(0, 1), c5, A(0, 2), c4, A(0, 3), c3, neg);
+    Inv[ 2] = COF(A(3, 1), s5, A(3, 2), s4, A(3, 3), s3, rcp);
+    Inv[ 3] = COF(A(2, 1), s5, A(2, 2), s4, A(2, 3), s3, neg);
+    Inv[ 4] = COF(A(1, 0), c5, A(1, 2), c2, A(1, 3), c1, neg);
+    Inv[ 5] = COF(A(0, 0), c5, A(0, 2), c2, A(0, 3), c1, rcp);
+    Inv[ 6] = COF(A(3, 0), s5, A(3, 2), s2, A(3, 3), s1, neg);
+    Inv[ 7] = COF(A(2, 0), s5, A(2, 2), s2, A(2, 3), s1, rcp);
+    Inv[ 8] = COF(A(1, 0), c4, A(1, 1), c2, A(1, 3), c0, rcp);
+    Inv[ 9] = COF(A(0, 0), c4, A(0, 1), c2, A(0, 3), c0, neg);
+    Inv[10] = COF(A(3, 0), s4, A(3, 1), s2, A(3, 3), s0, rcp);
+    Inv[11] = COF(A(2, 0), s4, A(2, 1), s2, A(2, 3), s0, neg);
+    Inv[12] = COF(A(1, 0), c3, A(1, 1), c1, A(1, 2), c0, neg);
+    Inv[13] = COF(A(0, 0), c3, A(0, 1), c1, A(0, 2), c0, rcp);
+    Inv[14] = COF(A(3, 0), s3, A(3, 1), s1, A(3, 2), s0, neg);
+    Inv[15] = COF(A(2, 0), s3, A(2, 1), s1, A(2, 2), s0, rcp);
+#undef COF
+#undef A
+}
+
+// Out[i] = inverse of In[i]. Singular matrices give non-finite elements.
+static inline void Mat4InverseBatch(Mat4 * Out, const Mat4 * In, int Count)
+{
+    VmFloat4 e[16], inv[16], det;
+    for (int i = 0; i < Count; i += 4)
+    {
+        int n = (Count - i < 4) ? Count - i : 4;
+        // Repeat the last matrix to fill a short group.
+        const float * m1 = In[i + ((n > 1) ? 1 : 0)].m;
+        const float * m2 = In[i + ((n > 2) ? 2 : 0)].m;
+        const float * m3 = In[i + ((n > 3) ? 3 : 0)].m;
+        vmLoadSoA(In[i].m, m1, m2, m3, e);
+        vmInverseSoA(e, inv, &det);
+        Mat4StoreSoA(inv, Out[i].m, n);
+    }
+}
+
+// returns 0: singular, Out unchanged
+//         1: success
+static inline int Mat4Inverse(Mat4 * Out, const Mat4 * In)
+{
+    VmFloat4 e[16], inv[16], det;
+    float d[4];
+    vmLoadSoA(In->m, In->m, In->m, In->m, e);
+    vmInverseSoA(e, inv, &det);
+    vmStore(d, det);
+    if (d[0] == 0.0f)
+    {
+        return 0;
+    }
+    Mat4StoreSoA(inv, Out->m, 1);
+    return 1;
+}
+
+// Transforms Count points given as separate X, Y, Z, W arrays by M.
+static inline void Vec4TransformSoA(const Mat4 * M,
+                                    const float * X, const float * Y, const float * Z, const float * W,
+                                    float * OutX, float * OutY, float * OutZ, float * OutW, int Count)
+{
+    const float * m = M->m;
+    int i = 0;
+
+    for (; i + 4 <= Count; i += 4)
+    {
+        VmFloat4 x = vmLoad(X + i), y = vmLoad(Y + i), z = vmLoad(Z + i), w = vmLoad(W + i);
+        float * out[4] = { OutX + i, OutY + i, OutZ + i, OutW + i };
+        for (int r = 0; r < 4; ++r)
+        {
+            VmFloat4 v = vmMul(x, vmSplat(m[r]));
+            v = vmMadd(y, vmSplat(m[4 + r]), v);
+            v = vmMadd(z, vmSplat(m[8 + r]), v);
+            v = vmMadd(w, vmSplat(m[12 + r]), v);
+            vmStore(out[r], v);
+        }
+    }
+
+    for (; i < Count; ++i)
+    {
+        float x = X[i], y = Y[i], z = Z[i], w = W[i];
+        OutX[i] = m[0] * x + m[4] * y + m[8]  * z + m[12] * w;
+        OutY[i] = m[1] * x + m[5] * y + m[9]  * z + m[13] * w;
+        OutZ[i] = m[2] * x + m[6] * y + m[10] * z + m[14] * w;
+        OutW[i] = m[3] * x + m[7] * y + m[11] * z + m[15] * w;
+    }
+}
+
+/***************************************************************************************
+***************************************************************************************/
+
+// Scalar references.
+
+static inline void Mat4MultiplyScalar(Mat4 * Out, const Mat4 * A, const Mat4 * B)
+{
+    Mat4 r;
+    for (int c = 0; c < 4; ++c)
+    {
+        for (int row = 0; row < 4; ++row)
+        {
+            float sum = 0.0f;
+            for (int k = 0; k < 4; ++k)
+            {
+                sum += A->m[k * 4 + row] * B->m[c * 4 + k];
+            }
+            r.m[c * 4 + row] = sum;
+        }
+    }
+    *Out = r;
+}
+
+static inline void Mat4TransposeScalar(Mat4 * Out, const Mat4 * A)
+{
+    Mat4 r;
+    for (int c = 0; c < 4; ++c)
+    {
+        for (int row = 0; row < 4; ++row)
+        {
+            r.m[row * 4 + c] = A->m[c * 4 + row];
+        }
+    }
+    *Out = r;
+}
+
+// Gauss-Jordan elimination with partial pivoting.
+// returns 0: singular, Out unchanged
+//         1: success
+static inline int Mat4InverseScalar(Mat4 * Out, const Mat4 * In)
+{
+    float a[4][8];
+    for (int r = 0; r < 4; ++r)
+    {
+        for (int c = 0; c < 4; ++c)
+        {
+            a[r][c] = In->m[c * 4 + r];
+            a[r][c + 4] = (r == c) ? 1.0f : 0.0f;
+        }
+    }
+
+    for (int c = 0; c < 4; ++c)
+    {
+        int pivot = c;
+        for (int r = c + 1; r < 4; ++r)
+        {
+            if (fabsf(a[r][c]) > fabsf(a[pivot][c]))
+            {
+                pivot = r;
+            }
+        }
+        if (a[pivot][c] == 0.0f)
+        {
+            return 0;
+        }
+        for (int k = 0; k < 8; ++k)
+        {
+            float t = a[c][k];
+            a[c][k] = a[pivot][k];
+            a[pivot][k] = t;
+        }
+
+        float scale = 1.0f / a[c][c];
+        for (int k = 0; k < 8; ++k)
+        {
+            a[c][k] *= scale;
+        }
+        for (int r = 0; r < 4; ++r)
+        {
+            if (r != c)
+            {
+                float f = a[r][c];
+                for (int k = 0; k < 8; ++k)
+                {
+                    a[r][k] -= f * a[c][k];
+                }
+            }
+        }
+    }
+
+    for (int r = 0; r < 4; ++r)
+    {
+        for (int c = 0; c < 4; ++c)
+        {
+            Out->m[c * 4 + r] = a[r][c + 4];
+        }
+    }
+    return 1;
+}
+
+#endif /* VECMATH_H */
@@ -0,0 +1,324 @@
+/*
+ * Static geometry in GL buffer objects.
+ */
+
+#include "vertexbuffer.h"
+#include "extensions.h"
+#include "glstate.h"
+#include <GLES2/gl2ext.h>
+#include "gltrace.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+
+// Interleaved vertex layouts, colors last so they share the same offset rule.
+typedef struct _VertexFloat
+{
+    GLfloat position[2];
+    GLubyte color[4];
+}
+VertexFloat;
+
+typedef struct _VertexCompact
+{
+    GLushort position[2];   // half float or normalized short bits
+    GLubyte  color[4];
+}
+VertexCompact;
+
+static const char * formatNames[VERTEX_FORMAT_COUNT] =
+{
+    "client",
+    "float",
+    "half",
+    "short",
+};
+
+/***************************************************************************************
+***************************************************************************************/
+
+// IEEE half float with round-to-nearest; NaN is not preserved.
+static GLushort floatToHalf(float Value)
+{
+    union
+    {
+        float        f;
+        unsigned int u;
+    }
+    bits;
+    bits.f = Value;
+
+    unsigned int sign = (bits.u >> 16) & 0x8000;
+    int exponent = (int)((bits.u >> 23) & 0xFF) - 127 + 15;
+    unsigned int mantissa = bits.u & 0x7FFFFF;
+
+    if (exponent <= 0)
+    {
+        // Subnormal half, or zero.
+        if (exponent < -10)
+        {
+            return (GLushort)sign;
+        }
+        mantissa |= 0x800000;
+        int shift = 14 - exponent;
+        unsigned int half = mantissa >> shift;
+        if ((mantissa >> (shift - 1)) & 1)
+        {
+            ++half;
+        }
+        return (GLushort)(sign | half);
+    }
+
+    if (exponent >= 31)
+    {
+        return (GLushort)(sign | 0x7C00);
+    }
+
+    // A carry out of the mantissa correctly bumps the exponent.
+    unsigned int half = sign | (exponent << 10) | (mantissa >> 13);
+    if (mantissa & 0x1000)
+    {
+        ++half;
+    }
+    return (GLushort)half;
+}
+
+static GLushort floatToShort(float Value)
+{
+    float scaled = Value * 32767.0f;
+    return (GLushort)(GLshort)((scaled < 0.0f) ? scaled - 0.5f : scaled + 0.5f);
+}
+
+static GLubyte floatToByte(float Value)
+{
+    Value = (Value < 0.0f) ? 0.0f : ((Value > 1.0f) ? 1.0f : Value);
+    return (GLubyte)(Value * 255.0f + 0.5f);
+}
+
+/***************************************************************************************
+***************************************************************************************/
+
+int VertexBufferCreate(VertexBuffer * Buffer, int Format,
+                       const GLfloat * Positions, const GLfloat * Colors, int VertexCount,
+                       const GLushort * Indices, int IndexCount)
+{
+    memset(Buffer, 0, sizeof(*Buffer));
+    Buffer->vertexCount  = VertexCount;
+    Buffer->indexCount   = (Indices != NULL) ? IndexCount : 0;
+    Buffer->indexType    = GL_UNSIGNED_SHORT;
+    Buffer->positionSize = 2;
+
+    if ((Format == VERTEX_FORMAT_HALF) && !HasGLExtension("GL_OES_vertex_half_float"))
+    {
+        fprintf(stderr, "GL_OES_vertex_half_float not supported, using float positions.\n");
+        Format = VERTEX_FORMAT_FLOAT;
+    }
+
+    if (Format == VERTEX_FORMAT_SHORT)
+    {
+        // Normalized shorts only cover [-1, 1].
+        for (int i = 0; i < VertexCount * 2; ++i)
+        {
+            if ((Positions[i] < -1.0f) || (Positions[i] > 1.0f))
+            {
+                fprintf(stderr, "Positions exceed [-1, 1], using float positions.\n");
+                Format = VERTEX_FORMAT_FLOAT;
+                break;
+            }
+        }
+    }
+
+    if ((Format <= VERTEX_FORMAT_CLIENT) || (Format >= VERTEX_FORMAT_COUNT))
+    {
+        Buffer->format             = VERTEX_FORMAT_CLIENT;
+        Buffer->stride             = 0;
+        Buffer->positionType       = GL_FLOAT;
+        Buffer->positionNormalized = GL_FALSE;
+        Buffer->positionPointer    = Positions;
+        Buffer->colorPointer       = Colors;
+        Buffer->colorSize          = 3;
+        Buffer->colorType          = GL_FLOAT;
+        Buffer->colorNormalized    = GL_FALSE;
+        Buffer->clientIndices      = Indices;
+        return 1;
+    }
+
+    Buffer->format          = Format;
+    Buffer->colorSize       = 4;
+    Buffer->colorType       = GL_UNSIGNED_BYTE;
+    Buffer->colorNormalized = GL_TRUE;
+
+    // Build the interleaved copy on the heap, upload once, drop it.
+    size_t size;
+    void * data;
+
+    if (Format == VERTEX_FORMAT_FLOAT)
+    {
+        size = sizeof(VertexFloat) * VertexCount;
+        VertexFloat * vertices = (VertexFloat*)malloc(size);
+        if (vertices == NULL)
+        {
+            fprintf(stderr, "Out of memory.\n");
+            return 0;
+        }
+
+        for (int i = 0; i < VertexCount; ++i)
+        {
+            vertices[i].position[0] = Positions[i * 2 + 0];
+            vertices[i].position[1] = Positions[i * 2 + 1];
+            for (int c = 0; c < 3; ++c)
+            {
+                vertices[i].color[c] = floatToByte(Colors[i * 3 + c]);
+            }
+            vertices[i].color[3] = 255;
+        }
+
+        data = vertices;
+        Buffer->stride             = sizeof(VertexFloat);
+        Buffer->positionType       = GL_FLOAT;
+        Buffer->positionNormalized = GL_FALSE;
+        Buffer->colorPointer       = (const GLvoid *)offsetof(VertexFloat, color);
+    }
+    else
+    {
+        size = sizeof(VertexCompact) * VertexCount;
+        VertexCompact * vertices = (VertexCompact*)malloc(size);
+        if (vertices == NULL)
+        {
+            fprintf(stderr, "Out of memory.\n");
+            return 0;
+        }
+
+        for (int i = 0; i < VertexCount; ++i)
+        {
+            for (int k = 0; k < 2; ++k)
+            {
+                float p = Positions[i * 2 + k];
+                vertices[i].position[k] = (Format == VERTEX_FORMAT_HALF) ? floatToHalf(p) : floatToShort(p);
+            }
+            for (int c = 0; c < 3; ++c)
+            {
+                vertices[i].color[c] = floatToByte(Colors[i * 3 + c]);
+            }
+            vertices[i].color[3] = 255;
+        }
+
+        data = vertices;
+        Buffer->stride             = sizeof(VertexCompact);
+        Buffer->positionType       = (Format == VERTEX_FORMAT_HALF) ? GL_HALF_FLOAT_OES : GL_SHORT;
+        Buffer->positionNormalized = (Format == VERTEX_FORMAT_SHORT) ? GL_TRUE : GL_FALSE;
+        Buffer->colorPointer       = (const GLvoid *)offsetof(VertexCompact, color);
+    }
+    Buffer->positionPointer = (const GLvoid *)0;
+
+    glGenBuffers(1, &Buffer->vbo);
+    GlStateBindBuffer(GL_ARRAY_BUFFER, Buffer->vbo);
+    glBufferData(GL_ARRAY_BUFFER, size, data, GL_STATIC_DRAW);
+    free(data);
+
+    if (Buffer->indexCount > 0)
+    {
+        glGenBuffers(1, &Buffer->ibo);
+        GlStateBindBuffer(GL_ELEMENT_ARRAY_BUFFER, Buffer->ibo);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof (GLushort) * Buffer->indexCount, Indices, GL_STATIC_DRAW);
+    }
+
+    return 1;
+}
+
+int VertexBufferCreateFromMesh(VertexBuffer * Buffer, const MeshFile * Mesh)
+{
+    const MeshHeader * header = Mesh->header;
+    memset(Buffer, 0, sizeof(*Buffer));
+
+    int index32 = (header->flags & MESH_INDEX32) != 0;
+    if (index32 && !HasGLExtension("GL_OES_element_index_uint"))
+    {
+        fprintf(stderr, "Mesh of %u vertices needs GL_OES_element_index_uint.\n", header->vertexCount);
+        return 0;
+    }
+
+    int quantized = (header->flags & MESH_QUANTIZED) != 0;
+    Buffer->format             = quantized ? VERTEX_FORMAT_SHORT : VERTEX_FORMAT_FLOAT;
+    Buffer->vertexCount        = header->vertexCount;
+    Buffer->indexCount         = header->indexCount;
+    Buffer->indexType          = index32 ? GL_UNSIGNED_INT : GL_UNSIGNED_SHORT;
+    Buffer->stride             = header->vertexStride;
+    Buffer->positionSize       = 3;
+    Buffer->positionType       = quantized ? GL_SHORT : GL_FLOAT;
+    Buffer->positionNormalized = quantized ? GL_TRUE : GL_FALSE;
+    Buffer->positionPointer    = (const GLvoid *)0;
+    Buffer->colorPointer       = (const GLvoid *)(quantized ? offsetof(MeshVertexShort, color)
+                                                            : offsetof(MeshVertexFloat, color));
+    Buffer->colorSize          = 4;
+    Buffer->colorType          = GL_UNSIGNED_BYTE;
+    Buffer->colorNormalized    = GL_TRUE;
+
+    // Straight from the mapped file.
+    glGenBuffers(1, &Buffer->vbo);
+    GlStateBindBuffer(GL_ARRAY_BUFFER, Buffer->vbo);
+    glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)header->vertexCount * header->vertexStride, Mesh->vertices, GL_STATIC_DRAW);
+
+    glGenBuffers(1, &Buffer->ibo);
+    GlStateBindBuffer(GL_ELEMENT_ARRAY_BUFFER, Buffer->ibo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, (GLsizeiptr)header->indexCount * (index32 ? 4 : 2), Mesh->indices, GL_STATIC_DRAW);
+    return 1;
+}
+
+void VertexBufferDestroy(VertexBuffer * Buffer)
+{
+    if (Buffer->vbo != 0)
+    {
+        GlStateDeleteBuffers(1, &Buffer->vbo);
+    }
+    if (Buffer->ibo != 0)
+    {
+        GlStateDeleteBuffers(1, &Buffer->ibo);
+    }
+    memset(Buffer, 0, sizeof(*Buffer));
+}
+
+void VertexBufferBind(const VertexBuffer * Buffer, GLint LocPosition, GLint LocColor)
+{
+    GlStateBindBuffer(GL_ARRAY_BUFFER, Buffer->vbo);
+    GlStateBindBuffer(GL_ELEMENT_ARRAY_BUFFER, Buffer->ibo);
+
+    GlStateAttribPointer(LocPosition, Buffer->positionSize, Buffer->positionType, Buffer->positionNormalized,
+                         Buffer->stride, Buffer->positionPointer);
+    GlStateAttribPointer(LocColor, Buffer->colorSize, Buffer->colorType, Buffer->colorNormalized,
+                         Buffer->stride, Buffer->colorPointer);
+}
+
+void VertexBufferDraw(const VertexBuffer * Buffer)
+{
+    if (Buffer->indexCount > 0)
+    {
+        glDrawElements(GL_TRIANGLES, Buffer->indexCount, Buffer->indexType,
+                       (Buffer->ibo != 0) ? (const GLvoid *)0 : Buffer->clientIndices);
+    }
+    else
+    {
+        glDrawArrays(GL_TRIANGLES, 0, Buffer->vertexCount);
+    }
+}
+
+unsigned int VertexBufferClientBytesPerDraw(const VertexBuffer * Buffer)
+{
+    if (Buffer->format != VERTEX_FORMAT_CLIENT)
+    {
+        return 0;
+    }
+
+    unsigned int bytes = Buffer->vertexCount * (2 + Buffer->colorSize) * sizeof (GLfloat);
+    if (Buffer->indexCount > 0)
+    {
+        bytes += Buffer->indexCount * sizeof (GLushort);
+    }
+    return bytes;
+}
+
+const char * VertexFormatName(int Format)
+{
+    return ((Format >= 0) && (Format < VERTEX_FORMAT_COUNT)) ? formatNames[Format] : "unknown";
+}
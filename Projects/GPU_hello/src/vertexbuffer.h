@@ -0,0 +1,77 @@
+/*
+ * Static geometry in GL buffer objects.
+ *
+ * Positions and colors are uploaded once into one interleaved vertex buffer
+ * (plus an optional 16-bit index buffer), so the driver no longer copies
+ * client-side arrays on every draw. Colors are normalized unsigned bytes;
+ * positions are floats, half floats (GL_OES_vertex_half_float) or
+ * normalized shorts. Meshes from a mesh file (meshfile.h) are uploaded
+ * as they are stored.
+ */
+
+#ifndef VERTEXBUFFER_H
+#define VERTEXBUFFER_H
+
+#include "meshfile.h"
+#include <GLES2/gl2.h>
+
+enum
+{
+    VERTEX_FORMAT_CLIENT,   // client-side float arrays, no buffer objects
+    VERTEX_FORMAT_FLOAT,    // float xy + ubyte rgba, 12 bytes per vertex
+    VERTEX_FORMAT_HALF,     // half float xy + ubyte rgba, 8 bytes per vertex
+    VERTEX_FORMAT_SHORT,    // normalized short xy + ubyte rgba, 8 bytes per vertex
+    VERTEX_FORMAT_COUNT
+};
+
+typedef struct _VertexBuffer
+{
+    int             format;
+    GLuint          vbo;
+    GLuint          ibo;
+    GLsizei         stride;
+    GLint           positionSize;       // 2, or 3 for mesh files
+    GLenum          positionType;
+    GLboolean       positionNormalized;
+    const GLvoid *  positionPointer;    // buffer offset, or client array
+    const GLvoid *  colorPointer;
+    GLint           colorSize;
+    GLenum          colorType;
+    GLboolean       colorNormalized;
+    GLsizei         vertexCount;
+    GLsizei         indexCount;
+    GLenum          indexType;
+    const GLushort * clientIndices;
+}
+VertexBuffer;
+
+// Positions are 2 floats and Colors 3 floats per vertex; Indices may be NULL.
+// Formats the context cannot take fall back to VERTEX_FORMAT_FLOAT.
+// With VERTEX_FORMAT_CLIENT the arrays are referenced, not copied.
+// returns 0: fail
+//         1: success
+int VertexBufferCreate(VertexBuffer * Buffer, int Format,
+                       const GLfloat * Positions, const GLfloat * Colors, int VertexCount,
+                       const GLushort * Indices, int IndexCount);
+
+// Uploads the blocks of an open mesh file; the file may be closed after.
+// Its format is VERTEX_FORMAT_FLOAT, or VERTEX_FORMAT_SHORT for quantized
+// positions.
+// returns 0: fail
+//         1: success
+int VertexBufferCreateFromMesh(VertexBuffer * Buffer, const MeshFile * Mesh);
+
+void VertexBufferDestroy(VertexBuffer * Buffer);
+
+// Binds the buffers and points the two attributes into them.
+void VertexBufferBind(const VertexBuffer * Buffer, GLint LocPosition, GLint LocColor);
+
+// Draws the whole buffer as GL_TRIANGLES; the buffer must be bound.
+void VertexBufferDraw(const VertexBuffer * Buffer);
+
+// Bytes the driver copies from client memory for one draw.
+unsigned int VertexBufferClientBytesPerDraw(const VertexBuffer * Buffer);
+
+const char * VertexFormatName(int Format);
+
+#endif /* VERTEXBUFFER_H */
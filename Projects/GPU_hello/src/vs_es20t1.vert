@@ -1,11 +1,56 @@
+// Shared by every variant of the triangle program (see shadervariant.h);
+// the variant's feature defines come first. A plain load has none of them
+// and is the vertex colour program.
+#ifndef SHADER_VARIANT
+#define VERTEX_COLOR 1
+#endif
+
 attribute vec4 my_Vertex;
-attribute vec4 my_Color;
 uniform   mat4 my_TransformMatrix;
 
+#ifdef VERTEX_COLOR
+attribute vec4 my_Color;
+#else
+uniform   vec4 my_Color;
+#endif
+
+#ifdef TEXTURED
+attribute vec2 my_TexCoord;
+varying   vec2 texCoord;
+#endif
+
+#ifdef FOG
+uniform   vec2 my_FogRange;		// start, 1 / (end - start) in clip w
+varying   float fog;
+#endif
+
+#ifdef SKINNING
+attribute float my_Index;		// the bone, rigid skinning
+uniform   mat4 my_Palette[SKINNING];
+#endif
+
+#ifdef DEQUANTIZE
+uniform   vec4 my_Dequantize[2];	// scale, offset
+#endif
+
 varying vec4 color;
 
 void main()
 {
+	vec4 position = my_Vertex;
+#ifdef DEQUANTIZE
+	position = vec4(position.xyz * my_Dequantize[0].xyz + my_Dequantize[1].xyz, 1.0);
+#endif
+#ifdef SKINNING
+	position = my_Palette[int(my_Index)] * position;
+#endif
+
 	color = my_Color;
-	gl_Position = my_TransformMatrix * my_Vertex;
+#ifdef TEXTURED
+	texCoord = my_TexCoord;
+#endif
+	gl_Position = my_TransformMatrix * position;
+#ifdef FOG
+	fog = clamp((gl_Position.w - my_FogRange.x) * my_FogRange.y, 0.0, 1.0);
+#endif
 }
@@ -0,0 +1,67 @@
+##############################################################################
+#
+# Freescale Confidential Proprietary
+#
+# Copyright (c) 2016 Freescale Semiconductor;
+# All Rights Reserved
+#
+##############################################################################
+#
+# THIS SOFTWARE IS PROVIDED BY FREESCALE "AS IS" AND ANY EXPRESSED OR
+# IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+# OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+# IN NO EVENT SHALL FREESCALE OR ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+# INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+# (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+# SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+# HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+# STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+# IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+# THE POSSIBILITY OF SUCH DAMAGE.
+#
+##############################################################################
+
+SDK_ROOT := $(call path_relative_to,$(CURDIR),$(CURR_SDK_ROOT))
+
+
+##############################################################################
+# ARM_APP
+#
+# Offline tool: no GL, runs wherever the meshes are built. The file format
+# is shared with gpu_hello.
+##############################################################################
+
+ARM_APP = gpu_meshconv
+
+ARM_APP_SRCS =                                                               \
+    meshconv.cpp                                                             \
+    ../../GPU_hello/src/meshfile.cpp                                         \
+
+ARM_INCS =                                                                   \
+    -I.                                                                      \
+    -I../../GPU_hello/src                                                    \
+
+ARM_LDOPTS +=                                                                \
+    -lm
+
+ARM_DEFS += -DLINUX
+
+
+##############################################################################
+# X86_APP
+##############################################################################
+
+X86_APP = gpu_meshconv
+
+X86_APP_SRCS =                                                               \
+    meshconv.cpp                                                             \
+    ../../GPU_hello/src/meshfile.cpp                                         \
+
+X86_INCS =                                                                   \
+    -I.                                                                      \
+    -I../../GPU_hello/src                                                    \
+
+X86_LDOPTS +=                                                                \
+    -lm
+
+X86_DEFS += -DLINUX
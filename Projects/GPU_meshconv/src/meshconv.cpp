@@ -0,0 +1,767 @@
+/*
+ * Mesh converter.
+ *
+ * Turns a Wavefront OBJ file (positions, optional vertex colors, polygon
+ * faces), or a generated test grid, into the binary mesh files gpu_hello
+ * maps with -M (meshfile.h). On the way:
+ *
+ *  - The triangles are reordered for the post-transform vertex cache with
+ *    Forsyth's linear-speed algorithm: greedily emit the triangle whose
+ *    vertices score best, a score favouring vertices recently used (in a
+ *    modelled LRU cache) and vertices with few triangles left.
+ *  - The vertices are renumbered in the order the indices first use them,
+ *    so vertex fetches walk the buffer forwards. Unused vertices go.
+ *  - Positions are quantized to normalized shorts over the bounding box
+ *    (-f keeps floats), colors to RGBA8.
+ *
+ * The average cache miss ratio (vertex shader runs per triangle) of a FIFO
+ * cache is printed before and after, for 16 and 32 entries.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include "meshfile.h"
+
+#define CONV_NAME           "gpu_meshconv"
+#define CONV_LINE           4096
+#define CONV_MAX_POLYGON    64
+
+// Forsyth's scoring, as in his article.
+#define CACHE_SIZE          32
+#define CACHE_DECAY_POWER   1.5f
+#define LAST_TRI_SCORE      0.75f
+#define VALENCE_BOOST_SCALE 2.0f
+#define VALENCE_BOOST_POWER 0.5f
+#define MAX_VALENCE         64      // score table size, larger valences share the last entry
+
+typedef struct _ConvMesh
+{
+    float *             positions;  // 3 per vertex
+    unsigned char *     colors;     // RGBA, 4 per vertex
+    unsigned int *      indices;
+    unsigned int        vertexCount;
+    unsigned int        indexCount;
+    unsigned int        vertexCapacity;
+    unsigned int        indexCapacity;
+}
+ConvMesh;
+
+const char * inputFName = NULL;
+const char * outputFName = NULL;
+int gridSize = 0;
+int keepFloats = 0;
+
+float cacheScores[CACHE_SIZE];
+float valenceScores[MAX_VALENCE + 1];
+
+/***************************************************************************************
+***************************************************************************************/
+
+static unsigned long long convNs(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (unsigned long long)now.tv_sec * 1000000000ull + now.tv_nsec;
+}
+
+// returns 0: out of memory
+//         1: success
+static int addVertex(ConvMesh * Mesh, const float * Position, const unsigned char * Color)
+{
+    if (Mesh->vertexCount == Mesh->vertexCapacity)
+    {
+        unsigned int capacity = (Mesh->vertexCapacity == 0) ? 1024 : Mesh->vertexCapacity * 2;
+        float * positions = (float *)realloc(Mesh->positions, capacity * 3 * sizeof(float));
+        unsigned char * colors = (unsigned char *)realloc(Mesh->colors, capacity * 4);
+        if (positions != NULL)
+        {
+            Mesh->positions = positions;
+        }
+        if (colors != NULL)
+        {
+            Mesh->colors = colors;
+        }
+        if ((positions == NULL) || (colors == NULL))
+        {
+            return 0;
+        }
+        Mesh->vertexCapacity = capacity;
+    }
+    memcpy(&Mesh->positions[Mesh->vertexCount * 3], Position, 3 * sizeof(float));
+    memcpy(&Mesh->colors[Mesh->vertexCount * 4], Color, 4);
+    ++Mesh->vertexCount;
+    return 1;
+}
+
+// returns 0: out of memory
+//         1: success
+static int addTriangle(ConvMesh * Mesh, unsigned int A, unsigned int B, unsigned int C)
+{
+    if (Mesh->indexCount + 3 > Mesh->indexCapacity)
+    {
+        unsigned int capacity = (Mesh->indexCapacity == 0) ? 3072 : Mesh->indexCapacity * 2;
+        unsigned int * indices = (unsigned int *)realloc(Mesh->indices, capacity * sizeof(unsigned int));
+        if (indices == NULL)
+        {
+            return 0;
+        }
+        Mesh->indices = indices;
+        Mesh->indexCapacity = capacity;
+    }
+    Mesh->indices[Mesh->indexCount++] = A;
+    Mesh->indices[Mesh->indexCount++] = B;
+    Mesh->indices[Mesh->indexCount++] = C;
+    return 1;
+}
+
+static void freeMesh(ConvMesh * Mesh)
+{
+    free(Mesh->positions);
+    free(Mesh->colors);
+    free(Mesh->indices);
+    memset(Mesh, 0, sizeof(*Mesh));
+}
+
+/***************************************************************************************
+***************************************************************************************/
+
+// Only v and f lines are read; faces are triangulated as fans. Vertices
+// without colors are colored later, from their position.
+// returns 0: fail
+//         1: success
+static int loadObj(const char * Path, ConvMesh * Mesh, int * HasColors)
+{
+    FILE * file = fopen(Path, "r");
+    if (file == NULL)
+    {
+        fprintf(stderr, "Cannot open %s.\n", Path);
+        return 0;
+    }
+
+    char line[CONV_LINE];
+    int lineNumber = 0;
+    int colored = 0;
+    int ok = 1;
+    while (ok && (fgets(line, sizeof(line), file) != NULL))
+    {
+        ++lineNumber;
+        if ((line[0] == 'v') && (line[1] == ' '))
+        {
+            float position[3];
+            float rgb[3];
+            int fields = sscanf(&line[2], "%f %f %f %f %f %f", &position[0], &position[1], &position[2],
+                                &rgb[0], &rgb[1], &rgb[2]);
+            if (fields < 3)
+            {
+                fprintf(stderr, "%s:%d: bad vertex.\n", Path, lineNumber);
+                ok = 0;
+                break;
+            }
+            unsigned char color[4] = { 0, 0, 0, 255 };
+            if (fields == 6)
+            {
+                for (int i = 0; i < 3; ++i)
+                {
+                    float c = (rgb[i] < 0.0f) ? 0.0f : ((rgb[i] > 1.0f) ? 1.0f : rgb[i]);
+                    color[i] = (unsigned char)(c * 255.0f + 0.5f);
+                }
+                colored = 1;
+            }
+            ok = addVertex(Mesh, position, color);
+        }
+        else if ((line[0] == 'f') && (line[1] == ' '))
+        {
+            // v, v/vt, v//vn or v/vt/vn; negative indices count back from
+            // the last vertex.
+            unsigned int polygon[CONV_MAX_POLYGON];
+            int corners = 0;
+            for (char * token = strtok(&line[2], " \t\r\n"); token != NULL; token = strtok(NULL, " \t\r\n"))
+            {
+                long index = strtol(token, NULL, 10);
+                index = (index < 0) ? (long)Mesh->vertexCount + index : index - 1;
+                if ((index < 0) || (index >= (long)Mesh->vertexCount) || (corners == CONV_MAX_POLYGON))
+                {
+                    fprintf(stderr, "%s:%d: bad face.\n", Path, lineNumber);
+                    ok = 0;
+                    break;
+                }
+                polygon[corners++] = (unsigned int)index;
+            }
+            for (int i = 2; ok && (i < corners); ++i)
+            {
+                ok = addTriangle(Mesh, polygon[0], polygon[i - 1], polygon[i]);
+            }
+        }
+    }
+    fclose(file);
+
+    if (ok && (Mesh->indexCount == 0))
+    {
+        fprintf(stderr, "%s has no faces.\n", Path);
+        ok = 0;
+    }
+    *HasColors = colored;
+    return ok;
+}
+
+// Size x Size vertices over [-1, 1] with a wave in z, the vertices and the
+// triangles in random order: the worst case for both caches.
+// returns 0: fail
+//         1: success
+static int makeGrid(int Size, ConvMesh * Mesh)
+{
+    if ((Size < 2) || (Size > 4096))
+    {
+        fprintf(stderr, "Grid size must be 2 .. 4096.\n");
+        return 0;
+    }
+
+    unsigned int count = (unsigned int)(Size * Size);
+    unsigned int * order = (unsigned int *)malloc(count * sizeof(unsigned int));
+    if (order == NULL)
+    {
+        return 0;
+    }
+
+    // Fixed seed, so the same grid is made each time.
+    srand(1);
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        order[i] = i;
+    }
+    for (unsigned int i = count - 1; i > 0; --i)
+    {
+        unsigned int j = (unsigned int)rand() % (i + 1);
+        unsigned int t = order[i];
+        order[i] = order[j];
+        order[j] = t;
+    }
+
+    // order[] maps grid points to vertex numbers.
+    int ok = 1;
+    unsigned char color[4] = { 0, 0, 0, 255 };
+    for (unsigned int i = 0; ok && (i < count); ++i)
+    {
+        float position[3] = { 0.0f, 0.0f, 0.0f };
+        ok = addVertex(Mesh, position, color);
+    }
+    for (unsigned int point = 0; ok && (point < count); ++point)
+    {
+        float * position = &Mesh->positions[order[point] * 3];
+        position[0] = (float)(point % Size) / (Size - 1) * 2.0f - 1.0f;
+        position[1] = (float)(point / Size) / (Size - 1) * 2.0f - 1.0f;
+        position[2] = 0.1f * sinf(position[0] * 6.0f) * cosf(position[1] * 6.0f);
+    }
+
+    for (int row = 0; ok && (row < Size - 1); ++row)
+    {
+        for (int column = 0; ok && (column < Size - 1); ++column)
+        {
+            unsigned int a = order[row * Size + column];
+            unsigned int b = order[row * Size + column + 1];
+            unsigned int c = order[(row + 1) * Size + column];
+            unsigned int d = order[(row + 1) * Size + column + 1];
+            ok = addTriangle(Mesh, a, b, c) && addTriangle(Mesh, c, b, d);
+        }
+    }
+    free(order);
+
+    unsigned int triangles = Mesh->indexCount / 3;
+    for (unsigned int i = triangles - 1; ok && (i > 0); --i)
+    {
+        unsigned int j = (unsigned int)rand() % (i + 1);
+        unsigned int t[3];
+        memcpy(t, &Mesh->indices[i * 3], sizeof(t));
+        memcpy(&Mesh->indices[i * 3], &Mesh->indices[j * 3], sizeof(t));
+        memcpy(&Mesh->indices[j * 3], t, sizeof(t));
+    }
+    return ok;
+}
+
+/***************************************************************************************
+***************************************************************************************/
+
+// Vertex shader runs per triangle with a FIFO post-transform cache of
+// CacheSize entries: a vertex is in the cache if fewer than CacheSize
+// misses happened since it was last loaded.
+static float cacheMissRatio(const ConvMesh * Mesh, int CacheSize)
+{
+    unsigned int * loaded = (unsigned int *)malloc(Mesh->vertexCount * sizeof(unsigned int));
+    if (loaded == NULL)
+    {
+        return 0.0f;
+    }
+    memset(loaded, 0xFF, Mesh->vertexCount * sizeof(unsigned int));
+
+    unsigned int misses = 0;
+    for (unsigned int i = 0; i < Mesh->indexCount; ++i)
+    {
+        unsigned int v = Mesh->indices[i];
+        if ((loaded[v] == 0xFFFFFFFF) || (misses - loaded[v] >= (unsigned int)CacheSize))
+        {
+            loaded[v] = misses++;
+        }
+    }
+    free(loaded);
+    return (float)misses / (Mesh->indexCount / 3);
+}
+
+static void initScores(void)
+{
+    for (int i = 0; i < CACHE_SIZE; ++i)
+    {
+        // The last triangle's vertices get a fixed score, so the next one
+        // does not simply reuse its newest edge.
+        cacheScores[i] = (i < 3) ? LAST_TRI_SCORE
+                                 : powf(1.0f - (float)(i - 3) / (CACHE_SIZE - 3), CACHE_DECAY_POWER);
+    }
+    valenceScores[0] = 0.0f;
+    for (int i = 1; i <= MAX_VALENCE; ++i)
+    {
+        valenceScores[i] = VALENCE_BOOST_SCALE * powf((float)i, -VALENCE_BOOST_POWER);
+    }
+}
+
+static float vertexScore(int CachePosition, unsigned int Valence)
+{
+    if (Valence == 0)
+    {
+        return -1.0f;   // nothing left to draw with it
+    }
+    float score = (CachePosition >= 0) ? cacheScores[CachePosition] : 0.0f;
+    return score + valenceScores[(Valence > MAX_VALENCE) ? MAX_VALENCE : Valence];
+}
+
+// Reorders Mesh->indices in place.
+// returns 0: out of memory
+//         1: success
+static int optimizeTriangles(ConvMesh * Mesh)
+{
+    unsigned int vertexCount = Mesh->vertexCount;
+    unsigned int triangleCount = Mesh->indexCount / 3;
+
+    // Per vertex: its triangles not drawn yet, first the count, then the
+    // lists in one array; drawn triangles are swapped out of the list.
+    unsigned int * valence = (unsigned int *)calloc(vertexCount, sizeof(unsigned int));
+    unsigned int * firstTriangle = (unsigned int *)malloc((vertexCount + 1) * sizeof(unsigned int));
+    unsigned int * vertexTriangles = (unsigned int *)malloc(Mesh->indexCount * sizeof(unsigned int));
+    int * cachePosition = (int *)malloc(vertexCount * sizeof(int));
+    float * score = (float *)malloc(vertexCount * sizeof(float));
+    float * triangleScore = (float *)malloc(triangleCount * sizeof(float));
+    unsigned char * drawn = (unsigned char *)calloc(triangleCount, 1);
+    unsigned int * output = (unsigned int *)malloc(Mesh->indexCount * sizeof(unsigned int));
+    int ok = (valence != NULL) && (firstTriangle != NULL) && (vertexTriangles != NULL) && (cachePosition != NULL) &&
+             (score != NULL) && (triangleScore != NULL) && (drawn != NULL) && (output != NULL);
+
+    if (ok)
+    {
+        for (unsigned int i = 0; i < Mesh->indexCount; ++i)
+        {
+            ++valence[Mesh->indices[i]];
+        }
+        firstTriangle[0] = 0;
+        for (unsigned int v = 0; v < vertexCount; ++v)
+        {
+            firstTriangle[v + 1] = firstTriangle[v] + valence[v];
+            valence[v] = 0;
+        }
+        for (unsigned int i = 0; i < Mesh->indexCount; ++i)
+        {
+            unsigned int v = Mesh->indices[i];
+            vertexTriangles[firstTriangle[v] + valence[v]++] = i / 3;
+        }
+        for (unsigned int v = 0; v < vertexCount; ++v)
+        {
+            cachePosition[v] = -1;
+            score[v] = vertexScore(-1, valence[v]);
+        }
+        for (unsigned int t = 0; t < triangleCount; ++t)
+        {
+            const unsigned int * corner = &Mesh->indices[t * 3];
+            triangleScore[t] = score[corner[0]] + score[corner[1]] + score[corner[2]];
+        }
+    }
+
+    // The modelled LRU cache, with room for a triangle pushed on a full one.
+    unsigned int cache[CACHE_SIZE + 3];
+    int cacheUsed = 0;
+    unsigned int scan = 0;          // no triangle before it is left to draw
+    for (unsigned int emitted = 0; ok && (emitted < triangleCount); ++emitted)
+    {
+        // The best triangle using a cached vertex; only when the cache has
+        // nothing left (a new piece of the mesh) are all triangles looked at,
+        // taking the first not drawn.
+        int best = -1;
+        float bestScore = -1.0f;
+        for (int c = 0; c < cacheUsed; ++c)
+        {
+            unsigned int v = cache[c];
+            for (unsigned int k = firstTriangle[v]; k < firstTriangle[v] + valence[v]; ++k)
+            {
+                unsigned int t = vertexTriangles[k];
+                if (triangleScore[t] > bestScore)
+                {
+                    best = (int)t;
+                    bestScore = triangleScore[t];
+                }
+            }
+        }
+        if (best < 0)
+        {
+            while (drawn[scan])
+            {
+                ++scan;
+            }
+            best = (int)scan;
+        }
+
+        const unsigned int * corner = &Mesh->indices[best * 3];
+        memcpy(&output[emitted * 3], corner, 3 * sizeof(unsigned int));
+        drawn[best] = 1;
+
+        // Out of its vertices' lists.
+        for (int i = 0; i < 3; ++i)
+        {
+            unsigned int v = corner[i];
+            unsigned int * list = &vertexTriangles[firstTriangle[v]];
+            for (unsigned int k = 0; k < valence[v]; ++k)
+            {
+                if (list[k] == (unsigned int)best)
+                {
+                    list[k] = list[--valence[v]];
+                    break;
+                }
+            }
+        }
+
+        // Its vertices to the front of the cache, the rest moved back.
+        unsigned int next[CACHE_SIZE + 3];
+        int nextUsed = 0;
+        for (int i = 0; i < 3; ++i)
+        {
+            next[nextUsed++] = corner[i];
+        }
+        for (int c = 0; c < cacheUsed; ++c)
+        {
+            unsigned int v = cache[c];
+            if ((v != corner[0]) && (v != corner[1]) && (v != corner[2]))
+            {
+                next[nextUsed++] = v;
+            }
+        }
+
+        // New scores for every vertex that moved, in or out, then for their
+        // triangles. Evicted vertices are only in next[] past CACHE_SIZE.
+        for (int c = 0; c < nextUsed; ++c)
+        {
+            unsigned int v = next[c];
+            cachePosition[v] = (c < CACHE_SIZE) ? c : -1;
+            score[v] = vertexScore(cachePosition[v], valence[v]);
+        }
+        for (int c = 0; c < nextUsed; ++c)
+        {
+            unsigned int v = next[c];
+            for (unsigned int k = firstTriangle[v]; k < firstTriangle[v] + valence[v]; ++k)
+            {
+                unsigned int t = vertexTriangles[k];
+                const unsigned int * other = &Mesh->indices[t * 3];
+                triangleScore[t] = score[other[0]] + score[other[1]] + score[other[2]];
+            }
+        }
+
+        cacheUsed = (nextUsed > CACHE_SIZE) ? CACHE_SIZE : nextUsed;
+        memcpy(cache, next, cacheUsed * sizeof(unsigned int));
+    }
+
+    if (ok)
+    {
+        memcpy(Mesh->indices, output, Mesh->indexCount * sizeof(unsigned int));
+    }
+    free(valence);
+    free(firstTriangle);
+    free(vertexTriangles);
+    free(cachePosition);
+    free(score);
+    free(triangleScore);
+    free(drawn);
+    free(output);
+    return ok;
+}
+
+// Renumbers the vertices in the order the indices first use them and drops
+// the unused ones.
+// returns 0: out of memory
+//         1: success
+static int reorderVertices(ConvMesh * Mesh)
+{
+    unsigned int * remap = (unsigned int *)malloc(Mesh->vertexCount * sizeof(unsigned int));
+    float * positions = (float *)malloc(Mesh->vertexCount * 3 * sizeof(float));
+    unsigned char * colors = (unsigned char *)malloc(Mesh->vertexCount * 4);
+    if ((remap == NULL) || (positions == NULL) || (colors == NULL))
+    {
+        free(remap);
+        free(positions);
+        free(colors);
+        return 0;
+    }
+
+    memset(remap, 0xFF, Mesh->vertexCount * sizeof(unsigned int));
+    unsigned int used = 0;
+    for (unsigned int i = 0; i < Mesh->indexCount; ++i)
+    {
+        unsigned int v = Mesh->indices[i];
+        if (remap[v] == 0xFFFFFFFF)
+        {
+            remap[v] = used;
+            memcpy(&positions[used * 3], &Mesh->positions[v * 3], 3 * sizeof(float));
+            memcpy(&colors[used * 4], &Mesh->colors[v * 4], 4);
+            ++used;
+        }
+        Mesh->indices[i] = remap[v];
+    }
+    free(remap);
+
+    free(Mesh->positions);
+    free(Mesh->colors);
+    Mesh->positions = positions;
+    Mesh->colors = colors;
+    Mesh->vertexCount = used;
+    Mesh->vertexCapacity = used;
+    return 1;
+}
+
+/***************************************************************************************
+***************************************************************************************/
+
+static void getBounds(const ConvMesh * Mesh, float * Min, float * Max)
+{
+    for (int k = 0; k < 3; ++k)
+    {
+        Min[k] = Max[k] = Mesh->positions[k];
+    }
+    for (unsigned int v = 1; v < Mesh->vertexCount; ++v)
+    {
+        for (int k = 0; k < 3; ++k)
+        {
+            float p = Mesh->positions[v * 3 + k];
+            Min[k] = (p < Min[k]) ? p : Min[k];
+            Max[k] = (p > Max[k]) ? p : Max[k];
+        }
+    }
+}
+
+// Colors from the position in the bounding box, for meshes without any.
+static void colorByPosition(ConvMesh * Mesh, const float * Min, const float * Max)
+{
+    for (unsigned int v = 0; v < Mesh->vertexCount; ++v)
+    {
+        for (int k = 0; k < 3; ++k)
+        {
+            float extent = Max[k] - Min[k];
+            float t = (extent > 0.0f) ? (Mesh->positions[v * 3 + k] - Min[k]) / extent : 0.5f;
+            Mesh->colors[v * 4 + k] = (unsigned char)(64.0f + t * 191.0f + 0.5f);
+        }
+        Mesh->colors[v * 4 + 3] = 255;
+    }
+}
+
+static int writePadding(FILE * File, long Offset)
+{
+    static const char zeros[MESH_ALIGN] = { 0 };
+    long position = ftell(File);
+    return (position >= 0) && (position <= Offset) &&
+           (fwrite(zeros, 1, (size_t)(Offset - position), File) == (size_t)(Offset - position));
+}
+
+static unsigned int alignUp(unsigned int Value)
+{
+    return (Value + MESH_ALIGN - 1) & ~(unsigned int)(MESH_ALIGN - 1);
+}
+
+// returns 0: fail
+//         1: success
+static int writeMesh(const char * Path, const ConvMesh * Mesh, int Quantize)
+{
+    MeshHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = MESH_MAGIC;
+    header.version = MESH_VERSION;
+    header.flags = (Quantize ? MESH_QUANTIZED : 0) | ((Mesh->vertexCount > 65536) ? MESH_INDEX32 : 0);
+    header.vertexCount = Mesh->vertexCount;
+    header.indexCount = Mesh->indexCount;
+    header.vertexStride = Quantize ? sizeof(MeshVertexShort) : sizeof(MeshVertexFloat);
+    header.vertexOffset = alignUp(sizeof(MeshHeader));
+    header.indexOffset = alignUp(header.vertexOffset + header.vertexCount * header.vertexStride);
+
+    float min[3];
+    float max[3];
+    getBounds(Mesh, min, max);
+    for (int k = 0; k < 3; ++k)
+    {
+        // Normalized shorts are -1 .. 1, so the box is mapped onto that.
+        header.scale[k] = Quantize ? (max[k] - min[k]) * 0.5f : 1.0f;
+        header.offset[k] = Quantize ? (max[k] + min[k]) * 0.5f : 0.0f;
+        if (header.scale[k] == 0.0f)
+        {
+            header.scale[k] = 1.0f;
+        }
+    }
+
+    FILE * file = fopen(Path, "wb");
+    if (file == NULL)
+    {
+        fprintf(stderr, "Cannot create %s.\n", Path);
+        return 0;
+    }
+
+    int ok = (fwrite(&header, sizeof(header), 1, file) == 1) && writePadding(file, header.vertexOffset);
+    for (unsigned int v = 0; ok && (v < Mesh->vertexCount); ++v)
+    {
+        const float * position = &Mesh->positions[v * 3];
+        if (Quantize)
+        {
+            MeshVertexShort vertex;
+            for (int k = 0; k < 3; ++k)
+            {
+                float n = (position[k] - header.offset[k]) / header.scale[k];
+                n = (n < -1.0f) ? -1.0f : ((n > 1.0f) ? 1.0f : n);
+                vertex.position[k] = (short)lrintf(n * 32767.0f);
+            }
+            vertex.position[3] = 0;
+            memcpy(vertex.color, &Mesh->colors[v * 4], 4);
+            ok = (fwrite(&vertex, sizeof(vertex), 1, file) == 1);
+        }
+        else
+        {
+            MeshVertexFloat vertex;
+            memcpy(vertex.position, position, sizeof(vertex.position));
+            memcpy(vertex.color, &Mesh->colors[v * 4], 4);
+            ok = (fwrite(&vertex, sizeof(vertex), 1, file) == 1);
+        }
+    }
+
+    ok = ok && writePadding(file, header.indexOffset);
+    for (unsigned int i = 0; ok && (i < Mesh->indexCount); ++i)
+    {
+        if (header.flags & MESH_INDEX32)
+        {
+            ok = (fwrite(&Mesh->indices[i], 4, 1, file) == 1);
+        }
+        else
+        {
+            unsigned short index = (unsigned short)Mesh->indices[i];
+            ok = (fwrite(&index, 2, 1, file) == 1);
+        }
+    }
+
+    if ((fclose(file) != 0) || !ok)
+    {
+        fprintf(stderr, "Cannot write %s.\n", Path);
+        return 0;
+    }
+    return 1;
+}
+
+/***************************************************************************************
+***************************************************************************************/
+
+static void PrintHelp(void)
+{
+    printf("Usage: %s [-f] input.obj output.mesh\n", CONV_NAME);
+    printf("       %s [-f] -g <size> output.mesh\n", CONV_NAME);
+    printf("  -f         keep float positions, default is normalized shorts\n");
+    printf("  -g <size>  convert a size x size grid in random order instead of a file\n");
+}
+
+static int ParseCommandLine(int argc, char * argv[])
+{
+    const char * files[2] = { NULL, NULL };
+    int fileCount = 0;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "-f") == 0)
+        {
+            keepFloats = 1;
+        }
+        else if ((strcmp(argv[i], "-g") == 0) && (i + 1 < argc))
+        {
+            gridSize = atoi(argv[++i]);
+        }
+        else if ((argv[i][0] != '-') && (fileCount < 2))
+        {
+            files[fileCount++] = argv[i];
+        }
+        else
+        {
+            return 0;
+        }
+    }
+
+    if (gridSize > 0)
+    {
+        outputFName = files[0];
+        return fileCount == 1;
+    }
+    inputFName = files[0];
+    outputFName = files[1];
+    return fileCount == 2;
+}
+
+int main(int argc, char * argv[])
+{
+    if (!ParseCommandLine(argc, argv))
+    {
+        PrintHelp();
+        return 1;
+    }
+
+    ConvMesh mesh;
+    memset(&mesh, 0, sizeof(mesh));
+    int hasColors = 0;
+    int ok = (gridSize > 0) ? makeGrid(gridSize, &mesh) : loadObj(inputFName, &mesh, &hasColors);
+    if (!ok)
+    {
+        freeMesh(&mesh);
+        return 1;
+    }
+    printf("input: %u vertices, %u triangles, ACMR %.3f (16) %.3f (32)\n", mesh.vertexCount, mesh.indexCount / 3,
+           cacheMissRatio(&mesh, 16), cacheMissRatio(&mesh, 32));
+
+    initScores();
+    unsigned long long start = convNs();
+    ok = optimizeTriangles(&mesh) && reorderVertices(&mesh);
+    if (!ok)
+    {
+        fprintf(stderr, "Out of memory.\n");
+        freeMesh(&mesh);
+        return 1;
+    }
+    printf("optimized: %u vertices, ACMR %.3f (16) %.3f (32), %.1f ms\n", mesh.vertexCount,
+           cacheMissRatio(&mesh, 16), cacheMissRatio(&mesh, 32), (convNs() - start) / 1e6);
+
+    if (!hasColors)
+    {
+        float min[3];
+        float max[3];
+        getBounds(&mesh, min, max);
+        colorByPosition(&mesh, min, max);
+    }
+    ok = writeMesh(outputFName, &mesh, !keepFloats);
+    freeMesh(&mesh);
+
+    // Read back as gpu_hello will.
+    MeshFile check;
+    memset(&check, 0, sizeof(check));
+    if (ok && MeshFileOpen(outputFName, &check) && MeshFilePrefault(&check))
+    {
+        printf("output: %s, %lu bytes, %s positions, %d-bit indices\n", outputFName, (unsigned long)check.size,
+               (check.header->flags & MESH_QUANTIZED) ? "short" : "float",
+               (check.header->flags & MESH_INDEX32) ? 32 : 16);
+        MeshFileClose(&check);
+        return 0;
+    }
+    MeshFileClose(&check);
+    return 1;
+}
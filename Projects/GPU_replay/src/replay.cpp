@@ -0,0 +1,959 @@
+/*
+ * GL trace replayer.
+ *
+ * Replays a trace recorded by gpu_hello -p <file> without the application:
+ * no scene update, no event thread, only the recorded GL calls. The whole
+ * trace is read into memory first, so the frame times are the cost of
+ * submitting the calls to the driver and swapping.
+ *
+ * The records before and including the first frame (shader builds, buffer
+ * uploads) run once, the frames after it run -l times, the records after
+ * the last frame (cleanup) run once at the end.
+ */
+#include <GLES2/gl2.h>
+#include <GLES2/gl2ext.h>
+#include <gc_vdk.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "framestats.h"
+#define GL_TRACE_NO_REDIRECT
+#include "gltrace.h"
+
+#define REPLAY_NAME "GL trace replay"
+#define REPLAY_MAX_ATTRIBS  16
+#define REPLAY_MAX_UNIFORMS 256
+#define REPLAY_MAX_DIRECT   16
+
+// Recorded object names above this are taken for a corrupt trace; GL names
+// are handed out from 1 up.
+#define REPLAY_MAX_NAME     (1 << 20)
+
+#ifndef GL_VIV_direct_texture
+#define GL_VIV_NV12 0x8FC1
+#define GL_VIV_YUY2 0x8FC2
+#endif
+
+typedef void (GL_APIENTRY * TexDirectMapProc)(GLenum Target, GLsizei Width, GLsizei Height, GLenum Format,
+                                              GLvoid ** Logical, const GLuint * Physical);
+typedef void (GL_APIENTRY * TexDirectInvalidateProc)(GLenum Target);
+
+// to hold vdk information.
+vdkEGL egl;
+int width  = -1;
+int height = -1;
+int posX   = -1;
+int posY   = -1;
+int loops  = 1;
+int pacing = 0;
+int warmupFrames = 1;
+const char * traceFName = NULL;
+const char * statsFName = NULL;
+
+typedef struct _ReplayTrace
+{
+    unsigned char *     data;
+    size_t              size;
+    GlTraceHeader       header;
+    size_t              loopBegin;      // first record after the first frame
+    size_t              loopEnd;        // first record after the last frame
+    int                 frames;
+    unsigned long long  firstFrameNs;
+    unsigned long long  lastFrameNs;
+}
+ReplayTrace;
+
+// Recorded object name to replayed name.
+typedef struct _NameMap
+{
+    GLuint *        names;
+    unsigned int    size;
+}
+NameMap;
+
+typedef struct _UniformMap
+{
+    GLuint  program;    // recorded
+    GLint   recorded;
+    GLint   location;
+}
+UniformMap;
+
+ReplayTrace trace;
+NameMap objects;            // shaders and programs share one namespace
+NameMap buffers;
+NameMap textures;
+NameMap framebuffers;
+GLint attribMap[REPLAY_MAX_ATTRIBS];
+UniformMap uniforms[REPLAY_MAX_UNIFORMS];
+int uniformCount = 0;
+GLuint currentProgram = 0;  // recorded name
+GLuint arrayBuffer = 0;     // replayed name
+void * readback = NULL;     // destination of replayed glReadPixels()
+size_t readbackSize = 0;
+void * directMemory[REPLAY_MAX_DIRECT];     // blank frames behind mapped textures
+int directCount = 0;
+TexDirectMapProc texDirectMap = NULL;
+TexDirectInvalidateProc texDirectInvalidate = NULL;
+
+int argCount = 9;
+char argSpec = '-';
+char argNames[] = {'i', 'x', 'y', 'w', 'h', 'l', 'p', 'u', 'o'};
+char argValues[][255] = {
+    "trace_file",
+    "x_coord",
+    "y_coord",
+    "width",
+    "height",
+    "loops",
+    "pacing",
+    "warmup",
+    "stats_file",
+};
+char argDescs[][255] = {
+    "trace recorded with gpu_hello -p <file>",
+    "x coordinate of the window, default is -1(screen center)",
+    "y coordinate of the window, default is -1(screen center)",
+    "width  of the window in pixels, default is the recorded width",
+    "height of the window in pixels, default is the recorded height",
+    "times the frames after the first one are replayed, default is 1",
+    "0 = as fast as possible, 1 = at the recorded frame times, default is 0",
+    "warm-up frames left out of the frame statistics, default is 1 (the setup frame)",
+    "write frame statistics to a file, .csv for CSV, JSON otherwise",
+};
+
+// Argument words each record needs, by opcode; see gltrace.h.
+static const unsigned char recordArgCounts[GL_TRACE_OP_COUNT] =
+{
+    0,  // none
+    2,  // GL_TRACE_FRAME
+    1,  // GL_TRACE_CLEAR
+    4,  // GL_TRACE_CLEAR_COLOR
+    4,  // GL_TRACE_VIEWPORT
+    0,  // GL_TRACE_FLUSH
+    0,  // GL_TRACE_FINISH
+    2,  // GL_TRACE_CREATE_SHADER
+    1,  // GL_TRACE_SHADER_SOURCE
+    1,  // GL_TRACE_COMPILE_SHADER
+    1,  // GL_TRACE_DELETE_SHADER
+    1,  // GL_TRACE_CREATE_PROGRAM
+    2,  // GL_TRACE_ATTACH_SHADER
+    1,  // GL_TRACE_LINK_PROGRAM
+    1,  // GL_TRACE_USE_PROGRAM
+    1,  // GL_TRACE_DELETE_PROGRAM
+    2,  // GL_TRACE_GET_ATTRIB_LOCATION
+    2,  // GL_TRACE_GET_UNIFORM_LOCATION
+    1,  // GL_TRACE_GEN_BUFFER
+    1,  // GL_TRACE_DELETE_BUFFER
+    2,  // GL_TRACE_BIND_BUFFER
+    4,  // GL_TRACE_BUFFER_DATA
+    2,  // GL_TRACE_BUFFER_SUB_DATA
+    1,  // GL_TRACE_ENABLE_ATTRIB
+    1,  // GL_TRACE_DISABLE_ATTRIB
+    6,  // GL_TRACE_ATTRIB_POINTER
+    5,  // GL_TRACE_CLIENT_ARRAY
+    2,  // GL_TRACE_UNIFORM_MATRIX4
+    3,  // GL_TRACE_DRAW_ARRAYS
+    5,  // GL_TRACE_DRAW_ELEMENTS
+    1,  // GL_TRACE_CLEAR_DEPTH
+    1,  // GL_TRACE_ENABLE
+    1,  // GL_TRACE_DISABLE
+    2,  // GL_TRACE_BLEND_FUNC
+    1,  // GL_TRACE_DEPTH_FUNC
+    1,  // GL_TRACE_DEPTH_MASK
+    2,  // GL_TRACE_UNIFORM1I
+    2,  // GL_TRACE_UNIFORM4
+    4,  // GL_TRACE_SCISSOR
+    1,  // GL_TRACE_GEN_TEXTURE
+    1,  // GL_TRACE_DELETE_TEXTURE
+    2,  // GL_TRACE_BIND_TEXTURE
+    3,  // GL_TRACE_TEX_PARAMETERI
+    8,  // GL_TRACE_TEX_IMAGE_2D
+    1,  // GL_TRACE_GEN_FRAMEBUFFER
+    1,  // GL_TRACE_DELETE_FRAMEBUFFER
+    2,  // GL_TRACE_BIND_FRAMEBUFFER
+    5,  // GL_TRACE_FRAMEBUFFER_TEXTURE_2D
+    6,  // GL_TRACE_READ_PIXELS
+    2,  // GL_TRACE_PIXEL_STOREI
+    8,  // GL_TRACE_TEX_SUB_IMAGE_2D
+    1,  // GL_TRACE_ACTIVE_TEXTURE
+    4,  // GL_TRACE_TEX_DIRECT_MAP
+    1,  // GL_TRACE_TEX_DIRECT_INVALIDATE
+};
+
+/***************************************************************************************
+***************************************************************************************/
+
+// In 64 bits, so a corrupt data size cannot wrap around on any target.
+static unsigned long long recordLength(const GlTraceRecord * Record)
+{
+    return sizeof(GlTraceRecord) + sizeof (unsigned int) * (unsigned long long)Record->argCount
+         + (((unsigned long long)Record->dataSize + 3) & ~3ull);
+}
+
+// Checks a complete record reads no argument and no payload it does not
+// have. Error tells what is wrong.
+// returns 0: fail
+//         1: success
+static int recordCheck(const GlTraceRecord * Record, const char ** Error)
+{
+    if ((Record->op == 0) || (Record->op >= GL_TRACE_OP_COUNT))
+    {
+        *Error = "unknown record, recorded by a newer build?";
+        return 0;
+    }
+    if (Record->argCount < recordArgCounts[Record->op])
+    {
+        *Error = "too few arguments";
+        return 0;
+    }
+
+    const unsigned int * args = (const unsigned int *)(Record + 1);
+    const char * data = (const char *)(args + Record->argCount);
+    unsigned long long needed = 0;
+    switch (Record->op)
+    {
+    case GL_TRACE_GET_ATTRIB_LOCATION:
+    case GL_TRACE_GET_UNIFORM_LOCATION:
+        if ((Record->dataSize == 0) || (memchr(data, '\0', Record->dataSize) == NULL))
+        {
+            *Error = "name not terminated";
+            return 0;
+        }
+        break;
+
+    case GL_TRACE_BUFFER_DATA:
+        needed = args[3] ? args[1] : 0;
+        break;
+
+    case GL_TRACE_UNIFORM_MATRIX4:
+        needed = sizeof (GLfloat) * 16ull * args[1];
+        break;
+
+    case GL_TRACE_UNIFORM4:
+        needed = sizeof (GLfloat) * 4ull * args[1];
+        break;
+
+    case GL_TRACE_DRAW_ELEMENTS:
+        if (args[4])
+        {
+            needed = (unsigned long long)args[1] * ((args[2] == GL_UNSIGNED_BYTE) ? 1 : (args[2] == GL_UNSIGNED_INT) ? 4 : 2);
+        }
+        break;
+
+    default:
+        break;
+    }
+    if (needed > Record->dataSize)
+    {
+        *Error = "payload shorter than the call reads";
+        return 0;
+    }
+    return 1;
+}
+
+static int mapSet(NameMap * Map, unsigned int Recorded, GLuint Name)
+{
+    if (Recorded >= REPLAY_MAX_NAME)
+    {
+        fprintf(stderr, "Recorded name %u out of range, corrupt trace?\n", Recorded);
+        return 0;
+    }
+    if (Recorded >= Map->size)
+    {
+        unsigned int size = (Map->size > 0) ? Map->size : 64;
+        while (size <= Recorded)
+        {
+            size *= 2;
+        }
+
+        GLuint * names = (GLuint *)realloc(Map->names, sizeof (GLuint) * size);
+        if (names == NULL)
+        {
+            fprintf(stderr, "Out of memory.\n");
+            return 0;
+        }
+        memset(names + Map->size, 0, sizeof (GLuint) * (size - Map->size));
+        Map->names = names;
+        Map->size  = size;
+    }
+    Map->names[Recorded] = Name;
+    return 1;
+}
+
+static GLuint mapGet(const NameMap * Map, unsigned int Recorded)
+{
+    return (Recorded < Map->size) ? Map->names[Recorded] : 0;
+}
+
+static GLint attribGet(unsigned int Recorded)
+{
+    return (Recorded < REPLAY_MAX_ATTRIBS) ? attribMap[Recorded] : (GLint)Recorded;
+}
+
+static GLint uniformGet(GLint Recorded)
+{
+    for (int i = 0; i < uniformCount; ++i)
+    {
+        if ((uniforms[i].recorded == Recorded) && (uniforms[i].program == currentProgram))
+        {
+            return uniforms[i].location;
+        }
+    }
+    return -1;
+}
+
+static float floatFromBits(unsigned int Bits)
+{
+    float value;
+    memcpy(&value, &Bits, sizeof(value));
+    return value;
+}
+
+static void sleepUntil(unsigned long long Ns)
+{
+    unsigned long long now = FrameStatsNs();
+    if (Ns > now)
+    {
+        struct timespec wait;
+        wait.tv_sec  = (time_t)((Ns - now) / 1000000000ULL);
+        wait.tv_nsec = (long)((Ns - now) % 1000000000ULL);
+        nanosleep(&wait, NULL);
+    }
+}
+
+/***************************************************************************************
+***************************************************************************************/
+
+// Reads the whole trace and checks every record lies inside the file and
+// has the arguments and payload its call reads.
+// returns 0: fail
+//         1: success
+int LoadTrace(const char * FName, ReplayTrace * Trace)
+{
+    memset(Trace, 0, sizeof(*Trace));
+
+    FILE * fptr = fopen(FName, "rb");
+    if (fptr == NULL)
+    {
+        fprintf(stderr, "Cannot open trace file '%s'\n", FName);
+        return 0;
+    }
+
+    fseek(fptr, 0, SEEK_END);
+    long size = ftell(fptr);
+    fseek(fptr, 0, SEEK_SET);
+
+    Trace->data = (unsigned char *)malloc((size > 0) ? size : 1);
+    if ((Trace->data == NULL) || (size < (long)sizeof(GlTraceHeader))
+    || (fread(Trace->data, size, 1, fptr) != 1))
+    {
+        fprintf(stderr, "Cannot read trace file '%s'\n", FName);
+        fclose(fptr);
+        free(Trace->data);
+        Trace->data = NULL;
+        return 0;
+    }
+    fclose(fptr);
+    Trace->size = size;
+
+    memcpy(&Trace->header, Trace->data, sizeof(GlTraceHeader));
+    if ((Trace->header.magic != GL_TRACE_MAGIC) || (Trace->header.version != GL_TRACE_VERSION))
+    {
+        fprintf(stderr, "'%s' is not a version %u GL trace\n", FName, GL_TRACE_VERSION);
+        free(Trace->data);
+        Trace->data = NULL;
+        return 0;
+    }
+
+    size_t offset = sizeof(GlTraceHeader);
+    while (offset < Trace->size)
+    {
+        const GlTraceRecord * record = (const GlTraceRecord *)(Trace->data + offset);
+        unsigned long long length = sizeof(GlTraceRecord);
+        if (Trace->size - offset >= length)
+        {
+            length = recordLength(record);
+        }
+
+        if (Trace->size - offset < length)
+        {
+            // A recording cut short; keep what is complete.
+            fprintf(stderr, "Trace truncated at byte %lu\n", (unsigned long)offset);
+            Trace->size = offset;
+            break;
+        }
+
+        const char * error = NULL;
+        if (!recordCheck(record, &error))
+        {
+            fprintf(stderr, "Trace record %u at byte %lu: %s\n", record->op, (unsigned long)offset, error);
+            free(Trace->data);
+            Trace->data = NULL;
+            return 0;
+        }
+        offset += (size_t)length;
+
+        if (record->op == GL_TRACE_FRAME)
+        {
+            const unsigned int * args = (const unsigned int *)(record + 1);
+            unsigned long long ns = args[0] | ((unsigned long long)args[1] << 32);
+            if (Trace->frames++ == 0)
+            {
+                Trace->loopBegin    = offset;
+                Trace->firstFrameNs = ns;
+            }
+            Trace->loopEnd     = offset;
+            Trace->lastFrameNs = ns;
+        }
+    }
+
+    if (Trace->frames == 0)
+    {
+        Trace->loopBegin = Trace->loopEnd = Trace->size;
+    }
+    return 1;
+}
+
+// Issues one record; frames are handled by the caller.
+// returns 0: unknown record or name out of range
+//         1: success
+int ReplayRecord(const GlTraceRecord * Record)
+{
+    const unsigned int * args = (const unsigned int *)(Record + 1);
+    const void * data = args + Record->argCount;
+
+    switch (Record->op)
+    {
+    case GL_TRACE_CLEAR:
+        glClear(args[0]);
+        break;
+
+    case GL_TRACE_CLEAR_COLOR:
+        glClearColor(floatFromBits(args[0]), floatFromBits(args[1]), floatFromBits(args[2]), floatFromBits(args[3]));
+        break;
+
+    case GL_TRACE_VIEWPORT:
+        glViewport(args[0], args[1], args[2], args[3]);
+        break;
+
+    case GL_TRACE_FLUSH:
+        glFlush();
+        break;
+
+    case GL_TRACE_FINISH:
+        glFinish();
+        break;
+
+    case GL_TRACE_CREATE_SHADER:
+        return mapSet(&objects, args[1], glCreateShader(args[0]));
+
+    case GL_TRACE_SHADER_SOURCE:
+    {
+        const GLchar * source = (const GLchar *)data;
+        GLint length = Record->dataSize;
+        glShaderSource(mapGet(&objects, args[0]), 1, &source, &length);
+        break;
+    }
+
+    case GL_TRACE_COMPILE_SHADER:
+        glCompileShader(mapGet(&objects, args[0]));
+        break;
+
+    case GL_TRACE_DELETE_SHADER:
+        glDeleteShader(mapGet(&objects, args[0]));
+        break;
+
+    case GL_TRACE_CREATE_PROGRAM:
+        return mapSet(&objects, args[0], glCreateProgram());
+
+    case GL_TRACE_ATTACH_SHADER:
+        glAttachShader(mapGet(&objects, args[0]), mapGet(&objects, args[1]));
+        break;
+
+    case GL_TRACE_LINK_PROGRAM:
+        glLinkProgram(mapGet(&objects, args[0]));
+        break;
+
+    case GL_TRACE_USE_PROGRAM:
+        currentProgram = args[0];
+        glUseProgram(mapGet(&objects, args[0]));
+        break;
+
+    case GL_TRACE_DELETE_PROGRAM:
+        glDeleteProgram(mapGet(&objects, args[0]));
+        break;
+
+    case GL_TRACE_GET_ATTRIB_LOCATION:
+        if (args[1] < REPLAY_MAX_ATTRIBS)
+        {
+            attribMap[args[1]] = glGetAttribLocation(mapGet(&objects, args[0]), (const GLchar *)data);
+        }
+        break;
+
+    case GL_TRACE_GET_UNIFORM_LOCATION:
+        if (uniformCount < REPLAY_MAX_UNIFORMS)
+        {
+            UniformMap & uniform = uniforms[uniformCount++];
+            uniform.program  = args[0];
+            uniform.recorded = (GLint)args[1];
+            uniform.location = glGetUniformLocation(mapGet(&objects, args[0]), (const GLchar *)data);
+        }
+        break;
+
+    case GL_TRACE_GEN_BUFFER:
+    {
+        GLuint buffer = 0;
+        glGenBuffers(1, &buffer);
+        return mapSet(&buffers, args[0], buffer);
+    }
+
+    case GL_TRACE_DELETE_BUFFER:
+    {
+        GLuint buffer = mapGet(&buffers, args[0]);
+        glDeleteBuffers(1, &buffer);
+        arrayBuffer = (arrayBuffer == buffer) ? 0 : arrayBuffer;
+        break;
+    }
+
+    case GL_TRACE_BIND_BUFFER:
+        if (args[0] == GL_ARRAY_BUFFER)
+        {
+            arrayBuffer = mapGet(&buffers, args[1]);
+        }
+        glBindBuffer(args[0], mapGet(&buffers, args[1]));
+        break;
+
+    case GL_TRACE_BUFFER_DATA:
+        glBufferData(args[0], args[1], args[3] ? data : NULL, args[2]);
+        break;
+
+    case GL_TRACE_BUFFER_SUB_DATA:
+        glBufferSubData(args[0], args[1], Record->dataSize, data);
+        break;
+
+    case GL_TRACE_ENABLE_ATTRIB:
+        glEnableVertexAttribArray(attribGet(args[0]));
+        break;
+
+    case GL_TRACE_DISABLE_ATTRIB:
+        glDisableVertexAttribArray(attribGet(args[0]));
+        break;
+
+    case GL_TRACE_ATTRIB_POINTER:
+        glVertexAttribPointer(attribGet(args[0]), args[1], args[2], (GLboolean)args[3], args[4],
+                              (const GLvoid *)(size_t)args[5]);
+        break;
+
+    case GL_TRACE_CLIENT_ARRAY:
+        // Client arrays were set with no array buffer bound.
+        if (arrayBuffer != 0)
+        {
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+        }
+        glVertexAttribPointer(attribGet(args[0]), args[1], args[2], (GLboolean)args[3], args[4], data);
+        if (arrayBuffer != 0)
+        {
+            glBindBuffer(GL_ARRAY_BUFFER, arrayBuffer);
+        }
+        break;
+
+    case GL_TRACE_UNIFORM_MATRIX4:
+        glUniformMatrix4fv(uniformGet((GLint)args[0]), args[1], GL_FALSE, (const GLfloat *)data);
+        break;
+
+    case GL_TRACE_DRAW_ARRAYS:
+        glDrawArrays(args[0], args[1], args[2]);
+        break;
+
+    case GL_TRACE_DRAW_ELEMENTS:
+        glDrawElements(args[0], args[1], args[2], args[4] ? data : (const GLvoid *)(size_t)args[3]);
+        break;
+
+    case GL_TRACE_CLEAR_DEPTH:
+        glClearDepthf(floatFromBits(args[0]));
+        break;
+
+    case GL_TRACE_ENABLE:
+        glEnable(args[0]);
+        break;
+
+    case GL_TRACE_DISABLE:
+        glDisable(args[0]);
+        break;
+
+    case GL_TRACE_BLEND_FUNC:
+        glBlendFunc(args[0], args[1]);
+        break;
+
+    case GL_TRACE_DEPTH_FUNC:
+        glDepthFunc(args[0]);
+        break;
+
+    case GL_TRACE_DEPTH_MASK:
+        glDepthMask((GLboolean)args[0]);
+        break;
+
+    case GL_TRACE_UNIFORM1I:
+        glUniform1i(uniformGet((GLint)args[0]), (GLint)args[1]);
+        break;
+
+    case GL_TRACE_UNIFORM4:
+        glUniform4fv(uniformGet((GLint)args[0]), args[1], (const GLfloat *)data);
+        break;
+
+    case GL_TRACE_SCISSOR:
+        glScissor(args[0], args[1], args[2], args[3]);
+        break;
+
+    case GL_TRACE_GEN_TEXTURE:
+    {
+        GLuint texture = 0;
+        glGenTextures(1, &texture);
+        return mapSet(&textures, args[0], texture);
+    }
+
+    case GL_TRACE_DELETE_TEXTURE:
+    {
+        GLuint texture = mapGet(&textures, args[0]);
+        glDeleteTextures(1, &texture);
+        break;
+    }
+
+    case GL_TRACE_BIND_TEXTURE:
+        glBindTexture(args[0], mapGet(&textures, args[1]));
+        break;
+
+    case GL_TRACE_TEX_PARAMETERI:
+        glTexParameteri(args[0], args[1], args[2]);
+        break;
+
+    case GL_TRACE_TEX_IMAGE_2D:
+        glTexImage2D(args[0], args[1], args[2], args[3], args[4], 0, args[5], args[6], args[7] ? data : NULL);
+        break;
+
+    case GL_TRACE_GEN_FRAMEBUFFER:
+    {
+        GLuint framebuffer = 0;
+        glGenFramebuffers(1, &framebuffer);
+        return mapSet(&framebuffers, args[0], framebuffer);
+    }
+
+    case GL_TRACE_DELETE_FRAMEBUFFER:
+    {
+        GLuint framebuffer = mapGet(&framebuffers, args[0]);
+        glDeleteFramebuffers(1, &framebuffer);
+        break;
+    }
+
+    case GL_TRACE_BIND_FRAMEBUFFER:
+        glBindFramebuffer(args[0], mapGet(&framebuffers, args[1]));
+        break;
+
+    case GL_TRACE_FRAMEBUFFER_TEXTURE_2D:
+        glFramebufferTexture2D(args[0], args[1], args[2], mapGet(&textures, args[3]), args[4]);
+        break;
+
+    case GL_TRACE_READ_PIXELS:
+    {
+        // Same transfer, the pixels are not compared. Any format is at most
+        // four bytes per pixel.
+        size_t size = (size_t)args[2] * args[3] * 4;
+        if (size > readbackSize)
+        {
+            void * buffer = realloc(readback, size);
+            if (buffer == NULL)
+            {
+                fprintf(stderr, "Out of memory.\n");
+                return 0;
+            }
+            readback = buffer;
+            readbackSize = size;
+        }
+        glReadPixels(args[0], args[1], args[2], args[3], args[4], args[5], readback);
+        break;
+    }
+
+    case GL_TRACE_PIXEL_STOREI:
+        glPixelStorei(args[0], args[1]);
+        break;
+
+    case GL_TRACE_TEX_SUB_IMAGE_2D:
+        glTexSubImage2D(args[0], args[1], args[2], args[3], args[4], args[5], args[6], args[7], data);
+        break;
+
+    case GL_TRACE_ACTIVE_TEXTURE:
+        glActiveTexture(args[0]);
+        break;
+
+    case GL_TRACE_TEX_DIRECT_MAP:
+    {
+        // The camera frames were not recorded: a blank frame of the same
+        // layout is mapped, or uploaded as RGBA without the extension.
+        size_t planeSize = (size_t)args[1] * args[2];
+        void * memory = (directCount < REPLAY_MAX_DIRECT) ? calloc(1, planeSize * 2) : NULL;
+        if ((texDirectMap == NULL) || (memory == NULL))
+        {
+            free(memory);
+            glTexImage2D(args[0], 0, GL_RGBA, args[1], args[2], 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+            break;
+        }
+        directMemory[directCount++] = memory;
+
+        GLvoid * logical[2] = { memory, (unsigned char *)memory + planeSize };
+        GLuint physical = ~0u;
+        texDirectMap(args[0], args[1], args[2], args[3], logical, &physical);
+        break;
+    }
+
+    case GL_TRACE_TEX_DIRECT_INVALIDATE:
+        if (texDirectInvalidate != NULL)
+        {
+            texDirectInvalidate(args[0]);
+        }
+        break;
+
+    default:
+        fprintf(stderr, "Unknown trace record %u, recorded by a newer build?\n", Record->op);
+        return 0;
+    }
+    return 1;
+}
+
+/***************************************************************************************
+***************************************************************************************/
+
+// Replays [Begin, End); every frame record swaps.
+// returns 0: stopped (error, escape or close)
+//         1: success
+int ReplayRange(size_t Begin, size_t End, unsigned long long PaceOffsetNs, int * FrameCount)
+{
+    size_t offset = Begin;
+    while (offset < End)
+    {
+        const GlTraceRecord * record = (const GlTraceRecord *)(trace.data + offset);
+        offset += (size_t)recordLength(record);
+
+        if (record->op != GL_TRACE_FRAME)
+        {
+            if (!ReplayRecord(record))
+            {
+                return 0;
+            }
+            continue;
+        }
+
+        FrameStatsLap(FRAME_PHASE_RENDER);
+        vdkSwapEGL(&egl);
+        FrameStatsLap(FRAME_PHASE_SWAP);
+        FrameStatsEnd();
+        ++ *FrameCount;
+
+        if (pacing)
+        {
+            // Idle time until the recorded swap is not frame time.
+            const unsigned int * args = (const unsigned int *)(record + 1);
+            unsigned long long ns = args[0] | ((unsigned long long)args[1] << 32);
+            sleepUntil(PaceOffsetNs + ns);
+            FrameStatsRestart();
+        }
+
+        vdkEvent event;
+        while (vdkGetEvent(egl.window, &event))
+        {
+            if (((event.type == VDK_KEYBOARD) && event.data.keyboard.pressed
+              && (event.data.keyboard.scancode == VDK_ESCAPE))
+            || (event.type == VDK_CLOSE))
+            {
+                return 0;
+            }
+        }
+        FrameStatsLap(FRAME_PHASE_EVENTS);
+    }
+    return 1;
+}
+
+/***************************************************************************************
+***************************************************************************************/
+
+int ParseCommandLine(int argc, char * argv[])
+{
+    int result = 1;
+    // Walk all command line arguments.
+    for (int i = 1; i < argc; ++i)
+    {
+        if ((argv[i][0] != '-') || (++i >= argc))
+        {
+            result = 0;
+            break;
+        }
+
+        switch (argv[i - 1][1])
+        {
+        case 'i':
+            traceFName = argv[i];
+            break;
+
+        case 'x':
+            posX = atoi(&argv[i][0]);
+            break;
+
+        case 'y':
+            posY = atoi(&argv[i][0]);
+            break;
+
+        case 'w':
+            width = atoi(&argv[i][0]);
+            break;
+
+        case 'h':
+            height = atoi(&argv[i][0]);
+            break;
+
+        case 'l':
+            loops = atoi(&argv[i][0]);
+            break;
+
+        case 'p':
+            pacing = atoi(&argv[i][0]);
+            break;
+
+        case 'u':
+            warmupFrames = atoi(&argv[i][0]);
+            break;
+
+        case 'o':
+            statsFName = argv[i];
+            break;
+
+        default:
+            result = 0;
+            break;
+        }
+
+        if (result == 0)
+        {
+            break;
+        }
+    }
+
+    return result && (traceFName != NULL);
+}
+
+void PrintHelp()
+{
+    printf("Usage: ");
+    printf("command + [arguments]\n");
+    printf("Argument List:\n");
+
+    for (int i = 0; i < argCount; i++)
+    {
+        printf("\t");
+        printf("%c%c %s\t%s\n", argSpec, argNames[i], argValues[i], argDescs[i]);
+    }
+}
+
+// Program entry.
+int main(int argc, char** argv)
+{
+    EGLint configAttribs[] =
+    {
+        EGL_SAMPLES,      0,
+        EGL_RED_SIZE,     8,
+        EGL_GREEN_SIZE,   8,
+        EGL_BLUE_SIZE,    8,
+        EGL_ALPHA_SIZE,   EGL_DONT_CARE,
+        EGL_DEPTH_SIZE,   0,
+        EGL_SURFACE_TYPE, EGL_WINDOW_BIT,
+        EGL_NONE,
+    };
+
+    EGLint attribListContext[] =
+    {
+        EGL_CONTEXT_CLIENT_VERSION, 2,
+        EGL_NONE
+    };
+
+    if (!ParseCommandLine(argc, argv))
+    {
+        PrintHelp();
+        return 0;
+    }
+
+    if (!LoadTrace(traceFName, &trace))
+    {
+        return 1;
+    }
+    printf("trace: %lu bytes, %d frames over %.3f ms\n", (unsigned long)trace.size, trace.frames,
+           (trace.lastFrameNs - trace.firstFrameNs) / 1e6);
+
+    width  = (width  >= 0) ? width  : (int)trace.header.width;
+    height = (height >= 0) ? height : (int)trace.header.height;
+    if (!vdkSetupEGL(posX, posY, width, height, configAttribs, NULL, attribListContext, &egl))
+    {
+        fprintf(stderr, "EGL setup failed.\n");
+        free(trace.data);
+        return 1;
+    }
+    vdkSetWindowTitle(egl.window, REPLAY_NAME);
+    vdkShowWindow(egl.window);
+
+    // GL_VIV_direct_texture, for traces of the camera's zero-copy path.
+    texDirectMap = (TexDirectMapProc)eglGetProcAddress("glTexDirectVIVMap");
+    texDirectInvalidate = (TexDirectInvalidateProc)eglGetProcAddress("glTexDirectInvalidateVIV");
+    if ((texDirectMap == NULL) || (texDirectInvalidate == NULL))
+    {
+        texDirectMap = NULL;
+        texDirectInvalidate = NULL;
+    }
+
+    for (int i = 0; i < REPLAY_MAX_ATTRIBS; ++i)
+    {
+        attribMap[i] = i;
+    }
+
+    FrameStatsInit(warmupFrames);
+
+    int frameCount = 0;
+    unsigned long long start = FrameStatsNs();
+
+    // Setup and the first frame, the frames after it loops times, cleanup.
+    int result = ReplayRange(sizeof(GlTraceHeader), trace.loopBegin, start - trace.firstFrameNs, &frameCount);
+    for (int loop = 0; result && (loop < loops); ++loop)
+    {
+        unsigned long long paceOffset = FrameStatsNs() - trace.firstFrameNs;
+        result = ReplayRange(trace.loopBegin, trace.loopEnd, paceOffset, &frameCount);
+    }
+    unsigned long long elapsed = FrameStatsNs() - start;
+    ReplayRange(trace.loopEnd, trace.size, 0, &frameCount);
+    glFinish();
+
+    float fps = (elapsed > 0) ? (float)(frameCount * 1e9 / elapsed) : 0.0f;
+    printf("%d frames in %d ticks -> %.3f fps\n", frameCount, (int)(elapsed / 1000000), fps);
+    FrameStatsPrint(stdout);
+    if (statsFName != NULL)
+    {
+        FrameStatsWrite(statsFName);
+    }
+
+    GLenum error = glGetError();
+    if (error != GL_NO_ERROR)
+    {
+        printf("GL error 0x%04X during replay\n", error);
+    }
+
+    vdkFinishEGL(&egl);
+    free(objects.names);
+    free(buffers.names);
+    free(textures.names);
+    free(framebuffers.names);
+    free(readback);
+    for (int i = 0; i < directCount; ++i)
+    {
+        free(directMemory[i]);
+    }
+    free(trace.data);
+
+    return 0;
+}